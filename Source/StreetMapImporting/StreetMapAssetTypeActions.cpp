@@ -2,6 +2,11 @@
 #include "StreetMap.h"
 #include "AssetRegistry/AssetData.h"
 #include "EditorFramework/AssetImportData.h"
+#include "StreetMapTileBuilder.h"
+#include "StreetMapTileActor.h"
+#include "ToolMenuSection.h"
+#include "ScopedTransaction.h"
+#include "Editor.h"
 
 #define LOCTEXT_NAMESPACE "StreetMapImporting"
 
@@ -60,4 +65,62 @@ void FStreetMapAssetTypeActions::GetResolvedSourceFilePaths(const TArray<UObject
 	}
 }
 
+
+
+bool FStreetMapAssetTypeActions::HasActions( const TArray<UObject*>& InObjects ) const
+{
+	return true;
+}
+
+
+void FStreetMapAssetTypeActions::GetActions( const TArray<UObject*>& InObjects, FToolMenuSection& Section )
+{
+	TArray<TWeakObjectPtr<UStreetMap>> StreetMaps = GetTypedWeakObjectPtrs<UStreetMap>( InObjects );
+
+	Section.AddMenuEntry(
+		"StreetMap_SplitIntoTiles",
+		LOCTEXT( "StreetMap_SplitIntoTiles", "Split Into Tiles" ),
+		LOCTEXT( "StreetMap_SplitIntoTilesTooltip", "Splits the street map into one tile asset per grid cell, and places a spatially loaded tile actor for each tile in the current level.  With World Partition, only the tiles near the player are loaded." ),
+		FSlateIcon(),
+		FUIAction(
+			FExecuteAction::CreateSP( this, &FStreetMapAssetTypeActions::ExecuteSplitIntoTiles, StreetMaps ),
+			FCanExecuteAction::CreateLambda( [StreetMaps]()
+			{
+				// Tiles can't be split any further
+				for( const TWeakObjectPtr<UStreetMap>& StreetMap : StreetMaps )
+				{
+					if( StreetMap.IsValid() && !StreetMap->IsTile() )
+					{
+						return true;
+					}
+				}
+				return false;
+			} )
+		)
+	);
+}
+
+
+void FStreetMapAssetTypeActions::ExecuteSplitIntoTiles( TArray<TWeakObjectPtr<UStreetMap>> StreetMaps )
+{
+	UWorld* World = GEditor != nullptr ? GEditor->GetEditorWorldContext().World() : nullptr;
+
+	const FScopedTransaction Transaction( LOCTEXT( "SplitIntoTilesTransaction", "Split Street Map Into Tiles" ) );
+
+	for( const TWeakObjectPtr<UStreetMap>& WeakStreetMap : StreetMaps )
+	{
+		UStreetMap* StreetMap = WeakStreetMap.Get();
+		if( StreetMap == nullptr || StreetMap->IsTile() )
+		{
+			continue;
+		}
+
+		const TArray<UStreetMap*> Tiles = FStreetMapTileBuilder::CreateTileAssets( *StreetMap );
+		if( World != nullptr && Tiles.Num() > 0 )
+		{
+			FStreetMapTileBuilder::SpawnTileActors( *World, Tiles );
+		}
+	}
+}
+
 #undef LOCTEXT_NAMESPACE
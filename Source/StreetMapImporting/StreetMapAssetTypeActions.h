@@ -14,4 +14,11 @@ public:
 	virtual FText GetAssetDescription(const FAssetData& AssetData) const override;
 	virtual bool IsImportedAsset() const override;
 	virtual void GetResolvedSourceFilePaths( const TArray<UObject*>& TypeAssets, TArray<FString>& OutSourceFilePaths ) const override;
+	virtual bool HasActions( const TArray<UObject*>& InObjects ) const override;
+	virtual void GetActions( const TArray<UObject*>& InObjects, struct FToolMenuSection& Section ) override;
+
+private:
+
+	/** Splits each street map into one tile asset per grid cell, and spawns a spatially loaded actor for each tile */
+	void ExecuteSplitIntoTiles( TArray<TWeakObjectPtr<class UStreetMap>> StreetMaps );
 };
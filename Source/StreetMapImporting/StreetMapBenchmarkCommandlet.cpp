@@ -0,0 +1,469 @@
+#include "StreetMapBenchmarkCommandlet.h"
+#include "StreetMapSyntheticCity.h"
+#include "StreetMap.h"
+#include "StreetMapComponent.h"
+#include "StreetMapDerivedData.h"
+#include "StreetMapSnapshot.h"
+#include "StreetMapSubsystem.h"
+#include "StreetMapPCGData.h"
+#include "OSMFile.h"
+#include "StreetMapOSMConverter.h"
+#include "Data/PCGPointData.h"
+#include "Engine/World.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/App.h"
+#include "Misc/DateTime.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogStreetMapBenchmark, Log, All);
+
+namespace StreetMapBenchmark
+{
+	/** Summary of the timings of one benchmark, in milliseconds */
+	struct FTimingSummary
+	{
+		double Min = 0.0;
+		double Median = 0.0;
+		double Mean = 0.0;
+		double Max = 0.0;
+
+		explicit FTimingSummary(TArray<double> Milliseconds)
+		{
+			if (Milliseconds.Num() == 0)
+			{
+				return;
+			}
+
+			Milliseconds.Sort();
+			Min = Milliseconds[0];
+			Max = Milliseconds.Last();
+			Median = Milliseconds.Num() % 2 == 1
+				? Milliseconds[Milliseconds.Num() / 2]
+				: (Milliseconds[Milliseconds.Num() / 2 - 1] + Milliseconds[Milliseconds.Num() / 2]) * 0.5;
+
+			for (const double Sample : Milliseconds)
+			{
+				Mean += Sample;
+			}
+			Mean /= Milliseconds.Num();
+		}
+	};
+}
+
+
+UStreetMapBenchmarkCommandlet::UStreetMapBenchmarkCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+int32 UStreetMapBenchmarkCommandlet::Main(const FString& Params)
+{
+	FStreetMapSyntheticCitySettings CitySettings;
+	FParse::Value(*Params, TEXT("GridSize="), CitySettings.GridSize);
+	FParse::Value(*Params, TEXT("BlockSize="), CitySettings.BlockSize);
+	FParse::Value(*Params, TEXT("OrganicStreets="), CitySettings.OrganicStreetCount);
+	FParse::Value(*Params, TEXT("Buildings="), CitySettings.BuildingCount);
+	FParse::Value(*Params, TEXT("Seed="), CitySettings.Seed);
+
+	int32 Iterations = 5;
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	Iterations = FMath::Max(Iterations, 1);
+
+	int32 QueryCount = 1000;
+	FParse::Value(*Params, TEXT("Queries="), QueryCount);
+	QueryCount = FMath::Max(QueryCount, 1);
+
+	FString Label = TEXT("Default");
+	FParse::Value(*Params, TEXT("Label="), Label);
+
+	FString OutputDirectory = FPaths::ProjectSavedDir() / TEXT("StreetMapBenchmarks");
+	FParse::Value(*Params, TEXT("Output="), OutputDirectory);
+
+	Results.Reset();
+
+	// City
+	FStreetMapSyntheticCityStats CityStats;
+	const FString CityXml = FStreetMapSyntheticCity::GenerateOSMXml(CitySettings, CityStats);
+	UE_LOG(LogStreetMapBenchmark, Display, TEXT("Generated a city with %d nodes, %d roads and %d buildings (%.1f MB of XML)"),
+		CityStats.NodeCount, CityStats.RoadCount, CityStats.BuildingCount, CityXml.Len() * sizeof(TCHAR) / (1024.0 * 1024.0));
+
+	UStreetMap* StreetMap = NewObject<UStreetMap>(GetTransientPackage(), TEXT("StreetMapBenchmark"), RF_Transient);
+	StreetMap->AddToRoot();
+
+	// Import: parse the XML and convert it into the street map
+	bool bImported = true;
+	RunBenchmark(TEXT("Import"), Iterations, [&]() -> int64
+	{
+		// The parser works in place, so every run needs its own copy.  Copying is a small fraction of parsing.
+		FString MutableCityXml = CityXml;
+		FOSMFile OSMFile;
+		bImported &= OSMFile.LoadOpenStreetMapFile(MutableCityXml, /* bIsFilePathActuallyTextBuffer */ true, nullptr);
+		FStreetMapOSMConverter::Convert(OSMFile, *StreetMap);
+		return CityStats.NodeCount;
+	});
+
+	// Everything below reads the published snapshot, as runtime code does.  Editing the map would copy its data out of
+	// the snapshot, and a commandlet has no end of frame to publish it again.
+	const TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot = StreetMap->GetSnapshot();
+	if (!bImported || !Snapshot.IsValid() || Snapshot->GetRoads().Num() == 0)
+	{
+		UE_LOG(LogStreetMapBenchmark, Error, TEXT("Couldn't import the synthetic city"));
+		StreetMap->RemoveFromRoot();
+		return 1;
+	}
+
+	// Derived data is built directly, so the derived data cache doesn't hide the cost
+	RunBenchmark(TEXT("BuildDerivedData"), Iterations, [&]() -> int64
+	{
+		FStreetMapDerivedData DerivedData;
+		DerivedData.Build(*Snapshot);
+		return Snapshot->GetBuildings().Num();
+	});
+
+	// Component mesh and collision.  Mesh generation uses the map's derived data, so make sure it's there first.
+	Snapshot->GetDerivedData();
+
+	UStreetMapComponent* Component = NewObject<UStreetMapComponent>(GetTransientPackage(), NAME_None, RF_Transient);
+	Component->AddToRoot();
+	Component->SetCanEverAffectNavigation(false);
+	Component->SetStreetMap(StreetMap);
+
+	RunBenchmark(TEXT("GenerateMesh"), Iterations, [&]() -> int64
+	{
+		Component->GenerateMesh();
+		return Component->GetNumMeshVertices();
+	});
+
+	FStreetMapCollisionSettings CollisionSettings = Component->GetCollisionSettings();
+	CollisionSettings.bGenerateCollision = true;
+	RunBenchmark(TEXT("GenerateCollision"), Iterations, [&]() -> int64
+	{
+		Component->SetCollisionSettings(CollisionSettings);
+		return Component->GetNumMeshTriangles();
+	});
+
+	// Subsystem queries, at the same random locations for every run
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, /* bInformEngineOfWorld */ false);
+	UStreetMapSubsystem* Subsystem = World->GetSubsystem<UStreetMapSubsystem>();
+	Subsystem->RegisterStreetMap(StreetMap);
+
+	FRandomStream Random(CitySettings.Seed);
+	const FVector2D BoundsMin = Snapshot->GetBoundsMin();
+	const FVector2D BoundsMax = Snapshot->GetBoundsMax();
+	TArray<FVector> QueryLocations;
+	QueryLocations.Reserve(QueryCount);
+	for (int32 QueryIndex = 0; QueryIndex < QueryCount; ++QueryIndex)
+	{
+		QueryLocations.Emplace(Random.FRandRange(BoundsMin.X, BoundsMax.X), Random.FRandRange(BoundsMin.Y, BoundsMax.Y), 0.0);
+	}
+
+	RunBenchmark(TEXT("FindNearestRoadPoint"), Iterations, [&]() -> int64
+	{
+		for (const FVector& Location : QueryLocations)
+		{
+			FStreetMapRoadPointRef RoadPoint;
+			Subsystem->FindNearestRoadPoint(Location, RoadPoint);
+		}
+		return QueryLocations.Num();
+	});
+
+	RunBenchmark(TEXT("FindNearestRoadLocation"), Iterations, [&]() -> int64
+	{
+		for (const FVector& Location : QueryLocations)
+		{
+			FStreetMapRoadLocation RoadLocation;
+			Subsystem->FindNearestRoadLocation(Location, RoadLocation);
+		}
+		return QueryLocations.Num();
+	});
+
+	// Radius of one block, in map units
+	const float QueryRadius = (float)(CitySettings.BlockSize * 100.0);
+	RunBenchmark(TEXT("FindBuildingsInRadius"), Iterations, [&]() -> int64
+	{
+		for (const FVector& Location : QueryLocations)
+		{
+			Subsystem->FindBuildingsInRadius(Location, QueryRadius);
+		}
+		return QueryLocations.Num();
+	});
+
+	TArray<FStreetMapRoadLocation> RoadLocations;
+	RoadLocations.SetNum(QueryLocations.Num());
+	RunBenchmark(TEXT("FindNearestRoadLocationsBatch"), Iterations, [&]() -> int64
+	{
+		Subsystem->FindNearestRoadLocations(QueryLocations, RoadLocations);
+		return QueryLocations.Num();
+	});
+
+	TArray<FStreetMapBuildingRef> BatchBuildings;
+	TArray<int32> BatchResultOffsets;
+	RunBenchmark(TEXT("FindBuildingsInRadiusBatch"), Iterations, [&]() -> int64
+	{
+		Subsystem->FindBuildingsInRadiusBatch(QueryLocations, QueryRadius, BatchBuildings, BatchResultOffsets);
+		return QueryLocations.Num();
+	});
+
+	RunBenchmark(TEXT("FindBuildingAtLocation"), Iterations, [&]() -> int64
+	{
+		for (const FVector& Location : QueryLocations)
+		{
+			Subsystem->FindBuildingAtLocation(Location);
+		}
+		return QueryLocations.Num();
+	});
+
+	RunBenchmark(TEXT("FindBuildingsInBox"), Iterations, [&]() -> int64
+	{
+		for (const FVector& Location : QueryLocations)
+		{
+			Subsystem->FindBuildingsInBox(FBox(Location - FVector(QueryRadius), Location + FVector(QueryRadius)));
+		}
+		return QueryLocations.Num();
+	});
+
+	// The 8 closest intersections and the 20 nearest buildings
+	FStreetMapQueryFilter IntersectionFilter;
+	IntersectionFilter.MinNodeRoadCount = 2;
+	RunBenchmark(TEXT("FindNearestNodes"), Iterations, [&]() -> int64
+	{
+		for (const FVector& Location : QueryLocations)
+		{
+			Subsystem->FindNearestNodes(Location, 8, IntersectionFilter);
+		}
+		return QueryLocations.Num();
+	});
+
+	RunBenchmark(TEXT("FindNearestBuildings"), Iterations, [&]() -> int64
+	{
+		for (const FVector& Location : QueryLocations)
+		{
+			Subsystem->FindNearestBuildings(Location, 20, FStreetMapQueryFilter());
+		}
+		return QueryLocations.Num();
+	});
+
+	// Minimap sized boxes, a few blocks across, into the same result every time
+	FStreetMapVolumeQueryResult VolumeResult;
+	RunBenchmark(TEXT("FindFeaturesInBox"), Iterations, [&]() -> int64
+	{
+		for (const FVector& Location : QueryLocations)
+		{
+			Subsystem->FindFeaturesInBox(FBox(Location - FVector(QueryRadius * 2.0, QueryRadius * 2.0, 0.0), Location + FVector(QueryRadius * 2.0, QueryRadius * 2.0, 10000.0)), VolumeResult);
+		}
+		return QueryLocations.Num();
+	});
+
+	// Line of sight at head height between pairs of query locations a few blocks apart
+	TArray<FVector> TraceStarts;
+	TArray<FVector> TraceEnds;
+	for (int32 QueryIndex = 0; QueryIndex < QueryLocations.Num(); ++QueryIndex)
+	{
+		TraceStarts.Add(QueryLocations[QueryIndex] + FVector(0.0, 0.0, 170.0));
+		TraceEnds.Add(TraceStarts.Last() + FVector(Random.FRandRange(-1.0, 1.0), Random.FRandRange(-1.0, 1.0), 0.0).GetSafeNormal2D() * QueryRadius * 4.0);
+	}
+	RunBenchmark(TEXT("LineTraceBuildings"), Iterations, [&]() -> int64
+	{
+		for (int32 QueryIndex = 0; QueryIndex < TraceStarts.Num(); ++QueryIndex)
+		{
+			FStreetMapBuildingHit Hit;
+			Subsystem->LineTraceBuildings(TraceStarts[QueryIndex], TraceEnds[QueryIndex], Hit);
+		}
+		return TraceStarts.Num();
+	});
+
+	TArray<FStreetMapBuildingHit> TraceHits;
+	TraceHits.SetNum(TraceStarts.Num());
+	RunBenchmark(TEXT("LineTraceBuildingsBatch"), Iterations, [&]() -> int64
+	{
+		Subsystem->LineTraceBuildingsBatch(TraceStarts, TraceEnds, TraceHits);
+		return TraceStarts.Num();
+	});
+
+	// GPS traces driven down random roads, a sample every 10m with up to 5m of noise, 100 samples or to the end of the road
+	TArray<FVector> GpsSamples;
+	TArray<int32> GpsTraceOffsets;
+	GpsTraceOffsets.Add(0);
+	const TArray<FStreetMapRoad>& Roads = Snapshot->GetRoads();
+	for (int32 TraceIndex = 0; TraceIndex < FMath::Max(QueryCount / 100, 1) && Roads.Num() > 0; ++TraceIndex)
+	{
+		const FStreetMapRoad& Road = Roads[Random.RandRange(0, Roads.Num() - 1)];
+		const float RoadLength = Road.ComputeLengthOfRoad(*StreetMap);
+		for (int32 SampleIndex = 0; SampleIndex < 100 && SampleIndex * 1000.0f <= RoadLength; ++SampleIndex)
+		{
+			const FVector2D Location = Road.MakeLocationAlongRoad(*StreetMap, SampleIndex * 1000.0f);
+			GpsSamples.Emplace(Location.X + Random.FRandRange(-500.0f, 500.0f), Location.Y + Random.FRandRange(-500.0f, 500.0f), 0.0);
+		}
+		GpsTraceOffsets.Add(GpsSamples.Num());
+	}
+	TArray<FStreetMapRoadLocation> MatchedLocations;
+	MatchedLocations.SetNum(GpsSamples.Num());
+	RunBenchmark(TEXT("MatchTraces"), Iterations, [&]() -> int64
+	{
+		Subsystem->MatchTraces(GpsSamples, GpsTraceOffsets, FStreetMapMapMatchSettings(), MatchedLocations);
+		return GpsSamples.Num();
+	});
+
+	// Search as you type: the first few letters of random road names, as typed and with the last letter mistyped.  The
+	// first search builds the name index, so it isn't timed.
+	TArray<FString> NamePrefixes;
+	for (int32 QueryIndex = 0; QueryIndex < QueryCount; ++QueryIndex)
+	{
+		const FString& RoadName = Roads[Random.RandRange(0, Roads.Num() - 1)].GetRoadName(*StreetMap);
+		NamePrefixes.Add(RoadName.Left(Random.RandRange(2, FMath::Max(RoadName.Len(), 2))));
+	}
+	Subsystem->FindFeaturesByName(TEXT("a"));
+	RunBenchmark(TEXT("FindFeaturesByName"), Iterations, [&]() -> int64
+	{
+		for (const FString& Prefix : NamePrefixes)
+		{
+			Subsystem->FindFeaturesByName(Prefix);
+		}
+		return NamePrefixes.Num();
+	});
+
+	RunBenchmark(TEXT("FindFeaturesByNameFuzzy"), Iterations, [&]() -> int64
+	{
+		for (const FString& Prefix : NamePrefixes)
+		{
+			Subsystem->FindFeaturesByName(Prefix.LeftChop(1) + TEXT("x"), 10, 1);
+		}
+		return NamePrefixes.Num();
+	});
+
+	Subsystem->UnregisterStreetMap(StreetMap);
+	World->DestroyWorld(/* bInformEngineOfWorld */ false);
+
+	// PCG point output
+	RunBenchmark(TEXT("PCGRoadPoints"), Iterations, [&]() -> int64
+	{
+		UStreetMapRoadsPCGData* RoadsData = NewObject<UStreetMapRoadsPCGData>();
+		RoadsData->Initialize(StreetMap);
+		const UPCGPointData* PointData = RoadsData->ToPointData(nullptr);
+		return PointData != nullptr ? PointData->GetPoints().Num() : 0;
+	});
+
+	RunBenchmark(TEXT("PCGBuildingPoints"), Iterations, [&]() -> int64
+	{
+		UStreetMapBuildingsPCGData* BuildingsData = NewObject<UStreetMapBuildingsPCGData>();
+		BuildingsData->Initialize(StreetMap);
+		const UPCGPointData* PointData = BuildingsData->ToPointData(nullptr);
+		return PointData != nullptr ? PointData->GetPoints().Num() : 0;
+	});
+
+	TMap<FString, FString> RunInfo;
+	RunInfo.Add(TEXT("Label"), Label);
+	RunInfo.Add(TEXT("EngineVersion"), FEngineVersion::Current().ToString());
+	RunInfo.Add(TEXT("BuildConfiguration"), LexToString(FApp::GetBuildConfiguration()));
+	RunInfo.Add(TEXT("GridSize"), LexToString(CitySettings.GridSize));
+	RunInfo.Add(TEXT("BlockSize"), LexToString(CitySettings.BlockSize));
+	RunInfo.Add(TEXT("OrganicStreets"), LexToString(CitySettings.OrganicStreetCount));
+	RunInfo.Add(TEXT("Seed"), LexToString(CitySettings.Seed));
+	RunInfo.Add(TEXT("Iterations"), LexToString(Iterations));
+	RunInfo.Add(TEXT("Queries"), LexToString(QueryCount));
+	RunInfo.Add(TEXT("Roads"), LexToString(Snapshot->GetRoads().Num()));
+	RunInfo.Add(TEXT("Nodes"), LexToString(Snapshot->GetNodes().Num()));
+	RunInfo.Add(TEXT("Buildings"), LexToString(Snapshot->GetBuildings().Num()));
+	RunInfo.Add(TEXT("MeshVertices"), LexToString(Component->GetNumMeshVertices()));
+	RunInfo.Add(TEXT("MeshTriangles"), LexToString(Component->GetNumMeshTriangles()));
+
+	Component->RemoveFromRoot();
+	StreetMap->RemoveFromRoot();
+
+	return WriteResults(OutputDirectory, Label, RunInfo) ? 0 : 1;
+}
+
+
+void UStreetMapBenchmarkCommandlet::RunBenchmark(const TCHAR* Name, const int32 Iterations, TFunctionRef<int64()> Run)
+{
+	FBenchmarkResult& Result = Results.AddDefaulted_GetRef();
+	Result.Name = Name;
+
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		Result.ItemCount = Run();
+		Result.Milliseconds.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}
+
+	const StreetMapBenchmark::FTimingSummary Summary(Result.Milliseconds);
+	UE_LOG(LogStreetMapBenchmark, Display, TEXT("%-24s median %10.3f ms  min %10.3f ms  max %10.3f ms  (%lld items)"),
+		Name, Summary.Median, Summary.Min, Summary.Max, Result.ItemCount);
+}
+
+
+bool UStreetMapBenchmarkCommandlet::WriteResults(const FString& OutputDirectory, const FString& Label, const TMap<FString, FString>& RunInfo) const
+{
+	const FString BaseName = FString::Printf(TEXT("StreetMapBenchmark-%s-%s"), *Label, *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")));
+
+	// CSV: one line per benchmark, so files from several runs can simply be concatenated
+	FString Csv = TEXT("Label,Benchmark,Iterations,Items,MinMs,MedianMs,MeanMs,MaxMs\n");
+	for (const FBenchmarkResult& Result : Results)
+	{
+		const StreetMapBenchmark::FTimingSummary Summary(Result.Milliseconds);
+		Csv.Appendf(TEXT("%s,%s,%d,%lld,%.4f,%.4f,%.4f,%.4f\n"),
+			*Label, *Result.Name, Result.Milliseconds.Num(), Result.ItemCount, Summary.Min, Summary.Median, Summary.Mean, Summary.Max);
+	}
+
+	// JSON: everything, including each run's time
+	TSharedRef<FJsonObject> RootObject = MakeShared<FJsonObject>();
+
+	TSharedRef<FJsonObject> InfoObject = MakeShared<FJsonObject>();
+	for (const TPair<FString, FString>& Info : RunInfo)
+	{
+		InfoObject->SetStringField(Info.Key, Info.Value);
+	}
+	RootObject->SetObjectField(TEXT("Info"), InfoObject);
+
+	TArray<TSharedPtr<FJsonValue>> ResultValues;
+	for (const FBenchmarkResult& Result : Results)
+	{
+		const StreetMapBenchmark::FTimingSummary Summary(Result.Milliseconds);
+
+		TSharedRef<FJsonObject> ResultObject = MakeShared<FJsonObject>();
+		ResultObject->SetStringField(TEXT("Name"), Result.Name);
+		ResultObject->SetNumberField(TEXT("Items"), (double)Result.ItemCount);
+		ResultObject->SetNumberField(TEXT("MinMs"), Summary.Min);
+		ResultObject->SetNumberField(TEXT("MedianMs"), Summary.Median);
+		ResultObject->SetNumberField(TEXT("MeanMs"), Summary.Mean);
+		ResultObject->SetNumberField(TEXT("MaxMs"), Summary.Max);
+
+		TArray<TSharedPtr<FJsonValue>> SampleValues;
+		for (const double Sample : Result.Milliseconds)
+		{
+			SampleValues.Add(MakeShared<FJsonValueNumber>(Sample));
+		}
+		ResultObject->SetArrayField(TEXT("SamplesMs"), SampleValues);
+
+		ResultValues.Add(MakeShared<FJsonValueObject>(ResultObject));
+	}
+	RootObject->SetArrayField(TEXT("Results"), ResultValues);
+
+	FString Json;
+	const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(RootObject, JsonWriter);
+
+	const FString CsvPath = OutputDirectory / (BaseName + TEXT(".csv"));
+	const FString JsonPath = OutputDirectory / (BaseName + TEXT(".json"));
+	if (!FFileHelper::SaveStringToFile(Csv, *CsvPath) || !FFileHelper::SaveStringToFile(Json, *JsonPath))
+	{
+		UE_LOG(LogStreetMapBenchmark, Error, TEXT("Couldn't write results to %s"), *OutputDirectory);
+		return false;
+	}
+
+	UE_LOG(LogStreetMapBenchmark, Display, TEXT("Wrote results to %s and %s"), *CsvPath, *JsonPath);
+	return true;
+}
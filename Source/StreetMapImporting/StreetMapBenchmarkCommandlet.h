@@ -0,0 +1,49 @@
+#pragma once
+#include "Commandlets/Commandlet.h"
+#include "StreetMapBenchmarkCommandlet.generated.h"
+
+class UStreetMap;
+
+/**
+ * Generates a synthetic city and times the street map pipeline on it: importing OpenStreetMap XML, building derived
+ * data, generating the component mesh and collision, subsystem queries, and PCG point output.  Results are written as
+ * CSV and JSON so runs can be compared.  Run it with -nullrhi, nothing is rendered.
+ *
+ * Usage: -run=StreetMapBenchmark [-GridSize=20] [-BlockSize=100] [-OrganicStreets=50] [-Buildings=2000] [-Seed=1]
+ *                                [-Iterations=5] [-Queries=1000] [-Label=<name>] [-Output=<directory>]
+ *
+ * Results go to Saved/StreetMapBenchmarks unless -Output is given.
+ */
+UCLASS()
+class UStreetMapBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+
+private:
+
+	/** Timings of one benchmark */
+	struct FBenchmarkResult
+	{
+		/** Name of the benchmark */
+		FString Name;
+
+		/** Number of items processed in each run, e.g. queries or points */
+		int64 ItemCount = 0;
+
+		/** Time each run took, in milliseconds */
+		TArray<double> Milliseconds;
+	};
+
+	/** Runs a benchmark several times and records how long each run took */
+	void RunBenchmark(const TCHAR* Name, const int32 Iterations, TFunctionRef<int64()> Run);
+
+	/** Writes all results to a CSV and a JSON file */
+	bool WriteResults(const FString& OutputDirectory, const FString& Label, const TMap<FString, FString>& RunInfo) const;
+
+	/** Results of every benchmark run so far */
+	TArray<FBenchmarkResult> Results;
+};
@@ -228,10 +228,11 @@ FReply FStreetMapComponentDetails::OnCreateStaticMeshAssetClicked()
 			const TArray< uint32 > RawMeshIndices = SelectedStreetMapComponent->GetRawMeshIndices();
 
 
-			// Copy verts
+			// Copy verts (cached vertices are relative to the component's mesh origin)
+			const FVector3f MeshOrigin(SelectedStreetMapComponent->GetMeshOrigin());
 			for (int32 VertIndex = 0; VertIndex < RawMeshVertices.Num();VertIndex++)
 			{
-				RawMesh.VertexPositions.Add(RawMeshVertices[VertIndex].Position);
+				RawMesh.VertexPositions.Add(RawMeshVertices[VertIndex].Position + MeshOrigin);
 			}
 
 			// Copy 'wedge' info
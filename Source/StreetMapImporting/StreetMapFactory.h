@@ -19,11 +19,15 @@ protected:
 
 	// UFactory overrides
 	virtual UObject* FactoryCreateText( UClass* Class, UObject* Parent, FName Name, EObjectFlags Flags, UObject* Context, const TCHAR* Type, const TCHAR*& Buffer, const TCHAR* BufferEnd, FFeedbackContext* Warn ) override;
+	virtual UObject* FactoryCreateFile( UClass* Class, UObject* Parent, FName Name, EObjectFlags Flags, const FString& Filename, const TCHAR* Parms, FFeedbackContext* Warn, bool& bOutOperationCanceled ) override;
 
 	/** Loads the street map from an OpenStreetMap XML file.  Note that in the case of the file path containing the XML data, the string must be mutable for us to parse it quickly. */
 	bool LoadFromOpenStreetMapXMLFile( class UStreetMap* StreetMap, FString& OSMFilePath, const bool bIsFilePathActuallyTextBuffer, class FFeedbackContext* FeedbackContext );
 
-	/** Static: Latitude/longitude scale factor */
-	static const double LatitudeLongitudeScale;
+public:
+
+	/** Version of the importer, recorded on every map it creates.  Bump this whenever a change to the importer means
+	    that existing maps should be reimported to pick it up. */
+	static const int32 ImporterVersion;
 };
 
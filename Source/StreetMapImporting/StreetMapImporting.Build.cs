@@ -12,7 +12,8 @@ public class StreetMapImporting : ModuleRules
 				"Core",
 				"CoreUObject",
 				"Engine",
-				"StreetMapRuntime"
+				"StreetMapRuntime",
+				"StreetMapLoading"
 			}
 		);
 
@@ -20,7 +21,6 @@ public class StreetMapImporting : ModuleRules
 			new string[]
 			{
 				"UnrealEd",
-				"XmlParser",
 				"AssetTools",
 				"Projects",
 				"Slate",
@@ -29,7 +29,10 @@ public class StreetMapImporting : ModuleRules
 				"RenderCore",
 				"RHI",
 				"RawMesh",
-				"AssetRegistry"
+				"AssetRegistry",
+				"ToolMenus",
+				"Json",
+				"PCG"
 			}
 		);
 	}
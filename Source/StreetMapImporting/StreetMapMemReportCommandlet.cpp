@@ -0,0 +1,73 @@
+#include "StreetMapMemReportCommandlet.h"
+#include "StreetMap.h"
+#include "StreetMapMemory.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Misc/Parse.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogStreetMapMemReport, Log, All);
+
+
+UStreetMapMemReportCommandlet::UStreetMapMemReportCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+int32 UStreetMapMemReportCommandlet::Main(const FString& Params)
+{
+	FString Path = TEXT("/Game");
+	FParse::Value(*Params, TEXT("Path="), Path);
+
+	int64 BudgetKB = 0;
+	FParse::Value(*Params, TEXT("BudgetKB="), BudgetKB);
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(/* bSynchronousSearch */ true);
+
+	FARFilter Filter;
+	Filter.ClassPaths.Add(UStreetMap::StaticClass()->GetClassPathName());
+	Filter.PackagePaths.Add(FName(*Path));
+	Filter.bRecursivePaths = true;
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	UE_LOG(LogStreetMapMemReport, Display, TEXT("Found %d street maps in %s"), Assets.Num(), *Path);
+	FStreetMapMemoryReport::PrintStreetMapHeader(*GLog);
+
+	FStreetMapMemoryUsage Total;
+	int32 OverBudgetCount = 0;
+	for (const FAssetData& Asset : Assets)
+	{
+		UStreetMap* StreetMap = Cast<UStreetMap>(Asset.GetAsset());
+		if (StreetMap == nullptr)
+		{
+			UE_LOG(LogStreetMapMemReport, Warning, TEXT("Couldn't load %s"), *Asset.GetObjectPathString());
+			continue;
+		}
+
+		// Cooked maps always carry their derived data, so count it as well
+		StreetMap->GetDerivedData();
+
+		const FStreetMapMemoryUsage Usage = StreetMap->GetMemoryUsage();
+		FStreetMapMemoryReport::PrintStreetMap(*GLog, *StreetMap, Usage);
+		Total += Usage;
+
+		if (BudgetKB > 0 && Usage.GetTotal() > (SIZE_T)BudgetKB * 1024)
+		{
+			UE_LOG(LogStreetMapMemReport, Error, TEXT("%s uses %.1f KB, which is over the budget of %lld KB"), *StreetMap->GetPathName(), Usage.GetTotal() / 1024.0, BudgetKB);
+			++OverBudgetCount;
+		}
+
+		// Don't keep every map loaded at once
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	UE_LOG(LogStreetMapMemReport, Display, TEXT("All street maps: %.1f KB"), Total.GetTotal() / 1024.0);
+
+	return OverBudgetCount > 0 ? 1 : 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "Commandlets/Commandlet.h"
+#include "StreetMapMemReportCommandlet.generated.h"
+
+/**
+ * Loads every street map asset and prints how much memory each one uses at runtime, including its derived data.
+ * Component meshes only exist in levels, so use the StreetMap.MemReport console command in game to see those.
+ *
+ * Usage: -run=StreetMapMemReport [-Path=/Game/Maps] [-BudgetKB=<KB>]
+ *
+ * With a budget, every map over it is reported as an error and the commandlet fails, so it can gate a build.
+ */
+UCLASS()
+class UStreetMapMemReportCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};
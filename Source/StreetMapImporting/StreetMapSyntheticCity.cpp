@@ -0,0 +1,176 @@
+#include "StreetMapSyntheticCity.h"
+#include "StreetMapGeoReference.h"
+#include "Math/RandomStream.h"
+
+
+FString FStreetMapSyntheticCity::GenerateOSMXml(const FStreetMapSyntheticCitySettings& Settings, FStreetMapSyntheticCityStats& OutStats)
+{
+	OutStats = FStreetMapSyntheticCityStats();
+
+	const int32 GridSize = FMath::Max(Settings.GridSize, 1);
+	const double BlockSize = FMath::Max(Settings.BlockSize, 1.0);
+	const double CitySize = GridSize * BlockSize;
+
+	FRandomStream Random(Settings.Seed);
+
+	// The city is laid out in meters east and north of its origin, then projected to latitude/longitude
+	const double MetersPerDegreeLatitude = FStreetMapGeoReference::DefaultMetersPerDegree;
+	const double MetersPerDegreeLongitude = MetersPerDegreeLatitude * FMath::Cos(FMath::DegreesToRadians(Settings.OriginLatitude));
+
+	FString NodesXml;
+	FString WaysXml;
+	int64 NextNodeId = 1;
+	int64 NextWayId = 1;
+
+	auto AddNode = [&](const double X, const double Y) -> int64
+	{
+		const int64 NodeId = NextNodeId++;
+		NodesXml.Appendf(TEXT(" <node id=\"%lld\" lat=\"%.9f\" lon=\"%.9f\"/>\n"),
+			NodeId,
+			Settings.OriginLatitude + Y / MetersPerDegreeLatitude,
+			Settings.OriginLongitude + X / MetersPerDegreeLongitude);
+		++OutStats.NodeCount;
+		return NodeId;
+	};
+
+	auto AddWay = [&](TArrayView<const int64> NodeIds, TArrayView<const TPair<const TCHAR*, FString>> Tags)
+	{
+		WaysXml.Appendf(TEXT(" <way id=\"%lld\">\n"), NextWayId++);
+		for (const int64 NodeId : NodeIds)
+		{
+			WaysXml.Appendf(TEXT("  <nd ref=\"%lld\"/>\n"), NodeId);
+		}
+		for (const TPair<const TCHAR*, FString>& Tag : Tags)
+		{
+			WaysXml.Appendf(TEXT("  <tag k=\"%s\" v=\"%s\"/>\n"), Tag.Key, *Tag.Value);
+		}
+		WaysXml += TEXT(" </way>\n");
+	};
+
+	// Street grid.  Streets run east to west and avenues north to south, and they share a node at every intersection.
+	TArray<int64> GridNodeIds;
+	GridNodeIds.SetNumUninitialized((GridSize + 1) * (GridSize + 1));
+	for (int32 Y = 0; Y <= GridSize; ++Y)
+	{
+		for (int32 X = 0; X <= GridSize; ++X)
+		{
+			GridNodeIds[Y * (GridSize + 1) + X] = AddNode(X * BlockSize, Y * BlockSize);
+		}
+	}
+
+	TArray<int64> WayNodeIds;
+	for (int32 Y = 0; Y <= GridSize; ++Y)
+	{
+		WayNodeIds.Reset();
+		for (int32 X = 0; X <= GridSize; ++X)
+		{
+			WayNodeIds.Add(GridNodeIds[Y * (GridSize + 1) + X]);
+		}
+
+		const TPair<const TCHAR*, FString> Tags[] =
+		{
+			{ TEXT("highway"), Y % 5 == 0 ? TEXT("primary") : TEXT("residential") },
+			{ TEXT("name"), FString::Printf(TEXT("Street %d"), Y) },
+		};
+		AddWay(WayNodeIds, Tags);
+		++OutStats.RoadCount;
+	}
+
+	for (int32 X = 0; X <= GridSize; ++X)
+	{
+		WayNodeIds.Reset();
+		for (int32 Y = 0; Y <= GridSize; ++Y)
+		{
+			WayNodeIds.Add(GridNodeIds[Y * (GridSize + 1) + X]);
+		}
+
+		TArray<TPair<const TCHAR*, FString>, TInlineAllocator<3>> Tags;
+		Tags.Emplace(TEXT("highway"), X % 5 == 0 ? TEXT("secondary") : TEXT("residential"));
+		Tags.Emplace(TEXT("name"), FString::Printf(TEXT("Avenue %d"), X));
+		if (X % 3 == 1)
+		{
+			Tags.Emplace(TEXT("oneway"), TEXT("yes"));
+		}
+		AddWay(WayNodeIds, Tags);
+		++OutStats.RoadCount;
+	}
+
+	// Winding streets start at a grid intersection and wander off until they leave the city
+	for (int32 StreetIndex = 0; StreetIndex < Settings.OrganicStreetCount; ++StreetIndex)
+	{
+		const int32 StartX = Random.RandRange(0, GridSize);
+		const int32 StartY = Random.RandRange(0, GridSize);
+		FVector2D Location(StartX * BlockSize, StartY * BlockSize);
+		double Heading = Random.FRandRange(0.0, 2.0 * UE_DOUBLE_PI);
+
+		WayNodeIds.Reset();
+		WayNodeIds.Add(GridNodeIds[StartY * (GridSize + 1) + StartX]);
+		for (int32 SegmentIndex = 0; SegmentIndex < Settings.OrganicStreetSegments; ++SegmentIndex)
+		{
+			Heading += FMath::DegreesToRadians(Random.FRandRange(-30.0, 30.0));
+			Location += FVector2D(FMath::Cos(Heading), FMath::Sin(Heading)) * Random.FRandRange(0.4, 0.8) * BlockSize;
+			if (Location.X < 0.0 || Location.Y < 0.0 || Location.X > CitySize || Location.Y > CitySize)
+			{
+				break;
+			}
+			WayNodeIds.Add(AddNode(Location.X, Location.Y));
+		}
+
+		if (WayNodeIds.Num() >= 2)
+		{
+			const TPair<const TCHAR*, FString> Tags[] =
+			{
+				{ TEXT("highway"), StreetIndex % 4 == 0 ? TEXT("tertiary") : TEXT("service") },
+				{ TEXT("name"), FString::Printf(TEXT("Lane %d"), StreetIndex) },
+			};
+			AddWay(WayNodeIds, Tags);
+			++OutStats.RoadCount;
+		}
+	}
+
+	// Buildings are rectangles inside random blocks, kept clear of the streets around the block
+	const double StreetMargin = BlockSize * 0.1;
+	for (int32 BuildingIndex = 0; BuildingIndex < Settings.BuildingCount; ++BuildingIndex)
+	{
+		const FVector2D BlockMin(Random.RandRange(0, GridSize - 1) * BlockSize, Random.RandRange(0, GridSize - 1) * BlockSize);
+		const FVector2D Size(Random.FRandRange(0.1, 0.35) * BlockSize, Random.FRandRange(0.1, 0.35) * BlockSize);
+		const FVector2D Min(
+			BlockMin.X + StreetMargin + Random.FRandRange(0.0, BlockSize - 2.0 * StreetMargin - Size.X),
+			BlockMin.Y + StreetMargin + Random.FRandRange(0.0, BlockSize - 2.0 * StreetMargin - Size.Y));
+
+		// Closed ways repeat their first node at the end
+		const int64 FirstNodeId = AddNode(Min.X, Min.Y);
+		const int64 NodeIds[] =
+		{
+			FirstNodeId,
+			AddNode(Min.X + Size.X, Min.Y),
+			AddNode(Min.X + Size.X, Min.Y + Size.Y),
+			AddNode(Min.X, Min.Y + Size.Y),
+			FirstNodeId,
+		};
+
+		TArray<TPair<const TCHAR*, FString>, TInlineAllocator<3>> Tags;
+		Tags.Emplace(TEXT("building"), TEXT("yes"));
+		Tags.Emplace(TEXT("building:levels"), LexToString(Random.RandRange(1, 12)));
+		if (BuildingIndex % 4 == 0)
+		{
+			Tags.Emplace(TEXT("height"), FString::Printf(TEXT("%.1f"), Random.FRandRange(4.0, 60.0)));
+		}
+		AddWay(NodeIds, Tags);
+		++OutStats.BuildingCount;
+	}
+
+	FString Xml;
+	Xml.Reserve(NodesXml.Len() + WaysXml.Len() + 512);
+	Xml += TEXT("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+	Xml += TEXT("<osm version=\"0.6\" generator=\"StreetMapSyntheticCity\">\n");
+	Xml.Appendf(TEXT(" <bounds minlat=\"%.9f\" minlon=\"%.9f\" maxlat=\"%.9f\" maxlon=\"%.9f\"/>\n"),
+		Settings.OriginLatitude,
+		Settings.OriginLongitude,
+		Settings.OriginLatitude + CitySize / MetersPerDegreeLatitude,
+		Settings.OriginLongitude + CitySize / MetersPerDegreeLongitude);
+	Xml += NodesXml;
+	Xml += WaysXml;
+	Xml += TEXT("</osm>\n");
+	return Xml;
+}
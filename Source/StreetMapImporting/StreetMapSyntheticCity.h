@@ -0,0 +1,60 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/** Shape of a synthetic city */
+struct FStreetMapSyntheticCitySettings
+{
+	/** Number of city blocks along each side of the street grid */
+	int32 GridSize = 20;
+
+	/** Edge length of a city block, in meters */
+	double BlockSize = 100.0;
+
+	/** Number of winding streets added on top of the grid */
+	int32 OrganicStreetCount = 50;
+
+	/** Number of segments in each winding street */
+	int32 OrganicStreetSegments = 12;
+
+	/** Number of buildings, spread over random blocks */
+	int32 BuildingCount = 2000;
+
+	/** Seed for everything random, so the same settings always make the same city */
+	int32 Seed = 1;
+
+	/** Latitude of the south west corner of the city */
+	double OriginLatitude = 40.0;
+
+	/** Longitude of the south west corner of the city */
+	double OriginLongitude = -75.0;
+};
+
+
+/** What ended up in a synthetic city */
+struct FStreetMapSyntheticCityStats
+{
+	int32 NodeCount = 0;
+	int32 RoadCount = 0;
+	int32 BuildingCount = 0;
+};
+
+
+/**
+ * Makes OpenStreetMap XML for made up cities of any size: a grid of streets with every fifth street a major road, winding
+ * streets wandering off grid intersections, and rectangular buildings inside the blocks.  The output goes through the
+ * regular OpenStreetMap loader, so it exercises the same code as real map data.
+ */
+class FStreetMapSyntheticCity
+{
+public:
+
+	/**
+	 * Generates a city
+	 *
+	 * @param	Settings	Shape of the city
+	 * @param	OutStats	Receives what ended up in the city
+	 *
+	 * @return	OpenStreetMap XML for the city
+	 */
+	static FString GenerateOSMXml(const FStreetMapSyntheticCitySettings& Settings, FStreetMapSyntheticCityStats& OutStats);
+};
@@ -0,0 +1,142 @@
+#include "StreetMapTileBuilder.h"
+#include "StreetMap.h"
+#include "StreetMapTileActor.h"
+#include "StreetMapComponent.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Modules/ModuleManager.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopedSlowTask.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+
+#define LOCTEXT_NAMESPACE "StreetMapTileBuilder"
+
+DEFINE_LOG_CATEGORY_STATIC(LogStreetMapTileBuilder, Log, All);
+
+
+TArray<UStreetMap*> FStreetMapTileBuilder::CreateTileAssets(UStreetMap& SourceMap)
+{
+	TArray<UStreetMap*> Tiles;
+	if (SourceMap.IsTile())
+	{
+		return Tiles;
+	}
+
+	const TArray<FStreetMapCell>& Cells = SourceMap.GetCells();
+	const FString TileFolder = FPackageName::GetLongPackagePath(SourceMap.GetOutermost()->GetName()) / (SourceMap.GetName() + TEXT("_Tiles"));
+
+	FScopedSlowTask SlowTask(Cells.Num(), FText::Format(LOCTEXT("CreatingTiles", "Splitting {0} into tiles"), FText::FromString(SourceMap.GetName())));
+	SlowTask.MakeDialog();
+
+	for (int32 CellIndex = 0; CellIndex < Cells.Num(); ++CellIndex)
+	{
+		SlowTask.EnterProgressFrame();
+
+		const FIntPoint& CellCoordinate = Cells[CellIndex].Coordinate;
+		const FString TileName = FString::Printf(TEXT("%s_Tile_%d_%d"), *SourceMap.GetName(), CellCoordinate.X, CellCoordinate.Y);
+
+		// Splitting again updates the existing tiles, so actors that reference them stay valid
+		UPackage* TilePackage = CreatePackage(*(TileFolder / TileName));
+		check(TilePackage);
+
+		UStreetMap* Tile = FindObject<UStreetMap>(TilePackage, *TileName);
+		if (Tile == nullptr)
+		{
+			Tile = NewObject<UStreetMap>(TilePackage, *TileName, RF_Public | RF_Standalone | RF_Transactional);
+			FAssetRegistryModule::AssetCreated(Tile);
+		}
+		else
+		{
+			Tile->Modify();
+		}
+
+		Tile->BuildTileFromCell(SourceMap, CellIndex);
+		Tile->MarkPackageDirty();
+		Tiles.Add(Tile);
+	}
+
+	// Splitting again after the map lost cells leaves tiles behind that no cell updates anymore.  SpawnTileActors()
+	// removes their actors, but the assets are only reported, since other levels or assets may still use them.
+	const IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	TArray<FAssetData> TileFolderAssets;
+	AssetRegistry.GetAssetsByPath(FName(*TileFolder), TileFolderAssets);
+	const FString TilePrefix = SourceMap.GetName() + TEXT("_Tile_");
+	for (const FAssetData& Asset : TileFolderAssets)
+	{
+		const FString AssetName = Asset.AssetName.ToString();
+		if (Asset.IsInstanceOf(UStreetMap::StaticClass()) && AssetName.StartsWith(TilePrefix) &&
+			!Tiles.ContainsByPredicate([&AssetName](const UStreetMap* Tile) { return Tile->GetName() == AssetName; }))
+		{
+			UE_LOG(LogStreetMapTileBuilder, Warning, TEXT("%s is left over from an earlier split of %s into more tiles, and is no longer updated.  Delete it if nothing uses it."),
+				*Asset.GetObjectPathString(), *SourceMap.GetName());
+		}
+	}
+
+	return Tiles;
+}
+
+
+TArray<AStreetMapTileActor*> FStreetMapTileBuilder::SpawnTileActors(UWorld& World, const TArray<UStreetMap*>& Tiles, const FTransform& TileTransform)
+{
+	// Reuse the actors from an earlier split, if there are any.  Actors of tiles from the same folder that aren't being
+	// spawned again are left over from a split into more tiles, so they're removed.
+	TSet<FString> TileFolders;
+	for (const UStreetMap* Tile : Tiles)
+	{
+		TileFolders.Add(FPackageName::GetLongPackagePath(Tile->GetOutermost()->GetName()));
+	}
+
+	TMap<const UStreetMap*, AStreetMapTileActor*> ExistingTileActors;
+	TArray<AStreetMapTileActor*> StaleTileActors;
+	for (TActorIterator<AStreetMapTileActor> It(&World); It; ++It)
+	{
+		const UStreetMap* ExistingTile = It->GetStreetMapComponent()->GetStreetMap();
+		if (ExistingTile != nullptr && !Tiles.Contains(ExistingTile) && TileFolders.Contains(FPackageName::GetLongPackagePath(ExistingTile->GetOutermost()->GetName())))
+		{
+			StaleTileActors.Add(*It);
+		}
+		else
+		{
+			ExistingTileActors.Add(ExistingTile, *It);
+		}
+	}
+
+	for (AStreetMapTileActor* StaleTileActor : StaleTileActors)
+	{
+		World.EditorDestroyActor(StaleTileActor, /* bShouldModifyLevel */ true);
+	}
+
+	TArray<AStreetMapTileActor*> TileActors;
+	TileActors.Reserve(Tiles.Num());
+
+	FScopedSlowTask SlowTask(Tiles.Num(), LOCTEXT("SpawningTileActors", "Spawning street map tile actors"));
+	SlowTask.MakeDialog();
+
+	for (UStreetMap* Tile : Tiles)
+	{
+		SlowTask.EnterProgressFrame();
+
+		AStreetMapTileActor* TileActor = ExistingTileActors.FindRef(Tile);
+		if (TileActor == nullptr)
+		{
+			FActorSpawnParameters SpawnParameters;
+			SpawnParameters.Name = MakeUniqueObjectName(World.PersistentLevel, AStreetMapTileActor::StaticClass(), *Tile->GetName());
+			TileActor = World.SpawnActor<AStreetMapTileActor>(AStreetMapTileActor::StaticClass(), TileTransform, SpawnParameters);
+		}
+		else
+		{
+			TileActor->Modify();
+		}
+
+		if (TileActor != nullptr)
+		{
+			TileActor->SetActorLabel(Tile->GetName());
+			TileActor->SetStreetMapTile(Tile);
+			TileActors.Add(TileActor);
+		}
+	}
+
+	return TileActors;
+}
+
+#undef LOCTEXT_NAMESPACE
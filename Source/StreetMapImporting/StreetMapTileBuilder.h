@@ -0,0 +1,35 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class UStreetMap;
+class UWorld;
+class AStreetMapTileActor;
+
+/** Splits street maps into World Partition streamable tiles: one tile asset and one tile actor per grid cell */
+class FStreetMapTileBuilder
+{
+public:
+
+	/**
+	 * Creates (or updates) one street map tile asset for each grid cell of the source map.  Tiles are saved next to the
+	 * source map, in a "<MapName>_Tiles" folder.  Tiles left there by an earlier split whose cells are gone aren't deleted,
+	 * since something else may still use them, but each one is logged as a warning.
+	 *
+	 * @param	SourceMap	The map to split.  Maps that are already tiles can't be split again.
+	 *
+	 * @return	The tile assets, one per cell.  Empty if the map couldn't be split.
+	 */
+	static TArray<UStreetMap*> CreateTileAssets(UStreetMap& SourceMap);
+
+	/**
+	 * Spawns a spatially loaded tile actor for each tile, or updates the tile actor that is already there.  Actors showing
+	 * other tiles from the same tile folders are left over from an earlier split, and are destroyed.
+	 *
+	 * @param	World			World to spawn actors in.  Tiles only stream in and out if this world uses World Partition.
+	 * @param	Tiles			Tile assets created by CreateTileAssets()
+	 * @param	TileTransform	Transform for all tile actors.  Tiles keep their map space coordinates, so they all share one transform.
+	 *
+	 * @return	The tile actors, one per tile
+	 */
+	static TArray<AStreetMapTileActor*> SpawnTileActors(UWorld& World, const TArray<UStreetMap*>& Tiles, const FTransform& TileTransform = FTransform::Identity);
+};
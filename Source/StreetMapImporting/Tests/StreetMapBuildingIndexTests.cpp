@@ -0,0 +1,66 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapTestCity.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStreetMapBuildingIndexTest, "StreetMap.Queries.BuildingIndex", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FStreetMapBuildingIndexTest::RunTest(const FString& Parameters)
+{
+	using namespace StreetMapTestCity;
+
+	const TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot = MakeCity();
+	if (!TestTrue(TEXT("City imports"), Snapshot.IsValid()))
+	{
+		return false;
+	}
+
+	const TArray<FStreetMapBuilding>& Buildings = Snapshot->GetBuildings();
+	const FStreetMapBuildingIndex& Index = Snapshot->GetDerivedData()->GetBuildingIndex();
+	const double Radius = 3000.0;
+
+	// Half the locations are building centers, so some of them are inside a building
+	TArray<FVector2D> Locations;
+	MakeQueryLocations(*Snapshot, Locations);
+	for (int32 LocationIndex = 0; LocationIndex < Locations.Num(); LocationIndex += 2)
+	{
+		const FStreetMapBuilding& Building = Buildings[LocationIndex % Buildings.Num()];
+		Locations[LocationIndex] = (Building.BoundsMin + Building.BoundsMax) * 0.5;
+	}
+
+	TArray<int32> FoundBuildings;
+	for (const FVector2D& Location : Locations)
+	{
+		TArray<int32> ExpectedInCircle;
+		bool bInsideAny = false;
+		for (int32 BuildingIndex = 0; BuildingIndex < Buildings.Num(); ++BuildingIndex)
+		{
+			const double Distance = DistanceToBuilding(Buildings[BuildingIndex], Location);
+			bInsideAny |= Distance == 0.0;
+			if (Distance <= Radius)
+			{
+				ExpectedInCircle.Add(BuildingIndex);
+			}
+		}
+
+		// Building at the location.  Footprints may overlap, so any building containing it will do.
+		const int32 BuildingAt = Index.FindBuildingAt(Buildings, Location);
+		TestTrue(TEXT("Building found at location"), (BuildingAt != INDEX_NONE) == bInsideAny);
+		if (BuildingAt != INDEX_NONE)
+		{
+			TestTrue(TEXT("Building found contains the location"), IsInsidePolygon(Buildings[BuildingAt].BuildingPoints, Location));
+		}
+
+		// Buildings in a circle
+		FoundBuildings.Reset();
+		Index.FindBuildingsInCircle(Buildings, Location, Radius, FoundBuildings);
+		FoundBuildings.Sort();
+		TestTrue(TEXT("Buildings in circle"), FoundBuildings == ExpectedInCircle);
+	}
+
+	return true;
+}
+
+#endif	// WITH_DEV_AUTOMATION_TESTS
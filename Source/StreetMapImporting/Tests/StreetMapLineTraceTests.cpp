@@ -0,0 +1,80 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapTestCity.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStreetMapBuildingLineTraceTest, "StreetMap.Queries.BuildingLineTrace", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FStreetMapBuildingLineTraceTest::RunTest(const FString& Parameters)
+{
+	using namespace StreetMapTestCity;
+
+	const TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot = MakeCity();
+	if (!TestTrue(TEXT("City imports"), Snapshot.IsValid()))
+	{
+		return false;
+	}
+
+	const TArray<FStreetMapBuilding>& Buildings = Snapshot->GetBuildings();
+	const FStreetMapBuildingIndex& Index = Snapshot->GetDerivedData()->GetBuildingIndex();
+
+	// Every building is at least one level (or 4m) tall, so level traces this low can only hit walls, or start inside
+	const double LevelHeight = 300.0;
+	const double TraceZ = 100.0;
+
+	TArray<FVector2D> Locations;
+	MakeQueryLocations(*Snapshot, Locations);
+	for (int32 QueryIndex = 0; QueryIndex + 1 < Locations.Num(); QueryIndex += 2)
+	{
+		const FVector2D Start = Locations[QueryIndex];
+		const FVector2D End = Locations[QueryIndex + 1];
+		const FVector2D Delta = End - Start;
+
+		// First crossing of the trace with any footprint edge, or zero when it starts inside a footprint
+		double ExpectedTime = MAX_dbl;
+		for (const FStreetMapBuilding& Building : Buildings)
+		{
+			const TArray<FVector2D>& Points = Building.BuildingPoints;
+			if (IsInsidePolygon(Points, Start))
+			{
+				ExpectedTime = 0.0;
+				break;
+			}
+			for (int32 PointIndex = 0, Previous = Points.Num() - 1; PointIndex < Points.Num(); Previous = PointIndex++)
+			{
+				const FVector2D Edge = Points[PointIndex] - Points[Previous];
+				const double Denominator = FVector2D::CrossProduct(Delta, Edge);
+				if (Denominator == 0.0)
+				{
+					continue;
+				}
+				const FVector2D ToEdge = Points[Previous] - Start;
+				const double Time = FVector2D::CrossProduct(ToEdge, Edge) / Denominator;
+				const double EdgeAlpha = FVector2D::CrossProduct(ToEdge, Delta) / Denominator;
+				if (Time >= 0.0 && Time <= 1.0 && EdgeAlpha >= 0.0 && EdgeAlpha <= 1.0)
+				{
+					ExpectedTime = FMath::Min(ExpectedTime, Time);
+				}
+			}
+		}
+
+		FStreetMapBuildingHit Hit;
+		const bool bHit = Index.LineTrace(Buildings, FVector(Start, TraceZ), FVector(End, TraceZ), LevelHeight, 1.0, Hit);
+		if (!TestTrue(TEXT("Trace hits"), bHit == (ExpectedTime != MAX_dbl)))
+		{
+			return false;
+		}
+		if (bHit)
+		{
+			// Compared as distances, so the tolerance doesn't depend on the trace's length
+			TestEqual(TEXT("Trace hit distance"), Hit.Time * Delta.Size(), ExpectedTime * Delta.Size(), 1.0);
+			TestTrue(TEXT("Trace hit face"), (Hit.Face == EStreetMapBuildingFace::Inside) == (ExpectedTime == 0.0));
+		}
+	}
+
+	return true;
+}
+
+#endif	// WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,76 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapTestCity.h"
+#include "StreetMapMapMatcher.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStreetMapMapMatcherTest, "StreetMap.Queries.MapMatcher", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FStreetMapMapMatcherTest::RunTest(const FString& Parameters)
+{
+	using namespace StreetMapTestCity;
+
+	const TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot = MakeCity();
+	if (!TestTrue(TEXT("City imports"), Snapshot.IsValid()))
+	{
+		return false;
+	}
+
+	const TArray<FStreetMapRoad>& Roads = Snapshot->GetRoads();
+	FStreetMapMapMatchSettings Settings;
+	const FStreetMapMapMatcher Matcher(Snapshot.ToSharedRef(), Settings);
+	FStreetMapMapMatcher::FScratch Scratch;
+
+	// Drive down every avenue, with samples off to alternating sides of it.  Each sample has to be matched onto the
+	// avenue, no further from it than the offset, even where other roads are about as close.
+	const double Offset = 300.0;
+	int32 TraceCount = 0;
+	TArray<FVector2D> Samples;
+	TArray<int32> SampleRoads;
+	TArray<FStreetMapRoadLocation> RoadLocations;
+	for (int32 RoadIndex = 0; RoadIndex < Roads.Num(); ++RoadIndex)
+	{
+		const FStreetMapRoad& Road = Roads[RoadIndex];
+		if (!Snapshot->GetNameById(Road.NameId).StartsWith(TEXT("Avenue")) || Road.RoadPoints.Num() < 3)
+		{
+			continue;
+		}
+
+		Samples.Reset();
+		for (int32 PointIndex = 0; PointIndex + 1 < Road.RoadPoints.Num(); ++PointIndex)
+		{
+			const FVector2D& A = Road.RoadPoints[PointIndex];
+			const FVector2D& B = Road.RoadPoints[PointIndex + 1];
+			const FVector2D Side = FVector2D(-(B - A).Y, (B - A).X).GetSafeNormal() * (PointIndex % 2 == 0 ? Offset : -Offset);
+			Samples.Add((A + B) * 0.5 + Side);
+		}
+
+		RoadLocations.SetNum(Samples.Num());
+		Matcher.MatchTrace(Samples, RoadLocations, Scratch);
+		for (int32 SampleIndex = 0; SampleIndex < Samples.Num(); ++SampleIndex)
+		{
+			const FStreetMapRoadLocation& RoadLocation = RoadLocations[SampleIndex];
+			if (!TestTrue(TEXT("Sample matched"), RoadLocation.IsValid()))
+			{
+				return false;
+			}
+			TestEqual(TEXT("Sample matched onto the avenue"), Roads[RoadLocation.RoadIndex].NameId, Road.NameId);
+			TestEqual(TEXT("Match distance"), (double)RoadLocation.Distance, Offset, DistanceTolerance);
+		}
+		++TraceCount;
+	}
+
+	TestTrue(TEXT("Avenues matched"), TraceCount > 0);
+
+	// A sample far from every road isn't matched
+	const FVector2D FarAway = Snapshot->GetBoundsMax() + FVector2D(1000000.0, 1000000.0);
+	RoadLocations.SetNum(1);
+	Matcher.MatchTrace(MakeArrayView(&FarAway, 1), RoadLocations, Scratch);
+	TestFalse(TEXT("Sample far from roads isn't matched"), RoadLocations[0].IsValid());
+
+	return true;
+}
+
+#endif	// WITH_DEV_AUTOMATION_TESTS
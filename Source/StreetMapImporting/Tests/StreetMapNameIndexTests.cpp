@@ -0,0 +1,95 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapTestCity.h"
+#include "StreetMapNameIndex.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStreetMapNameIndexTest, "StreetMap.Queries.NameIndex", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FStreetMapNameIndexTest::RunTest(const FString& Parameters)
+{
+	using namespace StreetMapTestCity;
+
+	const TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot = MakeCity();
+	if (!TestTrue(TEXT("City imports"), Snapshot.IsValid()))
+	{
+		return false;
+	}
+
+	const TArray<FStreetMapRoad>& Roads = Snapshot->GetRoads();
+	const FStreetMapNameIndex& Index = Snapshot->GetNameIndex();
+
+	// Each name with a road, and its roads
+	TMap<int32, TArray<int32>> NameRoads;
+	for (int32 RoadIndex = 0; RoadIndex < Roads.Num(); ++RoadIndex)
+	{
+		if (Roads[RoadIndex].NameId != INDEX_NONE)
+		{
+			NameRoads.FindOrAdd(Roads[RoadIndex].NameId).Add(RoadIndex);
+		}
+	}
+
+	TArray<FStreetMapNameIndexMatch> Matches;
+	for (const TCHAR* Prefix : { TEXT("Street 1"), TEXT("AVENUE"), TEXT("lane"), TEXT("2"), TEXT("Boulevard") })
+	{
+		// A name matches when it has a word the whole search text starts at
+		const FString Query = FStreetMapNameIndex::Normalize(Prefix);
+		TArray<int32> ExpectedNameIds;
+		for (const TPair<int32, TArray<int32>>& Pair : NameRoads)
+		{
+			const FString Name = FStreetMapNameIndex::Normalize(Snapshot->GetNameById(Pair.Key));
+			for (int32 WordStart = 0; WordStart < Name.Len(); ++WordStart)
+			{
+				if ((WordStart == 0 || Name[WordStart - 1] == TEXT(' ')) && FStringView(Name).Mid(WordStart).StartsWith(Query))
+				{
+					ExpectedNameIds.Add(Pair.Key);
+					break;
+				}
+			}
+		}
+		ExpectedNameIds.Sort();
+
+		Index.FindByPrefix(Prefix, MAX_int32, Matches);
+		TArray<int32> FoundNameIds;
+		for (const FStreetMapNameIndexMatch& Match : Matches)
+		{
+			const int32 NameId = Index.GetEntryNameId(Match.EntryIndex);
+			FoundNameIds.Add(NameId);
+			TestEqual(TEXT("Exact match edits"), Match.EditDistance, 0);
+			TestTrue(TEXT("Match text starts at the matching word"), FStringView(Index.GetMatchText(Match)).StartsWith(Query));
+
+			TArray<int32> EntryRoads(Index.GetEntryRoads(Match.EntryIndex));
+			EntryRoads.Sort();
+			const TArray<int32>* ExpectedRoads = NameRoads.Find(NameId);
+			TestTrue(TEXT("Entry has the roads with its name"), ExpectedRoads != nullptr && EntryRoads == *ExpectedRoads);
+		}
+		for (int32 MatchIndex = 1; MatchIndex < Matches.Num(); ++MatchIndex)
+		{
+			TestTrue(TEXT("Matches in order of the text from the matching word"), FCString::Strcmp(Index.GetMatchText(Matches[MatchIndex - 1]), Index.GetMatchText(Matches[MatchIndex])) <= 0);
+		}
+		FoundNameIds.Sort();
+		TestTrue(FString::Printf(TEXT("Names found for \"%s\""), Prefix), FoundNameIds == ExpectedNameIds);
+	}
+
+	// One typo away from "Avenue" finds every avenue with one edit, and nothing exactly
+	int32 AvenueCount = 0;
+	for (const TPair<int32, TArray<int32>>& Pair : NameRoads)
+	{
+		AvenueCount += Snapshot->GetNameById(Pair.Key).StartsWith(TEXT("Avenue")) ? 1 : 0;
+	}
+	Index.FindByFuzzyPrefix(TEXT("Avenu3"), 1, MAX_int32, Matches);
+	int32 FuzzyAvenueCount = 0;
+	for (const FStreetMapNameIndexMatch& Match : Matches)
+	{
+		TestEqual(TEXT("Fuzzy match edits"), Match.EditDistance, 1);
+		FuzzyAvenueCount += Snapshot->GetNameById(Index.GetEntryNameId(Match.EntryIndex)).StartsWith(TEXT("Avenue")) ? 1 : 0;
+	}
+	TestTrue(TEXT("Avenues exist"), AvenueCount > 0);
+	TestEqual(TEXT("Fuzzy matches every avenue"), FuzzyAvenueCount, AvenueCount);
+
+	return true;
+}
+
+#endif	// WITH_DEV_AUTOMATION_TESTS
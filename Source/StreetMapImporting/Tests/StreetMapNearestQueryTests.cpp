@@ -0,0 +1,212 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapTestCity.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStreetMapNearestRoadsTest, "StreetMap.Queries.NearestRoads", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FStreetMapNearestRoadsTest::RunTest(const FString& Parameters)
+{
+	using namespace StreetMapTestCity;
+
+	const TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot = MakeCity();
+	if (!TestTrue(TEXT("City imports"), Snapshot.IsValid()))
+	{
+		return false;
+	}
+
+	const TArray<FStreetMapRoad>& Roads = Snapshot->GetRoads();
+	const FStreetMapRoadSegmentIndex& Index = Snapshot->GetDerivedData()->GetRoadSegmentIndex();
+	const double MaxDistance = 4000.0;
+	const int32 MaxCount = 4;
+
+	TArray<FVector2D> Locations;
+	MakeQueryLocations(*Snapshot, Locations);
+	TArray<FStreetMapRoadLocation> NearestRoads;
+	for (const FVector2D& Location : Locations)
+	{
+		TArray<double> RoadDistances;
+		for (const FStreetMapRoad& Road : Roads)
+		{
+			RoadDistances.Add(DistanceToRoad(Road, Location));
+		}
+		const TArray<double> Expected = GetNearestDistances(RoadDistances, MaxCount, MaxDistance);
+
+		Index.FindNearestRoads(Roads, Location, MaxCount, MaxDistance, [](int32) { return true; }, NearestRoads);
+		if (!TestEqual(TEXT("Nearest road count"), NearestRoads.Num(), Expected.Num()))
+		{
+			return false;
+		}
+		for (int32 ResultIndex = 0; ResultIndex < NearestRoads.Num(); ++ResultIndex)
+		{
+			TestEqual(TEXT("Nearest road distance"), (double)NearestRoads[ResultIndex].Distance, Expected[ResultIndex], DistanceTolerance);
+		}
+	}
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStreetMapNodeIndexTest, "StreetMap.Queries.NodeIndex", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FStreetMapNodeIndexTest::RunTest(const FString& Parameters)
+{
+	using namespace StreetMapTestCity;
+
+	const TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot = MakeCity();
+	if (!TestTrue(TEXT("City imports"), Snapshot.IsValid()))
+	{
+		return false;
+	}
+
+	const TArray<FStreetMapNode>& Nodes = Snapshot->GetNodes();
+	const FStreetMapNodeIndex& Index = Snapshot->GetDerivedData()->GetNodeIndex();
+	const double MaxDistance = 8000.0;
+	const int32 MaxCount = 6;
+
+	TArray<FVector2D> Locations;
+	MakeQueryLocations(*Snapshot, Locations);
+	TArray<FStreetMapNearestItem> NearestNodes;
+	for (const FVector2D& Location : Locations)
+	{
+		// Only even nodes, so the filter is checked too
+		TArray<double> NodeDistances;
+		for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); NodeIndex += 2)
+		{
+			NodeDistances.Add(FVector2D::Distance(Location, Nodes[NodeIndex].Location));
+		}
+		const TArray<double> Expected = GetNearestDistances(NodeDistances, MaxCount, MaxDistance);
+
+		Index.FindNearestNodes(Location, MaxCount, MaxDistance, [](const int32 NodeIndex) { return NodeIndex % 2 == 0; }, NearestNodes);
+		if (!TestEqual(TEXT("Nearest node count"), NearestNodes.Num(), Expected.Num()))
+		{
+			return false;
+		}
+		for (int32 ResultIndex = 0; ResultIndex < NearestNodes.Num(); ++ResultIndex)
+		{
+			TestTrue(TEXT("Nearest node passes the filter"), NearestNodes[ResultIndex].Index % 2 == 0);
+			TestEqual(TEXT("Nearest node distance"), NearestNodes[ResultIndex].Distance, Expected[ResultIndex], DistanceTolerance);
+		}
+	}
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStreetMapNearestBuildingsTest, "StreetMap.Queries.NearestBuildings", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FStreetMapNearestBuildingsTest::RunTest(const FString& Parameters)
+{
+	using namespace StreetMapTestCity;
+
+	const TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot = MakeCity();
+	if (!TestTrue(TEXT("City imports"), Snapshot.IsValid()))
+	{
+		return false;
+	}
+
+	const TArray<FStreetMapBuilding>& Buildings = Snapshot->GetBuildings();
+	const FStreetMapBuildingIndex& Index = Snapshot->GetDerivedData()->GetBuildingIndex();
+	const double MaxDistance = 3000.0;
+	const int32 MaxCount = 5;
+
+	// Half the locations are building centers, so some buildings are at distance zero
+	TArray<FVector2D> Locations;
+	MakeQueryLocations(*Snapshot, Locations);
+	for (int32 LocationIndex = 0; LocationIndex < Locations.Num(); LocationIndex += 2)
+	{
+		const FStreetMapBuilding& Building = Buildings[LocationIndex % Buildings.Num()];
+		Locations[LocationIndex] = (Building.BoundsMin + Building.BoundsMax) * 0.5;
+	}
+
+	TArray<FStreetMapNearestItem> NearestBuildings;
+	for (const FVector2D& Location : Locations)
+	{
+		TArray<double> BuildingDistances;
+		for (const FStreetMapBuilding& Building : Buildings)
+		{
+			BuildingDistances.Add(DistanceToBuilding(Building, Location));
+		}
+		const TArray<double> Expected = GetNearestDistances(BuildingDistances, MaxCount, MaxDistance);
+
+		Index.FindNearestBuildings(Buildings, Location, MaxCount, MaxDistance, [](int32) { return true; }, NearestBuildings);
+		if (!TestEqual(TEXT("Nearest building count"), NearestBuildings.Num(), Expected.Num()))
+		{
+			return false;
+		}
+		for (int32 ResultIndex = 0; ResultIndex < NearestBuildings.Num(); ++ResultIndex)
+		{
+			TestEqual(TEXT("Nearest building distance"), NearestBuildings[ResultIndex].Distance, Expected[ResultIndex], DistanceTolerance);
+		}
+	}
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStreetMapNearestBuildingsFilterTest, "StreetMap.Queries.NearestBuildingsFilter", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FStreetMapNearestBuildingsFilterTest::RunTest(const FString& Parameters)
+{
+	using namespace StreetMapTestCity;
+
+	const TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot = MakeCity();
+	if (!TestTrue(TEXT("City imports"), Snapshot.IsValid()))
+	{
+		return false;
+	}
+
+	const TArray<FStreetMapBuilding>& Buildings = Snapshot->GetBuildings();
+	const FStreetMapBuildingIndex& Index = Snapshot->GetDerivedData()->GetBuildingIndex();
+	const double MaxDistance = 6000.0;
+	const int32 MaxCount = 5;
+
+	// Heights are in map units, which are centimeters on imported maps, so this is 20m.  Test city heights run from 4m
+	// to 60m, so it keeps some of the buildings with a height and drops the rest.
+	const double MinHeight = 2000.0;
+	FStreetMapQueryFilter Filter;
+	Filter.MinBuildingHeight = MinHeight;
+
+	int32 TallCount = 0;
+	int32 ShortCount = 0;
+	for (const FStreetMapBuilding& Building : Buildings)
+	{
+		TallCount += Building.Height >= MinHeight ? 1 : 0;
+		ShortCount += Building.Height > 0.0 && Building.Height < MinHeight ? 1 : 0;
+	}
+	TestTrue(TEXT("Some buildings are tall enough"), TallCount > 0);
+	TestTrue(TEXT("Some buildings are too short"), ShortCount > 0);
+
+	TArray<FVector2D> Locations;
+	MakeQueryLocations(*Snapshot, Locations);
+	TArray<FStreetMapNearestItem> NearestBuildings;
+	for (const FVector2D& Location : Locations)
+	{
+		TArray<double> BuildingDistances;
+		for (const FStreetMapBuilding& Building : Buildings)
+		{
+			if (Building.Height >= MinHeight)
+			{
+				BuildingDistances.Add(DistanceToBuilding(Building, Location));
+			}
+		}
+		const TArray<double> Expected = GetNearestDistances(BuildingDistances, MaxCount, MaxDistance);
+
+		Index.FindNearestBuildings(Buildings, Location, MaxCount, MaxDistance, [&Buildings, &Filter](const int32 BuildingIndex) { return Filter.AllowsBuilding(Buildings[BuildingIndex]); }, NearestBuildings);
+		if (!TestEqual(TEXT("Tall building count"), NearestBuildings.Num(), Expected.Num()))
+		{
+			return false;
+		}
+		for (int32 ResultIndex = 0; ResultIndex < NearestBuildings.Num(); ++ResultIndex)
+		{
+			TestTrue(TEXT("Building is tall enough"), Buildings[NearestBuildings[ResultIndex].Index].Height >= MinHeight);
+			TestEqual(TEXT("Tall building distance"), NearestBuildings[ResultIndex].Distance, Expected[ResultIndex], DistanceTolerance);
+		}
+	}
+
+	return true;
+}
+
+#endif	// WITH_DEV_AUTOMATION_TESTS
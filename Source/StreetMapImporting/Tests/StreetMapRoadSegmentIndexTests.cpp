@@ -0,0 +1,67 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapTestCity.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStreetMapRoadSegmentIndexTest, "StreetMap.Queries.RoadSegmentIndex", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FStreetMapRoadSegmentIndexTest::RunTest(const FString& Parameters)
+{
+	using namespace StreetMapTestCity;
+
+	const TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot = MakeCity();
+	if (!TestTrue(TEXT("City imports"), Snapshot.IsValid()))
+	{
+		return false;
+	}
+
+	const TArray<FStreetMapRoad>& Roads = Snapshot->GetRoads();
+	const FStreetMapRoadSegmentIndex& Index = Snapshot->GetDerivedData()->GetRoadSegmentIndex();
+	const double MaxDistance = 4000.0;
+
+	TArray<FVector2D> Locations;
+	MakeQueryLocations(*Snapshot, Locations);
+	for (const FVector2D& Location : Locations)
+	{
+		double NearestRoadDistance = MAX_dbl;
+		double NearestPointDistance = MAX_dbl;
+		for (const FStreetMapRoad& Road : Roads)
+		{
+			NearestRoadDistance = FMath::Min(NearestRoadDistance, DistanceToRoad(Road, Location));
+			for (const FVector2D& RoadPoint : Road.RoadPoints)
+			{
+				NearestPointDistance = FMath::Min(NearestPointDistance, FVector2D::Distance(Location, RoadPoint));
+			}
+		}
+
+		// Nearest location.  Ties may pick different roads, so only the distance has to agree.
+		FStreetMapRoadLocation RoadLocation;
+		if (Index.FindNearestLocation(Roads, Location, MaxDistance, RoadLocation))
+		{
+			TestEqual(TEXT("Nearest location distance"), (double)RoadLocation.Distance, NearestRoadDistance, DistanceTolerance);
+			TestEqual(TEXT("Nearest location is on its road"), DistanceToRoad(Roads[RoadLocation.RoadIndex], RoadLocation.Location), 0.0, DistanceTolerance);
+		}
+		else
+		{
+			TestTrue(TEXT("No road nearby"), NearestRoadDistance > MaxDistance - DistanceTolerance);
+		}
+
+		// Nearest road point
+		int32 RoadIndex;
+		int32 PointIndex;
+		if (Index.FindNearestPoint(Roads, Location, MaxDistance, RoadIndex, PointIndex))
+		{
+			TestEqual(TEXT("Nearest point distance"), FVector2D::Distance(Location, Roads[RoadIndex].RoadPoints[PointIndex]), NearestPointDistance, DistanceTolerance);
+		}
+		else
+		{
+			TestTrue(TEXT("No road point nearby"), NearestPointDistance > MaxDistance - DistanceTolerance);
+		}
+	}
+
+	return true;
+}
+
+#endif	// WITH_DEV_AUTOMATION_TESTS
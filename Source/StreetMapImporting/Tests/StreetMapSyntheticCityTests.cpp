@@ -0,0 +1,39 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapTestCity.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStreetMapSyntheticCityTest, "StreetMap.SyntheticCity", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FStreetMapSyntheticCityTest::RunTest(const FString& Parameters)
+{
+	using namespace StreetMapTestCity;
+
+	// Benchmark runs are only comparable if the same settings always make the same city
+	const FStreetMapSyntheticCitySettings Settings = MakeSettings();
+	FStreetMapSyntheticCityStats Stats;
+	FStreetMapSyntheticCityStats OtherStats;
+	TestTrue(TEXT("Same seed makes the same city"), FStreetMapSyntheticCity::GenerateOSMXml(Settings, Stats) == FStreetMapSyntheticCity::GenerateOSMXml(Settings, OtherStats));
+
+	FStreetMapSyntheticCitySettings OtherSettings = Settings;
+	++OtherSettings.Seed;
+	TestTrue(TEXT("Another seed makes another city"), FStreetMapSyntheticCity::GenerateOSMXml(Settings, Stats) != FStreetMapSyntheticCity::GenerateOSMXml(OtherSettings, OtherStats));
+
+	// Every road and building generated survives the import
+	FStreetMapSyntheticCityStats ImportStats;
+	const UStreetMap* StreetMap = ImportCity(Settings, ImportStats);
+	if (!TestNotNull(TEXT("City imports"), StreetMap))
+	{
+		return false;
+	}
+	TestEqual(TEXT("Road count"), StreetMap->GetRoads().Num(), ImportStats.RoadCount);
+	TestEqual(TEXT("Building count"), StreetMap->GetBuildings().Num(), ImportStats.BuildingCount);
+	TestEqual(TEXT("Building count matches the settings"), ImportStats.BuildingCount, Settings.BuildingCount);
+	TestTrue(TEXT("Grid and winding streets"), ImportStats.RoadCount >= 2 * (Settings.GridSize + 1));
+
+	return true;
+}
+
+#endif	// WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,142 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "StreetMapSyntheticCity.h"
+#include "StreetMap.h"
+#include "StreetMapSnapshot.h"
+#include "StreetMapDerivedData.h"
+#include "OSMFile.h"
+#include "StreetMapOSMConverter.h"
+#include "Math/RandomStream.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Query tests check every index against a brute force search over the same small synthetic city
+namespace StreetMapTestCity
+{
+	/** Distances from indexed and brute force searches may differ by this much, in map units, since the indices store floats */
+	static constexpr double DistanceTolerance = 0.05;
+
+	/** Locations to search from.  The same every run, and spread a little past the city so some searches find nothing nearby. */
+	static constexpr int32 QueryCount = 200;
+
+	/** Settings for the test city, which is small enough to search by brute force */
+	static FStreetMapSyntheticCitySettings MakeSettings()
+	{
+		FStreetMapSyntheticCitySettings Settings;
+		Settings.GridSize = 6;
+		Settings.OrganicStreetCount = 6;
+		Settings.BuildingCount = 150;
+		Settings.Seed = 7;
+		return Settings;
+	}
+
+	/** Imports a synthetic city into a transient street map */
+	static UStreetMap* ImportCity(const FStreetMapSyntheticCitySettings& Settings, FStreetMapSyntheticCityStats& OutStats)
+	{
+		const FString Xml = FStreetMapSyntheticCity::GenerateOSMXml(Settings, OutStats);
+
+		FOSMFile OSMFile;
+		if (!OSMFile.LoadOpenStreetMapFile(Xml, /* bIsFilePathActuallyTextBuffer */ true, nullptr))
+		{
+			return nullptr;
+		}
+
+		UStreetMap* StreetMap = NewObject<UStreetMap>(GetTransientPackage(), NAME_None, RF_Transient);
+		FStreetMapOSMConverter::Convert(OSMFile, *StreetMap);
+		return StreetMap;
+	}
+
+	/** Imports the test city and returns its snapshot, with derived data built */
+	static TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> MakeCity()
+	{
+		FStreetMapSyntheticCityStats Stats;
+		const UStreetMap* StreetMap = ImportCity(MakeSettings(), Stats);
+		if (StreetMap == nullptr)
+		{
+			return nullptr;
+		}
+
+		// The snapshot keeps the data alive after the street map is collected
+		TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot = StreetMap->GetSnapshot();
+		if (Snapshot.IsValid() && Snapshot->GetRoads().Num() > 0 && Snapshot->GetBuildings().Num() > 0)
+		{
+			Snapshot->GetDerivedData();
+			return Snapshot;
+		}
+		return nullptr;
+	}
+
+	static void MakeQueryLocations(const FStreetMapSnapshot& Snapshot, TArray<FVector2D>& OutLocations)
+	{
+		const FVector2D Margin(5000.0, 5000.0);
+		const FBox2D Bounds(Snapshot.GetBoundsMin() - Margin, Snapshot.GetBoundsMax() + Margin);
+
+		FRandomStream Random(11);
+		OutLocations.Reset(QueryCount);
+		for (int32 QueryIndex = 0; QueryIndex < QueryCount; ++QueryIndex)
+		{
+			OutLocations.Emplace(Random.FRandRange(Bounds.Min.X, Bounds.Max.X), Random.FRandRange(Bounds.Min.Y, Bounds.Max.Y));
+		}
+	}
+
+	static double DistanceToRoad(const FStreetMapRoad& Road, const FVector2D& Location)
+	{
+		double BestDistanceSquared = MAX_dbl;
+		for (int32 PointIndex = 0; PointIndex + 1 < Road.RoadPoints.Num(); ++PointIndex)
+		{
+			const FVector2D Closest = FMath::ClosestPointOnSegment2D(Location, Road.RoadPoints[PointIndex], Road.RoadPoints[PointIndex + 1]);
+			BestDistanceSquared = FMath::Min(BestDistanceSquared, FVector2D::DistSquared(Location, Closest));
+		}
+		return FMath::Sqrt(BestDistanceSquared);
+	}
+
+	static bool IsInsidePolygon(TArrayView<const FVector2D> Polygon, const FVector2D& Location)
+	{
+		bool bInside = false;
+		for (int32 Index = 0, Previous = Polygon.Num() - 1; Index < Polygon.Num(); Previous = Index++)
+		{
+			const FVector2D& A = Polygon[Index];
+			const FVector2D& B = Polygon[Previous];
+			if ((A.Y > Location.Y) != (B.Y > Location.Y) && Location.X < A.X + (B.X - A.X) * (Location.Y - A.Y) / (B.Y - A.Y))
+			{
+				bInside = !bInside;
+			}
+		}
+		return bInside;
+	}
+
+	/** Distance from a location to a building's footprint, zero inside it */
+	static double DistanceToBuilding(const FStreetMapBuilding& Building, const FVector2D& Location)
+	{
+		const TArray<FVector2D>& Points = Building.BuildingPoints;
+		if (IsInsidePolygon(Points, Location))
+		{
+			return 0.0;
+		}
+
+		double BestDistanceSquared = MAX_dbl;
+		for (int32 Index = 0, Previous = Points.Num() - 1; Index < Points.Num(); Previous = Index++)
+		{
+			const FVector2D Closest = FMath::ClosestPointOnSegment2D(Location, Points[Previous], Points[Index]);
+			BestDistanceSquared = FMath::Min(BestDistanceSquared, FVector2D::DistSquared(Location, Closest));
+		}
+		return FMath::Sqrt(BestDistanceSquared);
+	}
+
+	/** The k smallest of some distances, nearest first */
+	static TArray<double> GetNearestDistances(TArray<double> Distances, const int32 MaxCount, const double MaxDistance)
+	{
+		Distances.RemoveAll([MaxDistance](const double Distance) { return Distance > MaxDistance; });
+		Distances.Sort();
+		if (Distances.Num() > MaxCount)
+		{
+			Distances.SetNum(MaxCount);
+		}
+		return Distances;
+	}
+}
+
+#endif	// WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,461 @@
+#include "OSMFile.h"
+#include "Misc/FeedbackContext.h"
+#include "StreetMapMemory.h"
+#include "StreetMapStats.h"
+
+FOSMFile::FOSMFile()
+	: ParsingState(ParsingState::Root),
+	  CurrentNodeID(0),
+	  CurrentNodeInfo(nullptr),
+	  CurrentWayInfo(nullptr),
+	  CurrentWayTagKey(nullptr)
+{
+}
+		
+
+FOSMFile::~FOSMFile()
+{
+	// Clean up time
+	{
+		for( auto* Way : Ways )
+		{
+			delete Way;
+		}
+		Ways.Empty();
+				
+		for( auto HashPair : NodeMap )
+		{
+			FOSMNodeInfo* NodeInfo = HashPair.Value;
+			delete NodeInfo;
+		}
+		NodeMap.Empty();
+	}
+}
+
+
+bool FOSMFile::LoadOpenStreetMapFile( FString& OSMFilePath, const bool bIsFilePathActuallyTextBuffer, FFeedbackContext* FeedbackContext )
+{
+	LLM_SCOPE_BYTAG( StreetMap_Loading );
+	STREETMAP_SCOPE_CYCLE_COUNTER( STAT_StreetMap_LoadOSMFile );
+
+	// Progress can only be shown on the game thread
+	const bool bShowSlowTaskDialog = FeedbackContext != nullptr && IsInGameThread();
+	const bool bShowCancelButton = bShowSlowTaskDialog;
+
+	FText ErrorMessage;
+	int32 ErrorLineNumber;
+	if( FFastXml::ParseXmlFile( 
+		this, 
+		bIsFilePathActuallyTextBuffer ? nullptr : *OSMFilePath, 
+		bIsFilePathActuallyTextBuffer ? OSMFilePath.GetCharArray().GetData() : nullptr, 
+		FeedbackContext, 
+		bShowSlowTaskDialog, 
+		bShowCancelButton, 
+		/* Out */ ErrorMessage, 
+		/* Out */ ErrorLineNumber ) )
+	{
+		if( NodeMap.Num() > 0 )
+		{
+			AverageLatitude /= NodeMap.Num();
+			AverageLongitude /= NodeMap.Num();
+		}
+
+		return true;
+	}
+
+	if( FeedbackContext != nullptr )
+	{
+		FeedbackContext->Logf(
+			ELogVerbosity::Error,
+			TEXT( "Failed to load OpenStreetMap XML file ('%s', Line %i)" ),
+			*ErrorMessage.ToString(),
+			ErrorLineNumber );
+	}
+
+	return false;
+}
+
+		
+bool FOSMFile::ProcessXmlDeclaration( const TCHAR* ElementData, int32 XmlFileLineNumber )
+{
+	// Don't care about XML declaration
+	return true;
+}
+
+
+bool FOSMFile::ProcessComment( const TCHAR* Comment )
+{
+	// Don't care about comments
+	return true;
+}
+	
+	
+bool FOSMFile::ProcessElement( const TCHAR* ElementName, const TCHAR* ElementData, int32 XmlFileLineNumber )
+{
+	if( ParsingState == ParsingState::Root )
+	{
+		if( !FCString::Stricmp( ElementName, TEXT( "node" ) ) )
+		{
+			ParsingState = ParsingState::Node;
+			CurrentNodeInfo = new FOSMNodeInfo();
+			CurrentNodeInfo->Id = 0;
+			CurrentNodeInfo->Latitude = 0.0;
+			CurrentNodeInfo->Longitude = 0.0;
+		}
+		else if( !FCString::Stricmp( ElementName, TEXT( "way" ) ) )
+		{
+			ParsingState = ParsingState::Way;
+			CurrentWayInfo = NewWayInfo();
+
+			// @todo: We're currently ignoring the "visible" tag on ways, which means that roads will always
+			//        be included in our data set.  It might be nice to make this an import option.
+		}
+	}
+	else if( ParsingState == ParsingState::Way )
+	{
+		if( !FCString::Stricmp( ElementName, TEXT( "nd" ) ) )
+		{
+			ParsingState = ParsingState::Way_NodeRef;
+		}
+		else if( !FCString::Stricmp( ElementName, TEXT( "tag" ) ) )
+		{
+			ParsingState = ParsingState::Way_Tag;
+		}
+	}
+
+	return true;
+}
+
+
+bool FOSMFile::ProcessAttribute( const TCHAR* AttributeName, const TCHAR* AttributeValue )
+{
+	if( ParsingState == ParsingState::Node )
+	{
+		if( !FCString::Stricmp( AttributeName, TEXT( "id" ) ) )
+		{
+			CurrentNodeID = FPlatformString::Atoi64( AttributeValue );
+			CurrentNodeInfo->Id = CurrentNodeID;
+		}
+		else if( !FCString::Stricmp( AttributeName, TEXT( "lat" ) ) )
+		{
+			CurrentNodeInfo->Latitude = FPlatformString::Atod( AttributeValue );
+		}
+		else if( !FCString::Stricmp( AttributeName, TEXT( "lon" ) ) )
+		{
+			CurrentNodeInfo->Longitude = FPlatformString::Atod( AttributeValue );
+		}
+	}
+	else if( ParsingState == ParsingState::Way )
+	{
+		if( !FCString::Stricmp( AttributeName, TEXT( "id" ) ) )
+		{
+			CurrentWayInfo->Id = FPlatformString::Atoi64( AttributeValue );
+		}
+	}
+	else if( ParsingState == ParsingState::Way_NodeRef )
+	{
+		if( !FCString::Stricmp( AttributeName, TEXT( "ref" ) ) )
+		{
+			// Nodes can be missing from the file, or filtered out by region.  Ways just skip them.
+			FOSMNodeInfo* ReferencedNode = NodeMap.FindRef( FPlatformString::Atoi64( AttributeValue ) );
+			if( ReferencedNode != nullptr )
+			{
+				CurrentWayInfo->Nodes.Add( ReferencedNode );
+			}
+		}
+	}
+	else if( ParsingState == ParsingState::Way_Tag )
+	{
+		if( !FCString::Stricmp( AttributeName, TEXT( "k" ) ) )
+		{
+			CurrentWayTagKey = AttributeValue;
+		}
+		else if( !FCString::Stricmp( AttributeName, TEXT( "v" ) ) && CurrentWayTagKey != nullptr )
+		{
+			ApplyWayTag( *CurrentWayInfo, CurrentWayTagKey, AttributeValue );
+		}
+	}
+
+	return true;
+}
+
+
+bool FOSMFile::ProcessClose( const TCHAR* Element )
+{
+	if( ParsingState == ParsingState::Node )
+	{
+		FinishNode( CurrentNodeInfo );
+		CurrentNodeID = 0;
+		CurrentNodeInfo = nullptr;
+				
+		ParsingState = ParsingState::Root;
+	}
+	else if( ParsingState == ParsingState::Way )
+	{
+		FinishWay( CurrentWayInfo );
+		CurrentWayInfo = nullptr;
+				
+		ParsingState = ParsingState::Root;
+	}
+	else if( ParsingState == ParsingState::Way_NodeRef )
+	{
+		ParsingState = ParsingState::Way;
+	}
+	else if( ParsingState == ParsingState::Way_Tag )
+	{
+		CurrentWayTagKey = TEXT( "" );
+		ParsingState = ParsingState::Way;
+	}
+
+	return true;
+}
+
+
+FOSMFile::FOSMWayInfo* FOSMFile::NewWayInfo()
+{
+	FOSMWayInfo* WayInfo = new FOSMWayInfo();
+	WayInfo->Id = 0;
+	WayInfo->WayType = EOSMWayType::Other;
+	WayInfo->Height = 0.0;
+	WayInfo->BuildingLevels = 0;
+	WayInfo->bIsOneWay = false;
+	return WayInfo;
+}
+
+
+void FOSMFile::ApplyWayTag( FOSMWayInfo& WayInfo, const TCHAR* Key, const TCHAR* Value )
+{
+	if( !FCString::Stricmp( Key, TEXT( "name" ) ) )
+	{
+		WayInfo.Name = Value;
+	}
+	else if( !FCString::Stricmp( Key, TEXT( "ref" ) ) )
+	{
+		WayInfo.Ref = Value;
+	}
+	else if( !FCString::Stricmp( Key, TEXT( "highway" ) ) )
+	{
+		EOSMWayType WayType = EOSMWayType::Other;
+				
+		if( !FCString::Stricmp( Value, TEXT( "motorway" ) ) )
+		{
+			WayType = EOSMWayType::Motorway;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "motorway_link" ) ) )
+		{
+			WayType = EOSMWayType::Motorway_Link;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "trunk" ) ) )
+		{
+			WayType = EOSMWayType::Trunk;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "trunk_link" ) ) )
+		{
+			WayType = EOSMWayType::Trunk_Link;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "primary" ) ) )
+		{
+			WayType = EOSMWayType::Primary;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "primary_link" ) ) )
+		{
+			WayType = EOSMWayType::Primary_Link;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "secondary" ) ) )
+		{
+			WayType = EOSMWayType::Secondary;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "secondary_link" ) ) )
+		{
+			WayType = EOSMWayType::Secondary_Link;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "tertiary" ) ) )
+		{
+			WayType = EOSMWayType::Tertiary;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "tertiary_link" ) ) )
+		{
+			WayType = EOSMWayType::Tertiary_Link;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "residential" ) ) )
+		{
+			WayType = EOSMWayType::Residential;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "service" ) ) )
+		{
+			WayType = EOSMWayType::Service;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "unclassified" ) ) )
+		{
+			WayType = EOSMWayType::Unclassified;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "living_street" ) ) )
+		{
+			WayType = EOSMWayType::Living_Street;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "pedestrian" ) ) )
+		{
+			WayType = EOSMWayType::Pedestrian;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "track" ) ) )
+		{
+			WayType = EOSMWayType::Track;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "bus_guideway" ) ) )
+		{
+			WayType = EOSMWayType::Bus_Guideway;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "raceway" ) ) )
+		{
+			WayType = EOSMWayType::Raceway;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "road" ) ) )
+		{
+			WayType = EOSMWayType::Road;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "footway" ) ) )
+		{
+			WayType = EOSMWayType::Footway;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "cycleway" ) ) )
+		{
+			WayType = EOSMWayType::Cycleway;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "bridleway" ) ) )
+		{
+			WayType = EOSMWayType::Bridleway;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "steps" ) ) )
+		{
+			WayType = EOSMWayType::Steps;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "path" ) ) )
+		{
+			WayType = EOSMWayType::Path;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "proposed" ) ) )
+		{
+			WayType = EOSMWayType::Proposed;
+		}
+		else if( !FCString::Stricmp( Value, TEXT( "construction" ) ) )
+		{
+			WayType = EOSMWayType::Construction;
+		}
+		else
+		{
+			// Other type that we don't recognize yet.  See http://wiki.openstreetmap.org/wiki/Key:highway
+		}
+				
+				
+		WayInfo.WayType = WayType;
+	}
+	else if( !FCString::Stricmp( Key, TEXT( "building" ) ) )
+	{
+		WayInfo.WayType = EOSMWayType::Building;
+
+		if( !FCString::Stricmp( Value, TEXT( "yes" ) ) )
+		{
+			WayInfo.WayType = EOSMWayType::Building;
+		}
+		else
+		{
+			// Other type that we don't recognize yet.  See http://wiki.openstreetmap.org/wiki/Key:building
+		}
+	}
+	else if( !FCString::Stricmp( Key, TEXT( "height" ) ) )
+	{
+		// Check to see if there is a space character in the height value.  For now, we're looking
+		// for straight-up floating point values.
+		if( !FString( Value ).Contains( TEXT( " " ) ) )
+		{
+			// Okay, no space character.  So this has got to be a floating point number.  The OSM
+			// spec says that the height values are in meters.
+			WayInfo.Height = FPlatformString::Atod( Value );
+		}
+		else
+		{
+			// Looks like the height value contains units of some sort.
+			// @todo: Add support for interpreting unit strings and converting the values
+		}
+	}
+	else if (!FCString::Stricmp(Key, TEXT("building:levels")))
+	{
+		WayInfo.BuildingLevels = FPlatformString::Atoi(Value);
+	}
+	else if( !FCString::Stricmp( Key, TEXT( "oneway" ) ) )
+	{
+		if( !FCString::Stricmp( Value, TEXT( "yes" ) ) )
+		{
+			WayInfo.bIsOneWay = true;
+		}
+		else
+		{
+			WayInfo.bIsOneWay = false;
+		}
+	}
+}
+
+
+void FOSMFile::SetRegionFilter( const double InMinLatitude, const double InMinLongitude, const double InMaxLatitude, const double InMaxLongitude )
+{
+	bHasRegionFilter = true;
+	RegionMinLatitude = InMinLatitude;
+	RegionMinLongitude = InMinLongitude;
+	RegionMaxLatitude = InMaxLatitude;
+	RegionMaxLongitude = InMaxLongitude;
+}
+
+
+void FOSMFile::FinishNode( FOSMNodeInfo* NodeInfo )
+{
+	if( bHasRegionFilter &&
+		( NodeInfo->Latitude < RegionMinLatitude || NodeInfo->Latitude > RegionMaxLatitude ||
+		  NodeInfo->Longitude < RegionMinLongitude || NodeInfo->Longitude > RegionMaxLongitude ) )
+	{
+		delete NodeInfo;
+		return;
+	}
+
+	// Files can list the same node twice.  The first one wins, because ways that came in between may already point at
+	// it, and it's already part of the bounds and the average location.
+	if( NodeMap.Contains( NodeInfo->Id ) )
+	{
+		delete NodeInfo;
+		return;
+	}
+
+	AverageLatitude += NodeInfo->Latitude;
+	AverageLongitude += NodeInfo->Longitude;
+
+	// Update minimum and maximum latitude and longitude
+	// @todo: Performance: Instead of computing our own bounding box, we could parse the "minlat" and
+	//        "minlon" tags from the OSM file
+	MinLatitude = FMath::Min( MinLatitude, NodeInfo->Latitude );
+	MaxLatitude = FMath::Max( MaxLatitude, NodeInfo->Latitude );
+	MinLongitude = FMath::Min( MinLongitude, NodeInfo->Longitude );
+	MaxLongitude = FMath::Max( MaxLongitude, NodeInfo->Longitude );
+
+	NodeMap.Add( NodeInfo->Id, NodeInfo );
+}
+
+
+void FOSMFile::FinishWay( FOSMWayInfo* WayInfo )
+{
+	// Ways of unknown types are never turned into roads or buildings, so there's no point keeping them around
+	if( WayInfo->WayType == EOSMWayType::Other || WayInfo->Nodes.Num() < 2 )
+	{
+		delete WayInfo;
+		return;
+	}
+
+	// Update the nodes with information about the way that is referencing them
+	for( int32 NodeIndex = 0; NodeIndex < WayInfo->Nodes.Num(); ++NodeIndex )
+	{
+		FOSMWayRef NewWayRef;
+		NewWayRef.Way = WayInfo;
+		NewWayRef.NodeIndex = NodeIndex;
+		WayInfo->Nodes[ NodeIndex ]->WayRefs.Add( NewWayRef );
+	}
+
+	Ways.Add( WayInfo );
+}
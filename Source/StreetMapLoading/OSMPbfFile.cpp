@@ -0,0 +1,585 @@
+#include "OSMFile.h"
+#include "HAL/FileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FeedbackContext.h"
+#include "StreetMapMemory.h"
+#include "StreetMapStats.h"
+
+// OpenStreetMap PBF files are a sequence of blobs holding protocol buffer messages.  Only the few messages and fields
+// that we need are decoded here.  See http://wiki.openstreetmap.org/wiki/PBF_Format for the format.
+
+namespace OSMPbf
+{
+	/** Protocol buffer wire types */
+	enum class EWireType : uint8
+	{
+		Varint = 0,
+		Fixed64 = 1,
+		LengthDelimited = 2,
+		Fixed32 = 5
+	};
+
+	/** Largest blob header the format allows */
+	static const int64 MaxBlobHeaderSize = 64 * 1024;
+
+	/** Largest blob the format allows, compressed or not */
+	static const int64 MaxBlobSize = 32 * 1024 * 1024;
+
+
+	/** Reads the fields of a protocol buffer message in memory */
+	struct FMessageReader
+	{
+		const uint8* Data;
+		const uint8* End;
+
+		/** Set when the message turned out to be malformed.  Everything read after that is zero or empty. */
+		bool bError;
+
+		FMessageReader( TArrayView<const uint8> Message )
+			: Data( Message.GetData() ),
+			  End( Message.GetData() + Message.Num() ),
+			  bError( false )
+		{
+		}
+
+		/** Reads the key of the next field.  Returns false at the end of the message. */
+		bool ReadKey( uint32& OutFieldNumber, EWireType& OutWireType )
+		{
+			if( bError || Data >= End )
+			{
+				return false;
+			}
+
+			const uint64 Key = ReadVarint();
+			OutFieldNumber = uint32( Key >> 3 );
+			OutWireType = EWireType( Key & 0x7 );
+			return !bError;
+		}
+
+		uint64 ReadVarint()
+		{
+			uint64 Value = 0;
+			for( int32 Shift = 0; Shift < 64 && Data < End; Shift += 7 )
+			{
+				const uint8 Byte = *Data++;
+				Value |= uint64( Byte & 0x7F ) << Shift;
+				if( ( Byte & 0x80 ) == 0 )
+				{
+					return Value;
+				}
+			}
+
+			bError = true;
+			return 0;
+		}
+
+		/** Reads a zigzag encoded signed varint (sint32 or sint64) */
+		int64 ReadSignedVarint()
+		{
+			const uint64 Value = ReadVarint();
+			return int64( Value >> 1 ) ^ -int64( Value & 1 );
+		}
+
+		/** Reads a length delimited field.  The returned bytes point into the message. */
+		TArrayView<const uint8> ReadBytes()
+		{
+			const uint64 Size = ReadVarint();
+			if( bError || Size > uint64( End - Data ) )
+			{
+				bError = true;
+				return TArrayView<const uint8>();
+			}
+
+			TArrayView<const uint8> Bytes( Data, int32( Size ) );
+			Data += Size;
+			return Bytes;
+		}
+
+		/** Reads a repeated varint field, whether it's packed or not, and adds its values to OutValues */
+		void ReadRepeatedVarints( const EWireType WireType, const bool bIsSigned, TArray<int64>& OutValues )
+		{
+			if( WireType == EWireType::LengthDelimited )
+			{
+				FMessageReader PackedReader( ReadBytes() );
+				while( !PackedReader.bError && PackedReader.Data < PackedReader.End )
+				{
+					OutValues.Add( bIsSigned ? PackedReader.ReadSignedVarint() : int64( PackedReader.ReadVarint() ) );
+				}
+				bError |= PackedReader.bError;
+			}
+			else if( WireType == EWireType::Varint )
+			{
+				OutValues.Add( bIsSigned ? ReadSignedVarint() : int64( ReadVarint() ) );
+			}
+			else
+			{
+				bError = true;
+			}
+		}
+
+		/** Skips over a field we don't need */
+		void Skip( const EWireType WireType )
+		{
+			switch( WireType )
+			{
+				case EWireType::Varint:
+					ReadVarint();
+					break;
+
+				case EWireType::Fixed64:
+					Advance( 8 );
+					break;
+
+				case EWireType::LengthDelimited:
+					ReadBytes();
+					break;
+
+				case EWireType::Fixed32:
+					Advance( 4 );
+					break;
+
+				default:
+					bError = true;
+					break;
+			}
+		}
+
+		void Advance( const int64 ByteCount )
+		{
+			if( ByteCount > End - Data )
+			{
+				bError = true;
+			}
+			else
+			{
+				Data += ByteCount;
+			}
+		}
+	};
+}
+
+
+bool FOSMFile::LoadOpenStreetMapPbfFile( const FString& PbfFilePath, FFeedbackContext* FeedbackContext )
+{
+	using namespace OSMPbf;
+
+	LLM_SCOPE_BYTAG( StreetMap_Loading );
+	STREETMAP_SCOPE_CYCLE_COUNTER( STAT_StreetMap_LoadOSMFile );
+
+	auto LogError = [FeedbackContext, &PbfFilePath]( const TCHAR* ErrorMessage ) -> bool
+	{
+		if( FeedbackContext != nullptr )
+		{
+			FeedbackContext->Logf(
+				ELogVerbosity::Error,
+				TEXT( "Failed to load OpenStreetMap PBF file ('%s', %s)" ),
+				*PbfFilePath,
+				ErrorMessage );
+		}
+		return false;
+	};
+
+	TUniquePtr<FArchive> FileReader( IFileManager::Get().CreateFileReader( *PbfFilePath ) );
+	if( !FileReader.IsValid() )
+	{
+		return LogError( TEXT( "the file could not be opened" ) );
+	}
+
+	// The file is read one blob at a time, into buffers that are reused for every blob
+	TArray<uint8> BlobHeaderBytes;
+	TArray<uint8> BlobBytes;
+	TArray<uint8> UncompressedBlockBytes;
+
+	const int64 FileSize = FileReader->TotalSize();
+	while( FileReader->Tell() < FileSize )
+	{
+		// Every blob has a header, which is preceded by its size as a big endian 32-bit integer
+		uint8 BlobHeaderSizeBytes[ 4 ];
+		FileReader->Serialize( BlobHeaderSizeBytes, sizeof( BlobHeaderSizeBytes ) );
+		const int64 BlobHeaderSize = ( int64( BlobHeaderSizeBytes[ 0 ] ) << 24 ) | ( BlobHeaderSizeBytes[ 1 ] << 16 ) | ( BlobHeaderSizeBytes[ 2 ] << 8 ) | BlobHeaderSizeBytes[ 3 ];
+		if( FileReader->IsError() || BlobHeaderSize == 0 || BlobHeaderSize > MaxBlobHeaderSize )
+		{
+			return LogError( TEXT( "bad blob header size" ) );
+		}
+
+		BlobHeaderBytes.SetNumUninitialized( BlobHeaderSize );
+		FileReader->Serialize( BlobHeaderBytes.GetData(), BlobHeaderSize );
+
+		bool bIsDataBlob = false;
+		int64 BlobSize = -1;
+		{
+			FMessageReader BlobHeaderReader( BlobHeaderBytes );
+			uint32 FieldNumber;
+			EWireType WireType;
+			while( BlobHeaderReader.ReadKey( FieldNumber, WireType ) )
+			{
+				if( FieldNumber == 1 && WireType == EWireType::LengthDelimited )
+				{
+					// Only "OSMData" blobs have anything we need.  "OSMHeader" blobs just describe the file.
+					const TArrayView<const uint8> BlobType = BlobHeaderReader.ReadBytes();
+					bIsDataBlob = BlobType.Num() == 7 && FMemory::Memcmp( BlobType.GetData(), "OSMData", 7 ) == 0;
+				}
+				else if( FieldNumber == 3 && WireType == EWireType::Varint )
+				{
+					BlobSize = int64( BlobHeaderReader.ReadVarint() );
+				}
+				else
+				{
+					BlobHeaderReader.Skip( WireType );
+				}
+			}
+
+			if( FileReader->IsError() || BlobHeaderReader.bError || BlobSize < 0 || BlobSize > MaxBlobSize )
+			{
+				return LogError( TEXT( "bad blob header" ) );
+			}
+		}
+
+		// Seeking past the end doesn't fail, so a truncated or corrupt file has to be caught here
+		if( BlobSize > FileSize - FileReader->Tell() )
+		{
+			return LogError( TEXT( "the file is truncated" ) );
+		}
+
+		if( !bIsDataBlob )
+		{
+			FileReader->Seek( FileReader->Tell() + BlobSize );
+			continue;
+		}
+
+		BlobBytes.SetNumUninitialized( BlobSize );
+		FileReader->Serialize( BlobBytes.GetData(), BlobSize );
+		if( FileReader->IsError() )
+		{
+			return LogError( TEXT( "the file is truncated" ) );
+		}
+
+		// Blobs hold their block either uncompressed or compressed
+		TArrayView<const uint8> BlockBytes;
+		{
+			TArrayView<const uint8> RawBytes;
+			TArrayView<const uint8> ZlibBytes;
+			int64 RawSize = -1;
+			bool bHasUnsupportedCompression = false;
+
+			FMessageReader BlobReader( BlobBytes );
+			uint32 FieldNumber;
+			EWireType WireType;
+			while( BlobReader.ReadKey( FieldNumber, WireType ) )
+			{
+				if( FieldNumber == 1 && WireType == EWireType::LengthDelimited )
+				{
+					RawBytes = BlobReader.ReadBytes();
+				}
+				else if( FieldNumber == 2 && WireType == EWireType::Varint )
+				{
+					RawSize = int64( BlobReader.ReadVarint() );
+				}
+				else if( FieldNumber == 3 && WireType == EWireType::LengthDelimited )
+				{
+					ZlibBytes = BlobReader.ReadBytes();
+				}
+				else
+				{
+					// LZMA, LZ4 and Zstandard compressed blobs aren't supported
+					bHasUnsupportedCompression |= FieldNumber >= 4 && FieldNumber <= 7;
+					BlobReader.Skip( WireType );
+				}
+			}
+
+			if( BlobReader.bError )
+			{
+				return LogError( TEXT( "bad blob" ) );
+			}
+
+			if( RawBytes.Num() > 0 )
+			{
+				BlockBytes = RawBytes;
+			}
+			else if( ZlibBytes.Num() > 0 )
+			{
+				if( RawSize <= 0 || RawSize > MaxBlobSize )
+				{
+					return LogError( TEXT( "bad compressed block size" ) );
+				}
+
+				UncompressedBlockBytes.SetNumUninitialized( RawSize );
+				if( !FCompression::UncompressMemory( NAME_Zlib, UncompressedBlockBytes.GetData(), RawSize, ZlibBytes.GetData(), ZlibBytes.Num() ) )
+				{
+					return LogError( TEXT( "a block could not be decompressed" ) );
+				}
+				BlockBytes = UncompressedBlockBytes;
+			}
+			else if( bHasUnsupportedCompression )
+			{
+				return LogError( TEXT( "only uncompressed and zlib compressed blocks are supported" ) );
+			}
+		}
+
+		if( !LoadPbfPrimitiveBlock( BlockBytes ) )
+		{
+			return LogError( TEXT( "bad data block" ) );
+		}
+	}
+
+	if( NodeMap.Num() > 0 )
+	{
+		AverageLatitude /= NodeMap.Num();
+		AverageLongitude /= NodeMap.Num();
+	}
+
+	return true;
+}
+
+
+bool FOSMFile::LoadPbfPrimitiveBlock( TArrayView<const uint8> BlockData )
+{
+	using namespace OSMPbf;
+
+	uint32 FieldNumber;
+	EWireType WireType;
+
+	// The string table and coordinate encoding can come after the groups that use them, so find everything first
+	TArray<FString> StringTable;
+	TArray<TArrayView<const uint8>, TInlineAllocator<4>> Groups;
+	int64 Granularity = 100;
+	int64 LatitudeOffset = 0;
+	int64 LongitudeOffset = 0;
+	{
+		FMessageReader BlockReader( BlockData );
+		while( BlockReader.ReadKey( FieldNumber, WireType ) )
+		{
+			if( FieldNumber == 1 && WireType == EWireType::LengthDelimited )
+			{
+				FMessageReader StringTableReader( BlockReader.ReadBytes() );
+				while( StringTableReader.ReadKey( FieldNumber, WireType ) )
+				{
+					if( FieldNumber == 1 && WireType == EWireType::LengthDelimited )
+					{
+						const TArrayView<const uint8> StringBytes = StringTableReader.ReadBytes();
+						const FUTF8ToTCHAR String( (const ANSICHAR*)StringBytes.GetData(), StringBytes.Num() );
+						StringTable.Add( FString( String.Length(), String.Get() ) );
+					}
+					else
+					{
+						StringTableReader.Skip( WireType );
+					}
+				}
+				BlockReader.bError |= StringTableReader.bError;
+			}
+			else if( FieldNumber == 2 && WireType == EWireType::LengthDelimited )
+			{
+				Groups.Add( BlockReader.ReadBytes() );
+			}
+			else if( FieldNumber == 17 && WireType == EWireType::Varint )
+			{
+				Granularity = int64( BlockReader.ReadVarint() );
+			}
+			else if( FieldNumber == 19 && WireType == EWireType::Varint )
+			{
+				LatitudeOffset = int64( BlockReader.ReadVarint() );
+			}
+			else if( FieldNumber == 20 && WireType == EWireType::Varint )
+			{
+				LongitudeOffset = int64( BlockReader.ReadVarint() );
+			}
+			else
+			{
+				BlockReader.Skip( WireType );
+			}
+		}
+
+		if( BlockReader.bError )
+		{
+			return false;
+		}
+	}
+
+	// Coordinates are stored in units of Granularity nanodegrees
+	auto ToDegrees = [Granularity]( const int64 Coordinate, const int64 Offset ) -> double
+	{
+		return 1e-9 * double( Offset + Granularity * Coordinate );
+	};
+
+	auto GetString = [&StringTable]( const int64 StringIndex ) -> const TCHAR*
+	{
+		return StringTable.IsValidIndex( StringIndex ) ? *StringTable[ StringIndex ] : TEXT( "" );
+	};
+
+	// Scratch space, reused for every node and way in the block
+	TArray<int64> Ids;
+	TArray<int64> Latitudes;
+	TArray<int64> Longitudes;
+	TArray<int64> Keys;
+	TArray<int64> Values;
+	TArray<int64> NodeRefs;
+
+	for( const TArrayView<const uint8> Group : Groups )
+	{
+		FMessageReader GroupReader( Group );
+		while( GroupReader.ReadKey( FieldNumber, WireType ) )
+		{
+			if( FieldNumber == 1 && WireType == EWireType::LengthDelimited )
+			{
+				// Plain node
+				FOSMNodeInfo* NodeInfo = new FOSMNodeInfo();
+				NodeInfo->Id = 0;
+				int64 Latitude = 0;
+				int64 Longitude = 0;
+
+				FMessageReader NodeReader( GroupReader.ReadBytes() );
+				while( NodeReader.ReadKey( FieldNumber, WireType ) )
+				{
+					if( FieldNumber == 1 && WireType == EWireType::Varint )
+					{
+						NodeInfo->Id = NodeReader.ReadSignedVarint();
+					}
+					else if( FieldNumber == 8 && WireType == EWireType::Varint )
+					{
+						Latitude = NodeReader.ReadSignedVarint();
+					}
+					else if( FieldNumber == 9 && WireType == EWireType::Varint )
+					{
+						Longitude = NodeReader.ReadSignedVarint();
+					}
+					else
+					{
+						NodeReader.Skip( WireType );
+					}
+				}
+
+				if( NodeReader.bError )
+				{
+					delete NodeInfo;
+					return false;
+				}
+
+				NodeInfo->Latitude = ToDegrees( Latitude, LatitudeOffset );
+				NodeInfo->Longitude = ToDegrees( Longitude, LongitudeOffset );
+				FinishNode( NodeInfo );
+			}
+			else if( FieldNumber == 2 && WireType == EWireType::LengthDelimited )
+			{
+				// Dense nodes, stored as delta coded columns
+				Ids.Reset();
+				Latitudes.Reset();
+				Longitudes.Reset();
+
+				FMessageReader DenseNodesReader( GroupReader.ReadBytes() );
+				while( DenseNodesReader.ReadKey( FieldNumber, WireType ) )
+				{
+					if( FieldNumber == 1 )
+					{
+						DenseNodesReader.ReadRepeatedVarints( WireType, /* bIsSigned */ true, Ids );
+					}
+					else if( FieldNumber == 8 )
+					{
+						DenseNodesReader.ReadRepeatedVarints( WireType, /* bIsSigned */ true, Latitudes );
+					}
+					else if( FieldNumber == 9 )
+					{
+						DenseNodesReader.ReadRepeatedVarints( WireType, /* bIsSigned */ true, Longitudes );
+					}
+					else
+					{
+						DenseNodesReader.Skip( WireType );
+					}
+				}
+
+				if( DenseNodesReader.bError || Ids.Num() != Latitudes.Num() || Ids.Num() != Longitudes.Num() )
+				{
+					return false;
+				}
+
+				int64 Id = 0;
+				int64 Latitude = 0;
+				int64 Longitude = 0;
+				for( int32 DenseNodeIndex = 0; DenseNodeIndex < Ids.Num(); ++DenseNodeIndex )
+				{
+					Id += Ids[ DenseNodeIndex ];
+					Latitude += Latitudes[ DenseNodeIndex ];
+					Longitude += Longitudes[ DenseNodeIndex ];
+
+					FOSMNodeInfo* NodeInfo = new FOSMNodeInfo();
+					NodeInfo->Id = Id;
+					NodeInfo->Latitude = ToDegrees( Latitude, LatitudeOffset );
+					NodeInfo->Longitude = ToDegrees( Longitude, LongitudeOffset );
+					FinishNode( NodeInfo );
+				}
+			}
+			else if( FieldNumber == 3 && WireType == EWireType::LengthDelimited )
+			{
+				// Way
+				Keys.Reset();
+				Values.Reset();
+				NodeRefs.Reset();
+
+				FOSMWayInfo* WayInfo = NewWayInfo();
+
+				FMessageReader WayReader( GroupReader.ReadBytes() );
+				while( WayReader.ReadKey( FieldNumber, WireType ) )
+				{
+					if( FieldNumber == 1 && WireType == EWireType::Varint )
+					{
+						WayInfo->Id = int64( WayReader.ReadVarint() );
+					}
+					else if( FieldNumber == 2 )
+					{
+						WayReader.ReadRepeatedVarints( WireType, /* bIsSigned */ false, Keys );
+					}
+					else if( FieldNumber == 3 )
+					{
+						WayReader.ReadRepeatedVarints( WireType, /* bIsSigned */ false, Values );
+					}
+					else if( FieldNumber == 8 )
+					{
+						WayReader.ReadRepeatedVarints( WireType, /* bIsSigned */ true, NodeRefs );
+					}
+					else
+					{
+						WayReader.Skip( WireType );
+					}
+				}
+
+				if( WayReader.bError || Keys.Num() != Values.Num() )
+				{
+					delete WayInfo;
+					return false;
+				}
+
+				for( int32 TagIndex = 0; TagIndex < Keys.Num(); ++TagIndex )
+				{
+					ApplyWayTag( *WayInfo, GetString( Keys[ TagIndex ] ), GetString( Values[ TagIndex ] ) );
+				}
+
+				// Node references are delta coded too
+				int64 NodeId = 0;
+				for( const int64 NodeRef : NodeRefs )
+				{
+					NodeId += NodeRef;
+
+					// Nodes can be missing from the file, or filtered out by region.  Ways just skip them.
+					FOSMNodeInfo* ReferencedNode = NodeMap.FindRef( NodeId );
+					if( ReferencedNode != nullptr )
+					{
+						WayInfo->Nodes.Add( ReferencedNode );
+					}
+				}
+
+				FinishWay( WayInfo );
+			}
+			else
+			{
+				// Relations and changesets aren't used
+				GroupReader.Skip( WireType );
+			}
+		}
+
+		if( GroupReader.bError )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
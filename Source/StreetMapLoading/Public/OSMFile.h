@@ -1,8 +1,8 @@
 #pragma once
 #include "FastXml.h"
 
-/** OpenStreetMap file loader */
-class FOSMFile : public IFastXmlCallback
+/** OpenStreetMap file loader.  Loads OpenStreetMap XML (.osm) and Protocolbuffer Binary Format (.pbf) files. */
+class STREETMAPLOADING_API FOSMFile : public IFastXmlCallback
 {
 	
 public:
@@ -16,6 +16,16 @@ public:
 	/** Loads the map from an OpenStreetMap XML file.  Note that in the case of the file path containing the XML data, the string must be mutable for us to parse it quickly. */
 	bool LoadOpenStreetMapFile( FString& OSMFilePath, const bool bIsFilePathActuallyTextBuffer, class FFeedbackContext* FeedbackContext );
 
+	/** Loads the map from an OpenStreetMap PBF file.  The file is read one block at a time, so only the nodes and ways that are kept stay in memory. */
+	bool LoadOpenStreetMapPbfFile( const FString& PbfFilePath, class FFeedbackContext* FeedbackContext );
+
+	/**
+	 * Only keeps nodes inside a latitude/longitude box, to bound memory use when loading a small region of a large file.
+	 * Ways only keep their nodes inside the box, and are dropped entirely if that leaves them with fewer than two.
+	 * Must be set before loading.
+	 */
+	void SetRegionFilter( const double InMinLatitude, const double InMinLongitude, const double InMaxLatitude, const double InMaxLongitude );
+
 
 	struct FOSMWayInfo;
 		
@@ -149,6 +159,7 @@ public:
 		
 	struct FOSMNodeInfo
 	{
+		int64 Id;
 		double Latitude;
 		double Longitude;
 		TArray<FOSMWayRef> WayRefs;
@@ -157,6 +168,7 @@ public:
 		
 	struct FOSMWayInfo
 	{
+		int64 Id;
 		FString Name;
 		FString Ref;
 		TArray<FOSMNodeInfo*> Nodes;
@@ -193,6 +205,21 @@ protected:
 	virtual bool ProcessAttribute( const TCHAR* AttributeName, const TCHAR* AttributeValue ) override;
 	virtual bool ProcessClose( const TCHAR* Element ) override;
 
+	/** Adds a fully parsed node, unless it falls outside the region filter or the node was already added.  Takes ownership of the node. */
+	void FinishNode( FOSMNodeInfo* NodeInfo );
+
+	/** Adds a fully parsed way, unless none of its nodes were kept or it's of a type we never use.  Takes ownership of the way. */
+	void FinishWay( FOSMWayInfo* WayInfo );
+
+	/** Applies an OpenStreetMap tag (key and value) to a way */
+	void ApplyWayTag( FOSMWayInfo& WayInfo, const TCHAR* Key, const TCHAR* Value );
+
+	/** Makes a new way with default values */
+	static FOSMWayInfo* NewWayInfo();
+
+	/** Loads the nodes and ways from an uncompressed PBF primitive block */
+	bool LoadPbfPrimitiveBlock( TArrayView<const uint8> BlockData );
+
 	
 protected:
 	
@@ -219,6 +246,13 @@ protected:
 		
 	// Current way's tag key string
 	const TCHAR* CurrentWayTagKey;
+
+	// Optional latitude/longitude box that nodes must be inside of to be kept
+	bool bHasRegionFilter = false;
+	double RegionMinLatitude = -90.0;
+	double RegionMinLongitude = -180.0;
+	double RegionMaxLatitude = 90.0;
+	double RegionMaxLongitude = 180.0;
 };
 
 
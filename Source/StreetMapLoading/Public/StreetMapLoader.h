@@ -0,0 +1,100 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "StreetMapLoader.generated.h"
+
+class UStreetMap;
+class UStreetMapComponent;
+
+/** Options for loading street maps from OpenStreetMap files at runtime */
+USTRUCT(BlueprintType)
+struct STREETMAPLOADING_API FStreetMapLoadSettings
+{
+	GENERATED_BODY()
+
+	/** If true, only nodes inside the latitude/longitude box below are kept.  Bounds memory use when loading part of a large file. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "StreetMap")
+	bool bFilterRegion = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "StreetMap", meta = (EditCondition = "bFilterRegion", ClampMin = "-90", ClampMax = "90"))
+	double MinLatitude = -90.0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "StreetMap", meta = (EditCondition = "bFilterRegion", ClampMin = "-180", ClampMax = "180"))
+	double MinLongitude = -180.0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "StreetMap", meta = (EditCondition = "bFilterRegion", ClampMin = "-90", ClampMax = "90"))
+	double MaxLatitude = 90.0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "StreetMap", meta = (EditCondition = "bFilterRegion", ClampMin = "-180", ClampMax = "180"))
+	double MaxLongitude = 180.0;
+
+	/** If true, the map's derived data (building triangles and road graph) is built on the loading thread too, instead of on first use */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "StreetMap")
+	bool bBuildDerivedData = true;
+};
+
+/** Called on the game thread when a street map has loaded.  The street map is null if loading failed. */
+DECLARE_DELEGATE_OneParam(FOnStreetMapLoaded, UStreetMap* /* StreetMap */);
+
+/** Loads street maps from OpenStreetMap files (.osm or .pbf) on local disk, at runtime */
+class STREETMAPLOADING_API FStreetMapLoader
+{
+public:
+	/**
+	 * Starts loading a street map.  The file is read and turned into a new transient street map on a background thread,
+	 * then OnLoaded is called on the game thread.  Must be called on the game thread.
+	 *
+	 * @param FilePath Path of an OpenStreetMap XML (.osm) or PBF (.pbf) file
+	 * @param Settings Loading options
+	 * @param OnLoaded Called with the loaded street map, or null if loading failed
+	 */
+	static void LoadAsync(const FString& FilePath, const FStreetMapLoadSettings& Settings, FOnStreetMapLoaded OnLoaded);
+
+private:
+	/** Reads a file into a street map.  Runs on the loading thread. */
+	static bool LoadStreetMapFile(const FString& FilePath, const FStreetMapLoadSettings& Settings, UStreetMap& StreetMap);
+};
+
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FStreetMapLoadAsyncActionEvent, UStreetMap*, StreetMap);
+
+/** Blueprint node that loads a street map from an OpenStreetMap file at runtime, and optionally hands it to a component */
+UCLASS()
+class STREETMAPLOADING_API UStreetMapLoadAsyncAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Loads a street map from an OpenStreetMap file (.osm or .pbf) on local disk, without blocking the game thread.
+	 * @param FilePath Path of the file to load
+	 * @param Settings Loading options
+	 * @param Component Optional component that is given the loaded street map, and builds its mesh
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap", meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"))
+	static UStreetMapLoadAsyncAction* LoadStreetMapFromFile(UObject* WorldContextObject, const FString& FilePath, const FStreetMapLoadSettings& Settings, UStreetMapComponent* Component);
+
+	/** Called when the street map has loaded */
+	UPROPERTY(BlueprintAssignable)
+	FStreetMapLoadAsyncActionEvent OnLoaded;
+
+	/** Called when the file couldn't be loaded */
+	UPROPERTY(BlueprintAssignable)
+	FStreetMapLoadAsyncActionEvent OnFailed;
+
+	// UBlueprintAsyncActionBase interface
+	virtual void Activate() override;
+
+private:
+	void HandleLoaded(UStreetMap* StreetMap);
+
+	FString FilePath;
+
+	FStreetMapLoadSettings Settings;
+
+	UPROPERTY()
+	TWeakObjectPtr<UStreetMapComponent> Component;
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class FOSMFile;
+class UStreetMap;
+
+/** Turns loaded OpenStreetMap data into street map roads, nodes and buildings */
+class STREETMAPLOADING_API FStreetMapOSMConverter
+{
+
+public:
+
+	/**
+	 * Fills a street map with the roads, nodes and buildings from a loaded OpenStreetMap file, replacing whatever it
+	 * had before.  This can run on any thread, as long as nothing else is using the street map yet.
+	 *
+	 * @param	OSMFile		The loaded OpenStreetMap file
+	 * @param	StreetMap	The street map to fill in
+	 */
+	static void Convert( const FOSMFile& OSMFile, UStreetMap& StreetMap );
+};
@@ -0,0 +1,111 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapLoader.h"
+#include "OSMFile.h"
+#include "StreetMapOSMConverter.h"
+#include "StreetMap.h"
+#include "StreetMapComponent.h"
+#include "Async/Async.h"
+#include "Misc/FeedbackContext.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+void FStreetMapLoader::LoadAsync(const FString& FilePath, const FStreetMapLoadSettings& Settings, FOnStreetMapLoaded OnLoaded)
+{
+	check(IsInGameThread());
+
+	// The street map is made here and only filled in on the loading thread.  Nothing else can see it until it's handed
+	// to OnLoaded, and it stays rooted until then so it can't be garbage collected.
+	UPackage* TransientPackage = GetTransientPackage();
+	const FName StreetMapName = MakeUniqueObjectName(TransientPackage, UStreetMap::StaticClass(), FName(*FPaths::GetBaseFilename(FilePath)));
+	UStreetMap* StreetMap = NewObject<UStreetMap>(TransientPackage, StreetMapName, RF_Transient);
+	StreetMap->AddToRoot();
+
+	Async(EAsyncExecution::ThreadPool, [FilePath, Settings, StreetMap, OnLoaded = MoveTemp(OnLoaded)]() mutable
+	{
+		const bool bLoaded = LoadStreetMapFile(FilePath, Settings, *StreetMap);
+
+		AsyncTask(ENamedThreads::GameThread, [StreetMap, bLoaded, OnLoaded = MoveTemp(OnLoaded)]()
+		{
+			StreetMap->RemoveFromRoot();
+			if (!bLoaded)
+			{
+				StreetMap->MarkAsGarbage();
+			}
+
+			OnLoaded.ExecuteIfBound(bLoaded ? StreetMap : nullptr);
+		});
+	});
+}
+
+
+bool FStreetMapLoader::LoadStreetMapFile(const FString& FilePath, const FStreetMapLoadSettings& Settings, UStreetMap& StreetMap)
+{
+	FOSMFile OSMFile;
+	if (Settings.bFilterRegion)
+	{
+		OSMFile.SetRegionFilter(Settings.MinLatitude, Settings.MinLongitude, Settings.MaxLatitude, Settings.MaxLongitude);
+	}
+
+	bool bLoaded = false;
+	if (FPaths::GetExtension(FilePath).Equals(TEXT("pbf"), ESearchCase::IgnoreCase))
+	{
+		bLoaded = OSMFile.LoadOpenStreetMapPbfFile(FilePath, GWarn);
+	}
+	else
+	{
+		FString MutableFilePath = FilePath;
+		bLoaded = OSMFile.LoadOpenStreetMapFile(MutableFilePath, /* bIsFilePathActuallyTextBuffer */ false, GWarn);
+	}
+
+	if (!bLoaded)
+	{
+		return false;
+	}
+
+	FStreetMapOSMConverter::Convert(OSMFile, StreetMap);
+
+	if (Settings.bBuildDerivedData)
+	{
+		StreetMap.GetDerivedData();
+	}
+
+	return true;
+}
+
+
+UStreetMapLoadAsyncAction* UStreetMapLoadAsyncAction::LoadStreetMapFromFile(UObject* WorldContextObject, const FString& FilePath, const FStreetMapLoadSettings& Settings, UStreetMapComponent* Component)
+{
+	UStreetMapLoadAsyncAction* Action = NewObject<UStreetMapLoadAsyncAction>();
+	Action->FilePath = FilePath;
+	Action->Settings = Settings;
+	Action->Component = Component;
+	Action->RegisterWithGameInstance(WorldContextObject);
+	return Action;
+}
+
+
+void UStreetMapLoadAsyncAction::Activate()
+{
+	FStreetMapLoader::LoadAsync(FilePath, Settings, FOnStreetMapLoaded::CreateUObject(this, &UStreetMapLoadAsyncAction::HandleLoaded));
+}
+
+
+void UStreetMapLoadAsyncAction::HandleLoaded(UStreetMap* StreetMap)
+{
+	if (StreetMap != nullptr)
+	{
+		if (UStreetMapComponent* StreetMapComponent = Component.Get())
+		{
+			StreetMapComponent->SetStreetMap(StreetMap, /* bClearPreviousMeshIfAny */ true, /* bRebuildMesh */ true);
+		}
+
+		OnLoaded.Broadcast(StreetMap);
+	}
+	else
+	{
+		OnFailed.Broadcast(nullptr);
+	}
+
+	SetReadyToDestroy();
+}
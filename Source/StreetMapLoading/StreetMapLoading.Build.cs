@@ -0,0 +1,20 @@
+using UnrealBuildTool;
+
+public class StreetMapLoading : ModuleRules
+{
+	public StreetMapLoading(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"CoreUObject",
+				"Engine",
+				"XmlParser",
+				"StreetMapRuntime"
+			}
+		);
+	}
+}
@@ -0,0 +1,370 @@
+#include "StreetMapOSMConverter.h"
+#include "OSMFile.h"
+#include "StreetMap.h"
+#include "StreetMapMemory.h"
+#include "StreetMapStats.h"
+
+void FStreetMapOSMConverter::Convert( const FOSMFile& OSMFile, UStreetMap& StreetMap )
+{
+	LLM_SCOPE_BYTAG( StreetMap_Payload );
+	STREETMAP_SCOPE_CYCLE_COUNTER( STAT_StreetMap_ConvertOSMFile );
+
+	// Adds a road to the street map using the OpenStreetMap data, flattening the road's coordinates into our map's space
+	auto AddRoadForWay = []( 
+		UStreetMap& StreetMapRef, 
+		const FOSMFile::FOSMWayInfo& OSMWay, 
+		int32& OutRoadIndex ) -> bool
+	{
+		EStreetMapRoadType RoadType = EStreetMapRoadType::Other;
+		switch( OSMWay.WayType )
+		{
+			case FOSMFile::EOSMWayType::Motorway:
+			case FOSMFile::EOSMWayType::Motorway_Link:
+			case FOSMFile::EOSMWayType::Trunk:
+			case FOSMFile::EOSMWayType::Trunk_Link:
+			case FOSMFile::EOSMWayType::Primary:
+			case FOSMFile::EOSMWayType::Primary_Link:
+				RoadType = EStreetMapRoadType::Highway;
+				break;
+
+			case FOSMFile::EOSMWayType::Secondary:
+			case FOSMFile::EOSMWayType::Secondary_Link:
+			case FOSMFile::EOSMWayType::Tertiary:
+			case FOSMFile::EOSMWayType::Tertiary_Link:
+				RoadType = EStreetMapRoadType::MajorRoad;
+				break;
+
+			case FOSMFile::EOSMWayType::Residential:
+			case FOSMFile::EOSMWayType::Service:
+			case FOSMFile::EOSMWayType::Unclassified:
+			case FOSMFile::EOSMWayType::Road:	// @todo: Consider excluding "Road" from our data set, as it could be a highway that wasn't properly tagged in OSM yet
+				RoadType = EStreetMapRoadType::Street;
+				break;
+
+			default:
+				RoadType = EStreetMapRoadType::Other;
+		}
+
+		if( RoadType != EStreetMapRoadType::Other )
+		{
+			// Require at least two points!
+			if( OSMWay.Nodes.Num() > 1 )
+			{
+				// Create a road for this way
+				OutRoadIndex = StreetMapRef.Roads.Num();
+				FStreetMapRoad& NewRoad = *new( StreetMapRef.Roads )FStreetMapRoad();
+				StreetMapRef.RoadOsmIds.Add( OSMWay.Id );
+
+				FVector2D BoundsMin( TNumericLimits<double>::Max(), TNumericLimits<double>::Max() );
+				FVector2D BoundsMax( TNumericLimits<double>::Lowest(), TNumericLimits<double>::Lowest() );
+
+				NewRoad.RoadPoints.AddUninitialized( OSMWay.Nodes.Num() );
+				int32 CurRoadPoint = 0;
+
+				// Set defaults for each node index on this road.  INDEX_NONE means the node is not valid, which may be the case
+				// for nodes that we filter out entirely.  This will be filled in by valid indices to nodes later on.
+				NewRoad.NodeIndices.AddUninitialized( OSMWay.Nodes.Num() );
+				for( int32& NodeIndex : NewRoad.NodeIndices )
+				{
+					NodeIndex = INDEX_NONE;
+				}
+
+
+				for( const FOSMFile::FOSMNodeInfo* OSMNodePtr : OSMWay.Nodes )
+				{
+					const FOSMFile::FOSMNodeInfo& OSMNode = *OSMNodePtr;
+
+					// Points are projected relative to the center of the latitude/longitude bounds, so that
+					// we get as much precision as possible.
+					const FVector2D NodePos = StreetMapRef.GeoReference.GeoToMap( OSMNode.Latitude, OSMNode.Longitude );
+
+					// Update bounding box
+					{
+						if( NodePos.X < BoundsMin.X )
+						{
+							BoundsMin.X = NodePos.X;
+						}
+						if( NodePos.Y < BoundsMin.Y )
+						{
+							BoundsMin.Y = NodePos.Y;
+						}
+						if( NodePos.X > BoundsMax.X )
+						{
+							BoundsMax.X = NodePos.X;
+						}
+						if( NodePos.Y > BoundsMax.Y )
+						{
+							BoundsMax.Y = NodePos.Y;
+						}
+					}
+
+					// Fill in the points
+					NewRoad.RoadPoints[ CurRoadPoint++ ] = NodePos;
+				}
+
+
+				NewRoad.NameId = StreetMapRef.InternName( OSMWay.Name.IsEmpty() ? OSMWay.Ref : OSMWay.Name );
+				NewRoad.RoadType = RoadType;
+				NewRoad.BoundsMin = BoundsMin;
+				NewRoad.BoundsMax = BoundsMax;
+
+				NewRoad.bIsOneWay = OSMWay.bIsOneWay;
+
+				StreetMapRef.BoundsMin.X = FMath::Min( StreetMapRef.BoundsMin.X, BoundsMin.X );
+				StreetMapRef.BoundsMin.Y = FMath::Min( StreetMapRef.BoundsMin.Y, BoundsMin.Y );
+				StreetMapRef.BoundsMax.X = FMath::Max( StreetMapRef.BoundsMax.X, BoundsMax.X );
+				StreetMapRef.BoundsMax.Y = FMath::Max( StreetMapRef.BoundsMax.Y, BoundsMax.Y );
+
+				return true;
+			}
+			else
+			{
+				// NOTE: Skipped adding road for way because it has less than 2 points
+				// @todo: Log this for the user as an import warning
+			}
+		}
+
+		return false;
+	};
+
+
+	// Adds a building to the street map using the OpenStreetMap data, flattening the road's coordinates into our map's space
+	auto AddBuildingForWay = []( 
+		UStreetMap& StreetMapRef, 
+		const FOSMFile::FOSMWayInfo& OSMWay ) -> bool
+	{
+		if( OSMWay.WayType == FOSMFile::EOSMWayType::Building )
+		{
+			// Require at least three points so that we don't have degenerate polygon!
+			if( OSMWay.Nodes.Num() > 2 )
+			{
+				// Create a building for this way
+				FStreetMapBuilding& NewBuilding = *new( StreetMapRef.Buildings )FStreetMapBuilding();
+				StreetMapRef.BuildingOsmIds.Add( OSMWay.Id );
+
+				FVector2D BoundsMin( TNumericLimits<double>::Max(), TNumericLimits<double>::Max() );
+				FVector2D BoundsMax( TNumericLimits<double>::Lowest(), TNumericLimits<double>::Lowest() );
+
+				NewBuilding.BuildingPoints.AddUninitialized( OSMWay.Nodes.Num() );
+				int32 CurBuildingPoint = 0;
+
+				for( const FOSMFile::FOSMNodeInfo* OSMNodePtr : OSMWay.Nodes )
+				{
+					const FOSMFile::FOSMNodeInfo& OSMNode = *OSMNodePtr;
+
+					// Points are projected relative to the center of the latitude/longitude bounds, so that
+					// we get as much precision as possible.
+					const FVector2D NodePos = StreetMapRef.GeoReference.GeoToMap( OSMNode.Latitude, OSMNode.Longitude );
+
+					// Update bounding box
+					{
+						if( NodePos.X < BoundsMin.X )
+						{
+							BoundsMin.X = NodePos.X;
+						}
+						if( NodePos.Y < BoundsMin.Y )
+						{
+							BoundsMin.Y = NodePos.Y;
+						}
+						if( NodePos.X > BoundsMax.X )
+						{
+							BoundsMax.X = NodePos.X;
+						}
+						if( NodePos.Y > BoundsMax.Y )
+						{
+							BoundsMax.Y = NodePos.Y;
+						}
+					}
+
+					// Fill in the points
+					NewBuilding.BuildingPoints[ CurBuildingPoint++ ] = NodePos;
+				}
+
+				// Make sure the building ended up with a closed polygon, then remove the final (redundant) point
+				const bool bIsClosed = NewBuilding.BuildingPoints[ 0 ].Equals( NewBuilding.BuildingPoints[ NewBuilding.BuildingPoints.Num() - 1 ], KINDA_SMALL_NUMBER );
+				if( bIsClosed )
+				{
+					// Remove the final redundant point
+					NewBuilding.BuildingPoints.Pop();
+				}
+				else
+				{
+					// Wasn't expecting to have an unclosed shape.  Our tolerances might be off, or the data was malformed.
+					// Either way, it shouldn't be a problem as we'll close the shape ourselves below.
+					// @todo: Log this for the user as an import warning
+				}
+
+				NewBuilding.NameId = StreetMapRef.InternName( OSMWay.Name.IsEmpty() ? OSMWay.Ref : OSMWay.Name );
+
+				NewBuilding.Height = OSMWay.Height * StreetMapRef.GeoReference.UnitsPerMeter;
+				NewBuilding.BuildingLevels = OSMWay.BuildingLevels;
+
+				NewBuilding.BoundsMin = BoundsMin;
+				NewBuilding.BoundsMax = BoundsMax;
+
+				StreetMapRef.BoundsMin.X = FMath::Min( StreetMapRef.BoundsMin.X, BoundsMin.X );
+				StreetMapRef.BoundsMin.Y = FMath::Min( StreetMapRef.BoundsMin.Y, BoundsMin.Y );
+				StreetMapRef.BoundsMax.X = FMath::Max( StreetMapRef.BoundsMax.X, BoundsMax.X );
+				StreetMapRef.BoundsMax.Y = FMath::Max( StreetMapRef.BoundsMax.Y, BoundsMax.Y );
+
+				return true;
+			}
+			else
+			{
+				// NOTE: Skipped adding building for way because it has less than 3 points
+				// @todo: Log this for the user as an import warning
+			}
+		}
+
+		return false;
+	};
+
+
+	// Map space is centered on the middle of the loaded data.  Every point is projected through the geo reference, so
+	// runtime conversions agree exactly with the imported data.
+	// OSM data is stored in meters.  Keep in mind that if the scale to map units (cm) is changed, UStreetMapComponent
+	// sizes for roads may need to be updated too!
+	// @todo: We should make this scale factor customizable as an import option
+	StreetMap.GeoReference = FStreetMapGeoReference();
+	StreetMap.GeoReference.OriginLatitude = OSMFile.AverageLatitude;
+	StreetMap.GeoReference.OriginLongitude = OSMFile.AverageLongitude;
+	StreetMap.GeoReference.MetersPerDegree = FStreetMapGeoReference::DefaultMetersPerDegree;
+	StreetMap.GeoReference.UnitsPerMeter = 100.0;
+	StreetMap.GeoReference.bIsValid = true;
+
+	// Start over from an empty map.  Nothing is copied out of the published snapshot, which readers keep seeing until
+	// the new data is published below.
+	StreetMap.MakeDataEditable( /* bKeepPublishedData */ false );
+	StreetMap.ResetData();
+
+	// NOTE: The loaded OSMFile stores data in double precision, and so does our runtime representation (UStreetMap),
+	//       after transposing coordinates to be relative to the center of the map's 2D bounds.  Every feature is also
+	//       anchored to an integral grid cell with a double precision origin (see UStreetMap::RebuildCells()), which is
+	//       how maps are split into tiles.  The generated mesh is single precision, relative to the origin of the cell
+	//       at the center of the map, so it loses accuracy far from the center.  Huge maps should be split into tiles,
+	//       since each tile's mesh is relative to its own cell.
+
+	// Maps OSMWayInfos to the RoadIndex we created for that way
+	TMap< const FOSMFile::FOSMWayInfo*, int32 > OSMWayToRoadIndexMap;
+
+	StreetMap.BoundsMin = FVector2D( TNumericLimits<double>::Max(), TNumericLimits<double>::Max() );
+	StreetMap.BoundsMax = FVector2D( TNumericLimits<double>::Lowest(), TNumericLimits<double>::Lowest() );
+
+	for( const FOSMFile::FOSMWayInfo* OSMWay : OSMFile.Ways )
+	{
+		// Handle buildings differently than roads
+		if( OSMWay->WayType == FOSMFile::EOSMWayType::Building )
+		{
+			if( AddBuildingForWay( StreetMap, *OSMWay ) )
+			{
+				// ...
+			}
+		}
+		else
+		{
+			int32 RoadIndex = INDEX_NONE;
+			if( AddRoadForWay( StreetMap, *OSMWay, RoadIndex ) )
+			{
+				OSMWayToRoadIndexMap.Add( OSMWay, RoadIndex );
+			}
+		}
+	}
+
+	for( const auto& NodeMapHashPair : OSMFile.NodeMap )
+	{
+		const FOSMFile::FOSMNodeInfo& OSMNode = *NodeMapHashPair.Value;
+
+		// Any ways touching this node?
+		if( OSMNode.WayRefs.Num() > 0 )
+		{
+			TArray<FStreetMapRoadRef, TInlineAllocator<4>> NewNodeRoadRefs;
+
+			for( const FOSMFile::FOSMWayRef& OSMWayRef : OSMNode.WayRefs )
+			{
+				const int32* FoundRoundIndexPtr = OSMWayToRoadIndexMap.Find( OSMWayRef.Way );
+				if( FoundRoundIndexPtr != nullptr )
+				{
+					const int32 FoundRoadIndex = *FoundRoundIndexPtr;
+
+					FStreetMapRoadRef RoadRef;
+					RoadRef.RoadIndex = FoundRoadIndex;
+
+					const int32 RoadPointIndex = OSMWayRef.NodeIndex;
+					RoadRef.RoadPointIndex = RoadPointIndex;
+					NewNodeRoadRefs.Add( RoadRef );
+				}
+				else
+				{
+					// Skipped ref because we didn't keep this road in our data set							
+				}
+			}
+
+			// Only store nodes that are attached to at least one road.  We must have at least a connection to a single
+			// road, otherwise we've filtered this node's road out and there's no point in wasting memory on the node itself.
+			if( NewNodeRoadRefs.Num() > 0 )
+			{
+				// Most nodes from OpenStreetMap will only be touching a single road.  These nodes usually make up the points
+				// along the length of the road, even for roads with no intersections except at the beginning and end.  We
+				// don't need to store these points unless they are at the ends of the road.  Keeping the points at the
+				// beginning and end of the road is useful when calculating navigation data, but the other nodes can go!
+				// In the road's NodeIndices array, any nodes we filter out here will simply have an INDEX_NONE value in that
+				// array, and we'll only store the positions of the road at these points in the road's RoadPoints array.
+
+				const FStreetMapRoadRef& FirstRoadRef = NewNodeRoadRefs[ 0 ];
+				const FStreetMapRoad& FirstRoad = StreetMap.Roads[ FirstRoadRef.RoadIndex ];
+
+				if( NewNodeRoadRefs.Num() > 1 ||					// Does the node connect to more than one road?
+					FirstRoadRef.RoadPointIndex == 0 ||				// Does the node connect to the beginning of the road?
+					FirstRoadRef.RoadPointIndex == ( FirstRoad.NodeIndices.Num() - 1 ) )	// Does the node connect to the end of the road?
+				{
+					// The node's road refs go at the end of the street map's shared road ref list
+					FStreetMapNode NewNode;
+					NewNode.Location = FirstRoad.RoadPoints[ FirstRoadRef.RoadPointIndex ];
+					NewNode.FirstRoadRef = StreetMap.NodeRoadRefs.Num();
+					NewNode.NumRoadRefs = NewNodeRoadRefs.Num();
+					StreetMap.NodeRoadRefs.Append( NewNodeRoadRefs );
+
+					const int32 NewNodeIndex = StreetMap.Nodes.Num();
+					StreetMap.Nodes.Add( NewNode );
+					StreetMap.NodeOsmIds.Add( NodeMapHashPair.Key );
+
+					// Update the roads that are overlapping this node
+					for( const FStreetMapRoadRef& RoadRef : NewNodeRoadRefs )
+					{
+						FStreetMapRoad& Road = StreetMap.Roads[ RoadRef.RoadIndex ];
+						check( Road.NodeIndices[ RoadRef.RoadPointIndex ] == INDEX_NONE );
+						Road.NodeIndices[ RoadRef.RoadPointIndex ] = NewNodeIndex;
+					}
+				}
+				else
+				{
+					// Node has only one road that is references, and it wasn't the beginning or end of the road, so filter it out!
+				}
+			}
+			else
+			{
+				// Node doesn't reference any roads that we kept, or the data was malformed.  Filter it out.
+			}
+		}
+	}
+
+	// Validation test: Make sure that all roads have at least two nodes referencing them, one at the beginning and
+	// one at the end.
+	for( const FStreetMapRoad& Road : StreetMap.Roads )
+	{
+		const bool bHasNodeAtBeginning = Road.NodeIndices[ 0 ] != INDEX_NONE;
+		const bool bHasNodeAtEnd = Road.NodeIndices[ Road.NodeIndices.Num() - 1 ] != INDEX_NONE;
+
+		// All roads should have at least two nodes referencing them, one at the beginning and one at the end
+		ensure( bHasNodeAtBeginning && bHasNodeAtEnd );
+	}
+
+	// Anchor every road and building to a grid cell
+	StreetMap.CellSize = UStreetMap::DefaultCellSize;
+	StreetMap.RebuildCells();
+
+	// The new data moves into a snapshot.  Readers that grabbed one before a reimport keep their old copy, everyone else
+	// sees the new data.  This can run on a loading thread, so it's published right away rather than at the end of the
+	// frame.
+	StreetMap.PublishSnapshot();
+}
@@ -0,0 +1,88 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "OSMFile.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOSMFileDuplicateNodeTest, "StreetMap.Loading.OSMFile.DuplicateNode", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FOSMFileDuplicateNodeTest::RunTest(const FString& Parameters)
+{
+	// Node 1 is listed again after a way already points at it
+	FString Xml = TEXT(
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<osm version=\"0.6\">\n"
+		"  <node id=\"1\" lat=\"10.0\" lon=\"20.0\"/>\n"
+		"  <node id=\"2\" lat=\"10.2\" lon=\"20.2\"/>\n"
+		"  <way id=\"100\">\n"
+		"    <nd ref=\"1\"/>\n"
+		"    <nd ref=\"2\"/>\n"
+		"    <tag k=\"highway\" v=\"residential\"/>\n"
+		"  </way>\n"
+		"  <node id=\"1\" lat=\"50.0\" lon=\"60.0\"/>\n"
+		"</osm>\n");
+
+	FOSMFile OSMFile;
+	if (!TestTrue(TEXT("File loads"), OSMFile.LoadOpenStreetMapFile(Xml, /* bIsFilePathActuallyTextBuffer */ true, nullptr)))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("Node count"), OSMFile.NodeMap.Num(), 2);
+	if (!TestEqual(TEXT("Way count"), OSMFile.Ways.Num(), 1))
+	{
+		return false;
+	}
+
+	const FOSMFile::FOSMNodeInfo* Node = OSMFile.NodeMap.FindRef(1);
+	if (!TestNotNull(TEXT("Node 1"), Node))
+	{
+		return false;
+	}
+
+	// The way still points at the node in the map, which kept its first location and its way ref
+	TestTrue(TEXT("Way points at the kept node"), OSMFile.Ways[0]->Nodes[0] == Node);
+	TestEqual(TEXT("Node 1 latitude"), Node->Latitude, 10.0);
+	TestEqual(TEXT("Node 1 longitude"), Node->Longitude, 20.0);
+	TestEqual(TEXT("Node 1 way refs"), Node->WayRefs.Num(), 1);
+
+	// The duplicate doesn't pull the bounds or the average location
+	TestEqual(TEXT("Average latitude"), OSMFile.AverageLatitude, 10.1, 1e-9);
+	TestEqual(TEXT("Average longitude"), OSMFile.AverageLongitude, 20.1, 1e-9);
+	TestEqual(TEXT("Max latitude"), OSMFile.MaxLatitude, 10.2);
+	TestEqual(TEXT("Max longitude"), OSMFile.MaxLongitude, 20.2);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOSMFileTruncatedPbfTest, "StreetMap.Loading.OSMFile.TruncatedPbf", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FOSMFileTruncatedPbfTest::RunTest(const FString& Parameters)
+{
+	// One blob header, for an "OSMHeader" blob of 1000 bytes that the file ends before
+	const uint8 PbfBytes[] =
+	{
+		0x00, 0x00, 0x00, 0x0E,							// Blob header size, big endian
+		0x0A, 0x09, 'O', 'S', 'M', 'H', 'e', 'a', 'd', 'e', 'r',	// Field 1 (type)
+		0x18, 0xE8, 0x07,								// Field 3 (datasize) = 1000
+	};
+
+	const FString PbfFilePath = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("TruncatedPbfTest.osm.pbf"));
+	if (!TestTrue(TEXT("Test file saved"), FFileHelper::SaveArrayToFile(TArrayView<const uint8>(PbfBytes, UE_ARRAY_COUNT(PbfBytes)), *PbfFilePath)))
+	{
+		return false;
+	}
+
+	FOSMFile OSMFile;
+	TestFalse(TEXT("Truncated file fails to load"), OSMFile.LoadOpenStreetMapPbfFile(PbfFilePath, nullptr));
+
+	IFileManager::Get().Delete(*PbfFilePath);
+	return true;
+}
+
+#endif	// WITH_DEV_AUTOMATION_TESTS
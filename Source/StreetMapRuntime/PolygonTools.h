@@ -16,6 +16,15 @@ public:
 	/** Given a 2D polygon and a point, determines whether the point is inside the polygon.  Supports convex polygons.  If the point is exactly on the polygon boundary, the return value could be either false or true. */
 	static inline bool IsPointInsidePolygon( const TArray<FVector2D>& Polygon, const FVector2D Point );
 
+	/** Determines if any part of a 2D polygon (its inside or its edges) is within the specified circle */
+	static inline bool DoesPolygonIntersectCircle( const TArray<FVector2D>& Polygon, const FVector2D Center, const double Radius );
+
+	/** Determines if any part of a 2D polygon (its inside or its edges) is within the specified box */
+	static inline bool DoesPolygonIntersectBox( const TArray<FVector2D>& Polygon, const FBox2D& Box );
+
+	/** Computes the squared distance from a point to the nearest part of a 2D polygon, which is zero if the point is inside it */
+	static inline double DistanceSquaredToPolygon( const TArray<FVector2D>& Polygon, const FVector2D Point );
+
 
 private:
 
@@ -76,6 +85,98 @@ bool FPolygonTools::IsPointInsidePolygon( const TArray<FVector2D>& Polygon, cons
 }
 
 
+bool FPolygonTools::DoesPolygonIntersectCircle( const TArray<FVector2D>& Polygon, const FVector2D Center, const double Radius )
+{
+	// Either the circle's center is inside the polygon, or one of the polygon's edges passes through the circle
+	if( IsPointInsidePolygon( Polygon, Center ) )
+	{
+		return true;
+	}
+
+	const double RadiusSquared = Radius * Radius;
+	const int32 NumCorners = Polygon.Num();
+	for( int32 CornerIndex = 0, PreviousCornerIndex = NumCorners - 1; CornerIndex < NumCorners; PreviousCornerIndex = CornerIndex++ )
+	{
+		const FVector2D EdgeStart = Polygon[ PreviousCornerIndex ];
+		const FVector2D Edge = Polygon[ CornerIndex ] - EdgeStart;
+		const double EdgeLengthSquared = Edge.SizeSquared();
+		const double Alpha = EdgeLengthSquared > 0.0 ? FMath::Clamp( ( ( Center - EdgeStart ) | Edge ) / EdgeLengthSquared, 0.0, 1.0 ) : 0.0;
+		if( FVector2D::DistSquared( Center, EdgeStart + Edge * Alpha ) <= RadiusSquared )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+bool FPolygonTools::DoesPolygonIntersectBox( const TArray<FVector2D>& Polygon, const FBox2D& Box )
+{
+	// Either the box's center is inside the polygon (then the polygon covers part of the box), or one of the polygon's
+	// edges passes through the box.  That covers polygons entirely inside the box too, since their edges are.
+	if( IsPointInsidePolygon( Polygon, Box.GetCenter() ) )
+	{
+		return true;
+	}
+
+	const int32 NumCorners = Polygon.Num();
+	for( int32 CornerIndex = 0, PreviousCornerIndex = NumCorners - 1; CornerIndex < NumCorners; PreviousCornerIndex = CornerIndex++ )
+	{
+		// Clip the edge against the box, one axis at a time (Liang-Barsky)
+		const FVector2D EdgeStart = Polygon[ PreviousCornerIndex ];
+		const FVector2D Edge = Polygon[ CornerIndex ] - EdgeStart;
+		double EnterAlpha = 0.0;
+		double ExitAlpha = 1.0;
+		for( int32 Axis = 0; Axis < 2 && EnterAlpha <= ExitAlpha; ++Axis )
+		{
+			if( FMath::IsNearlyZero( Edge[ Axis ] ) )
+			{
+				if( EdgeStart[ Axis ] < Box.Min[ Axis ] || EdgeStart[ Axis ] > Box.Max[ Axis ] )
+				{
+					ExitAlpha = -1.0;
+				}
+			}
+			else
+			{
+				const double AlphaA = ( Box.Min[ Axis ] - EdgeStart[ Axis ] ) / Edge[ Axis ];
+				const double AlphaB = ( Box.Max[ Axis ] - EdgeStart[ Axis ] ) / Edge[ Axis ];
+				EnterAlpha = FMath::Max( EnterAlpha, FMath::Min( AlphaA, AlphaB ) );
+				ExitAlpha = FMath::Min( ExitAlpha, FMath::Max( AlphaA, AlphaB ) );
+			}
+		}
+		if( EnterAlpha <= ExitAlpha )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+double FPolygonTools::DistanceSquaredToPolygon( const TArray<FVector2D>& Polygon, const FVector2D Point )
+{
+	if( IsPointInsidePolygon( Polygon, Point ) )
+	{
+		return 0.0;
+	}
+
+	double BestDistanceSquared = MAX_dbl;
+	const int32 NumCorners = Polygon.Num();
+	for( int32 CornerIndex = 0, PreviousCornerIndex = NumCorners - 1; CornerIndex < NumCorners; PreviousCornerIndex = CornerIndex++ )
+	{
+		const FVector2D EdgeStart = Polygon[ PreviousCornerIndex ];
+		const FVector2D Edge = Polygon[ CornerIndex ] - EdgeStart;
+		const double EdgeLengthSquared = Edge.SizeSquared();
+		const double Alpha = EdgeLengthSquared > 0.0 ? FMath::Clamp( ( ( Point - EdgeStart ) | Edge ) / EdgeLengthSquared, 0.0, 1.0 ) : 0.0;
+		BestDistanceSquared = FMath::Min( BestDistanceSquared, FVector2D::DistSquared( Point, EdgeStart + Edge * Alpha ) );
+	}
+
+	return BestDistanceSquared;
+}
+
+
 bool FPolygonTools::Snip( const TArray<FVector2D>& Polygon, const int32 U, const int32 V, const int32 W, const int32 PointCount, const int32* VertexIndices )
 {
 	const FVector2D A = Polygon[ VertexIndices[ U ] ];
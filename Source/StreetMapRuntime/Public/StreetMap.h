@@ -1,5 +1,9 @@
 #pragma once
 #include "Math/MathFwd.h"
+#include "HAL/CriticalSection.h"
+#include "Containers/ArrayView.h"
+#include <atomic>
+#include "StreetMapGeoReference.h"
 #include "StreetMap.generated.h"
 
 USTRUCT(BlueprintType)
@@ -111,10 +115,28 @@ public:
 		BuildingBorderZ(10.0f)
 	{
 	}
+
+	/** Adds every setting to a hash, so that meshes kept in the derived data cache are rebuilt when settings change */
+	void UpdateHash(class FSHA1& Hash) const;
 };
 
 
 
+/** How road and building names are stored in cooked street map data */
+UENUM( BlueprintType )
+enum class EStreetMapNameCookMode : uint8
+{
+	/** Names are cooked as they are */
+	Keep,
+
+	/** The name table is compressed in cooked data, and decompressed on load */
+	Compress,
+
+	/** Names are stripped from cooked data.  Name IDs are kept, so features that share a name still compare equal. */
+	Strip,
+};
+
+
 /** Types of roads */
 UENUM( BlueprintType )
 enum EStreetMapRoadType
@@ -133,15 +155,41 @@ enum EStreetMapRoadType
 };
 
 
+/** A cell in the street map's spatial grid.  Each cell anchors a double precision origin, so that geometry near the cell can
+    be narrowed to single precision relative to that origin without losing accuracy, no matter how far the cell is from the
+    center of the map. */
+USTRUCT( BlueprintType )
+struct STREETMAPRUNTIME_API FStreetMapCell
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Integer coordinate of this cell in the map's grid */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	FIntPoint Coordinate = FIntPoint::ZeroValue;
+
+	/** Double precision origin (minimum corner) of this cell, in map space */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	FVector2D Origin = FVector2D::ZeroVector;
+
+	/** Number of roads anchored to this cell */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	int32 RoadCount = 0;
+
+	/** Number of buildings anchored to this cell */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	int32 BuildingCount = 0;
+};
+
+
 /** A road */
 USTRUCT( BlueprintType )
 struct STREETMAPRUNTIME_API FStreetMapRoad
 {
 	GENERATED_USTRUCT_BODY()
 
-	/** Name of the road */
+	/** Name of the road, as an ID in the street map's name table (INDEX_NONE if the road has no name) */
 	UPROPERTY( Category=StreetMap, EditAnywhere )
-	FString RoadName;
+	int32 NameId;
 	
 	/** Type of road */
 	UPROPERTY( Category=StreetMap, EditAnywhere )
@@ -165,6 +213,10 @@ struct STREETMAPRUNTIME_API FStreetMapRoad
 	UPROPERTY( Category=StreetMap, EditAnywhere )
 	FVector2D BoundsMax;
 
+	/** Index of the grid cell this road is anchored to (the cell containing the center of its bounds) */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	int32 CellIndex;
+
 	/** True if this node is a one way.  One way nodes are only traversable in the order the nodes are listed in the above array. */
 	UPROPERTY( Category=StreetMap, EditAnywhere )
 	uint8 bIsOneWay : 1;
@@ -173,6 +225,9 @@ struct STREETMAPRUNTIME_API FStreetMapRoad
 	/** Returns this node's index */
 	inline int32 GetRoadIndex( const class UStreetMap& StreetMap ) const;
 
+	/** Gets the name of this road from the street map's name table */
+	inline const FString& GetRoadName( const class UStreetMap& StreetMap ) const;
+
 	/** Gets the node for the specified point, or the node that came before that if the specified point doesn't have a node */
 	inline const struct FStreetMapNode& GetNodeAtPointIndexOrEarlier( const class UStreetMap& StreetMap, const int32 PointIndex, int32& OutNodeAtPointIndex ) const;
 
@@ -185,6 +240,9 @@ struct STREETMAPRUNTIME_API FStreetMapRoad
 	/** Computes the distance along the road between two points on the road.  Be careful!  The same node can appear on a road twice. */
 	float ComputeDistanceBetweenNodesOnRoad( const class UStreetMap& StreetMap, const int32 NodePointIndexA, const int32 NodePointIndexB ) const;
 
+	/** Computes the distance along the road between two of its points.  Only needs the road itself. */
+	float ComputeDistanceBetweenPointsOnRoad( const int32 PointIndexA, const int32 PointIndexB ) const;
+
 	/** Given a position along the road, finds the nodes that come earlier and later on that road */
 	void FindEarlierAndLaterNodesForPositionAlongRoad( const class UStreetMap& StreetMap, const float PositionAlongRoad, const FStreetMapNode*& OutEarlierNode, float& OutEarlierNodePositionAlongRoad, const FStreetMapNode*& OutLaterNode, float& OutLaterNodePositionAlongRoad ) const;
 
@@ -207,13 +265,20 @@ struct STREETMAPRUNTIME_API FStreetMapRoad
 		return bIsOneWay == 1 ? true : false;
 	}
 
+#if WITH_EDITORONLY_DATA
+	/** Name of the road, from before names were moved into the street map's name table */
+	UPROPERTY()
+	FString RoadName_DEPRECATED;
+#endif	// WITH_EDITORONLY_DATA
+
 	FStreetMapRoad() :
-		RoadName(),
+		NameId(INDEX_NONE),
 		RoadType(EStreetMapRoadType::Street),
 		NodeIndices(),
 		RoadPoints(),
 		BoundsMin(FVector2D::ZeroVector),
 		BoundsMax(FVector2D::ZeroVector),
+		CellIndex(INDEX_NONE),
 		bIsOneWay(0)
 	{
 	}
@@ -221,7 +286,8 @@ struct STREETMAPRUNTIME_API FStreetMapRoad
 
 
 /** Nodes have a list of road refs, one for each road that intersects this node.  Each road ref references a road and also the 
-    point along that road where this node exists. */
+    point along that road where this node exists.  The road refs of all nodes are stored together in the street map's
+    NodeRoadRefs list. */
 USTRUCT( BlueprintType )
 struct STREETMAPRUNTIME_API FStreetMapRoadRef
 {
@@ -243,10 +309,24 @@ struct STREETMAPRUNTIME_API FStreetMapNode
 {
 	GENERATED_USTRUCT_BODY()
 	
-	/** All of the roads that intersect this node.  We have references to each of these roads, as well as the point along each
-	    road where this node exists */
+	/** Location of this node in map space.  Stored right on the node so that pathfinding and queries don't have to go
+	    through a road to find it. */
 	UPROPERTY( Category=StreetMap, EditAnywhere )
-	TArray<FStreetMapRoadRef> RoadRefs;
+	FVector2D Location = FVector2D::ZeroVector;
+
+	/** Index of this node's first road ref in the street map's NodeRoadRefs list */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	int32 FirstRoadRef = 0;
+
+	/** Number of road refs this node has, one for each road that intersects this node */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	int32 NumRoadRefs = 0;
+
+#if WITH_EDITORONLY_DATA
+	/** Road refs owned by the node, from before they were moved into the street map's NodeRoadRefs list */
+	UPROPERTY()
+	TArray<FStreetMapRoadRef> RoadRefs_DEPRECATED;
+#endif	// WITH_EDITORONLY_DATA
 
 	/** Returns this node's index */
 	inline int32 GetNodeIndex( const UStreetMap& StreetMap ) const;
@@ -254,6 +334,10 @@ struct STREETMAPRUNTIME_API FStreetMapNode
 	/** Gets the location of this node */
 	inline FVector2D GetLocation( const UStreetMap& StreetMap ) const;
 
+	/** Gets all of the roads that intersect this node.  We have references to each of these roads, as well as the point
+	    along each road where this node exists */
+	inline TArrayView<const FStreetMapRoadRef> GetRoadRefs( const UStreetMap& StreetMap ) const;
+
 
 	///
 	/// Utility functions which may be useful for pathfinding algorithms (not used internally.)
@@ -282,15 +366,15 @@ struct STREETMAPRUNTIME_API FStreetMapBuilding
 {
 	GENERATED_USTRUCT_BODY()
 
-	/** Name of the building */
+	/** Name of the building, as an ID in the street map's name table (INDEX_NONE if the building has no name) */
 	UPROPERTY( Category=StreetMap, EditAnywhere )
-	FString BuildingName;
+	int32 NameId = INDEX_NONE;
 
 	/** Polygon points that define the perimeter of the building */
 	UPROPERTY( Category=StreetMap, EditAnywhere )
 	TArray<FVector2D> BuildingPoints;
 
-	/** Height of the building in meters (if known, otherwise zero) */
+	/** Height of the building in map units (if known, otherwise zero) */
 	UPROPERTY( Category=StreetMap, EditAnywhere )
 	double Height = 0.0;
 
@@ -307,9 +391,85 @@ struct STREETMAPRUNTIME_API FStreetMapBuilding
 	/** 2D bounds (max) of this building's points */
 	UPROPERTY( Category=StreetMap, EditAnywhere )
 	FVector2D BoundsMax = FVector2D::ZeroVector;
+
+	/** Index of the grid cell this building is anchored to (the cell containing the center of its bounds) */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	int32 CellIndex = INDEX_NONE;
+
+#if WITH_EDITORONLY_DATA
+	/** Name of the building, from before names were moved into the street map's name table */
+	UPROPERTY()
+	FString BuildingName_DEPRECATED;
+#endif	// WITH_EDITORONLY_DATA
+
+	/** Gets the name of this building from the street map's name table */
+	inline const FString& GetBuildingName( const class UStreetMap& StreetMap ) const;
 };
 
 
+/** A node on the edge of a street map tile, where at least one road carries on into a neighboring tile.  The neighbor
+    has its own copy of the node with the same OpenStreetMap ID, which is how the road graphs of two tiles are stitched. */
+USTRUCT( BlueprintType )
+struct STREETMAPRUNTIME_API FStreetMapTileBoundaryStub
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Index of the node in this tile */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	int32 NodeIndex = INDEX_NONE;
+
+	/** Grid coordinate of the neighboring tile that the node's roads continue into */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	FIntPoint NeighborTileCoordinate = FIntPoint::ZeroValue;
+};
+
+
+/** Names of the asset registry tags published by street maps.  Tools can read these from the asset registry to budget
+    levels and plan cooks without loading the map itself. */
+struct STREETMAPRUNTIME_API FStreetMapAssetRegistryTags
+{
+	/** Number of roads, nodes, buildings and grid cells */
+	static const FName RoadCount;
+	static const FName NodeCount;
+	static const FName BuildingCount;
+	static const FName CellCount;
+
+	/** Total number of points along all roads, and around all buildings */
+	static const FName RoadPointCount;
+	static const FName BuildingPointCount;
+
+	/** Number of distinct names in the name table */
+	static const FName NameCount;
+
+	/** Total length of all roads, in meters */
+	static const FName TotalRoadLength;
+
+	/** Map space bounds, as FVector2D strings */
+	static const FName BoundsMin;
+	static const FName BoundsMax;
+
+	/** Human readable width and height of the map */
+	static const FName Extent;
+
+	/** Size in bytes of the road, node, building and name data.  This is the feature payload only, without package overhead. */
+	static const FName RoadDataSize;
+	static const FName NodeDataSize;
+	static const FName BuildingDataSize;
+	static const FName NameTableSize;
+
+	/** Version of the importer that created the map (0 if it was imported before importer versions were recorded) */
+	static const FName ImporterVersion;
+
+	/** Grid coordinate of the tile, as an FIntPoint string.  Only published by maps that are tiles of a larger map. */
+	static const FName TileCoordinate;
+};
+
+
+class FStreetMapSnapshot;
+struct FStreetMapDerivedData;
+struct FStreetMapMemoryUsage;
+
+
 /** A loaded street map */
 UCLASS()
 class STREETMAPRUNTIME_API UStreetMap : public UObject
@@ -321,42 +481,57 @@ public:
 	/** Default constructor for UStreetMap */
 	UStreetMap();
 
+	/** Default edge length of a grid cell, in map units (1 km) */
+	static const double DefaultCellSize;
+
 	// UObject overrides
+	virtual void Serialize( FArchive& Ar ) override;
 	virtual void GetAssetRegistryTags( TArray<FAssetRegistryTag>& OutTags ) const override;
+	virtual void PostLoad() override;
+	virtual void BeginDestroy() override;
+	virtual void GetResourceSizeEx( FResourceSizeEx& CumulativeResourceSize ) override;
+#if WITH_EDITOR
+	virtual void BeginCacheForCookedPlatformData( const ITargetPlatform* TargetPlatform ) override;
+	virtual bool IsCachedCookedPlatformDataLoaded( const ITargetPlatform* TargetPlatform ) override;
+#endif
 	
+	// NOTE: The published snapshot owns this map's data, and the Get*() getters below read it from there, however
+	//       the map is accessed.  Only the Edit*() functions change anything: the first call copies the data out of
+	//       the snapshot (copy on write), and from then on all getters return the copy, until it's moved into a new
+	//       snapshot by PublishSnapshot().  That happens at the end of the frame for edits made on the game thread,
+	//       and the new snapshot builds its derived data again, so don't call them just to read.  Arrays returned by
+	//       the getters are only valid until the next publish.
+
 	/** Gets the roads in this street map (read only) */
-	const TArray<FStreetMapRoad>& GetRoads() const
-	{
-		return Roads;
-	}
+	const TArray<FStreetMapRoad>& GetRoads() const;
 
-	/** Gets the roads in this street map */
-	TArray<FStreetMapRoad>& GetRoads()
+	/** Gets the roads in this street map for editing.  Copies the map's data out of its snapshot (see above.) */
+	TArray<FStreetMapRoad>& EditRoads()
 	{
+		MakeDataEditable();
 		return Roads;
 	}
 	
 	/** Gets the nodes on the map (read only.)  Nodes describe intersections between roads */
-	const TArray<FStreetMapNode>& GetNodes() const
-	{
-		return Nodes;
-	}
+	const TArray<FStreetMapNode>& GetNodes() const;
 
-	/** Gets the nodes on the map.  Nodes describe intersections between roads */
-	TArray<FStreetMapNode>& GetNodes()
+	/** Gets the nodes on the map for editing.  Copies the map's data out of its snapshot (see above.) */
+	TArray<FStreetMapNode>& EditNodes()
 	{
+		MakeDataEditable();
 		return Nodes;
 	}
 	
+	/** Gets the road refs of all nodes (read only.)  Each node owns a contiguous range of this list. */
+	const TArray<FStreetMapRoadRef>& GetNodeRoadRefs() const;
+
 	/** Gets all of the buildings (read only) */
-	const TArray<FStreetMapBuilding>& GetBuildings() const
-	{
-		return Buildings;
-	}
+	const TArray<FStreetMapBuilding>& GetBuildings() const;
 
-	/** Gets all of the buildings */
-	TArray<FStreetMapBuilding>& GetBuildings()
+	/** Gets all of the buildings for editing.  Copies the map's data out of its snapshot (see above.) */
+	TArray<FStreetMapBuilding>& EditBuildings()
 	{
+		MakeDataEditable();
 		return Buildings;
 	}
 
@@ -370,8 +545,178 @@ public:
 		return BoundsMax;
 	}
 
+	/** Gets the edge length of the map's grid cells, in map units */
+	double GetCellSize() const
+	{
+		return CellSize;
+	}
+
+	/** Gets all of the grid cells that have at least one road or building anchored to them */
+	const TArray<FStreetMapCell>& GetCells() const
+	{
+		return Cells;
+	}
+
+	/** Gets the grid coordinate of the cell containing the specified map space location */
+	FIntPoint GetCellCoordinate( const FVector2D& Location ) const
+	{
+		return FIntPoint(
+			FMath::FloorToInt32( Location.X / CellSize ),
+			FMath::FloorToInt32( Location.Y / CellSize ) );
+	}
+
+	/** Finds the index of the cell with the specified grid coordinate, or INDEX_NONE if no features are anchored there */
+	int32 FindCellIndex( const FIntPoint& CellCoordinate ) const;
+
+	/** Gets the double precision origin of the specified cell.  Returns the map origin for INDEX_NONE. */
+	FVector2D GetCellOrigin( const int32 CellIndex ) const
+	{
+		return Cells.IsValidIndex( CellIndex ) ? Cells[ CellIndex ].Origin : FVector2D::ZeroVector;
+	}
+
+	/** Converts a map space location to single precision, relative to some double precision origin (usually a cell origin) */
+	static FVector2f ToRelativeLocation( const FVector2D& Location, const FVector2D& RelativeToOrigin )
+	{
+		// Subtract in double precision first, so that only the small relative offset is narrowed
+		return FVector2f( Location - RelativeToOrigin );
+	}
+
+	/** Converts a single precision location relative to some origin back into double precision map space */
+	static FVector2D FromRelativeLocation( const FVector2f& RelativeLocation, const FVector2D& RelativeToOrigin )
+	{
+		return RelativeToOrigin + FVector2D( RelativeLocation );
+	}
+
+	/** Gets the projection that ties this map's space to latitude/longitude.  Check bIsValid, older imports don't have one. */
+	const FStreetMapGeoReference& GetGeoReference() const
+	{
+		return GeoReference;
+	}
+
+	/** Assigns every road and building to the grid cell that contains the center of its bounds, and rebuilds the cell list */
+	void RebuildCells();
+
+	/** Returns true if this map is a tile that was split off a larger map */
+	bool IsTile() const
+	{
+		return bIsTile;
+	}
+
+	/** Gets the grid coordinate of the cell this tile was split from.  Only meaningful for tiles. */
+	FIntPoint GetTileCoordinate() const
+	{
+		return TileCoordinate;
+	}
+
+	/** Gets the nodes on the edge of this tile whose roads carry on into neighboring tiles */
+	const TArray<FStreetMapTileBoundaryStub>& GetTileBoundaryStubs() const
+	{
+		return TileBoundaryStubs;
+	}
+
+	/**
+	 * Replaces the contents of this map with a single grid cell of a larger map.  The tile gets every road and building
+	 * anchored to that cell, the nodes along those roads, and a boundary stub for each node whose roads carry on into
+	 * another cell.  Map space coordinates are kept as they are, so tiles line up with each other and with the source map.
+	 *
+	 * @param	SourceMap	The map to split the tile off.  Must not be this map.
+	 * @param	CellIndex	Index of the source map cell that becomes this tile
+	 */
+	void BuildTileFromCell( const UStreetMap& SourceMap, const int32 CellIndex );
+
+	/** Gets the OpenStreetMap IDs of all roads, nodes and buildings, in the same order as the features.  Empty if the map
+	    was imported without IDs. */
+	const TArray<int64>& GetRoadOsmIds() const;
+	const TArray<int64>& GetNodeOsmIds() const;
+	const TArray<int64>& GetBuildingOsmIds() const;
+
+	/** Gets the OpenStreetMap way ID of the specified road, or INDEX_NONE if the map was imported without IDs */
+	int64 GetRoadOsmId( const int32 RoadIndex ) const
+	{
+		const TArray<int64>& OsmIds = GetRoadOsmIds();
+		return OsmIds.IsValidIndex( RoadIndex ) ? OsmIds[ RoadIndex ] : INDEX_NONE;
+	}
+
+	/** Gets the OpenStreetMap node ID of the specified node, or INDEX_NONE if the map was imported without IDs */
+	int64 GetNodeOsmId( const int32 NodeIndex ) const
+	{
+		const TArray<int64>& OsmIds = GetNodeOsmIds();
+		return OsmIds.IsValidIndex( NodeIndex ) ? OsmIds[ NodeIndex ] : INDEX_NONE;
+	}
+
+	/** Gets the OpenStreetMap way ID of the specified building, or INDEX_NONE if the map was imported without IDs */
+	int64 GetBuildingOsmId( const int32 BuildingIndex ) const
+	{
+		const TArray<int64>& OsmIds = GetBuildingOsmIds();
+		return OsmIds.IsValidIndex( BuildingIndex ) ? OsmIds[ BuildingIndex ] : INDEX_NONE;
+	}
+
+	/** Finds the index of the road that was imported from the specified OpenStreetMap way, or INDEX_NONE.  Looks up the published snapshot's ID index. */
+	int32 FindRoadIndexByOsmId( const int64 OsmWayId ) const;
+
+	/** Finds the index of the node that was imported from the specified OpenStreetMap node, or INDEX_NONE.  Looks up the published snapshot's ID index. */
+	int32 FindNodeIndexByOsmId( const int64 OsmNodeId ) const;
+
+	/** Finds the index of the building that was imported from the specified OpenStreetMap way, or INDEX_NONE.  Looks up the published snapshot's ID index. */
+	int32 FindBuildingIndexByOsmId( const int64 OsmWayId ) const;
+
+	/** Finds the road that was imported from the specified OpenStreetMap way in the published snapshot, or nullptr */
+	const FStreetMapRoad* FindRoadByOsmId( const int64 OsmWayId ) const;
+
+	/** Finds the node that was imported from the specified OpenStreetMap node in the published snapshot, or nullptr */
+	const FStreetMapNode* FindNodeByOsmId( const int64 OsmNodeId ) const;
+
+	/** Finds the building that was imported from the specified OpenStreetMap way in the published snapshot, or nullptr */
+	const FStreetMapBuilding* FindBuildingByOsmId( const int64 OsmWayId ) const;
+
+	/**
+	 * Gets the published snapshot of this map's data, which any thread can read without locking.  This only copies a
+	 * pointer, and never returns null.  Edits that haven't been published yet aren't in it.
+	 */
+	TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> GetSnapshot() const;
+
+	/**
+	 * Moves edited roads, nodes, buildings and names into a new snapshot and swaps it in for the old one.  Edits made on
+	 * the game thread are published at the end of the frame, so this only needs calling to publish them sooner, or after
+	 * editing on another thread.  Readers holding the old snapshot keep using it until they let go of it.  Does nothing
+	 * if nothing was edited since the last publish.  Derived data is thrown away and rebuilt the next time it is needed.
+	 */
+	void PublishSnapshot();
+
+	/**
+	 * Gets the runtime data derived from the published snapshot: building triangles, the road graph and spatial indices.
+	 * See FStreetMapSnapshot::GetDerivedData().  Code that reads roads, nodes or buildings along with it should get both
+	 * from the same snapshot instead, since the map may publish a new one in between.
+	 */
+	TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> GetDerivedData() const;
+
+#if WITH_EDITOR
+	/** Gets the derived data cache key for the published data.  Data built from this map can use it in its own keys. */
+	FString GetDerivedDataKey() const;
+#endif
+
+	/** Gets how many bytes this map uses: its data, lookup tables built from it, derived data and the published snapshot */
+	FStreetMapMemoryUsage GetMemoryUsage() const;
+
+	/** Gets the name table shared by all roads and buildings.  Name IDs index into this list. */
+	const TArray<FString>& GetNames() const;
+
+	/** Gets a name from the name table, or an empty string for INDEX_NONE (or if names were stripped when cooking) */
+	const FString& GetNameById( const int32 NameId ) const
+	{
+		static const FString EmptyName;
+		const TArray<FString>& NameTable = GetNames();
+		return NameTable.IsValidIndex( NameId ) ? NameTable[ NameId ] : EmptyName;
+	}
+
+	/** Adds a name to the name table if it isn't there already, and returns its ID.  Empty names get INDEX_NONE. */
+	int32 InternName( const FString& Name );
+
 
 protected:
+
+	// NOTE: The roads, nodes, road refs, buildings, OpenStreetMap IDs and names below are only filled in while the map
+	//       is being loaded, saved or edited.  The rest of the time they're empty, and the published snapshot has them.
 	
 	/** List of roads */
 	UPROPERTY( Category=StreetMap, VisibleAnywhere )
@@ -381,6 +726,10 @@ protected:
 	UPROPERTY( Category=StreetMap, VisibleAnywhere )
 	TArray<FStreetMapNode> Nodes;
 
+	/** Road refs of all nodes, stored back to back.  Each node references its range with FirstRoadRef and NumRoadRefs. */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere )
+	TArray<FStreetMapRoadRef> NodeRoadRefs;
+
 	/** List of all buildings on the street map */
 	UPROPERTY( Category=StreetMap, VisibleAnywhere)
 	TArray<FStreetMapBuilding> Buildings;
@@ -393,16 +742,124 @@ protected:
 	UPROPERTY( Category=StreetMap, VisibleAnywhere)
 	FVector2D BoundsMax;
 
+	/** Projection from latitude/longitude into this map's space, as used by the importer */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere)
+	FStreetMapGeoReference GeoReference;
+
+	/** Edge length of a grid cell, in map units */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere)
+	double CellSize;
+
+	/** Grid cells that have at least one road or building anchored to them */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere)
+	TArray<FStreetMapCell> Cells;
+
+	/** Maps grid coordinates to indices in the Cells list.  Rebuilt on load. */
+	TMap<FIntPoint, int32> CellCoordinateToIndexMap;
+
+	/** OpenStreetMap way ID of each road, in the same order as the Roads list */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere)
+	TArray<int64> RoadOsmIds;
+
+	/** OpenStreetMap node ID of each node, in the same order as the Nodes list */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere)
+	TArray<int64> NodeOsmIds;
+
+	/** OpenStreetMap way ID of each building, in the same order as the Buildings list */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere)
+	TArray<int64> BuildingOsmIds;
+
+	/** True if this map is a tile that was split off a larger map */
+	UPROPERTY( Category=Tile, VisibleAnywhere )
+	bool bIsTile;
+
+	/** Grid coordinate of the source map cell this tile was split from */
+	UPROPERTY( Category=Tile, VisibleAnywhere )
+	FIntPoint TileCoordinate;
+
+	/** Nodes on the edge of this tile whose roads carry on into neighboring tiles */
+	UPROPERTY( Category=Tile, VisibleAnywhere )
+	TArray<FStreetMapTileBoundaryStub> TileBoundaryStubs;
+
+	/** How road and building names are stored when this map is cooked */
+	UPROPERTY( Category=Cooking, EditAnywhere )
+	EStreetMapNameCookMode NameCookMode;
+
+	/** Name table shared by all roads and buildings.  Serialized by hand so that it can be compressed or stripped when cooking. */
+	TArray<FString> Names;
+
+	/** Case sensitive key functions for interning names */
+	struct FNameTableKeyFuncs : BaseKeyFuncs<TPair<FString, int32>, FString, false>
+	{
+		static const FString& GetSetKey( const TPair<FString, int32>& Element ) { return Element.Key; }
+		static bool Matches( const FString& A, const FString& B ) { return A.Equals( B, ESearchCase::CaseSensitive ); }
+		static uint32 GetKeyHash( const FString& Key ) { return FCrc::StrCrc32( *Key ); }
+	};
+
+	/** Maps names back to their IDs while interning.  Rebuilt on demand. */
+	TMap<FString, int32, FDefaultSetAllocator, FNameTableKeyFuncs> NameToIdMap;
+
+private:
+
+	/** Serializes the name table, compressing or stripping it when cooking */
+	void SerializeNameTable( FArchive& Ar );
+
+	/** Serializes derived data into cooked maps, and loads it back from them */
+	void SerializeCookedDerivedData( FArchive& Ar );
+
+	/**
+	 * Makes this map's own arrays hold its data, so it can be edited.  Does nothing if they already do.
+	 *
+	 * @param	bKeepPublishedData	If true, the published data is copied in.  Otherwise the arrays start out empty.
+	 */
+	void MakeDataEditable( const bool bKeepPublishedData = true );
+
+	/** Moves the edited data into a new snapshot and swaps it in */
+	void MoveDataIntoSnapshot();
+
+	/** Copies the published data into this map's own arrays */
+	void CopyDataFromSnapshot();
+
+	/** Empties this map's own arrays */
+	void ResetData();
+
+	/** The currently published snapshot, which owns this map's data unless it is being edited.  Never null. */
+	TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot;
+
+	/** True while the snapshot has this map's data, and false while this map's own arrays have it */
+	bool bDataIsPublished;
+
+	/** Publishes edits made on the game thread at the end of the frame */
+	FDelegateHandle PublishAtEndOfFrameHandle;
+
+	/** Version of the most recently made snapshot */
+	mutable std::atomic<uint32> SnapshotVersion { 0 };
+
+	/** Guards the Snapshot pointer for other threads.  Only held long enough to copy or swap the pointer. */
+	mutable FRWLock SnapshotLock;
+
+	/** Derived data loaded from a cooked map, until PostLoad() hands it to the snapshot made from the loaded data */
+	TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> CookedDerivedData;
+
+protected:
+
 #if WITH_EDITORONLY_DATA
 	/** Importing data and options used for this mesh */
 	UPROPERTY( VisibleAnywhere, Instanced, Category=ImportSettings )
 	class UAssetImportData* AssetImportData;
 
+	/** Version of the importer that created this map.  Zero for maps imported before importer versions were recorded. */
+	UPROPERTY( VisibleAnywhere, Category=ImportSettings )
+	int32 ImporterVersion;
+
 	friend class UStreetMapFactory;
 	friend class UStreetMapReimportFactory;
 	friend class FStreetMapAssetTypeActions;
 #endif	// WITH_EDITORONLY_DATA
 
+	/** Fills in maps loaded from OpenStreetMap files, in the editor and at runtime */
+	friend class FStreetMapOSMConverter;
+
 };
 
 
@@ -414,6 +871,18 @@ inline int32 FStreetMapRoad::GetRoadIndex( const UStreetMap& StreetMap ) const
 }
 
 
+inline const FString& FStreetMapRoad::GetRoadName( const UStreetMap& StreetMap ) const
+{
+	return StreetMap.GetNameById( NameId );
+}
+
+
+inline const FString& FStreetMapBuilding::GetBuildingName( const UStreetMap& StreetMap ) const
+{
+	return StreetMap.GetNameById( NameId );
+}
+
+
 inline const FStreetMapNode& FStreetMapRoad::GetNodeAtPointIndexOrEarlier( const UStreetMap& StreetMap, const int32 PointIndex, int32& OutNodeAtPointIndex ) const
 {
 	const FStreetMapNode* CurrentOrEarlierPointNode = nullptr;
@@ -457,6 +926,12 @@ inline float FStreetMapRoad::ComputeLengthOfRoad( const class UStreetMap& Street
 
 
 inline float FStreetMapRoad::ComputeDistanceBetweenNodesOnRoad( const class UStreetMap& StreetMap, const int32 NodePointIndexA, const int32 NodePointIndexB ) const
+{
+	return ComputeDistanceBetweenPointsOnRoad( NodePointIndexA, NodePointIndexB );
+}
+
+
+inline float FStreetMapRoad::ComputeDistanceBetweenPointsOnRoad( const int32 PointIndexA, const int32 PointIndexB ) const
 {
 	float TotalDistanceSoFar = 0.0f;
 
@@ -467,8 +942,8 @@ inline float FStreetMapRoad::ComputeDistanceBetweenNodesOnRoad( const class UStr
 	//        can be computed at load time or at import time (and stored in the asset).  Most of the other functions
 	//        in this class that perform Size() computations could be changed to use cached distances also!
 
-	const int32 SmallerPointIndex = FMath::Max( 0, FMath::Min( NodePointIndexA, NodePointIndexB ) );
-	const int32 LargerPointIndex = FMath::Min( RoadPoints.Num() - 1, FMath::Max( NodePointIndexA, NodePointIndexB ) );
+	const int32 SmallerPointIndex = FMath::Max( 0, FMath::Min( PointIndexA, PointIndexB ) );
+	const int32 LargerPointIndex = FMath::Min( RoadPoints.Num() - 1, FMath::Max( PointIndexA, PointIndexB ) );
 
 	for( int32 PointIndex = SmallerPointIndex; PointIndex < LargerPointIndex; ++PointIndex )
 	{
@@ -618,14 +1093,20 @@ inline int32 FStreetMapNode::GetNodeIndex( const UStreetMap& StreetMap ) const
 }
 
 
+inline TArrayView<const FStreetMapRoadRef> FStreetMapNode::GetRoadRefs( const UStreetMap& StreetMap ) const
+{
+	return TArrayView<const FStreetMapRoadRef>( StreetMap.GetNodeRoadRefs().GetData() + FirstRoadRef, NumRoadRefs );
+}
+
+
 inline bool FStreetMapNode::IsDeadEnd( const UStreetMap& StreetMap ) const
 {
-	if( RoadRefs.Num() == 1 )
+	if( NumRoadRefs == 1 )
 	{
 		// @todo: If this road only connects to dead end roads that oppose the direction, we need to treat this road
 		//        as a dead end.  This case should be extremely uncommon, though!
 
-		const FStreetMapRoadRef& SoleRoadRef = RoadRefs[ 0 ];
+		const FStreetMapRoadRef& SoleRoadRef = StreetMap.GetNodeRoadRefs()[ FirstRoadRef ];
 		const FStreetMapRoad& SoleRoad = StreetMap.GetRoads()[ SoleRoadRef.RoadIndex ];
 		if( SoleRoadRef.RoadPointIndex == 0 || SoleRoadRef.RoadPointIndex == ( SoleRoad.NodeIndices.Num() - 1 ) )
 		{
@@ -640,8 +1121,6 @@ inline bool FStreetMapNode::IsDeadEnd( const UStreetMap& StreetMap ) const
 
 inline FVector2D FStreetMapNode::GetLocation( const UStreetMap& StreetMap ) const
 {
-	const FStreetMapRoadRef& MyFirstRoadRef = RoadRefs[ 0 ];
-	const FVector2D Location = StreetMap.GetRoads()[ MyFirstRoadRef.RoadIndex ].RoadPoints[ MyFirstRoadRef.RoadPointIndex ];
 	return Location;
 }
 
@@ -693,7 +1172,7 @@ inline int32 FStreetMapNode::GetConnectionCount( const UStreetMap& StreetMap, co
 {
 	// NOTE: We're iterating here in the exact same order as in the GetConnection() function below!  That's critically important!
 	int32 TotalConnections = 0;
-	for( const FStreetMapRoadRef& RoadRef : RoadRefs )
+	for( const FStreetMapRoadRef& RoadRef : GetRoadRefs( StreetMap ) )
 	{
 		const FStreetMapRoad& Road = StreetMap.GetRoads()[ RoadRef.RoadIndex ];
 		
@@ -727,7 +1206,7 @@ inline const FStreetMapNode* FStreetMapNode::GetConnection( const UStreetMap& St
 
 	// NOTE: We're iterating here in the exact same order as in the GetConnectionCount() function above!  That's critically important!
 	int32 CurrentConnectionIndex = 0;
-	for( const FStreetMapRoadRef& RoadRef : RoadRefs )
+	for( const FStreetMapRoadRef& RoadRef : GetRoadRefs( StreetMap ) )
 	{
 		const FStreetMapRoad& Road = StreetMap.GetRoads()[ RoadRef.RoadIndex ];
 		
@@ -7,6 +7,8 @@
 #include "StreetMapComponent.generated.h"
 
 class UBodySetup;
+class ITargetPlatform;
+struct FStreetMapMemoryUsage;
 
 /**
  * Component that represents a section of street map roads and buildings
@@ -48,6 +50,39 @@ public:
 		return Indices;
 	}
 
+	/** Returns the double precision origin that cached raw mesh vertices are relative to, in component space */
+	FVector GetMeshOrigin() const
+	{
+		return MeshOrigin;
+	}
+
+	/** Returns the settings this component's mesh is generated with */
+	const FStreetMapMeshBuildSettings& GetMeshBuildSettings() const
+	{
+		return MeshBuildSettings;
+	}
+
+	/** Returns the settings this component's collision is generated with */
+	const FStreetMapCollisionSettings& GetCollisionSettings() const
+	{
+		return CollisionSettings;
+	}
+
+	/** Changes the settings collision is generated with, then generates or clears collision to match */
+	void SetCollisionSettings(const FStreetMapCollisionSettings& NewCollisionSettings);
+
+	/** Returns the number of vertices in the cached mesh */
+	int32 GetNumMeshVertices() const
+	{
+		return Vertices.Num();
+	}
+
+	/** Returns the number of triangles in the cached mesh */
+	int32 GetNumMeshTriangles() const
+	{
+		return Indices.Num() / 3;
+	}
+
 	/**
 	* Returns StreetMap Default Material if a valid one is found in plugin's content folder.
 	* Otherwise , it returns the default surface 3d material.
@@ -85,6 +120,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "StreetMap")
 		void SetStreetMap(UStreetMap* NewStreetMap, bool bClearPreviousMeshIfAny = false, bool bRebuildMesh = false);
 
+	/** Gets how many bytes this component's cached mesh, render buffers and collision use.  The street map itself isn't included. */
+	FStreetMapMemoryUsage GetMemoryUsage() const;
+
 
 
 	//** Begin Interface_CollisionDataProvider Interface */
@@ -109,6 +147,12 @@ protected:
 
 public:
 
+	// UObject interface
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void PostLoad() override;
+	virtual void BeginDestroy() override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
 	// UActorComponent interface
 	virtual void InitializeComponent() override;
 	virtual void UninitializeComponent() override;
@@ -117,6 +161,7 @@ public:
 	virtual  UBodySetup* GetBodySetup() override;
 	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
 	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+	virtual FMatrix GetRenderMatrix() const override;
 	virtual int32 GetNumMaterials() const override;
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
@@ -128,6 +173,12 @@ public:
 	/** Rebuilds the graphics and physics mesh representation if we don't have one right now.  Designed to be called on demand. */
 	void BuildMesh();
 
+	/**
+	 * Generates the cached mesh from the street map's data, without looking in the derived data cache.  Unlike BuildMesh(),
+	 * this leaves bounds, collision and render state alone.
+	 */
+	void GenerateMesh();
+
 
 
 protected:
@@ -138,14 +189,40 @@ protected:
 	/** Updating navoctree entry for this component , if need/possible. */
 	void UpdateNavigationIfNeeded();
 
-	/** Generates a cached mesh from raw street map data */
-	void GenerateMesh();
+	/** Fetches the cached mesh from the derived data cache, or generates it (and caches it) if it isn't there */
+	void LoadOrGenerateMesh();
+
+	/**
+	 * Serializes the cached mesh.  It is left out of uncooked levels, since it can be generated again from the street map,
+	 * and out of cooked data for platforms that never use it.
+	 */
+	void SerializeMesh(FArchive& Ar);
+
+	/** Serializes the cached mesh and its origin and bounds, as stored in the derived data cache */
+	void SerializeMeshDerivedData(FArchive& Ar);
+
+	/** Updates the StreetMap memory stat after the cached mesh changed */
+	void UpdateMeshMemoryStat();
+
+#if WITH_EDITOR
+	/** Returns true if the cached mesh is used on the specified cook target, either for rendering or to build collision */
+	bool IsMeshNeededOnCookTarget(const ITargetPlatform* TargetPlatform) const;
+
+	/** Gets the derived data cache key for the mesh, from the street map's data and the mesh build settings */
+	FString GetMeshDerivedDataKey() const;
+#endif
+
+	/** Converts a street map location into a single precision mesh vertex location, relative to MeshOrigin */
+	FVector2f ToMeshLocation(const FVector2D& MapLocation) const
+	{
+		return UStreetMap::ToRelativeLocation(MapLocation, FVector2D(MeshOrigin));
+	}
 
 	/** Adds a 2D line to the raw mesh */
 	void AddThick2DLine(const FVector2f Start, const FVector2f End, const float Z, const float Thickness, const FColor& StartColor, const FColor& EndColor, FBox3f& MeshBoundingBox);
 
 	/** Adds 3D triangles to the raw mesh */
-	void AddTriangles(const TArray<FVector3f>& Points, const TArray<int32>& PointIndices, const FVector3f& ForwardVector, const FVector3f& UpVector, const FColor& Color, FBox3f& MeshBoundingBox);
+	void AddTriangles(const TArray<FVector3f>& Points, TArrayView<const int32> PointIndices, const FVector3f& ForwardVector, const FVector3f& UpVector, const FColor& Color, FBox3f& MeshBoundingBox);
 
 
 protected:
@@ -170,18 +247,35 @@ protected:
 	// Cached mesh representation
 	//
 
-	/** Cached raw mesh vertices */
+	/** True if a mesh was generated for the street map.  Uncooked levels only keep this flag and generate the mesh at load. */
 	UPROPERTY()
+	bool bMeshGenerated;
+
+	/** Cached raw mesh vertices.  Serialized by hand, see SerializeMesh(). */
 	TArray< struct FStreetMapVertex > Vertices;
 
-	/** Cached raw mesh triangle indices */
-	UPROPERTY()
+	/** Cached raw mesh triangle indices.  Serialized by hand, see SerializeMesh(). */
 	TArray< uint32 > Indices;
 
-	/** Cached bounding box */
+	/**
+	 * Double precision origin of the cached mesh, in component space: the origin of the grid cell at the center of the map.
+	 * Vertices are single precision relative to this origin, and so is the collision mesh, so they lose accuracy with
+	 * distance from it.  Very large maps should be split into tiles, whose meshes are each relative to their own cell.
+	 * GenerateMesh() logs a warning for maps large enough to need it.
+	 */
+	UPROPERTY()
+	FVector MeshOrigin;
+
+	/** Cached bounding box (relative to MeshOrigin) */
 	UPROPERTY()
 	FBoxSphereBounds CachedLocalBounds;
 
+	/** Size of the vertex and index buffers of the most recently created scene proxy */
+	SIZE_T RenderBufferSize;
+
+	/** Size of the cached mesh, as last added to the StreetMap memory stat */
+	SIZE_T MeshMemoryStatSize;
+
 	/** Cached StreetMap DefaultMaterial */
 	UPROPERTY()
 	UMaterialInterface* StreetMapDefaultMaterial;
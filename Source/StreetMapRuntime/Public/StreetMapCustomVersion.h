@@ -0,0 +1,41 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+
+/** Custom serialization version for street map assets */
+struct STREETMAPRUNTIME_API FStreetMapCustomVersion
+{
+	enum Type
+	{
+		/** Before any version changes were made */
+		BeforeCustomVersionWasAdded = 0,
+
+		/** Road and building names moved into a shared name table */
+		NameTable,
+
+		/** Nodes store their own location, and their road refs moved into one list on the street map */
+		CompactNodeTable,
+
+		/** Cooked street maps carry their derived data (building triangles and road graph) */
+		CookedDerivedData,
+
+		/** Street map components serialize their generated mesh by hand, so cooks can leave it out per target platform */
+		ComponentMeshSerializedByHand,
+
+		/** Street map component meshes are derived data, kept in the derived data cache instead of in levels */
+		ComponentMeshIsDerivedData,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	/** The GUID for this custom version number */
+	const static FGuid GUID;
+
+private:
+	FStreetMapCustomVersion() {}
+};
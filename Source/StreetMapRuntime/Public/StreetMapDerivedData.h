@@ -0,0 +1,135 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "StreetMapSpatialIndex.h"
+
+class FStreetMapSnapshot;
+
+
+/** A directed edge in a street map's road graph.  Edges only exist in directions that can be traveled. */
+struct FStreetMapGraphEdge
+{
+	/** Index of the node this edge leads to */
+	int32 ToNodeIndex = INDEX_NONE;
+
+	/** Index of the road this edge follows */
+	int32 RoadIndex = INDEX_NONE;
+
+	/** Index of the point along the road where this edge starts */
+	int32 FromRoadPointIndex = INDEX_NONE;
+
+	/** Index of the point along the road where this edge ends */
+	int32 ToRoadPointIndex = INDEX_NONE;
+
+	/** Distance along the road between the two nodes, in map units */
+	float Length = 0.0f;
+
+	friend FArchive& operator<<( FArchive& Ar, FStreetMapGraphEdge& Edge )
+	{
+		Ar << Edge.ToNodeIndex << Edge.RoadIndex << Edge.FromRoadPointIndex << Edge.ToRoadPointIndex << Edge.Length;
+		return Ar;
+	}
+};
+
+
+/**
+ * Runtime data derived from a street map's roads, nodes and buildings.  Nothing in here is authored.  It is built once
+ * and cached: in the editor through the derived data cache, and in cooked builds by serializing it right into the cooked
+ * street map, so that loading a cooked map never has to build it.
+ *
+ * Each snapshot owns the derived data built from it (see FStreetMapSnapshot::GetDerivedData()).  The road graph and the
+ * spatial indices store road, node and building indices, so the arrays passed to their queries have to come from that
+ * same snapshot.
+ */
+struct STREETMAPRUNTIME_API FStreetMapDerivedData
+{
+	/** Builds all derived data for the specified snapshot.  Its indices refer to the snapshot's roads, nodes and buildings. */
+	void Build( const FStreetMapSnapshot& Snapshot );
+
+	/** Gets the triangulated roof polygon of a building, as indices into the building's points (three per triangle).  Returns
+	    false if the building's polygon could not be triangulated. */
+	bool GetBuildingTriangles( const int32 BuildingIndex, TArrayView<const int32>& OutTriangleIndices, bool& bOutWindsClockwise ) const
+	{
+		if( !BuildingTriangleFlags.IsValidIndex( BuildingIndex ) || ( BuildingTriangleFlags[ BuildingIndex ] & EBuildingTriangleFlags::Triangulated ) == 0 )
+		{
+			return false;
+		}
+
+		const int32 FirstIndex = BuildingTriangleOffsets[ BuildingIndex ];
+		OutTriangleIndices = TArrayView<const int32>( BuildingTriangleIndices.GetData() + FirstIndex, BuildingTriangleOffsets[ BuildingIndex + 1 ] - FirstIndex );
+		bOutWindsClockwise = ( BuildingTriangleFlags[ BuildingIndex ] & EBuildingTriangleFlags::WindsClockwise ) != 0;
+		return true;
+	}
+
+	/** Gets the graph edges leaving the specified node, in the directions they can be traveled */
+	TArrayView<const FStreetMapGraphEdge> GetNodeEdges( const int32 NodeIndex ) const
+	{
+		const int32 FirstEdge = GraphEdgeOffsets[ NodeIndex ];
+		return TArrayView<const FStreetMapGraphEdge>( GraphEdges.GetData() + FirstEdge, GraphEdgeOffsets[ NodeIndex + 1 ] - FirstEdge );
+	}
+
+	/** Gets the number of nodes in the road graph */
+	int32 GetNodeCount() const
+	{
+		return FMath::Max( GraphEdgeOffsets.Num() - 1, 0 );
+	}
+
+	/** Gets the spatial index over road segments, for finding the nearest road to a location */
+	const FStreetMapRoadSegmentIndex& GetRoadSegmentIndex() const
+	{
+		return RoadSegmentIndex;
+	}
+
+	/** Gets the spatial index over road graph nodes, for finding the nodes nearest to a location */
+	const FStreetMapNodeIndex& GetNodeIndex() const
+	{
+		return NodeIndex;
+	}
+
+	/** Gets the spatial index over building footprints, for finding the buildings at a location or in an area */
+	const FStreetMapBuildingIndex& GetBuildingIndex() const
+	{
+		return BuildingIndex;
+	}
+
+	/** Gets the number of bytes this data uses */
+	SIZE_T GetAllocatedSize() const;
+
+	friend STREETMAPRUNTIME_API FArchive& operator<<( FArchive& Ar, FStreetMapDerivedData& DerivedData );
+
+
+private:
+
+	/** Per building triangulation flags */
+	struct EBuildingTriangleFlags
+	{
+		enum Type : uint8
+		{
+			Triangulated = 1 << 0,
+			WindsClockwise = 1 << 1,
+		};
+	};
+
+	/** Offset of each building's triangle indices in BuildingTriangleIndices, plus one past the end */
+	TArray<int32> BuildingTriangleOffsets;
+
+	/** Triangle indices of all buildings, back to back */
+	TArray<int32> BuildingTriangleIndices;
+
+	/** EBuildingTriangleFlags for each building */
+	TArray<uint8> BuildingTriangleFlags;
+
+	/** Offset of each node's first edge in GraphEdges, plus one past the end (compressed sparse row layout) */
+	TArray<int32> GraphEdgeOffsets;
+
+	/** Graph edges of all nodes, back to back */
+	TArray<FStreetMapGraphEdge> GraphEdges;
+
+	/** Spatial index over road segments */
+	FStreetMapRoadSegmentIndex RoadSegmentIndex;
+
+	/** Spatial index over road graph nodes */
+	FStreetMapNodeIndex NodeIndex;
+
+	/** Spatial index over building footprints */
+	FStreetMapBuildingIndex BuildingIndex;
+};
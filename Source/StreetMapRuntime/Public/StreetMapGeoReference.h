@@ -0,0 +1,57 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StreetMapGeoReference.generated.h"
+
+/**
+ * Ties a street map's space to the globe.  OpenStreetMap coordinates are projected with the Sanson-Flamsteed
+ * (sinusoidal) projection, relative to an origin near the center of the imported data, then scaled to map units.
+ *
+ * The importer projects every point through GeoToMap(), so converting the same latitude/longitude at runtime gives
+ * exactly the location the importer produced.
+ */
+USTRUCT(BlueprintType)
+struct STREETMAPRUNTIME_API FStreetMapGeoReference
+{
+	GENERATED_BODY()
+
+	/** Latitude of the map origin, in degrees */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	double OriginLatitude = 0.0;
+
+	/** Longitude of the map origin, in degrees */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	double OriginLongitude = 0.0;
+
+	/** Meters per degree of latitude, and per degree of longitude at the equator */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	double MetersPerDegree = DefaultMetersPerDegree;
+
+	/** Map units per meter */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	double UnitsPerMeter = 100.0;
+
+	/** False for maps imported before geo references were stored.  Reimport those maps to fill it in. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	bool bIsValid = false;
+
+	/** Meters per degree along the equator */
+	static const double DefaultMetersPerDegree;
+
+	/** Converts a latitude/longitude (in degrees) into map space */
+	FVector2D GeoToMap(double Latitude, double Longitude) const;
+
+	/** Converts a map space location back into latitude/longitude, in degrees */
+	void MapToGeo(const FVector2D& MapLocation, double& OutLatitude, double& OutLongitude) const;
+
+	/**
+	 * Converts a batch of latitude/longitude pairs (in degrees) into map space.  Large batches are split across worker
+	 * threads.  Every point gets exactly the result GeoToMap() would give it.
+	 */
+	void GeoToMap(TArrayView<const double> Latitudes, TArrayView<const double> Longitudes, TArrayView<FVector2D> OutMapLocations) const;
+
+	/** Converts a batch of map space locations back into latitude/longitude, in degrees.  Large batches are split across worker threads. */
+	void MapToGeo(TArrayView<const FVector2D> MapLocations, TArrayView<double> OutLatitudes, TArrayView<double> OutLongitudes) const;
+};
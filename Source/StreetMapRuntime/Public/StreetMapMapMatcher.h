@@ -0,0 +1,144 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StreetMapSpatialIndex.h"
+#include "StreetMapMapMatcher.generated.h"
+
+struct FStreetMapDerivedData;
+class FStreetMapSnapshot;
+
+/** Settings for snapping GPS traces onto roads.  Distances are in world units for street map subsystem queries. */
+USTRUCT(BlueprintType)
+struct STREETMAPRUNTIME_API FStreetMapMapMatchSettings
+{
+	GENERATED_BODY()
+
+	/** How far from each sample to look for roads it could be on (50m) */
+	UPROPERTY(Category = StreetMap, EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	float SearchRadius = 5000.0f;
+
+	/** Most roads each sample could be on.  More candidates cope better with dense junctions, but are slower. */
+	UPROPERTY(Category = StreetMap, EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1"))
+	int32 MaxCandidates = 5;
+
+	/** Standard deviation of the GPS error (5m).  Roads farther from a sample than this are much less likely to be its road. */
+	UPROPERTY(Category = StreetMap, EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1"))
+	float GpsNoise = 500.0f;
+
+	/** How much the distance driven between two samples typically differs from the straight line between them (5m).  Smaller
+	    values penalize detours and U-turns more. */
+	UPROPERTY(Category = StreetMap, EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1"))
+	float RouteDeviation = 500.0f;
+
+	/** Routes this much longer than the straight line between two samples aren't considered (200m).  Where no route is short
+	    enough, the trace is split there and each part is matched on its own. */
+	UPROPERTY(Category = StreetMap, EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	float MaxDetour = 20000.0f;
+
+	/** Road types samples may be matched to (other settings don't apply to roads) */
+	UPROPERTY(Category = StreetMap, EditAnywhere, BlueprintReadWrite)
+	FStreetMapQueryFilter Filter;
+};
+
+
+/**
+ * Snaps GPS traces onto a street map's roads with a hidden Markov model, after Newson and Krumm's "Hidden Markov Map
+ * Matching Through Noise and Sparseness".  Each sample's candidates are the nearest locations on the roads around it,
+ * likelier the closer they are.  Moving from one sample's candidate to the next one's is likelier the closer the distance
+ * driven along the road graph is to the straight line between the samples, so a trace can't hop onto a parallel street
+ * it would take a detour to reach.  The Viterbi algorithm then picks the likeliest candidate for every sample at once.
+ *
+ * A matcher only reads the snapshot it was made with, so any number of threads can share one as long as each has its own
+ * scratch space.
+ */
+class STREETMAPRUNTIME_API FStreetMapMapMatcher
+{
+public:
+
+	/** Memory one thread reuses from one trace to the next */
+	struct FScratch
+	{
+		/** Candidates of the sample being searched */
+		TArray<FStreetMapRoadLocation> SampleCandidates;
+
+		/** Candidates of every sample, back to back */
+		TArray<FStreetMapRoadLocation> Candidates;
+
+		/** Offset of each sample's first candidate in Candidates, plus one past the end */
+		TArray<int32> CandidateOffsets;
+
+		/** Log probability of the likeliest path ending at each candidate */
+		TArray<double> Scores;
+
+		/** Candidate before each candidate on the likeliest path ending there, or INDEX_NONE where a path starts */
+		TArray<int32> Previous;
+
+		/** Route distances from one candidate to each of the next sample's candidates */
+		TArray<double> RouteDistances;
+
+		/** A graph node a route can end at, and how far along the road the candidate it leads to is from there */
+		struct FRouteEnd
+		{
+			int32 NodeIndex;
+			double Distance;
+			int32 CandidateIndex;
+		};
+		TArray<FRouteEnd> RouteEnds;
+
+		/** Shortest distance found to each graph node, by node index.  Only valid where NodeSearchIds matches SearchId. */
+		TArray<double> NodeDistances;
+
+		/** The search that last reached each graph node, so starting a search doesn't have to clear NodeDistances */
+		TArray<uint32> NodeSearchIds;
+
+		/** The search running now */
+		uint32 SearchId = 0;
+
+		/** Graph nodes left to visit, as (distance, node) pairs in a min heap */
+		TArray<TPair<double, int32>> Queue;
+	};
+
+	/**
+	 * @param	InSnapshot			Snapshot whose roads, road graph and road segment index to match with.  The matcher
+	 *								keeps it alive, and builds its derived data if it isn't there yet.
+	 * @param	Settings			Matching settings
+	 * @param	WorldToMapScale		Map units per unit of the settings' distances
+	 */
+	FStreetMapMapMatcher(const TSharedRef<const FStreetMapSnapshot, ESPMode::ThreadSafe>& InSnapshot, const FStreetMapMapMatchSettings& Settings, double WorldToMapScale = 1.0);
+
+	/**
+	 * Matches one trace
+	 *
+	 * @param	Samples				The trace's samples in map space, in the order they were recorded
+	 * @param	OutRoadLocations	Receives the road location of each sample, which is invalid for samples with no road
+	 *								nearby.  Distance is from the sample, in map units.  Must be as long as Samples.
+	 * @param	Scratch				Memory to reuse
+	 */
+	void MatchTrace(TArrayView<const FVector2D> Samples, TArrayView<FStreetMapRoadLocation> OutRoadLocations, FScratch& Scratch) const;
+
+private:
+
+	/** Finds the shortest distance driven from one candidate to each of the next sample's candidates, or MAX_dbl where there
+	    is no route shorter than MaxDistance */
+	void FindRouteDistances(const FStreetMapRoadLocation& From, TArrayView<const FStreetMapRoadLocation> To, double MaxDistance, TArrayView<double> OutDistances, FScratch& Scratch) const;
+
+	/** Follows the likeliest path back from the last sample of a run of connected samples, [FirstSample, EndSample) */
+	void Backtrack(int32 FirstSample, int32 EndSample, TArrayView<FStreetMapRoadLocation> OutRoadLocations, const FScratch& Scratch) const;
+
+	/** The snapshot matched against, and the derived data built from it */
+	TSharedRef<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot;
+	TSharedRef<const FStreetMapDerivedData, ESPMode::ThreadSafe> DerivedDataRef;
+
+	TArrayView<const FStreetMapRoad> Roads;
+	const FStreetMapDerivedData& DerivedData;
+
+	/** Settings, in map units */
+	double SearchRadius;
+	int32 MaxCandidates;
+	double GpsNoise;
+	double RouteDeviation;
+	double MaxDetour;
+	FStreetMapQueryFilter Filter;
+};
@@ -0,0 +1,95 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+class UStreetMap;
+class UStreetMapComponent;
+
+/**
+ * Low level memory tracker tags for street map data.  Run with -llm (or -llmcsv) to see them under "StreetMap".
+ *
+ *	Payload			Roads, nodes, buildings, names, OpenStreetMap IDs and grid cells of street map assets.  Published
+ *					data keeps this tag after it moves into a snapshot.
+ *	Lookup			Tables built from the payload at runtime: cell map, name interning map, and the OpenStreetMap ID and
+ *					name indices of snapshots
+ *	DerivedData		Building triangles, the road graph and spatial indices
+ *	Snapshot		Immutable snapshots handed to other threads
+ *	Mesh			CPU copies of component meshes
+ *	RenderBuffers	Vertex and index buffers of component scene proxies
+ *	Collision		Body setups and physics meshes built from component meshes
+ *	Loading			OpenStreetMap files being parsed
+ */
+LLM_DECLARE_TAG_API(StreetMap, STREETMAPRUNTIME_API);
+LLM_DECLARE_TAG_API(StreetMap_Payload, STREETMAPRUNTIME_API);
+LLM_DECLARE_TAG_API(StreetMap_Lookup, STREETMAPRUNTIME_API);
+LLM_DECLARE_TAG_API(StreetMap_DerivedData, STREETMAPRUNTIME_API);
+LLM_DECLARE_TAG_API(StreetMap_Snapshot, STREETMAPRUNTIME_API);
+LLM_DECLARE_TAG_API(StreetMap_Mesh, STREETMAPRUNTIME_API);
+LLM_DECLARE_TAG_API(StreetMap_RenderBuffers, STREETMAPRUNTIME_API);
+LLM_DECLARE_TAG_API(StreetMap_Collision, STREETMAPRUNTIME_API);
+LLM_DECLARE_TAG_API(StreetMap_Loading, STREETMAPRUNTIME_API);
+
+
+/** Bytes used by a street map asset or component, split up the same way as the low level memory tracker tags */
+struct STREETMAPRUNTIME_API FStreetMapMemoryUsage
+{
+	/** Grid cells, plus roads, nodes, buildings, names and OpenStreetMap IDs while they're being edited */
+	SIZE_T Payload = 0;
+
+	/** Lookup tables built from the payload */
+	SIZE_T Lookup = 0;
+
+	/** Building triangles, the road graph and spatial indices */
+	SIZE_T DerivedData = 0;
+
+	/** The currently published snapshot, which owns the map's data unless it is being edited */
+	SIZE_T Snapshot = 0;
+
+	/** CPU copy of the component mesh */
+	SIZE_T CPUMesh = 0;
+
+	/** Vertex and index buffers of the component's scene proxy */
+	SIZE_T GPUBuffers = 0;
+
+	/** Body setup and physics meshes */
+	SIZE_T Collision = 0;
+
+	/** Gets the number of bytes in system memory */
+	SIZE_T GetSystemMemory() const
+	{
+		return Payload + Lookup + DerivedData + Snapshot + CPUMesh + Collision;
+	}
+
+	/** Gets the number of bytes in all categories */
+	SIZE_T GetTotal() const
+	{
+		return GetSystemMemory() + GPUBuffers;
+	}
+
+	FStreetMapMemoryUsage& operator+=(const FStreetMapMemoryUsage& Other);
+};
+
+
+/** Prints how much memory street map assets and components use */
+class STREETMAPRUNTIME_API FStreetMapMemoryReport
+{
+public:
+
+	/** Prints one line per loaded street map asset and one line per street map component, followed by totals */
+	static void Print(FOutputDevice& Ar);
+
+	/** Prints the column headers for street map asset lines */
+	static void PrintStreetMapHeader(FOutputDevice& Ar);
+
+	/** Prints one line for a street map asset */
+	static void PrintStreetMap(FOutputDevice& Ar, const UStreetMap& StreetMap, const FStreetMapMemoryUsage& Usage);
+
+	/** Prints the column headers for street map component lines */
+	static void PrintComponentHeader(FOutputDevice& Ar);
+
+	/** Prints one line for a street map component */
+	static void PrintComponent(FOutputDevice& Ar, const UStreetMapComponent& Component, const FStreetMapMemoryUsage& Usage);
+};
@@ -0,0 +1,170 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StreetMap.h"
+#include "StreetMapNameIndex.generated.h"
+
+class UStreetMapComponent;
+
+/** A road or building name found by searching, with the features that have it */
+USTRUCT(BlueprintType)
+struct STREETMAPRUNTIME_API FStreetMapNamedFeatures
+{
+	GENERATED_BODY()
+
+	/** The name, as it is in the street map's name table */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	FString Name;
+
+	/** Indices of the roads with this name */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TArray<int32> RoadIndices;
+
+	/** Indices of the buildings with this name */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TArray<int32> BuildingIndices;
+
+	/** How many characters had to be inserted, removed or changed for the search text to match.  Zero for exact matches. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	int32 EditDistance = 0;
+
+	/** Street map the features are on */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<UStreetMap> StreetMap = nullptr;
+
+	/** Component showing that street map, or null for street maps registered without one */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<UStreetMapComponent> Component = nullptr;
+};
+
+
+/** A name found in an FStreetMapNameIndex */
+struct FStreetMapNameIndexMatch
+{
+	/** Index of the name's entry in the name index */
+	int32 EntryIndex;
+
+	/** Edits it took to match the name */
+	int32 EditDistance;
+
+	/** Where the word that matched starts in the normalized name */
+	int32 WordOffset;
+};
+
+
+/**
+ * Index over the road and building names of a street map, for search as you type.  Names are normalized first: case is
+ * folded, accents are removed (for Latin, Greek and Cyrillic letters), apostrophes are dropped and other punctuation
+ * separates words, so "st. peter's" finds "St Peters Straße".  Every word of every name is kept in one array, sorted
+ * by the rest of the name from that word on.  That makes a sorted suffix array over word starts, so "main" finds both
+ * "Main Street" and "North Main Street" with one binary search.  The same array walked as an implicit trie answers
+ * fuzzy lookups, which tolerate typos.
+ *
+ * Each name has one entry, with all roads and buildings that have that name.
+ */
+class STREETMAPRUNTIME_API FStreetMapNameIndex
+{
+public:
+
+	/** Builds the index over the names of the specified roads and buildings */
+	void Build(TArrayView<const FStreetMapRoad> Roads, TArrayView<const FStreetMapBuilding> Buildings, TArrayView<const FString> Names);
+
+	/** Normalizes a name or search text the way the index compares them */
+	static FString Normalize(FStringView Text);
+
+	/**
+	 * Finds names with a word that starts with the specified text
+	 *
+	 * @param	Prefix			Text to search for.  It is normalized the same way names are.
+	 * @param	MaxResults		Most names to find
+	 * @param	OutMatches		Receives the names found, in alphabetical order of the name from the matching word on
+	 */
+	void FindByPrefix(FStringView Prefix, int32 MaxResults, TArray<FStreetMapNameIndexMatch>& OutMatches) const;
+
+	/**
+	 * Finds names with a word that starts with something close to the specified text, such as "Mian" for "Main Street"
+	 *
+	 * @param	Prefix			Text to search for.  It is normalized the same way names are.
+	 * @param	MaxEdits		Most characters that may be inserted, removed or changed to match.  Always less than the
+	 *							length of the normalized text, or any name would match.
+	 * @param	MaxResults		Most names to find
+	 * @param	OutMatches		Receives the names found, fewest edits first, then in alphabetical order of the name from
+	 *							the matching word on
+	 */
+	void FindByFuzzyPrefix(FStringView Prefix, int32 MaxEdits, int32 MaxResults, TArray<FStreetMapNameIndexMatch>& OutMatches) const;
+
+	/** Gets the number of names in the index */
+	int32 GetEntryCount() const
+	{
+		return NameIds.Num();
+	}
+
+	/** Gets the name table ID of an entry's name */
+	int32 GetEntryNameId(const int32 EntryIndex) const
+	{
+		return NameIds[EntryIndex];
+	}
+
+	/** Gets the normalized text of a match's name from the matching word on, which is what matches are sorted by */
+	const TCHAR* GetMatchText(const FStreetMapNameIndexMatch& Match) const
+	{
+		return *NormalizedNames[Match.EntryIndex] + Match.WordOffset;
+	}
+
+	/** Gets the indices of the roads with an entry's name */
+	TArrayView<const int32> GetEntryRoads(const int32 EntryIndex) const
+	{
+		return TArrayView<const int32>(RoadIndices.GetData() + RoadOffsets[EntryIndex], RoadOffsets[EntryIndex + 1] - RoadOffsets[EntryIndex]);
+	}
+
+	/** Gets the indices of the buildings with an entry's name */
+	TArrayView<const int32> GetEntryBuildings(const int32 EntryIndex) const
+	{
+		return TArrayView<const int32>(BuildingIndices.GetData() + BuildingOffsets[EntryIndex], BuildingOffsets[EntryIndex + 1] - BuildingOffsets[EntryIndex]);
+	}
+
+	/** Gets the number of bytes this index uses */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	/** The start of a word in a normalized name */
+	struct FWord
+	{
+		int32 EntryIndex;
+		int32 Offset;
+	};
+
+	/** Gets the text of a name from a word on */
+	const TCHAR* GetWordText(const FWord& Word) const
+	{
+		return *NormalizedNames[Word.EntryIndex] + Word.Offset;
+	}
+
+	/**
+	 * Visits the words in [Begin, End), which all start with the same Depth characters, as a subtree of a trie over the
+	 * words.  Rows holds the edit distance table between the query and those characters, one row per character.
+	 * BestEdits is the fewest edits that matched the whole query at any depth so far.  Each entry keeps its best match,
+	 * and the first word found with it.
+	 */
+	void FindFuzzy(const FString& Query, int32 Begin, int32 End, int32 Depth, int32 BestEdits, int32 MaxEdits, TArray<int32>& Rows, TMap<int32, FStreetMapNameIndexMatch>& OutEntryMatches) const;
+
+	/** Name table ID of each entry */
+	TArray<int32> NameIds;
+
+	/** Normalized name of each entry */
+	TArray<FString> NormalizedNames;
+
+	/** Offset of each entry's first road in RoadIndices, plus one past the end */
+	TArray<int32> RoadOffsets;
+	TArray<int32> RoadIndices;
+
+	/** Offset of each entry's first building in BuildingIndices, plus one past the end */
+	TArray<int32> BuildingOffsets;
+	TArray<int32> BuildingIndices;
+
+	/** Start of every word of every name, sorted by the text from there on */
+	TArray<FWord> Words;
+};
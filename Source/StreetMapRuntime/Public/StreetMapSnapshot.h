@@ -0,0 +1,212 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StreetMap.h"
+
+class FStreetMapNameIndex;
+struct FStreetMapOsmIdIndex;
+struct FStreetMapDerivedData;
+
+/**
+ * Immutable version of a street map's roads, nodes, buildings and names.
+ *
+ * The published snapshot owns the street map's data: UStreetMap reads it from there, and only keeps a copy of its own
+ * while it is being edited.  UStreetMap::PublishSnapshot() moves the edited data into a new snapshot and swaps it in.
+ * Snapshots never change once they are published, so any number of threads can read one without locking.  Readers that
+ * still hold an old one keep it alive until they let go of it.
+ */
+class STREETMAPRUNTIME_API FStreetMapSnapshot
+{
+public:
+	/** Makes an empty snapshot.  Only UStreetMap fills snapshots in, before publishing them. */
+	FStreetMapSnapshot(FName InStreetMapName, uint32 InVersion);
+	~FStreetMapSnapshot();
+
+	/** Version of the street map data this snapshot was made from.  Goes up by one every time a snapshot is published. */
+	uint32 GetVersion() const
+	{
+		return Version;
+	}
+
+	/** Gets the name of the street map this snapshot was made from, for logging */
+	FName GetStreetMapName() const
+	{
+		return StreetMapName;
+	}
+
+	/** Gets all of the roads */
+	const TArray<FStreetMapRoad>& GetRoads() const
+	{
+		return Roads;
+	}
+
+	/** Gets all of the nodes */
+	const TArray<FStreetMapNode>& GetNodes() const
+	{
+		return Nodes;
+	}
+
+	/** Gets the road refs of all nodes.  Each node owns a contiguous range of this list. */
+	const TArray<FStreetMapRoadRef>& GetNodeRoadRefs() const
+	{
+		return NodeRoadRefs;
+	}
+
+	/** Gets the road refs of one node */
+	TArrayView<const FStreetMapRoadRef> GetRoadRefs(const FStreetMapNode& Node) const
+	{
+		return TArrayView<const FStreetMapRoadRef>(NodeRoadRefs.GetData() + Node.FirstRoadRef, Node.NumRoadRefs);
+	}
+
+	/** Gets all of the buildings */
+	const TArray<FStreetMapBuilding>& GetBuildings() const
+	{
+		return Buildings;
+	}
+
+	/** Gets the name table shared by all roads and buildings */
+	const TArray<FString>& GetNames() const
+	{
+		return Names;
+	}
+
+	/** Gets a name from the name table, or an empty string for INDEX_NONE */
+	const FString& GetNameById(const int32 NameId) const
+	{
+		static const FString EmptyName;
+		return Names.IsValidIndex(NameId) ? Names[NameId] : EmptyName;
+	}
+
+	/** Gets the index over road and building names, for searching them by prefix.  Built the first time it's needed. */
+	const FStreetMapNameIndex& GetNameIndex() const;
+
+	/** Gets the OpenStreetMap way ID of the specified road, or INDEX_NONE */
+	int64 GetRoadOsmId(const int32 RoadIndex) const
+	{
+		return RoadOsmIds.IsValidIndex(RoadIndex) ? RoadOsmIds[RoadIndex] : INDEX_NONE;
+	}
+
+	/** Gets the OpenStreetMap node ID of the specified node, or INDEX_NONE */
+	int64 GetNodeOsmId(const int32 NodeIndex) const
+	{
+		return NodeOsmIds.IsValidIndex(NodeIndex) ? NodeOsmIds[NodeIndex] : INDEX_NONE;
+	}
+
+	/** Gets the OpenStreetMap way ID of the specified building, or INDEX_NONE */
+	int64 GetBuildingOsmId(const int32 BuildingIndex) const
+	{
+		return BuildingOsmIds.IsValidIndex(BuildingIndex) ? BuildingOsmIds[BuildingIndex] : INDEX_NONE;
+	}
+
+	/** Gets the OpenStreetMap IDs of all roads, nodes and buildings, in the same order as the features.  Empty for maps
+	    imported without IDs. */
+	const TArray<int64>& GetRoadOsmIds() const
+	{
+		return RoadOsmIds;
+	}
+	const TArray<int64>& GetNodeOsmIds() const
+	{
+		return NodeOsmIds;
+	}
+	const TArray<int64>& GetBuildingOsmIds() const
+	{
+		return BuildingOsmIds;
+	}
+
+	/** Finds the index of the road that was imported from the specified OpenStreetMap way, or INDEX_NONE.  The first lookup builds an ID index. */
+	int32 FindRoadIndexByOsmId(const int64 OsmWayId) const;
+
+	/** Finds the index of the node that was imported from the specified OpenStreetMap node, or INDEX_NONE.  The first lookup builds an ID index. */
+	int32 FindNodeIndexByOsmId(const int64 OsmNodeId) const;
+
+	/** Finds the index of the building that was imported from the specified OpenStreetMap way, or INDEX_NONE.  The first lookup builds an ID index. */
+	int32 FindBuildingIndexByOsmId(const int64 OsmWayId) const;
+
+	/** Gets the bounding box of the map */
+	FVector2D GetBoundsMin() const
+	{
+		return BoundsMin;
+	}
+	FVector2D GetBoundsMax() const
+	{
+		return BoundsMax;
+	}
+
+	/** Gets the edge length of the map's grid cells */
+	double GetCellSize() const
+	{
+		return CellSize;
+	}
+
+	/**
+	 * Gets the runtime data derived from this snapshot: building triangles, the road graph and spatial indices.  Its
+	 * indices always refer to this snapshot's roads, nodes and buildings.  Cooked maps hand over the copy they loaded.
+	 * Otherwise it's built the first time it's needed (through the derived data cache, in the editor), which can take a
+	 * while for large maps.  The lock is not held meanwhile, so readers that already have it aren't held up, and threads
+	 * that ask for it at the same time may each build it, but all of them get the same copy back.
+	 */
+	TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> GetDerivedData() const;
+
+	/** Gets the derived data if it was already loaded or built, or null.  Never builds it. */
+	TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> FindDerivedData() const;
+
+#if WITH_EDITOR
+	/** Gets the derived data cache key of this snapshot's derived data, which hashes everything it is built from */
+	FString GetDerivedDataKey() const;
+#endif
+
+	/** Gets the number of bytes this snapshot uses, not counting its derived data */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	/** Moves edited data in before publishing */
+	friend class UStreetMap;
+
+	/** Gets the OpenStreetMap ID index, building it on first use */
+	const FStreetMapOsmIdIndex& GetOsmIdIndex() const;
+
+	/** Builds derived data from this snapshot.  In the editor, the derived data cache is checked first. */
+	TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> BuildDerivedData() const;
+
+	uint32 Version;
+	FName StreetMapName;
+
+	TArray<FStreetMapRoad> Roads;
+	TArray<FStreetMapNode> Nodes;
+	TArray<FStreetMapRoadRef> NodeRoadRefs;
+	TArray<FStreetMapBuilding> Buildings;
+	TArray<FString> Names;
+
+	TArray<int64> RoadOsmIds;
+	TArray<int64> NodeOsmIds;
+	TArray<int64> BuildingOsmIds;
+
+	FVector2D BoundsMin;
+	FVector2D BoundsMax;
+	double CellSize;
+
+	/** Hash index from OpenStreetMap IDs to feature indices.  Built on first use, then never changed, like the rest of the
+	    snapshot, so a reference to it stays valid for as long as the snapshot is held. */
+	mutable std::atomic<FStreetMapOsmIdIndex*> OsmIdIndex { nullptr };
+
+	/** Guards lazy creation of OsmIdIndex */
+	mutable FCriticalSection OsmIdIndexCriticalSection;
+
+	/** Built on first use, then never changed, like the rest of the snapshot */
+	mutable std::atomic<FStreetMapNameIndex*> NameIndex { nullptr };
+
+	/** Guards lazy creation of NameIndex */
+	mutable FCriticalSection NameIndexCriticalSection;
+
+	/** Derived data, either loaded with a cooked map or built on first use.  Never changes once it is set. */
+	mutable TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> DerivedData;
+
+	/** Guards the DerivedData pointer */
+	mutable FRWLock DerivedDataLock;
+};
+
+/** Shared, thread safe reference to an immutable street map snapshot */
+using FStreetMapSnapshotPtr = TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe>;
@@ -0,0 +1,915 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StreetMap.h"
+#include "StreetMapSpatialIndex.generated.h"
+
+class UStreetMapComponent;
+
+/** A location on a road, found by projecting a point onto the nearest segment of the road */
+USTRUCT(BlueprintType)
+struct STREETMAPRUNTIME_API FStreetMapRoadLocation
+{
+	GENERATED_BODY()
+
+	/** Index of the road, or INDEX_NONE if no road was found */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	int32 RoadIndex = INDEX_NONE;
+
+	/** Index of the road point the segment starts at.  The segment ends at the next road point. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	int32 SegmentIndex = INDEX_NONE;
+
+	/** How far along the segment the location is, from 0 at its first road point to 1 at its last */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	float SegmentAlpha = 0.0f;
+
+	/** Distance from the start of the road to the location.  FStreetMapRoad::MakeLocationAlongRoad() takes the same value. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	float PositionAlongRoad = 0.0f;
+
+	/** The location on the road, in map space */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	FVector2D Location = FVector2D::ZeroVector;
+
+	/** Distance from the query location to Location.  In world units for street map subsystem queries, otherwise map units. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	float Distance = 0.0f;
+
+	/** The location on the road, in world space.  Only filled in by street map subsystem queries. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	FVector WorldLocation = FVector::ZeroVector;
+
+	/** Street map the road is on.  Only filled in by street map subsystem queries. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<UStreetMap> StreetMap = nullptr;
+
+	/** Component showing that street map, or null for street maps registered without one.  Only filled in by street map
+	    subsystem queries. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<UStreetMapComponent> Component = nullptr;
+
+	/** @return True if a road was found */
+	bool IsValid() const
+	{
+		return RoadIndex != INDEX_NONE;
+	}
+};
+
+
+/** A road point found by a street map subsystem query, which may search several street maps */
+USTRUCT(BlueprintType)
+struct STREETMAPRUNTIME_API FStreetMapRoadPointRef
+{
+	GENERATED_BODY()
+
+	/** Index of the road in its street map, or INDEX_NONE if no road point was found */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	int32 RoadIndex = INDEX_NONE;
+
+	/** Index of the point on the road, or INDEX_NONE if no road point was found */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	int32 PointIndex = INDEX_NONE;
+
+	/** Street map the road is on */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<UStreetMap> StreetMap = nullptr;
+
+	/** Component showing that street map, or null for street maps registered without one */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<UStreetMapComponent> Component = nullptr;
+
+	/** The road point, in world space */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	FVector WorldLocation = FVector::ZeroVector;
+
+	/** Distance from the query location to the road point, in world units */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	float Distance = 0.0f;
+
+	/** @return True if a road point was found */
+	bool IsValid() const
+	{
+		return RoadIndex != INDEX_NONE;
+	}
+};
+
+
+/** A building found by a street map subsystem query, which may search several street maps */
+USTRUCT(BlueprintType)
+struct STREETMAPRUNTIME_API FStreetMapBuildingRef
+{
+	GENERATED_BODY()
+
+	/** Index of the building in its street map, or INDEX_NONE if no building was found */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	int32 BuildingIndex = INDEX_NONE;
+
+	/** Street map the building is in */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<UStreetMap> StreetMap = nullptr;
+
+	/** Component showing that street map, or null for street maps registered without one */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<UStreetMapComponent> Component = nullptr;
+
+	/** Distance from the query location to the building's footprint (zero inside it), in world units.  Only filled in by
+	    nearest building queries. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	float Distance = 0.0f;
+
+	/** @return True if a building was found */
+	bool IsValid() const
+	{
+		return BuildingIndex != INDEX_NONE;
+	}
+};
+
+
+/** A road graph node found by a street map subsystem query */
+USTRUCT(BlueprintType)
+struct STREETMAPRUNTIME_API FStreetMapNodeRef
+{
+	GENERATED_BODY()
+
+	/** Index of the node in its street map, or INDEX_NONE if no node was found */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	int32 NodeIndex = INDEX_NONE;
+
+	/** Street map the node is in */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<UStreetMap> StreetMap = nullptr;
+
+	/** Component showing that street map, or null for street maps registered without one */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<UStreetMapComponent> Component = nullptr;
+
+	/** The node's location, in world space */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	FVector WorldLocation = FVector::ZeroVector;
+
+	/** Distance from the query location to the node, in world units */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	float Distance = 0.0f;
+
+	/** @return True if a node was found */
+	bool IsValid() const
+	{
+		return NodeIndex != INDEX_NONE;
+	}
+};
+
+
+/** Narrows down what nearest neighbour queries find.  The default filter lets everything through. */
+USTRUCT(BlueprintType)
+struct STREETMAPRUNTIME_API FStreetMapQueryFilter
+{
+	GENERATED_BODY()
+
+	/** Only roads of these types are found, and only nodes on at least one road of these types.  Empty allows all types. */
+	UPROPERTY(Category = StreetMap, EditAnywhere, BlueprintReadWrite)
+	TArray<TEnumAsByte<EStreetMapRoadType>> AllowedRoadTypes;
+
+	/** Only nodes shared by at least this many roads are found.  Two leaves out the ends of dead-end roads. */
+	UPROPERTY(Category = StreetMap, EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	int32 MinNodeRoadCount = 0;
+
+	/** Only buildings at least this tall are found, in map units like FStreetMapBuilding::Height (0 = include all).  Buildings
+	    with only a level count have no height, so any minimum leaves them out. */
+	UPROPERTY(Category = StreetMap, EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	float MinBuildingHeight = 0.0f;
+
+	/** @return True if roads of the specified type pass the filter */
+	bool AllowsRoadType(const EStreetMapRoadType RoadType) const
+	{
+		return AllowedRoadTypes.Num() == 0 || AllowedRoadTypes.Contains(RoadType);
+	}
+
+	/** @return True if the building passes the filter */
+	bool AllowsBuilding(const FStreetMapBuilding& Building) const
+	{
+		return MinBuildingHeight <= 0.0f || Building.Height >= MinBuildingHeight;
+	}
+};
+
+
+/** Which part of an extruded building footprint a line trace hit */
+UENUM(BlueprintType)
+enum class EStreetMapBuildingFace : uint8
+{
+	/** One of the building's walls.  The hit's wall index says which. */
+	Wall,
+
+	/** The flat roof, at the building's height */
+	Roof,
+
+	/** The underside of the building, at ground level */
+	Floor,
+
+	/** The trace started inside the building */
+	Inside,
+};
+
+
+/** Where a line trace hit a building.  Buildings are traced as their footprints extruded from the ground up to their height. */
+USTRUCT(BlueprintType)
+struct STREETMAPRUNTIME_API FStreetMapBuildingHit
+{
+	GENERATED_BODY()
+
+	/** Index of the building hit, or INDEX_NONE if nothing was hit */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	int32 BuildingIndex = INDEX_NONE;
+
+	/** Which part of the building was hit */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	EStreetMapBuildingFace Face = EStreetMapBuildingFace::Wall;
+
+	/** For wall hits, the building point the wall starts at.  The wall ends at the next point.  Otherwise INDEX_NONE. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	int32 WallIndex = INDEX_NONE;
+
+	/** How far along the trace the hit is, from 0 at its start to 1 at its end */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	float Time = 0.0f;
+
+	/** Distance from the start of the trace to the hit.  In world units for street map subsystem queries, otherwise map units. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	float Distance = 0.0f;
+
+	/** Location of the hit.  In world space for street map subsystem queries, otherwise map space. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	FVector Location = FVector::ZeroVector;
+
+	/** Normal of the face hit, facing the start of the trace (zero for Inside hits).  In world space for street map
+	    subsystem queries, otherwise map space. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	FVector Normal = FVector::ZeroVector;
+
+	/** Street map the building is in.  Only filled in by street map subsystem queries. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<UStreetMap> StreetMap = nullptr;
+
+	/** Component showing that street map, or null for street maps registered without one.  Only filled in by street map
+	    subsystem queries. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<UStreetMapComponent> Component = nullptr;
+
+	/** @return True if a building was hit */
+	bool IsValid() const
+	{
+		return BuildingIndex != INDEX_NONE;
+	}
+};
+
+
+/** Consecutive segments of a road that are inside a volume */
+USTRUCT(BlueprintType)
+struct STREETMAPRUNTIME_API FStreetMapRoadRange
+{
+	GENERATED_BODY()
+
+	/** Index of the road */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	int32 RoadIndex = INDEX_NONE;
+
+	/** First road point of the range */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	int32 FirstPointIndex = INDEX_NONE;
+
+	/** Last road point of the range.  The segments between FirstPointIndex and LastPointIndex are at least partly inside. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	int32 LastPointIndex = INDEX_NONE;
+
+	/** Street map the road is on.  Only filled in by street map subsystem queries. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<UStreetMap> StreetMap = nullptr;
+
+	/** Component showing that street map, or null for street maps registered without one.  Only filled in by street map
+	    subsystem queries. */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<UStreetMapComponent> Component = nullptr;
+};
+
+
+/**
+ * Roads and buildings found by a street map subsystem volume query.  Keep one around and pass it to every query, so that
+ * per frame queries reuse its memory instead of allocating.
+ */
+USTRUCT(BlueprintType)
+struct STREETMAPRUNTIME_API FStreetMapVolumeQueryResult
+{
+	GENERATED_BODY()
+
+	/** The parts of roads inside the volume */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TArray<FStreetMapRoadRange> RoadRanges;
+
+	/** The buildings inside the volume */
+	UPROPERTY(Category = StreetMap, VisibleAnywhere, BlueprintReadOnly)
+	TArray<FStreetMapBuildingRef> Buildings;
+
+	/** Working space for building indices, kept so it isn't allocated again */
+	TArray<int32> ScratchBuildingIndices;
+
+	/** Empties the result, keeping its memory */
+	void Reset()
+	{
+		RoadRanges.Reset();
+		Buildings.Reset();
+		ScratchBuildingIndices.Reset();
+	}
+};
+
+
+/**
+ * A convex volume in map space, such as a box or a camera frustum, for finding the roads and buildings inside it.  The
+ * volume is bounded by planes that face out of it, the same way as FConvexVolume.
+ */
+class STREETMAPRUNTIME_API FStreetMapQueryVolume
+{
+public:
+
+	/**
+	 * Makes a volume from planes that face out of it, cut down to ClipBox so that it is never infinite (camera frustums
+	 * usually have no far plane)
+	 */
+	FStreetMapQueryVolume(TArrayView<const FPlane> InPlanes, const FBox& ClipBox);
+
+	/** @return True if nothing is inside the volume */
+	bool IsEmpty() const
+	{
+		return !Bounds.IsValid;
+	}
+
+	/** Gets the bounding box of the volume */
+	const FBox& GetBounds() const
+	{
+		return Bounds;
+	}
+
+	/** @return True if a box is at least partly inside the volume.  Boxes near the volume's corners may be let through. */
+	bool IntersectsBox(const FBox& Box) const;
+
+	/** @return True if any part of the segment from Start to End is inside the volume */
+	bool IntersectsSegment(const FVector& Start, const FVector& End) const;
+
+private:
+
+	/** Planes facing out of the volume, normalized */
+	TArray<FPlane, TInlineAllocator<12>> Planes;
+
+	/** Bounds of the corners of the volume */
+	FBox Bounds;
+};
+
+
+/** A node or building found by a nearest neighbour search, and its distance from the search location in map units */
+struct FStreetMapNearestItem
+{
+	int32 Index = INDEX_NONE;
+	double Distance = 0.0;
+};
+
+
+/**
+ * Packed bounding volume hierarchy over 2D boxes.  Nodes are 24 bytes and siblings sit next to each other, so walking
+ * down the tree touches about one cache line per level.  Bounds are stored as floats relative to the center of the tree
+ * and rounded outward, so they are never smaller than the boxes they were built from.
+ *
+ * The tree only knows items by number.  Build() hands back the order the items must be stored in, so that every leaf
+ * covers a contiguous range of them.  All item indices passed to callbacks are in that order.
+ */
+class STREETMAPRUNTIME_API FStreetMapBoundsTree
+{
+public:
+
+	/** Most items stored in one leaf */
+	static constexpr int32 MaxLeafSize = 4;
+
+	/** Builds the tree over the specified boxes.  OutItemOrder receives the original index of each item, in leaf order. */
+	void Build(TArrayView<const FBox2D> ItemBounds, TArray<int32>& OutItemOrder);
+
+	/** @return True if the tree has no items */
+	bool IsEmpty() const
+	{
+		return Nodes.Num() == 0;
+	}
+
+	/**
+	 * Finds the nearest item, nearest subtrees first.  ItemDistanceSquared(ItemIndex) returns the exact squared distance from
+	 * Location to an item.  Subtrees that are no closer than InOutBestDistanceSquared are skipped.
+	 *
+	 * @return	The nearest item closer than InOutBestDistanceSquared (which is updated to its squared distance), or INDEX_NONE
+	 */
+	template<typename ItemDistanceSquaredType>
+	int32 FindNearest(const FVector2D& Location, double& InOutBestDistanceSquared, ItemDistanceSquaredType&& ItemDistanceSquared) const;
+
+	/**
+	 * Calls Visitor(ItemIndex) for every item in a subtree that NodeOverlaps(NodeBounds) accepts.  NodeOverlaps is given the
+	 * bounds of each node, and may let through nodes that don't quite overlap.
+	 */
+	template<typename NodeOverlapsType, typename VisitorType>
+	void ForEachOverlapping(NodeOverlapsType&& NodeOverlaps, VisitorType&& Visitor) const;
+
+	/**
+	 * Visits items nearest first (best-first search), for finding the k nearest items without a guessed radius.
+	 * ItemDistanceSquared(ItemIndex) returns the exact squared distance from Location to an item, or MAX_dbl to leave the
+	 * item out.  Visitor(ItemIndex, DistanceSquared) is called for every item closer than MaxDistanceSquared, in order of
+	 * distance, until it returns false.  Only the subtrees needed to prove the order are opened.
+	 */
+	template<typename ItemDistanceSquaredType, typename VisitorType>
+	void ForEachNearest(const FVector2D& Location, double MaxDistanceSquared, ItemDistanceSquaredType&& ItemDistanceSquared, VisitorType&& Visitor) const;
+
+	/** Gets the number of bytes this tree uses */
+	SIZE_T GetAllocatedSize() const
+	{
+		return Nodes.GetAllocatedSize();
+	}
+
+	friend STREETMAPRUNTIME_API FArchive& operator<<(FArchive& Ar, FStreetMapBoundsTree& Tree);
+
+private:
+
+	struct FNode
+	{
+		/** Bounds of everything under this node, relative to the tree's origin */
+		FVector2f Min;
+		FVector2f Max;
+
+		/** For leaves, the first item.  For interior nodes, the first of the two children, which are next to each other. */
+		int32 First;
+
+		/** Number of items in a leaf, or zero for interior nodes */
+		int32 Count;
+
+		friend FArchive& operator<<(FArchive& Ar, FNode& Node)
+		{
+			Ar << Node.Min << Node.Max << Node.First << Node.Count;
+			return Ar;
+		}
+	};
+
+	/** Fills in the node at NodeIndex with items [Begin, End) of ItemOrder, splitting it further if there are too many */
+	void BuildNode(int32 NodeIndex, int32 Begin, int32 End, TArrayView<const FBox2D> ItemBounds, const TArray<FVector2D>& ItemCenters, TArray<int32>& ItemOrder);
+
+	/** Squared distance from a location relative to the origin to the closest point of a node's bounds */
+	static FORCEINLINE double NodeDistanceSquared(const FNode& Node, const FVector2D& LocalLocation)
+	{
+		const double DeltaX = FMath::Max3((double)Node.Min.X - LocalLocation.X, 0.0, LocalLocation.X - (double)Node.Max.X);
+		const double DeltaY = FMath::Max3((double)Node.Min.Y - LocalLocation.Y, 0.0, LocalLocation.Y - (double)Node.Max.Y);
+		return DeltaX * DeltaX + DeltaY * DeltaY;
+	}
+
+	/** All bounds are relative to this */
+	FVector2D Origin = FVector2D::ZeroVector;
+
+	/** All nodes.  The root is first. */
+	TArray<FNode> Nodes;
+};
+
+
+/**
+ * Spatial index over the segments between consecutive road points, for finding the nearest road to a location in
+ * O(log n) instead of testing every road point.  Roads with a single point get one zero length segment.
+ */
+class STREETMAPRUNTIME_API FStreetMapRoadSegmentIndex
+{
+public:
+
+	/** Builds the index over the specified roads */
+	void Build(TArrayView<const FStreetMapRoad> Roads);
+
+	/**
+	 * Finds the nearest location on any road, by projecting onto road segments
+	 *
+	 * @param	Roads			The roads the index was built from
+	 * @param	Location		Map space location to search from
+	 * @param	MaxDistance		Only roads closer than this are found
+	 * @param	OutRoadLocation	The location found
+	 *
+	 * @return	True if a road was found
+	 */
+	bool FindNearestLocation(TArrayView<const FStreetMapRoad> Roads, const FVector2D& Location, double MaxDistance, FStreetMapRoadLocation& OutRoadLocation) const;
+
+	/**
+	 * Finds the nearest road point
+	 *
+	 * @param	Roads			The roads the index was built from
+	 * @param	Location		Map space location to search from
+	 * @param	MaxDistance		Only road points closer than this are found
+	 * @param	OutRoadIndex	The road the point is on
+	 * @param	OutPointIndex	Index of the point on the road
+	 *
+	 * @return	True if a road point was found
+	 */
+	bool FindNearestPoint(TArrayView<const FStreetMapRoad> Roads, const FVector2D& Location, double MaxDistance, int32& OutRoadIndex, int32& OutPointIndex) const;
+
+	/**
+	 * Finds the nearest location on each of the k nearest roads
+	 *
+	 * @param	Roads				The roads the index was built from
+	 * @param	Location			Map space location to search from
+	 * @param	MaxCount			Most roads to find
+	 * @param	MaxDistance			Only roads closer than this are found
+	 * @param	RoadFilter			Returns true for the indices of roads that may be found.  Must not search for nearest roads itself.
+	 * @param	OutRoadLocations	Receives the nearest location on each road found, nearest first
+	 */
+	void FindNearestRoads(TArrayView<const FStreetMapRoad> Roads, const FVector2D& Location, int32 MaxCount, double MaxDistance, TFunctionRef<bool(int32 RoadIndex)> RoadFilter, TArray<FStreetMapRoadLocation>& OutRoadLocations) const;
+
+	/**
+	 * Finds the parts of roads inside a volume, with roads lying at Z zero
+	 *
+	 * @param	Roads				The roads the index was built from
+	 * @param	Volume				Map space volume
+	 * @param	OutRoadRanges		Runs of consecutive road segments at least partly inside the volume are added to this
+	 *								(which isn't emptied first), sorted by road and point
+	 */
+	void FindRoadsInVolume(TArrayView<const FStreetMapRoad> Roads, const FStreetMapQueryVolume& Volume, TArray<FStreetMapRoadRange>& OutRoadRanges) const;
+
+	/** Gets the number of segments in the index */
+	int32 GetSegmentCount() const
+	{
+		return Segments.Num();
+	}
+
+	/** Gets the number of bytes this index uses */
+	SIZE_T GetAllocatedSize() const
+	{
+		return Tree.GetAllocatedSize() + Segments.GetAllocatedSize();
+	}
+
+	friend STREETMAPRUNTIME_API FArchive& operator<<(FArchive& Ar, FStreetMapRoadSegmentIndex& Index);
+
+private:
+
+	struct FSegment
+	{
+		/** Road the segment is on */
+		int32 RoadIndex;
+
+		/** Road point the segment starts at */
+		int32 PointIndex;
+
+		/** Distance from the start of the road to PointIndex */
+		float PositionAlongRoad;
+
+		friend FArchive& operator<<(FArchive& Ar, FSegment& Segment)
+		{
+			Ar << Segment.RoadIndex << Segment.PointIndex << Segment.PositionAlongRoad;
+			return Ar;
+		}
+	};
+
+	/** Gets the end points of a segment.  Returns false if Roads doesn't have them, which means Roads isn't the set of roads
+	    this index was built from. */
+	static FORCEINLINE bool GetSegmentPoints(TArrayView<const FStreetMapRoad> Roads, const FSegment& Segment, const FVector2D*& OutStart, const FVector2D*& OutEnd);
+
+	/** Fills in the location on a segment nearest to Location.  The segment's points must be in Roads. */
+	void MakeRoadLocation(TArrayView<const FStreetMapRoad> Roads, int32 SegmentIndex, const FVector2D& Location, double DistanceSquared, FStreetMapRoadLocation& OutRoadLocation) const;
+
+	/** Bounding volume hierarchy over Segments */
+	FStreetMapBoundsTree Tree;
+
+	/** All segments, in the tree's leaf order */
+	TArray<FSegment> Segments;
+};
+
+
+/**
+ * Spatial index over the road graph's nodes, for finding the nodes nearest to a location.  Node locations are copied into
+ * the index in the tree's leaf order, so searching never has to jump around the node list.
+ */
+class STREETMAPRUNTIME_API FStreetMapNodeIndex
+{
+public:
+
+	/** Builds the index over the specified nodes */
+	void Build(TArrayView<const FStreetMapNode> Nodes);
+
+	/**
+	 * Finds the k nearest nodes
+	 *
+	 * @param	Location		Map space location to search from
+	 * @param	MaxCount		Most nodes to find
+	 * @param	MaxDistance		Only nodes closer than this are found
+	 * @param	NodeFilter		Returns true for the indices of nodes that may be found
+	 * @param	OutNodes		Receives the nodes found and their distances, nearest first
+	 */
+	void FindNearestNodes(const FVector2D& Location, int32 MaxCount, double MaxDistance, TFunctionRef<bool(int32 NodeIndex)> NodeFilter, TArray<FStreetMapNearestItem>& OutNodes) const;
+
+	/** Gets the number of bytes this index uses */
+	SIZE_T GetAllocatedSize() const
+	{
+		return Tree.GetAllocatedSize() + NodeIndices.GetAllocatedSize() + NodeLocations.GetAllocatedSize();
+	}
+
+	friend STREETMAPRUNTIME_API FArchive& operator<<(FArchive& Ar, FStreetMapNodeIndex& Index);
+
+private:
+
+	/** Bounding volume hierarchy over the nodes */
+	FStreetMapBoundsTree Tree;
+
+	/** Index of each node, in the tree's leaf order */
+	TArray<int32> NodeIndices;
+
+	/** Location of each node, in the tree's leaf order */
+	TArray<FVector2D> NodeLocations;
+};
+
+
+/**
+ * Uniform grid over building footprints, for finding the buildings at a location, in a circle or in a box without
+ * testing every building.  Each building is listed in every cell its bounds touch.  Candidates from the grid are tested
+ * against their bounds, then against their actual footprint polygons, so large or L-shaped buildings are found exactly
+ * where they are.
+ */
+class STREETMAPRUNTIME_API FStreetMapBuildingIndex
+{
+public:
+
+	/** Builds the index over the specified buildings */
+	void Build(TArrayView<const FStreetMapBuilding> Buildings);
+
+	/**
+	 * Finds the building whose footprint contains a location
+	 *
+	 * @param	Buildings	The buildings the index was built from
+	 * @param	Location	Map space location
+	 *
+	 * @return	Index of the building, or INDEX_NONE.  If footprints overlap, any of the buildings containing the location.
+	 */
+	int32 FindBuildingAt(TArrayView<const FStreetMapBuilding> Buildings, const FVector2D& Location) const;
+
+	/**
+	 * Finds all buildings whose footprints are at least partly inside a circle.  Buildings are added to OutBuildingIndices
+	 * (which isn't emptied first) in no particular order.
+	 */
+	void FindBuildingsInCircle(TArrayView<const FStreetMapBuilding> Buildings, const FVector2D& Center, double Radius, TArray<int32>& OutBuildingIndices) const;
+
+	/**
+	 * Finds all buildings whose footprints are at least partly inside a box.  Buildings are added to OutBuildingIndices
+	 * (which isn't emptied first) in no particular order.
+	 */
+	void FindBuildingsInBox(TArrayView<const FStreetMapBuilding> Buildings, const FBox2D& Box, TArray<int32>& OutBuildingIndices) const;
+
+	/**
+	 * Finds the k buildings whose footprints are nearest to a location.  Buildings containing the location are at distance
+	 * zero.  Cells are searched in rings around the location, and the search stops once no unsearched cell can hold
+	 * anything nearer than the buildings already found.
+	 *
+	 * @param	Buildings		The buildings the index was built from
+	 * @param	Location		Map space location to search from
+	 * @param	MaxCount		Most buildings to find
+	 * @param	MaxDistance		Only buildings closer than this are found
+	 * @param	BuildingFilter	Returns true for the indices of buildings that may be found.  Must not search for nearest
+	 *							buildings or trace against buildings itself.
+	 * @param	OutBuildings	Receives the buildings found and their distances, nearest first
+	 */
+	void FindNearestBuildings(TArrayView<const FStreetMapBuilding> Buildings, const FVector2D& Location, int32 MaxCount, double MaxDistance, TFunctionRef<bool(int32 BuildingIndex)> BuildingFilter, TArray<FStreetMapNearestItem>& OutBuildings) const;
+
+	/**
+	 * Finds all buildings at least partly inside a volume, with buildings extruded from the ground up to their height.
+	 * Buildings are added to OutBuildingIndices (which isn't emptied first) in no particular order.  They are tested by
+	 * their bounds, so buildings just outside the corners of the volume may be found too.
+	 */
+	void FindBuildingsInVolume(TArrayView<const FStreetMapBuilding> Buildings, const FStreetMapQueryVolume& Volume, double LevelHeight, TArray<int32>& OutBuildingIndices) const;
+
+	/**
+	 * Finds the first building a line segment hits, with buildings extruded from the ground (Z zero) up to their height.
+	 * Only the grid cells under the segment are visited, in order from its start, so the search stops at the first cell
+	 * beyond the nearest hit.
+	 *
+	 * @param	Buildings		The buildings the index was built from
+	 * @param	Start			Map space start of the segment.  Z is in map units, like the street map mesh.
+	 * @param	End				Map space end of the segment
+	 * @param	LevelHeight		Height of one level, for buildings with a level count but no height
+	 * @param	MaxTime			Only hits before this fraction of the way from Start to End are found
+	 * @param	OutHit			The hit found, in map space
+	 *
+	 * @return	True if a building was hit
+	 */
+	bool LineTrace(TArrayView<const FStreetMapBuilding> Buildings, const FVector& Start, const FVector& End, double LevelHeight, double MaxTime, FStreetMapBuildingHit& OutHit) const;
+
+	/** Gets how tall a building is extruded, in map units.  This is the height the street map mesh gives it. */
+	static double GetBuildingHeight(const FStreetMapBuilding& Building, double LevelHeight)
+	{
+		return Building.Height > 0.0 ? Building.Height : Building.BuildingLevels * LevelHeight;
+	}
+
+	/** Gets the size of one grid cell, in map units */
+	double GetCellSize() const
+	{
+		return CellSize;
+	}
+
+	/** Gets the number of bytes this index uses */
+	SIZE_T GetAllocatedSize() const
+	{
+		return CellOffsets.GetAllocatedSize() + CellBuildings.GetAllocatedSize();
+	}
+
+	friend STREETMAPRUNTIME_API FArchive& operator<<(FArchive& Ar, FStreetMapBuildingIndex& Index);
+
+private:
+
+	/** Aim for about this many buildings per cell */
+	static constexpr double TargetBuildingsPerCell = 4.0;
+
+	/** Gets the range of cells a box touches, clamped to the grid.  Returns false if the box is entirely outside the grid. */
+	bool GetCellRange(const FBox2D& Box, FIntPoint& OutMinCell, FIntPoint& OutMaxCell) const;
+
+	/**
+	 * Calls Visitor(BuildingIndex, Building) once for every building whose bounds overlap Box, even ones listed in several
+	 * of the cells the box touches
+	 */
+	template<typename VisitorType>
+	void ForEachBuildingOverlapping(TArrayView<const FStreetMapBuilding> Buildings, const FBox2D& Box, VisitorType&& Visitor) const;
+
+	/** Map space location of the corner of the grid's first cell */
+	FVector2D Origin = FVector2D::ZeroVector;
+
+	/** Width and height of every cell, in map units */
+	double CellSize = 1.0;
+
+	/** Number of cells along each axis */
+	FIntPoint CellCount = FIntPoint::ZeroValue;
+
+	/** Offset of each cell's buildings in CellBuildings, plus one past the end (compressed sparse row layout).  Cells are
+	    stored in rows along X. */
+	TArray<int32> CellOffsets;
+
+	/** Building indices listed in all cells, back to back */
+	TArray<int32> CellBuildings;
+};
+
+
+template<typename ItemDistanceSquaredType>
+int32 FStreetMapBoundsTree::FindNearest(const FVector2D& Location, double& InOutBestDistanceSquared, ItemDistanceSquaredType&& ItemDistanceSquared) const
+{
+	int32 BestItemIndex = INDEX_NONE;
+	if (Nodes.Num() == 0)
+	{
+		return BestItemIndex;
+	}
+
+	struct FStackEntry
+	{
+		int32 NodeIndex;
+		double DistanceSquared;
+	};
+
+	// Deep enough for trees over many millions of items without touching the heap
+	TArray<FStackEntry, TInlineAllocator<64>> Stack;
+
+	const FVector2D LocalLocation = Location - Origin;
+	Stack.Add({ 0, NodeDistanceSquared(Nodes[0], LocalLocation) });
+	while (Stack.Num() > 0)
+	{
+		const FStackEntry Entry = Stack.Pop(EAllowShrinking::No);
+		if (Entry.DistanceSquared >= InOutBestDistanceSquared)
+		{
+			continue;
+		}
+
+		const FNode& Node = Nodes[Entry.NodeIndex];
+		if (Node.Count > 0)
+		{
+			for (int32 ItemIndex = Node.First; ItemIndex < Node.First + Node.Count; ++ItemIndex)
+			{
+				const double DistanceSquared = ItemDistanceSquared(ItemIndex);
+				if (DistanceSquared < InOutBestDistanceSquared)
+				{
+					InOutBestDistanceSquared = DistanceSquared;
+					BestItemIndex = ItemIndex;
+				}
+			}
+		}
+		else
+		{
+			// Push the farther child first, so that the nearer one is searched first and tightens the bound sooner
+			const int32 NearChild = Node.First;
+			const double NearDistanceSquared = NodeDistanceSquared(Nodes[NearChild], LocalLocation);
+			const double FarDistanceSquared = NodeDistanceSquared(Nodes[NearChild + 1], LocalLocation);
+			const bool bSwap = FarDistanceSquared < NearDistanceSquared;
+
+			const FStackEntry NearEntry = { bSwap ? NearChild + 1 : NearChild, bSwap ? FarDistanceSquared : NearDistanceSquared };
+			const FStackEntry FarEntry = { bSwap ? NearChild : NearChild + 1, bSwap ? NearDistanceSquared : FarDistanceSquared };
+			if (FarEntry.DistanceSquared < InOutBestDistanceSquared)
+			{
+				Stack.Add(FarEntry);
+			}
+			if (NearEntry.DistanceSquared < InOutBestDistanceSquared)
+			{
+				Stack.Add(NearEntry);
+			}
+		}
+	}
+
+	return BestItemIndex;
+}
+
+
+template<typename ItemDistanceSquaredType, typename VisitorType>
+void FStreetMapBoundsTree::ForEachNearest(const FVector2D& Location, const double MaxDistanceSquared, ItemDistanceSquaredType&& ItemDistanceSquared, VisitorType&& Visitor) const
+{
+	if (Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	// Nodes and items share one queue ordered by distance.  Items are stored as ~ItemIndex, so they can't be confused with
+	// nodes.  When an item comes off the queue, everything still in it is at least as far away, so the item is next.
+	struct FQueueEntry
+	{
+		int32 Index;
+		double DistanceSquared;
+	};
+	const auto IsNearer = [](const FQueueEntry& A, const FQueueEntry& B)
+	{
+		return A.DistanceSquared < B.DistanceSquared;
+	};
+
+	TArray<FQueueEntry, TInlineAllocator<64>> Queue;
+
+	const FVector2D LocalLocation = Location - Origin;
+	const double RootDistanceSquared = NodeDistanceSquared(Nodes[0], LocalLocation);
+	if (RootDistanceSquared < MaxDistanceSquared)
+	{
+		Queue.HeapPush({ 0, RootDistanceSquared }, IsNearer);
+	}
+	while (Queue.Num() > 0)
+	{
+		FQueueEntry Entry;
+		Queue.HeapPop(Entry, IsNearer, EAllowShrinking::No);
+		if (Entry.Index < 0)
+		{
+			if (!Visitor(~Entry.Index, Entry.DistanceSquared))
+			{
+				return;
+			}
+			continue;
+		}
+
+		const FNode& Node = Nodes[Entry.Index];
+		if (Node.Count > 0)
+		{
+			for (int32 ItemIndex = Node.First; ItemIndex < Node.First + Node.Count; ++ItemIndex)
+			{
+				const double DistanceSquared = ItemDistanceSquared(ItemIndex);
+				if (DistanceSquared < MaxDistanceSquared)
+				{
+					Queue.HeapPush({ ~ItemIndex, DistanceSquared }, IsNearer);
+				}
+			}
+		}
+		else
+		{
+			for (int32 ChildIndex = Node.First; ChildIndex < Node.First + 2; ++ChildIndex)
+			{
+				const double DistanceSquared = NodeDistanceSquared(Nodes[ChildIndex], LocalLocation);
+				if (DistanceSquared < MaxDistanceSquared)
+				{
+					Queue.HeapPush({ ChildIndex, DistanceSquared }, IsNearer);
+				}
+			}
+		}
+	}
+}
+
+
+template<typename NodeOverlapsType, typename VisitorType>
+void FStreetMapBoundsTree::ForEachOverlapping(NodeOverlapsType&& NodeOverlaps, VisitorType&& Visitor) const
+{
+	if (Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(0);
+	while (Stack.Num() > 0)
+	{
+		const FNode& Node = Nodes[Stack.Pop(EAllowShrinking::No)];
+		if (!NodeOverlaps(FBox2D(Origin + FVector2D(Node.Min), Origin + FVector2D(Node.Max))))
+		{
+			continue;
+		}
+
+		if (Node.Count > 0)
+		{
+			for (int32 ItemIndex = Node.First; ItemIndex < Node.First + Node.Count; ++ItemIndex)
+			{
+				Visitor(ItemIndex);
+			}
+		}
+		else
+		{
+			Stack.Add(Node.First + 1);
+			Stack.Add(Node.First);
+		}
+	}
+}
@@ -0,0 +1,51 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+/** Street map stats.  Use "stat StreetMap" to see them in game. */
+DECLARE_STATS_GROUP(TEXT("StreetMap"), STATGROUP_StreetMap, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Load OSM File"), STAT_StreetMap_LoadOSMFile, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Convert OSM File"), STAT_StreetMap_ConvertOSMFile, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Derived Data"), STAT_StreetMap_BuildDerivedData, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Publish Snapshot"), STAT_StreetMap_PublishSnapshot, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Load Or Generate Mesh"), STAT_StreetMap_LoadOrGenerateMesh, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate Mesh"), STAT_StreetMap_GenerateMesh, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate Collision"), STAT_StreetMap_GenerateCollision, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Get Collision Triangles"), STAT_StreetMap_GetPhysicsTriMeshData, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Create Scene Proxy"), STAT_StreetMap_CreateSceneProxy, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Nearest Road Point"), STAT_StreetMap_FindNearestRoadPoint, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Nearest Road Location"), STAT_StreetMap_FindNearestRoadLocation, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Buildings In Radius"), STAT_StreetMap_FindBuildingsInRadius, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Building At Location"), STAT_StreetMap_FindBuildingAtLocation, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Buildings In Box"), STAT_StreetMap_FindBuildingsInBox, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Nearest Roads"), STAT_StreetMap_FindNearestRoads, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Nearest Nodes"), STAT_StreetMap_FindNearestNodes, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Nearest Buildings"), STAT_StreetMap_FindNearestBuildings, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Features In Volume"), STAT_StreetMap_FindFeaturesInVolume, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Line Trace Buildings"), STAT_StreetMap_LineTraceBuildings, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Features By Name"), STAT_StreetMap_FindFeaturesByName, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Nearest Road Points (Batch)"), STAT_StreetMap_FindNearestRoadPoints, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Nearest Road Locations (Batch)"), STAT_StreetMap_FindNearestRoadLocations, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Buildings At Locations (Batch)"), STAT_StreetMap_FindBuildingsAtLocations, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Buildings In Radius (Batch)"), STAT_StreetMap_FindBuildingsInRadiusBatch, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Line Trace Buildings (Batch)"), STAT_StreetMap_LineTraceBuildingsBatch, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Match Traces"), STAT_StreetMap_MatchTraces, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Component Meshes"), STAT_StreetMap_MeshMemory, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Render Buffers"), STAT_StreetMap_RenderBufferMemory, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Scene Proxy Vertices"), STAT_StreetMap_ProxyVertices, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Scene Proxy Triangles"), STAT_StreetMap_ProxyTriangles, STATGROUP_StreetMap, STREETMAPRUNTIME_API);
+
+/** Unreal Insights channel for street map work.  Enable it with -trace=cpu,StreetMap. */
+UE_TRACE_CHANNEL_EXTERN(StreetMapChannel, STREETMAPRUNTIME_API);
+
+/** Times a scope with one of the cycle stats above, and shows it in Unreal Insights on the StreetMap channel */
+#define STREETMAP_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, StreetMapChannel)
@@ -4,10 +4,20 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/WorldSubsystem.h"
+#include "Async/Future.h"
+#include "Engine/LatentActionManager.h"
+#include "Camera/CameraTypes.h"
+#include "Templates/PimplPtr.h"
+#include "StreetMapSpatialIndex.h"
+#include "StreetMapMapMatcher.h"
+#include "StreetMapNameIndex.h"
 #include "StreetMapSubsystem.generated.h"
 
 class UStreetMap;
 class UStreetMapComponent;
+class FStreetMapSnapshot;
+struct FStreetMapDerivedData;
+struct FConvexVolume;
 
 /**
  * Subsystem for managing street map data within a world.
@@ -75,25 +85,256 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "StreetMap")
 	TArray<UStreetMapComponent*> GetRegisteredComponents() const;
 
+	/*
+	 * Queries search every registered street map component, and every registered street map that no component shows.
+	 * World locations are transformed into each component's map space (street maps registered without a component are
+	 * treated as if they sat at the world origin), and street maps whose bounds are out of reach are skipped.  Component
+	 * scale is assumed to be uniform.  Only X and Y matter: queries look straight down onto each street map.
+	 */
+
 	/**
 	 * Find the nearest road point to a world location
 	 * @param WorldLocation The location to search from
-	 * @param OutRoadIndex The index of the found road (or INDEX_NONE)
-	 * @param OutPointIndex The index of the point on the road (or INDEX_NONE)
-	 * @param MaxSearchDistance Maximum distance to search (0 = unlimited)
+	 * @param OutRoadPoint The street map, road and point on the road found, with its world location and distance
+	 * @param MaxSearchDistance Maximum distance to search (0 = 1km)
 	 * @return True if a road point was found
 	 */
 	UFUNCTION(BlueprintCallable, Category = "StreetMap")
-	bool FindNearestRoadPoint(const FVector& WorldLocation, int32& OutRoadIndex, int32& OutPointIndex, float MaxSearchDistance = 0.0f) const;
+	bool FindNearestRoadPoint(const FVector& WorldLocation, FStreetMapRoadPointRef& OutRoadPoint, float MaxSearchDistance = 0.0f) const;
+
+	/**
+	 * Find the nearest location on any road to a world location.  Unlike FindNearestRoadPoint(), this projects onto the
+	 * segments between road points, so it finds the middle of a long straight road instead of one of its ends.
+	 * @param WorldLocation The location to search from
+	 * @param OutRoadLocation The street map, road, segment, distance along the road and location found
+	 * @param MaxSearchDistance Maximum distance to search (0 = 1km)
+	 * @return True if a road was found
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap")
+	bool FindNearestRoadLocation(const FVector& WorldLocation, FStreetMapRoadLocation& OutRoadLocation, float MaxSearchDistance = 0.0f) const;
 
 	/**
 	 * Find all buildings within a radius
 	 * @param WorldLocation The center location
 	 * @param Radius The search radius
-	 * @return Array of building indices that are within the radius
+	 * @return The buildings whose footprints are at least partly within the radius, in no particular order
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap")
+	TArray<FStreetMapBuildingRef> FindBuildingsInRadius(const FVector& WorldLocation, float Radius) const;
+
+	/**
+	 * Find the building whose footprint contains a world location
+	 * @param WorldLocation The location to test
+	 * @return The building, which isn't valid if the location isn't inside any building
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap")
+	FStreetMapBuildingRef FindBuildingAtLocation(const FVector& WorldLocation) const;
+
+	/**
+	 * Find all buildings overlapping a box.  On rotated street maps, the box is tested in map space as the bounds of its
+	 * rotated corners, which can be a little larger.
+	 * @param WorldBox The box to search
+	 * @return The buildings whose footprints are at least partly inside the box, in no particular order
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap")
+	TArray<FStreetMapBuildingRef> FindBuildingsInBox(const FBox& WorldBox) const;
+
+	/**
+	 * Find the nearest roads to a world location, without guessing a search radius
+	 * @param WorldLocation The location to search from
+	 * @param Count Most roads to find
+	 * @param Filter Road types to find (other settings don't apply to roads)
+	 * @param MaxSearchDistance Maximum distance to search (0 = 1km)
+	 * @return The nearest location on each road found, nearest first
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap")
+	TArray<FStreetMapRoadLocation> FindNearestRoads(const FVector& WorldLocation, int32 Count, const FStreetMapQueryFilter& Filter, float MaxSearchDistance = 0.0f) const;
+
+	/**
+	 * Find the nearest road graph nodes to a world location, such as the closest intersections
+	 * @param WorldLocation The location to search from
+	 * @param Count Most nodes to find
+	 * @param Filter Road types the nodes must be on, and how many roads must meet at them
+	 * @param MaxSearchDistance Maximum distance to search (0 = 1km)
+	 * @return The nodes found, nearest first
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap")
+	TArray<FStreetMapNodeRef> FindNearestNodes(const FVector& WorldLocation, int32 Count, const FStreetMapQueryFilter& Filter, float MaxSearchDistance = 0.0f) const;
+
+	/**
+	 * Find the buildings whose footprints are nearest to a world location.  A building containing the location is at
+	 * distance zero.
+	 * @param WorldLocation The location to search from
+	 * @param Count Most buildings to find
+	 * @param Filter Minimum height of the buildings to find
+	 * @param MaxSearchDistance Maximum distance to search (0 = 1km)
+	 * @return The buildings found, nearest first
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap")
+	TArray<FStreetMapBuildingRef> FindNearestBuildings(const FVector& WorldLocation, int32 Count, const FStreetMapQueryFilter& Filter, float MaxSearchDistance = 0.0f) const;
+
+	/**
+	 * Find the roads and buildings inside a box, such as the area a minimap shows.  Pass the same result every frame to
+	 * reuse its memory.
+	 * @param WorldBox The box to search.  Street maps lie at their component's Z, and buildings rise from there.
+	 * @param OutResult Receives the parts of roads and the buildings at least partly inside the box
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap")
+	void FindFeaturesInBox(const FBox& WorldBox, FStreetMapVolumeQueryResult& OutResult) const;
+
+	/**
+	 * Find the roads and buildings a camera can see, for labels and streaming.  Pass the same result every frame to reuse
+	 * its memory.  The view is not limited in distance, except by the street maps themselves.
+	 * @param View The camera's view, from a camera manager or camera component
+	 * @param OutResult Receives the parts of roads and the buildings at least partly inside the view frustum
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap")
+	void FindFeaturesInView(const FMinimalViewInfo& View, FStreetMapVolumeQueryResult& OutResult) const;
+
+	/**
+	 * Find the roads and buildings inside a convex volume, such as a view frustum from GetViewFrustumBounds()
+	 * @param WorldVolume The volume to search, in world space
+	 * @param OutResult Receives the parts of roads and the buildings at least partly inside the volume
+	 */
+	void FindFeaturesInVolume(const FConvexVolume& WorldVolume, FStreetMapVolumeQueryResult& OutResult) const;
+
+	/**
+	 * Find the first building a line segment hits.  Buildings are their footprints extruded from the street map's ground
+	 * plane up to the height the street map mesh gives them, so this works without generating collision.  Buildings
+	 * without a height or level count are flat and can't be hit.
+	 * @param Start The start of the segment
+	 * @param End The end of the segment.  For a ray, use a point far along it.
+	 * @param OutHit The building, face, distance, location and normal hit
+	 * @return True if a building was hit
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap")
+	bool LineTraceBuildings(const FVector& Start, const FVector& End, FStreetMapBuildingHit& OutHit) const;
+
+	/**
+	 * Check whether any building stands between two locations
+	 * @return True if the segment between the locations doesn't hit a building
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap")
+	bool HasLineOfSight(const FVector& From, const FVector& To) const;
+
+	/**
+	 * Find roads and buildings by name, for search as you type.  Matching ignores case, accents and punctuation, and any
+	 * word of a name can match, so "main" finds "North Main Street".
+	 * @param Text The start of the name, or of any word in it
+	 * @param MaxResults Most names to find
+	 * @param MaxEdits Most typos to tolerate: characters that may be inserted, removed or changed to match (0 = exact)
+	 * @return The names found, each with its roads and buildings.  Fewest edits first, then alphabetically from the word that matched, across every street map.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "StreetMap")
-	TArray<int32> FindBuildingsInRadius(const FVector& WorldLocation, float Radius) const;
+	TArray<FStreetMapNamedFeatures> FindFeaturesByName(const FString& Text, int32 MaxResults = 10, int32 MaxEdits = 0) const;
+
+	/**
+	 * Snap a recorded GPS trace onto the roads, such as a replayed vehicle log.  Unlike snapping each sample on its own
+	 * with FindNearestRoadLocation(), this follows the road graph from one sample to the next, so the trace doesn't jump
+	 * between parallel streets.  The whole trace is matched onto the street map whose bounds hold most of its samples.
+	 * @param WorldLocations The trace's samples, in the order they were recorded
+	 * @param Settings How far to search, and how noisy the samples are
+	 * @return The road location of each sample, which isn't valid for samples with no road nearby
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap")
+	TArray<FStreetMapRoadLocation> MatchTrace(const TArray<FVector>& WorldLocations, const FStreetMapMapMatchSettings& Settings) const;
+
+	/**
+	 * Batched FindNearestRoadPoint(), for running the same query for many agents at once.  The queries are split across
+	 * task graph workers, and nothing is allocated per query.
+	 * @param WorldLocations The locations to search from
+	 * @param OutRoadPoints Receives the road point found for each location (invalid if none).  Must be as long as WorldLocations.
+	 * @param MaxSearchDistance Maximum distance to search (0 = 1km)
+	 */
+	void FindNearestRoadPoints(TArrayView<const FVector> WorldLocations, TArrayView<FStreetMapRoadPointRef> OutRoadPoints, float MaxSearchDistance = 0.0f) const;
+
+	/**
+	 * Batched FindNearestRoadLocation().  The queries are split across task graph workers, and nothing is allocated per query.
+	 * @param WorldLocations The locations to search from
+	 * @param OutRoadLocations Receives the road location found for each location (invalid if none).  Must be as long as WorldLocations.
+	 * @param MaxSearchDistance Maximum distance to search (0 = 1km)
+	 */
+	void FindNearestRoadLocations(TArrayView<const FVector> WorldLocations, TArrayView<FStreetMapRoadLocation> OutRoadLocations, float MaxSearchDistance = 0.0f) const;
+
+	/**
+	 * Batched FindBuildingAtLocation().  The queries are split across task graph workers, and nothing is allocated per query.
+	 * @param WorldLocations The locations to test
+	 * @param OutBuildings Receives the building containing each location (invalid if none).  Must be as long as WorldLocations.
+	 */
+	void FindBuildingsAtLocations(TArrayView<const FVector> WorldLocations, TArrayView<FStreetMapBuildingRef> OutBuildings) const;
+
+	/**
+	 * Batched FindBuildingsInRadius().  The queries are split across task graph workers, which collect buildings in their own
+	 * scratch space.  Pass the same output arrays every frame to reuse their memory.
+	 * @param WorldLocations The center locations
+	 * @param Radius The search radius
+	 * @param OutBuildings Receives the buildings found for all locations, back to back
+	 * @param OutResultOffsets Receives one more entry than there are locations.  The buildings found for location I are
+	 *                         OutBuildings[OutResultOffsets[I]] up to (not including) OutBuildings[OutResultOffsets[I + 1]].
+	 */
+	void FindBuildingsInRadiusBatch(TArrayView<const FVector> WorldLocations, float Radius, TArray<FStreetMapBuildingRef>& OutBuildings, TArray<int32>& OutResultOffsets) const;
+
+	/**
+	 * Batched LineTraceBuildings(), for line of sight checks between many agents.  The queries are split across task graph
+	 * workers, and nothing is allocated per query.
+	 * @param Starts The start of each segment
+	 * @param Ends The end of each segment.  Must be as long as Starts.
+	 * @param OutHits Receives the hit for each segment (invalid if none).  Must be as long as Starts.
+	 */
+	void LineTraceBuildingsBatch(TArrayView<const FVector> Starts, TArrayView<const FVector> Ends, TArrayView<FStreetMapBuildingHit> OutHits) const;
+
+	/**
+	 * Batched MatchTrace(), for replaying many recorded traces at once.  The traces are split across task graph workers,
+	 * and each worker reuses its memory from one trace to the next.
+	 * @param WorldLocations The samples of all traces, back to back
+	 * @param TraceOffsets One more entry than there are traces.  The samples of trace I are WorldLocations[TraceOffsets[I]]
+	 *                     up to (not including) WorldLocations[TraceOffsets[I + 1]].
+	 * @param Settings How far to search, and how noisy the samples are
+	 * @param OutRoadLocations Receives the road location of each sample (invalid if none).  Must be as long as WorldLocations.
+	 */
+	void MatchTraces(TArrayView<const FVector> WorldLocations, TArrayView<const int32> TraceOffsets, const FStreetMapMapMatchSettings& Settings, TArrayView<FStreetMapRoadLocation> OutRoadLocations) const;
+
+	/*
+	 * Asynchronous queries run on a worker thread, so expensive ones don't stall the game thread.
+	 *
+	 * Threading contract:
+	 *  - Start them on the game thread, which is where the registered components' transforms can be read.  Starting one
+	 *    only notes which street maps to search and where they are.  It never fetches or builds derived data.
+	 *  - The worker task gets each street map's snapshot and derived data itself, building the derived data if it isn't
+	 *    there yet, so it reads the street maps as they are when the task starts.
+	 *  - The future is fulfilled on the worker thread.  Continuations attached with Then() run there, not on the game
+	 *    thread.  Waiting for the future on the game thread doesn't deadlock, since nothing waits for the game thread,
+	 *    but it does stall the game thread for as long as the query takes.  Latent nodes poll the future instead.
+	 *  - Results from street maps or components that were destroyed while the query ran are left out.
+	 */
+
+	/** Asynchronous FindNearestRoadLocation().  The result isn't valid if no road was found. */
+	TFuture<FStreetMapRoadLocation> FindNearestRoadLocationAsync(const FVector& WorldLocation, float MaxSearchDistance = 0.0f) const;
+
+	/** Asynchronous FindBuildingAtLocation() */
+	TFuture<FStreetMapBuildingRef> FindBuildingAtLocationAsync(const FVector& WorldLocation) const;
+
+	/** Asynchronous FindBuildingsInRadius() */
+	TFuture<TArray<FStreetMapBuildingRef>> FindBuildingsInRadiusAsync(const FVector& WorldLocation, float Radius) const;
+
+	/** Asynchronous FindBuildingsInBox() */
+	TFuture<TArray<FStreetMapBuildingRef>> FindBuildingsInBoxAsync(const FBox& WorldBox) const;
+
+	/** Latent version of FindNearestRoadLocation(), which searches on a worker thread and continues when it's done */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap", meta = (Latent, LatentInfo = "LatentInfo", DisplayName = "Find Nearest Road Location (Async)"))
+	void FindNearestRoadLocationLatent(const FVector& WorldLocation, float MaxSearchDistance, bool& bOutFound, FStreetMapRoadLocation& OutRoadLocation, FLatentActionInfo LatentInfo);
+
+	/** Latent version of FindBuildingAtLocation(), which searches on a worker thread and continues when it's done */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap", meta = (Latent, LatentInfo = "LatentInfo", DisplayName = "Find Building At Location (Async)"))
+	void FindBuildingAtLocationLatent(const FVector& WorldLocation, bool& bOutFound, FStreetMapBuildingRef& OutBuilding, FLatentActionInfo LatentInfo);
+
+	/** Latent version of FindBuildingsInRadius(), which searches on a worker thread and continues when it's done */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap", meta = (Latent, LatentInfo = "LatentInfo", DisplayName = "Find Buildings In Radius (Async)"))
+	void FindBuildingsInRadiusLatent(const FVector& WorldLocation, float Radius, TArray<FStreetMapBuildingRef>& OutBuildings, FLatentActionInfo LatentInfo);
+
+	/** Latent version of FindBuildingsInBox(), which searches on a worker thread and continues when it's done */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap", meta = (Latent, LatentInfo = "LatentInfo", DisplayName = "Find Buildings In Box (Async)"))
+	void FindBuildingsInBoxLatent(const FBox& WorldBox, TArray<FStreetMapBuildingRef>& OutBuildings, FLatentActionInfo LatentInfo);
 
 	/** Delegate broadcast when a street map is registered */
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnStreetMapRegistered, UStreetMap*, StreetMap);
@@ -108,6 +349,80 @@ public:
 	FOnStreetMapUnregistered OnStreetMapUnregistered;
 
 protected:
+	/** A street map that queries search, and where it is in the world */
+	struct FQueryTarget
+	{
+		UStreetMap* StreetMap = nullptr;
+
+		/** Component showing the street map, or null for street maps registered without one */
+		UStreetMapComponent* Component = nullptr;
+
+		/** What queries read from.  All queries in one call read the same snapshot, and the derived data built from it. */
+		TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot;
+		TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> DerivedData;
+
+		/** Transforms map space (X and Y, with Z zero) into world space */
+		FTransform MapToWorld;
+
+		/** Map units per world unit */
+		double WorldToMapScale = 1.0;
+
+		/** Bounds of the street map, in map space */
+		FBox2D MapBounds;
+
+		/** Height buildings with a level count but no height are extruded to, per level, in map units */
+		double BuildingLevelHeight = 0.0;
+
+		FVector2D WorldToMap(const FVector& WorldLocation) const
+		{
+			const FVector MapLocation = MapToWorld.InverseTransformPosition(WorldLocation);
+			return FVector2D(MapLocation.X, MapLocation.Y);
+		}
+
+		FVector MapToWorldLocation(const FVector2D& MapLocation) const
+		{
+			return MapToWorld.TransformPosition(FVector(MapLocation, 0.0));
+		}
+
+		/** Gets the distance from a map space location to the street map's bounds, in world units */
+		double GetWorldDistanceToBounds(const FVector2D& MapLocation) const
+		{
+			return FMath::Sqrt(MapBounds.ComputeSquaredDistanceToPoint(MapLocation)) / WorldToMapScale;
+		}
+	};
+
+	using FQueryTargets = TArray<FQueryTarget, TInlineAllocator<8>>;
+
+	/** Which street map to search and where it is, without its data.  Asynchronous queries look the data up when they run. */
+	struct FQueryTargetSource
+	{
+		TWeakObjectPtr<UStreetMap> StreetMap;
+
+		/** Component showing the street map, or null for street maps registered without one */
+		TWeakObjectPtr<UStreetMapComponent> Component;
+
+		/** Transforms map space (X and Y, with Z zero) into world space */
+		FTransform MapToWorld;
+
+		/** Height buildings with a level count but no height are extruded to, per level, in map units */
+		double BuildingLevelHeight = 0.0;
+	};
+
+	using FQueryTargetSources = TArray<FQueryTargetSource, TInlineAllocator<8>>;
+
+	/** Gets every street map queries should search, with its snapshot and derived data */
+	void GetQueryTargets(FQueryTargets& OutTargets) const;
+
+	/** Gets every street map queries should search and where it is.  Cheap, since it doesn't touch any street map data. */
+	void GetQueryTargetSources(FQueryTargetSources& OutSources) const;
+
+	/** Adds the roads and buildings inside a world space volume, bounded by planes facing out of it, to OutResult */
+	void FindFeaturesInPlanes(TArrayView<const FPlane> WorldPlanes, FStreetMapVolumeQueryResult& OutResult) const;
+
+	/** Scratch space batched queries keep between calls, so they don't allocate it again every time (see the .cpp) */
+	struct FBatchScratchPool;
+	TPimplPtr<FBatchScratchPool> BatchScratchPool;
+
 	/** Registered street map assets */
 	UPROPERTY()
 	TArray<TObjectPtr<UStreetMap>> RegisteredStreetMaps;
@@ -0,0 +1,21 @@
+#pragma once
+#include "StreetMapActor.h"
+#include "StreetMapTileActor.generated.h"
+
+/** An actor that renders one tile of a street map that was split into tiles.  Tile actors are spatially loaded, so with
+    World Partition only the tiles near the player are streamed in. */
+UCLASS(hidecategories = (Physics))
+class STREETMAPRUNTIME_API AStreetMapTileActor : public AStreetMapActor
+{
+	GENERATED_UCLASS_BODY()
+
+	/** Grid coordinate of the tile this actor renders */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "StreetMap")
+	FIntPoint TileCoordinate;
+
+public:
+	FORCEINLINE FIntPoint GetTileCoordinate() const { return TileCoordinate; }
+
+	/** Assigns a street map tile to this actor and builds its mesh */
+	void SetStreetMapTile(class UStreetMap* StreetMapTile);
+};
@@ -1,9 +1,78 @@
 #include "StreetMap.h"
 #include "EditorFramework/AssetImportData.h"
+#include "StreetMapCustomVersion.h"
+#include "StreetMapSnapshot.h"
+#include "StreetMapDerivedData.h"
+#include "StreetMapMemory.h"
+#include "StreetMapStats.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/ScopeRWLock.h"
+#include "Misc/Compression.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Misc/SecureHash.h"
+#include "Misc/CoreDelegates.h"
+const double UStreetMap::DefaultCellSize = 100000.0;
+
+void FStreetMapMeshBuildSettings::UpdateHash( FSHA1& Hash ) const
+{
+	TArray<uint8> SettingsBytes;
+	FMemoryWriter Writer( SettingsBytes );
+
+	float RoadOffsetZCopy = RoadOffsetZ;
+	bool bWant3DBuildingsCopy = bWant3DBuildings;
+	float BuildingLevelFloorFactorCopy = BuildingLevelFloorFactor;
+	bool bWantLitBuildingsCopy = bWantLitBuildings;
+	float StreetThicknessCopy = StreetThickness;
+	FLinearColor StreetColorCopy = StreetColor;
+	float MajorRoadThicknessCopy = MajorRoadThickness;
+	FLinearColor MajorRoadColorCopy = MajorRoadColor;
+	float HighwayThicknessCopy = HighwayThickness;
+	FLinearColor HighwayColorCopy = HighwayColor;
+	float BuildingBorderThicknessCopy = BuildingBorderThickness;
+	FLinearColor BuildingBorderLinearColorCopy = BuildingBorderLinearColor;
+	float BuildingBorderZCopy = BuildingBorderZ;
+	Writer << RoadOffsetZCopy << bWant3DBuildingsCopy << BuildingLevelFloorFactorCopy << bWantLitBuildingsCopy;
+	Writer << StreetThicknessCopy << StreetColorCopy << MajorRoadThicknessCopy << MajorRoadColorCopy << HighwayThicknessCopy << HighwayColorCopy;
+	Writer << BuildingBorderThicknessCopy << BuildingBorderLinearColorCopy << BuildingBorderZCopy;
+
+	Hash.Update( SettingsBytes.GetData(), SettingsBytes.Num() );
+}
+
+
+const FName FStreetMapAssetRegistryTags::RoadCount( TEXT( "Roads" ) );
+const FName FStreetMapAssetRegistryTags::NodeCount( TEXT( "Nodes" ) );
+const FName FStreetMapAssetRegistryTags::BuildingCount( TEXT( "Buildings" ) );
+const FName FStreetMapAssetRegistryTags::CellCount( TEXT( "Cells" ) );
+const FName FStreetMapAssetRegistryTags::RoadPointCount( TEXT( "RoadPoints" ) );
+const FName FStreetMapAssetRegistryTags::BuildingPointCount( TEXT( "BuildingPoints" ) );
+const FName FStreetMapAssetRegistryTags::NameCount( TEXT( "Names" ) );
+const FName FStreetMapAssetRegistryTags::TotalRoadLength( TEXT( "TotalRoadLength" ) );
+const FName FStreetMapAssetRegistryTags::BoundsMin( TEXT( "BoundsMin" ) );
+const FName FStreetMapAssetRegistryTags::BoundsMax( TEXT( "BoundsMax" ) );
+const FName FStreetMapAssetRegistryTags::Extent( TEXT( "Extent" ) );
+const FName FStreetMapAssetRegistryTags::RoadDataSize( TEXT( "RoadDataSize" ) );
+const FName FStreetMapAssetRegistryTags::NodeDataSize( TEXT( "NodeDataSize" ) );
+const FName FStreetMapAssetRegistryTags::BuildingDataSize( TEXT( "BuildingDataSize" ) );
+const FName FStreetMapAssetRegistryTags::NameTableSize( TEXT( "NameTableSize" ) );
+const FName FStreetMapAssetRegistryTags::ImporterVersion( TEXT( "ImporterVersion" ) );
+const FName FStreetMapAssetRegistryTags::TileCoordinate( TEXT( "TileCoordinate" ) );
+
 
 UStreetMap::UStreetMap()
+	: BoundsMin( FVector2D::ZeroVector ),
+	  BoundsMax( FVector2D::ZeroVector ),
+	  CellSize( DefaultCellSize ),
+	  bIsTile( false ),
+	  TileCoordinate( FIntPoint::ZeroValue ),
+	  NameCookMode( EStreetMapNameCookMode::Keep ),
+	  bDataIsPublished( true )
 {
+	// Until something is loaded or edited, the map's data is an empty snapshot
+	Snapshot = MakeShared<FStreetMapSnapshot, ESPMode::ThreadSafe>( GetFName(), SnapshotVersion );
+
 #if WITH_EDITORONLY_DATA
+	ImporterVersion = 0;
 	if( !HasAnyFlags( RF_ClassDefaultObject ) )
 	{
 		AssetImportData = NewObject<UAssetImportData>( this, TEXT( "AssetImportData" ) );
@@ -19,7 +88,811 @@ void UStreetMap::GetAssetRegistryTags( TArray<FAssetRegistryTag>& OutTags ) cons
 	{
 		OutTags.Add( FAssetRegistryTag( SourceFileTagName(), AssetImportData->GetSourceData().ToJson(), FAssetRegistryTag::TT_Hidden ) );
 	}
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::ImporterVersion, LexToString( ImporterVersion ), FAssetRegistryTag::TT_Numerical ) );
 #endif
 
+	// Everything below is cheap to gather from the loaded map, and saves tools from having to load it themselves
+	int64 RoadPointCount = 0;
+	double TotalRoadLength = 0.0;
+	SIZE_T RoadDataSize = GetRoads().Num() * sizeof( FStreetMapRoad ) + GetRoadOsmIds().Num() * sizeof( int64 );
+	for( const FStreetMapRoad& Road : GetRoads() )
+	{
+		RoadPointCount += Road.RoadPoints.Num();
+		TotalRoadLength += Road.ComputeLengthOfRoad( *this );
+		RoadDataSize += Road.RoadPoints.Num() * sizeof( FVector2D ) + Road.NodeIndices.Num() * sizeof( int32 );
+	}
+
+	int64 BuildingPointCount = 0;
+	SIZE_T BuildingDataSize = GetBuildings().Num() * sizeof( FStreetMapBuilding ) + GetBuildingOsmIds().Num() * sizeof( int64 );
+	for( const FStreetMapBuilding& Building : GetBuildings() )
+	{
+		BuildingPointCount += Building.BuildingPoints.Num();
+		BuildingDataSize += Building.BuildingPoints.Num() * sizeof( FVector2D );
+	}
+
+	const SIZE_T NodeDataSize = GetNodes().Num() * sizeof( FStreetMapNode ) + GetNodeRoadRefs().Num() * sizeof( FStreetMapRoadRef ) + GetNodeOsmIds().Num() * sizeof( int64 );
+
+	SIZE_T NameTableSize = 0;
+	for( const FString& Name : GetNames() )
+	{
+		NameTableSize += ( Name.Len() + 1 ) * sizeof( TCHAR );
+	}
+
+	// Map space is in centimeters
+	const FVector2D MapSize = ( GetRoads().Num() > 0 || GetBuildings().Num() > 0 ) ? BoundsMax - BoundsMin : FVector2D::ZeroVector;
+	const FString Extent = FString::Printf( TEXT( "%.2f x %.2f km" ), MapSize.X / 100000.0, MapSize.Y / 100000.0 );
+
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::RoadCount, LexToString( GetRoads().Num() ), FAssetRegistryTag::TT_Numerical ) );
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::NodeCount, LexToString( GetNodes().Num() ), FAssetRegistryTag::TT_Numerical ) );
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::BuildingCount, LexToString( GetBuildings().Num() ), FAssetRegistryTag::TT_Numerical ) );
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::CellCount, LexToString( Cells.Num() ), FAssetRegistryTag::TT_Numerical ) );
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::RoadPointCount, LexToString( RoadPointCount ), FAssetRegistryTag::TT_Numerical ) );
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::BuildingPointCount, LexToString( BuildingPointCount ), FAssetRegistryTag::TT_Numerical ) );
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::NameCount, LexToString( GetNames().Num() ), FAssetRegistryTag::TT_Numerical ) );
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::TotalRoadLength, FString::Printf( TEXT( "%.0f" ), TotalRoadLength / 100.0 ), FAssetRegistryTag::TT_Numerical ) );
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::BoundsMin, BoundsMin.ToString(), FAssetRegistryTag::TT_Hidden ) );
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::BoundsMax, BoundsMax.ToString(), FAssetRegistryTag::TT_Hidden ) );
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::Extent, Extent, FAssetRegistryTag::TT_Alphabetical ) );
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::RoadDataSize, LexToString( (uint64)RoadDataSize ), FAssetRegistryTag::TT_Numerical, FAssetRegistryTag::TD_Memory ) );
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::NodeDataSize, LexToString( (uint64)NodeDataSize ), FAssetRegistryTag::TT_Numerical, FAssetRegistryTag::TD_Memory ) );
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::BuildingDataSize, LexToString( (uint64)BuildingDataSize ), FAssetRegistryTag::TT_Numerical, FAssetRegistryTag::TD_Memory ) );
+	OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::NameTableSize, LexToString( (uint64)NameTableSize ), FAssetRegistryTag::TT_Numerical, FAssetRegistryTag::TD_Memory ) );
+
+	if( bIsTile )
+	{
+		OutTags.Add( FAssetRegistryTag( FStreetMapAssetRegistryTags::TileCoordinate, TileCoordinate.ToString(), FAssetRegistryTag::TT_Hidden ) );
+	}
+
 	Super::GetAssetRegistryTags( OutTags );
 }
+
+
+void UStreetMap::Serialize( FArchive& Ar )
+{
+	LLM_SCOPE_BYTAG( StreetMap_Payload );
+
+	// Cooked maps carry the published snapshot's derived data, so edits have to be published before they're saved with it
+	if( Ar.IsSaving() && Ar.IsCooking() && !bDataIsPublished )
+	{
+		PublishSnapshot();
+	}
+
+	// Published data belongs to the snapshot, so it's copied back for as long as it takes to save it.  Archives that only
+	// look for object references or count memory don't need it.
+	const bool bSaveFromSnapshot = Ar.IsSaving() && bDataIsPublished && !Ar.IsObjectReferenceCollector() && !Ar.IsCountingMemory();
+	if( bSaveFromSnapshot )
+	{
+		CopyDataFromSnapshot();
+	}
+
+	// Loaded data replaces whatever was published, and is published again in PostLoad()
+	if( Ar.IsLoading() )
+	{
+		MakeDataEditable( /* bKeepPublishedData */ false );
+	}
+
+	Super::Serialize( Ar );
+
+	Ar.UsingCustomVersion( FStreetMapCustomVersion::GUID );
+	if( Ar.CustomVer( FStreetMapCustomVersion::GUID ) >= FStreetMapCustomVersion::NameTable )
+	{
+		SerializeNameTable( Ar );
+	}
+	if( Ar.CustomVer( FStreetMapCustomVersion::GUID ) >= FStreetMapCustomVersion::CookedDerivedData )
+	{
+		SerializeCookedDerivedData( Ar );
+	}
+
+	if( bSaveFromSnapshot )
+	{
+		ResetData();
+	}
+}
+
+
+void UStreetMap::SerializeCookedDerivedData( FArchive& Ar )
+{
+	// Only cooked maps carry derived data.  Editor data builds it (or fetches it from the derived data cache) on demand.
+	bool bHasDerivedData = false;
+	TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> DerivedDataToSave;
+	if( Ar.IsSaving() && Ar.IsCooking() )
+	{
+		DerivedDataToSave = GetSnapshot()->GetDerivedData();
+		bHasDerivedData = DerivedDataToSave.IsValid();
+	}
+	Ar << bHasDerivedData;
+
+	if( bHasDerivedData )
+	{
+		if( Ar.IsLoading() )
+		{
+			LLM_SCOPE_BYTAG( StreetMap_DerivedData );
+			TSharedRef<FStreetMapDerivedData, ESPMode::ThreadSafe> LoadedDerivedData = MakeShared<FStreetMapDerivedData, ESPMode::ThreadSafe>();
+			Ar << *LoadedDerivedData;
+
+			// It was built from the data loaded along with it, and goes into the same snapshot in PostLoad()
+			CookedDerivedData = LoadedDerivedData;
+		}
+		else
+		{
+			// Serializing for save doesn't change anything
+			Ar << const_cast<FStreetMapDerivedData&>( *DerivedDataToSave );
+		}
+	}
+}
+
+
+void UStreetMap::SerializeNameTable( FArchive& Ar )
+{
+	// Names are only compressed or stripped in cooked data.  Editor data always keeps them as they are.
+	uint8 StorageMode = (uint8)EStreetMapNameCookMode::Keep;
+	if( Ar.IsSaving() && Ar.IsCooking() )
+	{
+		StorageMode = (uint8)NameCookMode;
+	}
+	Ar << StorageMode;
+
+	switch( (EStreetMapNameCookMode)StorageMode )
+	{
+		case EStreetMapNameCookMode::Keep:
+			Ar << Names;
+			break;
+
+		case EStreetMapNameCookMode::Strip:
+		{
+			// Only the number of names is kept, so that every name ID stays valid
+			int32 NumNames = Names.Num();
+			Ar << NumNames;
+			if( Ar.IsLoading() )
+			{
+				Names.Reset();
+				Names.SetNum( NumNames );
+			}
+			break;
+		}
+
+		case EStreetMapNameCookMode::Compress:
+		{
+			// All names are packed into a single buffer of null-terminated UTF-8 strings
+			int32 NumNames = Names.Num();
+			int32 UncompressedSize = 0;
+			TArray<uint8> CompressedBuffer;
+
+			if( Ar.IsSaving() )
+			{
+				TArray<uint8> UncompressedBuffer;
+				for( const FString& Name : Names )
+				{
+					FTCHARToUTF8 NameUTF8( *Name );
+					UncompressedBuffer.Append( (const uint8*)NameUTF8.Get(), NameUTF8.Length() );
+					UncompressedBuffer.Add( 0 );
+				}
+				UncompressedSize = UncompressedBuffer.Num();
+
+				int32 CompressedSize = FCompression::CompressMemoryBound( NAME_Zlib, UncompressedSize );
+				CompressedBuffer.SetNumUninitialized( CompressedSize );
+				verify( FCompression::CompressMemory( NAME_Zlib, CompressedBuffer.GetData(), CompressedSize, UncompressedBuffer.GetData(), UncompressedSize ) );
+				CompressedBuffer.SetNum( CompressedSize );
+			}
+
+			Ar << NumNames;
+			Ar << UncompressedSize;
+			Ar << CompressedBuffer;
+
+			if( Ar.IsLoading() )
+			{
+				TArray<uint8> UncompressedBuffer;
+				UncompressedBuffer.SetNumUninitialized( UncompressedSize );
+				Names.Reset( NumNames );
+
+				if( UncompressedSize > 0 && FCompression::UncompressMemory( NAME_Zlib, UncompressedBuffer.GetData(), UncompressedSize, CompressedBuffer.GetData(), CompressedBuffer.Num() ) )
+				{
+					int32 NameStart = 0;
+					for( int32 ByteIndex = 0; ByteIndex < UncompressedSize && Names.Num() < NumNames; ++ByteIndex )
+					{
+						if( UncompressedBuffer[ ByteIndex ] == 0 )
+						{
+							const FUTF8ToTCHAR NameTCHAR( (const ANSICHAR*)&UncompressedBuffer[ NameStart ], ByteIndex - NameStart );
+							Names.Emplace( NameTCHAR.Length(), NameTCHAR.Get() );
+							NameStart = ByteIndex + 1;
+						}
+					}
+				}
+
+				// Keep every name ID valid, even if the data was damaged
+				Names.SetNum( NumNames );
+			}
+			break;
+		}
+
+		default:
+			Ar.SetError();
+			break;
+	}
+
+	if( Ar.IsLoading() )
+	{
+		NameToIdMap.Reset();
+	}
+}
+
+
+void UStreetMap::PostLoad()
+{
+	Super::PostLoad();
+
+	LLM_SCOPE_BYTAG( StreetMap_Payload );
+
+#if WITH_EDITORONLY_DATA
+	// Maps saved before the name table existed have a name string on every road and building
+	if( GetLinkerCustomVersion( FStreetMapCustomVersion::GUID ) < FStreetMapCustomVersion::NameTable )
+	{
+		for( FStreetMapRoad& Road : Roads )
+		{
+			Road.NameId = InternName( Road.RoadName_DEPRECATED );
+			Road.RoadName_DEPRECATED.Empty();
+		}
+		for( FStreetMapBuilding& Building : Buildings )
+		{
+			Building.NameId = InternName( Building.BuildingName_DEPRECATED );
+			Building.BuildingName_DEPRECATED.Empty();
+		}
+	}
+
+	// Maps saved before the compact node table have road refs on every node, and no node locations
+	if( GetLinkerCustomVersion( FStreetMapCustomVersion::GUID ) < FStreetMapCustomVersion::CompactNodeTable )
+	{
+		NodeRoadRefs.Reset();
+		for( FStreetMapNode& Node : Nodes )
+		{
+			Node.FirstRoadRef = NodeRoadRefs.Num();
+			Node.NumRoadRefs = Node.RoadRefs_DEPRECATED.Num();
+			NodeRoadRefs.Append( Node.RoadRefs_DEPRECATED );
+
+			if( Node.NumRoadRefs > 0 )
+			{
+				const FStreetMapRoadRef& FirstRoadRef = Node.RoadRefs_DEPRECATED[ 0 ];
+				Node.Location = Roads[ FirstRoadRef.RoadIndex ].RoadPoints[ FirstRoadRef.RoadPointIndex ];
+			}
+			Node.RoadRefs_DEPRECATED.Empty();
+		}
+	}
+#endif	// WITH_EDITORONLY_DATA
+
+	// Maps saved before grid cells existed have no cells yet, so anchor their features now
+	if( Cells.Num() == 0 && ( Roads.Num() > 0 || Buildings.Num() > 0 ) )
+	{
+		RebuildCells();
+	}
+	else
+	{
+		LLM_SCOPE_BYTAG( StreetMap_Lookup );
+		CellCoordinateToIndexMap.Reset();
+		for( int32 CellIndex = 0; CellIndex < Cells.Num(); ++CellIndex )
+		{
+			CellCoordinateToIndexMap.Add( Cells[ CellIndex ].Coordinate, CellIndex );
+		}
+	}
+
+	// The loaded data moves into the snapshot, along with the derived data loaded from a cooked map
+	if( !bDataIsPublished )
+	{
+		MoveDataIntoSnapshot();
+	}
+}
+
+
+void UStreetMap::BeginDestroy()
+{
+	if( PublishAtEndOfFrameHandle.IsValid() )
+	{
+		FCoreDelegates::OnEndFrame.Remove( PublishAtEndOfFrameHandle );
+		PublishAtEndOfFrameHandle.Reset();
+	}
+
+	Super::BeginDestroy();
+}
+
+
+int32 UStreetMap::FindCellIndex( const FIntPoint& CellCoordinate ) const
+{
+	const int32* FoundCellIndexPtr = CellCoordinateToIndexMap.Find( CellCoordinate );
+	return FoundCellIndexPtr != nullptr ? *FoundCellIndexPtr : INDEX_NONE;
+}
+
+
+void UStreetMap::RebuildCells()
+{
+	if( CellSize <= 0.0 )
+	{
+		CellSize = DefaultCellSize;
+	}
+
+	// Features store the index of their cell
+	MakeDataEditable();
+
+	Cells.Reset();
+	CellCoordinateToIndexMap.Reset();
+
+	auto FindOrAddCell = [this]( const FVector2D& FeatureBoundsMin, const FVector2D& FeatureBoundsMax ) -> int32
+	{
+		const FIntPoint CellCoordinate = GetCellCoordinate( ( FeatureBoundsMin + FeatureBoundsMax ) * 0.5 );
+		if( const int32* FoundCellIndexPtr = CellCoordinateToIndexMap.Find( CellCoordinate ) )
+		{
+			return *FoundCellIndexPtr;
+		}
+
+		const int32 NewCellIndex = Cells.Num();
+		FStreetMapCell& NewCell = Cells.AddDefaulted_GetRef();
+		NewCell.Coordinate = CellCoordinate;
+		NewCell.Origin = FVector2D( (double)CellCoordinate.X * CellSize, (double)CellCoordinate.Y * CellSize );
+		CellCoordinateToIndexMap.Add( CellCoordinate, NewCellIndex );
+		return NewCellIndex;
+	};
+
+	for( FStreetMapRoad& Road : Roads )
+	{
+		Road.CellIndex = FindOrAddCell( Road.BoundsMin, Road.BoundsMax );
+		++Cells[ Road.CellIndex ].RoadCount;
+	}
+
+	for( FStreetMapBuilding& Building : Buildings )
+	{
+		Building.CellIndex = FindOrAddCell( Building.BoundsMin, Building.BoundsMax );
+		++Cells[ Building.CellIndex ].BuildingCount;
+	}
+}
+
+
+void UStreetMap::BuildTileFromCell( const UStreetMap& SourceMap, const int32 CellIndex )
+{
+	check( &SourceMap != this );
+	check( SourceMap.Cells.IsValidIndex( CellIndex ) );
+
+	// Start over from an empty map
+	MakeDataEditable( /* bKeepPublishedData */ false );
+	ResetData();
+	TileBoundaryStubs.Reset();
+
+	CellSize = SourceMap.CellSize;
+	GeoReference = SourceMap.GeoReference;
+	NameCookMode = SourceMap.NameCookMode;
+	bIsTile = true;
+	TileCoordinate = SourceMap.Cells[ CellIndex ].Coordinate;
+#if WITH_EDITORONLY_DATA
+	ImporterVersion = SourceMap.ImporterVersion;
+#endif
+
+	BoundsMin = FVector2D( TNumericLimits<double>::Max(), TNumericLimits<double>::Max() );
+	BoundsMax = FVector2D( TNumericLimits<double>::Lowest(), TNumericLimits<double>::Lowest() );
+
+	const TArray<FStreetMapRoad>& SourceRoads = SourceMap.GetRoads();
+	const TArray<FStreetMapNode>& SourceNodes = SourceMap.GetNodes();
+	const TArray<FStreetMapBuilding>& SourceBuildings = SourceMap.GetBuildings();
+
+	// Roads anchored to the cell.  Their node indices are filled in below, once we know which nodes the tile keeps.
+	TMap<int32, int32> SourceToTileRoadIndexMap;
+	for( int32 SourceRoadIndex = 0; SourceRoadIndex < SourceRoads.Num(); ++SourceRoadIndex )
+	{
+		const FStreetMapRoad& SourceRoad = SourceRoads[ SourceRoadIndex ];
+		if( SourceRoad.CellIndex == CellIndex )
+		{
+			SourceToTileRoadIndexMap.Add( SourceRoadIndex, Roads.Num() );
+
+			FStreetMapRoad& TileRoad = Roads.Add_GetRef( SourceRoad );
+			TileRoad.NameId = InternName( SourceRoad.GetRoadName( SourceMap ) );
+			for( int32& NodeIndex : TileRoad.NodeIndices )
+			{
+				NodeIndex = INDEX_NONE;
+			}
+			RoadOsmIds.Add( SourceMap.GetRoadOsmId( SourceRoadIndex ) );
+
+			BoundsMin.X = FMath::Min( BoundsMin.X, SourceRoad.BoundsMin.X );
+			BoundsMin.Y = FMath::Min( BoundsMin.Y, SourceRoad.BoundsMin.Y );
+			BoundsMax.X = FMath::Max( BoundsMax.X, SourceRoad.BoundsMax.X );
+			BoundsMax.Y = FMath::Max( BoundsMax.Y, SourceRoad.BoundsMax.Y );
+		}
+	}
+
+	// Every node along the tile's roads, keeping only the road refs to roads that made it into the tile
+	TMap<int32, int32> SourceToTileNodeIndexMap;
+	for( const TPair<int32, int32>& RoadIndexPair : SourceToTileRoadIndexMap )
+	{
+		const FStreetMapRoad& SourceRoad = SourceRoads[ RoadIndexPair.Key ];
+		for( const int32 SourceNodeIndex : SourceRoad.NodeIndices )
+		{
+			if( SourceNodeIndex == INDEX_NONE || SourceToTileNodeIndexMap.Contains( SourceNodeIndex ) )
+			{
+				continue;
+			}
+
+			const FStreetMapNode& SourceNode = SourceNodes[ SourceNodeIndex ];
+			const int32 TileNodeIndex = Nodes.Num();
+			SourceToTileNodeIndexMap.Add( SourceNodeIndex, TileNodeIndex );
+
+			FStreetMapNode& TileNode = Nodes.AddDefaulted_GetRef();
+			TileNode.Location = SourceNode.Location;
+			TileNode.FirstRoadRef = NodeRoadRefs.Num();
+			NodeOsmIds.Add( SourceMap.GetNodeOsmId( SourceNodeIndex ) );
+
+			const int32 FirstBoundaryStubIndex = TileBoundaryStubs.Num();
+			for( const FStreetMapRoadRef& SourceRoadRef : SourceNode.GetRoadRefs( SourceMap ) )
+			{
+				if( const int32* TileRoadIndexPtr = SourceToTileRoadIndexMap.Find( SourceRoadRef.RoadIndex ) )
+				{
+					FStreetMapRoadRef& TileRoadRef = NodeRoadRefs.AddDefaulted_GetRef();
+					TileRoadRef.RoadIndex = *TileRoadIndexPtr;
+					TileRoadRef.RoadPointIndex = SourceRoadRef.RoadPointIndex;
+					Roads[ TileRoadRef.RoadIndex ].NodeIndices[ TileRoadRef.RoadPointIndex ] = TileNodeIndex;
+					++TileNode.NumRoadRefs;
+				}
+				else
+				{
+					// The road is anchored to another cell, so the graph carries on in that tile
+					const FIntPoint NeighborTileCoordinate = SourceMap.Cells[ SourceRoads[ SourceRoadRef.RoadIndex ].CellIndex ].Coordinate;
+
+					bool bAlreadyHasStub = false;
+					for( int32 StubIndex = FirstBoundaryStubIndex; StubIndex < TileBoundaryStubs.Num(); ++StubIndex )
+					{
+						bAlreadyHasStub |= TileBoundaryStubs[ StubIndex ].NeighborTileCoordinate == NeighborTileCoordinate;
+					}
+					if( !bAlreadyHasStub )
+					{
+						FStreetMapTileBoundaryStub& BoundaryStub = TileBoundaryStubs.AddDefaulted_GetRef();
+						BoundaryStub.NodeIndex = TileNodeIndex;
+						BoundaryStub.NeighborTileCoordinate = NeighborTileCoordinate;
+					}
+				}
+			}
+		}
+	}
+
+	for( int32 SourceBuildingIndex = 0; SourceBuildingIndex < SourceBuildings.Num(); ++SourceBuildingIndex )
+	{
+		const FStreetMapBuilding& SourceBuilding = SourceBuildings[ SourceBuildingIndex ];
+		if( SourceBuilding.CellIndex == CellIndex )
+		{
+			FStreetMapBuilding& TileBuilding = Buildings.Add_GetRef( SourceBuilding );
+			TileBuilding.NameId = InternName( SourceBuilding.GetBuildingName( SourceMap ) );
+			BuildingOsmIds.Add( SourceMap.GetBuildingOsmId( SourceBuildingIndex ) );
+
+			BoundsMin.X = FMath::Min( BoundsMin.X, SourceBuilding.BoundsMin.X );
+			BoundsMin.Y = FMath::Min( BoundsMin.Y, SourceBuilding.BoundsMin.Y );
+			BoundsMax.X = FMath::Max( BoundsMax.X, SourceBuilding.BoundsMax.X );
+			BoundsMax.Y = FMath::Max( BoundsMax.Y, SourceBuilding.BoundsMax.Y );
+		}
+	}
+
+	// Maps imported without OpenStreetMap IDs have none to copy
+	if( SourceMap.GetRoadOsmIds().Num() == 0 )
+	{
+		RoadOsmIds.Reset();
+	}
+	if( SourceMap.GetNodeOsmIds().Num() == 0 )
+	{
+		NodeOsmIds.Reset();
+	}
+	if( SourceMap.GetBuildingOsmIds().Num() == 0 )
+	{
+		BuildingOsmIds.Reset();
+	}
+
+	RebuildCells();
+	PublishSnapshot();
+}
+
+
+TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> UStreetMap::GetDerivedData() const
+{
+	return GetSnapshot()->GetDerivedData();
+}
+
+
+#if WITH_EDITOR
+FString UStreetMap::GetDerivedDataKey() const
+{
+	return GetSnapshot()->GetDerivedDataKey();
+}
+
+
+void UStreetMap::BeginCacheForCookedPlatformData( const ITargetPlatform* TargetPlatform )
+{
+	Super::BeginCacheForCookedPlatformData( TargetPlatform );
+
+	// Derived data doesn't depend on the target platform, so one copy serves every platform being cooked.  It's kept on
+	// the snapshot, and goes away with it.
+	GetSnapshot()->GetDerivedData();
+}
+
+
+bool UStreetMap::IsCachedCookedPlatformDataLoaded( const ITargetPlatform* TargetPlatform )
+{
+	return GetSnapshot()->FindDerivedData().IsValid();
+}
+#endif	// WITH_EDITOR
+
+
+TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> UStreetMap::GetSnapshot() const
+{
+	FReadScopeLock ReadLock( SnapshotLock );
+	return Snapshot;
+}
+
+
+void UStreetMap::PublishSnapshot()
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER( STAT_StreetMap_PublishSnapshot );
+
+	if( PublishAtEndOfFrameHandle.IsValid() )
+	{
+		FCoreDelegates::OnEndFrame.Remove( PublishAtEndOfFrameHandle );
+		PublishAtEndOfFrameHandle.Reset();
+	}
+
+	if( bDataIsPublished )
+	{
+		return;
+	}
+
+	// The new snapshot builds its own derived data the next time someone needs it
+	MoveDataIntoSnapshot();
+}
+
+
+const TArray<FStreetMapRoad>& UStreetMap::GetRoads() const
+{
+	return bDataIsPublished ? Snapshot->GetRoads() : Roads;
+}
+
+
+const TArray<FStreetMapNode>& UStreetMap::GetNodes() const
+{
+	return bDataIsPublished ? Snapshot->GetNodes() : Nodes;
+}
+
+
+const TArray<FStreetMapRoadRef>& UStreetMap::GetNodeRoadRefs() const
+{
+	return bDataIsPublished ? Snapshot->GetNodeRoadRefs() : NodeRoadRefs;
+}
+
+
+const TArray<FStreetMapBuilding>& UStreetMap::GetBuildings() const
+{
+	return bDataIsPublished ? Snapshot->GetBuildings() : Buildings;
+}
+
+
+const TArray<FString>& UStreetMap::GetNames() const
+{
+	return bDataIsPublished ? Snapshot->GetNames() : Names;
+}
+
+
+const TArray<int64>& UStreetMap::GetRoadOsmIds() const
+{
+	return bDataIsPublished ? Snapshot->GetRoadOsmIds() : RoadOsmIds;
+}
+
+
+const TArray<int64>& UStreetMap::GetNodeOsmIds() const
+{
+	return bDataIsPublished ? Snapshot->GetNodeOsmIds() : NodeOsmIds;
+}
+
+
+const TArray<int64>& UStreetMap::GetBuildingOsmIds() const
+{
+	return bDataIsPublished ? Snapshot->GetBuildingOsmIds() : BuildingOsmIds;
+}
+
+
+const FStreetMapRoad* UStreetMap::FindRoadByOsmId( const int64 OsmId ) const
+{
+	// The index and the road have to come from the same snapshot
+	TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> CurrentSnapshot = GetSnapshot();
+	const int32 RoadIndex = CurrentSnapshot->FindRoadIndexByOsmId( OsmId );
+	return RoadIndex != INDEX_NONE ? &CurrentSnapshot->GetRoads()[ RoadIndex ] : nullptr;
+}
+
+
+const FStreetMapNode* UStreetMap::FindNodeByOsmId( const int64 OsmId ) const
+{
+	TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> CurrentSnapshot = GetSnapshot();
+	const int32 NodeIndex = CurrentSnapshot->FindNodeIndexByOsmId( OsmId );
+	return NodeIndex != INDEX_NONE ? &CurrentSnapshot->GetNodes()[ NodeIndex ] : nullptr;
+}
+
+
+const FStreetMapBuilding* UStreetMap::FindBuildingByOsmId( const int64 OsmId ) const
+{
+	TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> CurrentSnapshot = GetSnapshot();
+	const int32 BuildingIndex = CurrentSnapshot->FindBuildingIndexByOsmId( OsmId );
+	return BuildingIndex != INDEX_NONE ? &CurrentSnapshot->GetBuildings()[ BuildingIndex ] : nullptr;
+}
+
+
+void UStreetMap::MakeDataEditable( const bool bKeepPublishedData )
+{
+	if( !bDataIsPublished )
+	{
+		return;
+	}
+
+	if( bKeepPublishedData )
+	{
+		CopyDataFromSnapshot();
+	}
+	bDataIsPublished = false;
+
+	// Derived data loaded with a cooked map doesn't match edited data
+	CookedDerivedData.Reset();
+
+	// Readers keep seeing the old snapshot until the edits are published.  Game thread edits are published at the end of
+	// the frame; anybody else has to call PublishSnapshot() when they're done.
+	if( IsInGameThread() && !PublishAtEndOfFrameHandle.IsValid() && !HasAnyFlags( RF_ClassDefaultObject ) )
+	{
+		PublishAtEndOfFrameHandle = FCoreDelegates::OnEndFrame.AddUObject( this, &UStreetMap::PublishSnapshot );
+	}
+}
+
+
+void UStreetMap::CopyDataFromSnapshot()
+{
+	LLM_SCOPE_BYTAG( StreetMap_Payload );
+
+	Roads = Snapshot->GetRoads();
+	Nodes = Snapshot->GetNodes();
+	NodeRoadRefs = Snapshot->GetNodeRoadRefs();
+	Buildings = Snapshot->GetBuildings();
+	Names = Snapshot->GetNames();
+	RoadOsmIds = Snapshot->GetRoadOsmIds();
+	NodeOsmIds = Snapshot->GetNodeOsmIds();
+	BuildingOsmIds = Snapshot->GetBuildingOsmIds();
+}
+
+
+void UStreetMap::MoveDataIntoSnapshot()
+{
+	LLM_SCOPE_BYTAG( StreetMap_Snapshot );
+
+	// The data moves, so publishing never copies it
+	TSharedRef<FStreetMapSnapshot, ESPMode::ThreadSafe> NewSnapshot = MakeShared<FStreetMapSnapshot, ESPMode::ThreadSafe>( GetFName(), ++SnapshotVersion );
+	NewSnapshot->Roads = MoveTemp( Roads );
+	NewSnapshot->Nodes = MoveTemp( Nodes );
+	NewSnapshot->NodeRoadRefs = MoveTemp( NodeRoadRefs );
+	NewSnapshot->Buildings = MoveTemp( Buildings );
+	NewSnapshot->Names = MoveTemp( Names );
+	NewSnapshot->RoadOsmIds = MoveTemp( RoadOsmIds );
+	NewSnapshot->NodeOsmIds = MoveTemp( NodeOsmIds );
+	NewSnapshot->BuildingOsmIds = MoveTemp( BuildingOsmIds );
+	NewSnapshot->BoundsMin = BoundsMin;
+	NewSnapshot->BoundsMax = BoundsMax;
+	NewSnapshot->CellSize = CellSize;
+	NewSnapshot->DerivedData = MoveTemp( CookedDerivedData );
+
+	ResetData();
+	bDataIsPublished = true;
+
+	TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> OldSnapshot = NewSnapshot;
+	{
+		FWriteScopeLock WriteLock( SnapshotLock );
+		Swap( Snapshot, OldSnapshot );
+	}
+
+	// The old snapshot is freed here, unless some reader still has it
+}
+
+
+void UStreetMap::ResetData()
+{
+	Roads.Empty();
+	Nodes.Empty();
+	NodeRoadRefs.Empty();
+	Buildings.Empty();
+	Names.Empty();
+	NameToIdMap.Empty();
+	RoadOsmIds.Empty();
+	NodeOsmIds.Empty();
+	BuildingOsmIds.Empty();
+}
+
+
+int32 UStreetMap::InternName( const FString& Name )
+{
+	if( Name.IsEmpty() )
+	{
+		return INDEX_NONE;
+	}
+
+	LLM_SCOPE_BYTAG( StreetMap_Payload );
+	MakeDataEditable();
+
+	// The lookup map is transient, so it needs to be rebuilt after the name table was loaded
+	if( NameToIdMap.Num() == 0 && Names.Num() > 0 )
+	{
+		LLM_SCOPE_BYTAG( StreetMap_Lookup );
+		NameToIdMap.Reset();
+		NameToIdMap.Reserve( Names.Num() );
+		for( int32 NameId = 0; NameId < Names.Num(); ++NameId )
+		{
+			NameToIdMap.Add( Names[ NameId ], NameId );
+		}
+	}
+
+	if( const int32* FoundNameIdPtr = NameToIdMap.Find( Name ) )
+	{
+		return *FoundNameIdPtr;
+	}
+
+	const int32 NewNameId = Names.Add( Name );
+	NameToIdMap.Add( Name, NewNameId );
+	return NewNameId;
+}
+
+
+int32 UStreetMap::FindRoadIndexByOsmId( const int64 OsmWayId ) const
+{
+	return GetSnapshot()->FindRoadIndexByOsmId( OsmWayId );
+}
+
+
+int32 UStreetMap::FindNodeIndexByOsmId( const int64 OsmNodeId ) const
+{
+	return GetSnapshot()->FindNodeIndexByOsmId( OsmNodeId );
+}
+
+
+int32 UStreetMap::FindBuildingIndexByOsmId( const int64 OsmWayId ) const
+{
+	return GetSnapshot()->FindBuildingIndexByOsmId( OsmWayId );
+}
+
+
+FStreetMapMemoryUsage UStreetMap::GetMemoryUsage() const
+{
+	FStreetMapMemoryUsage Usage;
+
+	Usage.Payload += Roads.GetAllocatedSize();
+	for( const FStreetMapRoad& Road : Roads )
+	{
+		Usage.Payload += Road.RoadPoints.GetAllocatedSize() + Road.NodeIndices.GetAllocatedSize();
+	}
+	Usage.Payload += Nodes.GetAllocatedSize() + NodeRoadRefs.GetAllocatedSize();
+	Usage.Payload += Buildings.GetAllocatedSize();
+	for( const FStreetMapBuilding& Building : Buildings )
+	{
+		Usage.Payload += Building.BuildingPoints.GetAllocatedSize();
+	}
+	Usage.Payload += Names.GetAllocatedSize();
+	for( const FString& Name : Names )
+	{
+		Usage.Payload += Name.GetAllocatedSize();
+	}
+	Usage.Payload += RoadOsmIds.GetAllocatedSize() + NodeOsmIds.GetAllocatedSize() + BuildingOsmIds.GetAllocatedSize();
+	Usage.Payload += Cells.GetAllocatedSize() + TileBoundaryStubs.GetAllocatedSize();
+
+	// Interned name keys are copies of the name table
+	Usage.Lookup += CellCoordinateToIndexMap.GetAllocatedSize() + NameToIdMap.GetAllocatedSize();
+	for( const TPair<FString, int32>& NameAndId : NameToIdMap )
+	{
+		Usage.Lookup += NameAndId.Key.GetAllocatedSize();
+	}
+
+	const TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> CurrentSnapshot = GetSnapshot();
+	Usage.Snapshot = CurrentSnapshot->GetAllocatedSize();
+	if( const TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> DerivedData = CurrentSnapshot->FindDerivedData() )
+	{
+		Usage.DerivedData = sizeof( FStreetMapDerivedData ) + DerivedData->GetAllocatedSize();
+	}
+
+	return Usage;
+}
+
+
+void UStreetMap::GetResourceSizeEx( FResourceSizeEx& CumulativeResourceSize )
+{
+	Super::GetResourceSizeEx( CumulativeResourceSize );
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes( GetMemoryUsage().GetSystemMemory() );
+}
@@ -4,18 +4,39 @@
 #include "NavigationSystem.h"
 #include "Engine/StaticMesh.h"
 #include "StaticMeshResources.h"
-#include "PolygonTools.h"
+#include "StreetMapDerivedData.h"
+#include "StreetMapSnapshot.h"
+#include "StreetMapCustomVersion.h"
+#include "StreetMapMemory.h"
+#include "StreetMapStats.h"
 #include "PhysicsEngine/BodySetup.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Misc/SecureHash.h"
 
 #if WITH_EDITOR
 #include "Modules/ModuleManager.h"
 #include "PropertyEditorModule.h"
+#include "Interfaces/ITargetPlatform.h"
+#include "DerivedDataCacheInterface.h"
 #endif //WITH_EDITOR
 
+// Change this GUID whenever UStreetMapComponent::GenerateMesh() or SerializeMeshDerivedData() changes, so that cached meshes are rebuilt
+#define STREETMAP_MESH_DERIVEDDATA_VER TEXT("8B1F4D2A6C3E4F5B9A7D0E1C2B3A4F5E")
+
+DEFINE_LOG_CATEGORY_STATIC(LogStreetMapComponent, Log, All);
+
+// Mesh vertices further than this from MeshOrigin (50 km in centimeters) are only accurate to about half a centimeter
+static constexpr double StreetMapMeshPrecisionWarningDistance = 5000000.0;
+
 UStreetMapComponent::UStreetMapComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer),
 	  StreetMap(nullptr),
-	  CachedLocalBounds(ForceInit)
+	  bMeshGenerated(false),
+	  MeshOrigin(FVector::ZeroVector),
+	  CachedLocalBounds(ForceInit),
+	  RenderBufferSize(0),
+	  MeshMemoryStatSize(0)
 {
 	// We make sure our mesh collision profile name is set to NoCollisionProfileName at initialization. 
 	// Because we don't have collision data yet!
@@ -67,14 +88,196 @@ void UStreetMapComponent::UninitializeComponent()
 }
 
 
+void UStreetMapComponent::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	Ar.UsingCustomVersion(FStreetMapCustomVersion::GUID);
+	if (Ar.CustomVer(FStreetMapCustomVersion::GUID) >= FStreetMapCustomVersion::ComponentMeshSerializedByHand)
+	{
+		SerializeMesh(Ar);
+	}
+}
+
+
+void UStreetMapComponent::SerializeMesh(FArchive& Ar)
+{
+	LLM_SCOPE_BYTAG(StreetMap_Mesh);
+
+	bool bHasMesh = HasValidMesh();
+	if (Ar.IsSaving() && Ar.IsPersistent())
+	{
+#if WITH_EDITOR
+		if (Ar.IsCooking())
+		{
+			bHasMesh = bHasMesh && IsMeshNeededOnCookTarget(Ar.CookingTarget());
+		}
+		else
+#endif	// WITH_EDITOR
+		{
+			// Uncooked levels don't keep the mesh.  It's derived data, and PostLoad() fetches or generates it again.
+			// Transactions and duplicates still carry it, since they aren't persistent.
+			bHasMesh = false;
+		}
+	}
+	Ar << bHasMesh;
+
+	if (bHasMesh)
+	{
+		Vertices.BulkSerialize(Ar);
+		Indices.BulkSerialize(Ar);
+	}
+	else if (Ar.IsLoading())
+	{
+		Vertices.Empty();
+		Indices.Empty();
+	}
+
+	if (Ar.IsLoading())
+	{
+		UpdateMeshMemoryStat();
+	}
+}
+
+
+void UStreetMapComponent::SerializeMeshDerivedData(FArchive& Ar)
+{
+	Ar << MeshOrigin;
+	Ar << CachedLocalBounds;
+	Vertices.BulkSerialize(Ar);
+	Indices.BulkSerialize(Ar);
+}
+
+
+void UStreetMapComponent::UpdateMeshMemoryStat()
+{
+	const SIZE_T MeshMemory = Vertices.GetAllocatedSize() + Indices.GetAllocatedSize();
+	DEC_MEMORY_STAT_BY(STAT_StreetMap_MeshMemory, MeshMemoryStatSize);
+	INC_MEMORY_STAT_BY(STAT_StreetMap_MeshMemory, MeshMemory);
+	MeshMemoryStatSize = MeshMemory;
+}
+
+
+void UStreetMapComponent::LoadOrGenerateMesh()
+{
+	LLM_SCOPE_BYTAG(StreetMap_Mesh);
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_LoadOrGenerateMesh);
+
+#if WITH_EDITOR
+	if (StreetMap != nullptr)
+	{
+		const FString DerivedDataKey = GetMeshDerivedDataKey();
+
+		TArray<uint8> DerivedDataBytes;
+		if (GetDerivedDataCacheRef().GetSynchronous(*DerivedDataKey, DerivedDataBytes, GetPathName()))
+		{
+			FMemoryReader Reader(DerivedDataBytes, /* bIsPersistent */ true);
+			SerializeMeshDerivedData(Reader);
+			if (!Reader.IsError())
+			{
+				bMeshGenerated = true;
+				UpdateMeshMemoryStat();
+				return;
+			}
+		}
+
+		GenerateMesh();
+
+		DerivedDataBytes.Reset();
+		FMemoryWriter Writer(DerivedDataBytes, /* bIsPersistent */ true);
+		SerializeMeshDerivedData(Writer);
+		GetDerivedDataCacheRef().Put(*DerivedDataKey, DerivedDataBytes, GetPathName());
+		return;
+	}
+#endif	// WITH_EDITOR
+
+	GenerateMesh();
+}
+
+
+#if WITH_EDITOR
+bool UStreetMapComponent::IsMeshNeededOnCookTarget(const ITargetPlatform* TargetPlatform) const
+{
+	// Dedicated servers never render, so they only need the mesh if collision is built from it.  Roads, nodes and
+	// everything the queries use live on the street map asset, which is cooked for servers as usual.
+	if (TargetPlatform != nullptr && TargetPlatform->IsServerOnly())
+	{
+		return CollisionSettings.bGenerateCollision;
+	}
+
+	return true;
+}
+
+
+FString UStreetMapComponent::GetMeshDerivedDataKey() const
+{
+	// The street map's own key covers its geometry.  The mesh also depends on building heights, the cell size (which
+	// places the mesh origin) and the build settings.
+	FSHA1 Hash;
+	const TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot = StreetMap->GetSnapshot();
+	const FString StreetMapKey = Snapshot->GetDerivedDataKey();
+	Hash.UpdateWithString(*StreetMapKey, StreetMapKey.Len());
+	for (const FStreetMapBuilding& Building : Snapshot->GetBuildings())
+	{
+		Hash.Update((const uint8*)&Building.Height, sizeof(Building.Height));
+		Hash.Update((const uint8*)&Building.BuildingLevels, sizeof(Building.BuildingLevels));
+	}
+	const double CellSize = StreetMap->GetCellSize();
+	Hash.Update((const uint8*)&CellSize, sizeof(CellSize));
+	MeshBuildSettings.UpdateHash(Hash);
+	Hash.Final();
+
+	FSHAHash MeshHash;
+	Hash.GetHash(MeshHash.Hash);
+
+	return FDerivedDataCacheInterface::BuildCacheKey(TEXT("STREETMAPMESH"), STREETMAP_MESH_DERIVEDDATA_VER, *MeshHash.ToString());
+}
+#endif	// WITH_EDITOR
+
+
+void UStreetMapComponent::PostLoad()
+{
+	Super::PostLoad();
+
+	const int32 StreetMapVersion = GetLinkerCustomVersion(FStreetMapCustomVersion::GUID);
+	if (StreetMapVersion < FStreetMapCustomVersion::ComponentMeshIsDerivedData)
+	{
+		// Components saved before the mesh was serialized by hand lost it on load, so assume they had one
+		bMeshGenerated = HasValidMesh() || (StreetMapVersion < FStreetMapCustomVersion::ComponentMeshSerializedByHand && StreetMap != nullptr);
+	}
+
+	// Uncooked levels don't keep the mesh, so fetch it from the derived data cache or generate it again.  Cooked levels
+	// carry it for every platform that uses it.
+	if (!FPlatformProperties::RequiresCookedData() && bMeshGenerated && StreetMap != nullptr && !HasValidMesh())
+	{
+		StreetMap->ConditionalPostLoad();
+		LoadOrGenerateMesh();
+	}
+}
+
+
+void UStreetMapComponent::BeginDestroy()
+{
+	Super::BeginDestroy();
+
+	DEC_MEMORY_STAT_BY(STAT_StreetMap_MeshMemory, MeshMemoryStatSize);
+	MeshMemoryStatSize = 0;
+}
+
+
 FPrimitiveSceneProxy* UStreetMapComponent::CreateSceneProxy()
 {
+	LLM_SCOPE_BYTAG(StreetMap_RenderBuffers);
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_CreateSceneProxy);
+
 	FStreetMapSceneProxy* StreetMapSceneProxy = nullptr;
+	RenderBufferSize = 0;
 
 	if( HasValidMesh() )
 	{
 		StreetMapSceneProxy = new FStreetMapSceneProxy( this );
 		StreetMapSceneProxy->Init( this, Vertices, Indices );
+		RenderBufferSize = StreetMapSceneProxy->GetRenderBufferSize();
 	}
 	
 	return StreetMapSceneProxy;
@@ -105,8 +308,37 @@ void UStreetMapComponent::SetStreetMap(class UStreetMap* NewStreetMap, bool bCle
 }
 
 
+FStreetMapMemoryUsage UStreetMapComponent::GetMemoryUsage() const
+{
+	FStreetMapMemoryUsage Usage;
+	Usage.CPUMesh = Vertices.GetAllocatedSize() + Indices.GetAllocatedSize();
+
+	// The proxy is owned by the render thread, so we only go by the size it had when it was created
+	Usage.GPUBuffers = SceneProxy != nullptr ? RenderBufferSize : 0;
+
+	if (StreetMapBodySetup != nullptr)
+	{
+		Usage.Collision = StreetMapBodySetup->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+	}
+
+	return Usage;
+}
+
+
+void UStreetMapComponent::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	// The body setup is a subobject, so it reports its own size
+	const FStreetMapMemoryUsage Usage = GetMemoryUsage();
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Usage.CPUMesh);
+	CumulativeResourceSize.AddDedicatedVideoMemoryBytes(Usage.GPUBuffers);
+}
+
+
 bool UStreetMapComponent::GetPhysicsTriMeshData(struct FTriMeshCollisionData* CollisionData, bool InUseAllTriData)
 {
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_GetPhysicsTriMeshData);
 
 	if (!CollisionSettings.bGenerateCollision || !HasValidMesh())
 	{
@@ -118,9 +350,11 @@ bool UStreetMapComponent::GetPhysicsTriMeshData(struct FTriMeshCollisionData* Co
 	CollisionData->Vertices.Empty();
 	CollisionData->Vertices.AddUninitialized(NumVertices);
 
+	// Collision lives in component space, so vertices need to be moved back from the mesh origin
+	const FVector3f CollisionMeshOrigin(MeshOrigin);
 	for (int32 VertexIndex = 0; VertexIndex < NumVertices; VertexIndex++)
 	{
-		CollisionData->Vertices[VertexIndex] = Vertices[VertexIndex].Position;
+		CollisionData->Vertices[VertexIndex] = Vertices[VertexIndex].Position + CollisionMeshOrigin;
 	}
 
 	// Copy indices data
@@ -159,6 +393,8 @@ bool UStreetMapComponent::WantsNegXTriMesh()
 
 void UStreetMapComponent::CreateBodySetupIfNeeded(bool bForceCreation /*= false*/)
 {
+	LLM_SCOPE_BYTAG(StreetMap_Collision);
+
 	if (StreetMapBodySetup == nullptr || bForceCreation == true)
 	{
 		// Creating new BodySetup Object.
@@ -179,6 +415,9 @@ void UStreetMapComponent::GenerateCollision()
 		return;
 	}
 
+	LLM_SCOPE_BYTAG(StreetMap_Collision);
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_GenerateCollision);
+
 	// create a new body setup
 	CreateBodySetupIfNeeded(true);
 
@@ -195,6 +434,21 @@ void UStreetMapComponent::GenerateCollision()
 }
 
 
+void UStreetMapComponent::SetCollisionSettings(const FStreetMapCollisionSettings& NewCollisionSettings)
+{
+	CollisionSettings = NewCollisionSettings;
+
+	if (CollisionSettings.bGenerateCollision)
+	{
+		GenerateCollision();
+	}
+	else
+	{
+		ClearCollision();
+	}
+}
+
+
 void UStreetMapComponent::ClearCollision()
 {
 
@@ -229,6 +483,9 @@ class UBodySetup* UStreetMapComponent::GetBodySetup()
 
 void UStreetMapComponent::GenerateMesh()
 {
+	LLM_SCOPE_BYTAG(StreetMap_Mesh);
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_GenerateMesh);
+
 	/////////////////////////////////////////////////////////
 	// Visual tweakables for generated Street Map mesh
 	//
@@ -252,6 +509,7 @@ void UStreetMapComponent::GenerateMesh()
 
 
 	CachedLocalBounds = FBox( ForceInit );
+	MeshOrigin = FVector::ZeroVector;
 	Vertices.Reset();
 	Indices.Reset();
 
@@ -260,9 +518,21 @@ void UStreetMapComponent::GenerateMesh()
 		FBox3f MeshBoundingBox;
 		MeshBoundingBox.Init();
 
-		const auto& Roads = StreetMap->GetRoads();
-		const auto& Nodes = StreetMap->GetNodes();
-		const auto& Buildings = StreetMap->GetBuildings();
+		// Vertices are single precision, so we make them relative to the origin of the grid cell at the center of the map
+		// rather than to the map origin.  The offset is restored in double precision by GetRenderMatrix().  This is one
+		// origin for the whole mesh and its collision, so vertices far from the center are still less accurate (see
+		// MeshOrigin).  Maps only get a precise mesh everywhere when they're split into tiles.
+		{
+			const FVector2D MapCenter = ( StreetMap->GetBoundsMin() + StreetMap->GetBoundsMax() ) * 0.5;
+			const FIntPoint CenterCellCoordinate = StreetMap->GetCellCoordinate( MapCenter );
+			MeshOrigin = FVector( FVector2D( CenterCellCoordinate ) * StreetMap->GetCellSize(), 0.0 );
+		}
+
+		// Building triangles are indexed the same way as the buildings, so both come from the same snapshot
+		const TSharedPtr<const FStreetMapSnapshot, ESPMode::ThreadSafe> Snapshot = StreetMap->GetSnapshot();
+		const auto& Roads = Snapshot->GetRoads();
+		const auto& Nodes = Snapshot->GetNodes();
+		const auto& Buildings = Snapshot->GetBuildings();
 
 		for( const auto& Road : Roads )
 		{
@@ -292,8 +562,8 @@ void UStreetMapComponent::GenerateMesh()
 			for( int32 PointIndex = 0; PointIndex < Road.RoadPoints.Num() - 1; ++PointIndex )
 			{
 				AddThick2DLine( 
-					FVector2f(Road.RoadPoints[ PointIndex ]),
-					FVector2f(Road.RoadPoints[ PointIndex + 1 ]),
+					ToMeshLocation( Road.RoadPoints[ PointIndex ] ),
+					ToMeshLocation( Road.RoadPoints[ PointIndex + 1 ] ),
 					RoadZ,
 					RoadThickness,
 					RoadColor,
@@ -302,20 +572,19 @@ void UStreetMapComponent::GenerateMesh()
 			}
 		}
 		
+		// Building roofs are triangulated ahead of time, as part of the street map's derived data
+		const TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> DerivedData = Snapshot->GetDerivedData();
+
 		TArray< int32 > TempIndices;
-		TArray< int32 > TriangulatedVertexIndices;
+		TArrayView< const int32 > TriangulatedVertexIndices;
 		TArray< FVector3f > TempPoints;
 		for( int32 BuildingIndex = 0; BuildingIndex < Buildings.Num(); ++BuildingIndex )
 		{
 			const auto& Building = Buildings[ BuildingIndex ];
 
 			// Building mesh (or filled area, if the building has no height)
-
-			// Triangulate this building
-			// @todo: Performance: Triangulating lots of building polygons is quite slow.  We could easily do this 
-			//        as part of the import process and store tessellated geometry instead of doing this at load time.
 			bool WindsClockwise;
-			if( FPolygonTools::TriangulatePolygon( Building.BuildingPoints, TempIndices, /* Out */ TriangulatedVertexIndices, /* Out */ WindsClockwise ) )
+			if( DerivedData->GetBuildingTriangles( BuildingIndex, /* Out */ TriangulatedVertexIndices, /* Out */ WindsClockwise ) )
 			{
 				// @todo: Performance: We could preprocess the building shapes so that the points always wind
 				//        in a consistent direction, so we can skip determining the winding above.
@@ -339,7 +608,7 @@ void UStreetMapComponent::GenerateMesh()
 					TempPoints.SetNum( Building.BuildingPoints.Num(), false );
 					for( int32 PointIndex = 0; PointIndex < Building.BuildingPoints.Num(); ++PointIndex )
 					{
-						TempPoints[ PointIndex ] = FVector3f( FVector2f(Building.BuildingPoints[ ( Building.BuildingPoints.Num() - PointIndex ) - 1 ]), BuildingFillZ );
+						TempPoints[ PointIndex ] = FVector3f( ToMeshLocation( Building.BuildingPoints[ ( Building.BuildingPoints.Num() - PointIndex ) - 1 ] ), BuildingFillZ );
 					}
 					AddTriangles( TempPoints, TriangulatedVertexIndices, FVector3f::ForwardVector, FVector3f::UpVector, BuildingFillColor, MeshBoundingBox );
 				}
@@ -357,16 +626,16 @@ void UStreetMapComponent::GenerateMesh()
 							TempPoints.SetNum( 4, false );
 
 							const int32 TopLeftVertexIndex = 0;
-							TempPoints[ TopLeftVertexIndex ] = FVector3f( FVector2f(Building.BuildingPoints[ WindsClockwise ? RightPointIndex : LeftPointIndex ]), BuildingFillZ );
+							TempPoints[ TopLeftVertexIndex ] = FVector3f( ToMeshLocation( Building.BuildingPoints[ WindsClockwise ? RightPointIndex : LeftPointIndex ] ), BuildingFillZ );
 
 							const int32 TopRightVertexIndex = 1;
-							TempPoints[ TopRightVertexIndex ] = FVector3f( FVector2f(Building.BuildingPoints[ WindsClockwise ? LeftPointIndex : RightPointIndex ]), BuildingFillZ );
+							TempPoints[ TopRightVertexIndex ] = FVector3f( ToMeshLocation( Building.BuildingPoints[ WindsClockwise ? LeftPointIndex : RightPointIndex ] ), BuildingFillZ );
 
 							const int32 BottomRightVertexIndex = 2;
-							TempPoints[ BottomRightVertexIndex ] = FVector3f( FVector2f(Building.BuildingPoints[ WindsClockwise ? LeftPointIndex : RightPointIndex ]), 0.0f );
+							TempPoints[ BottomRightVertexIndex ] = FVector3f( ToMeshLocation( Building.BuildingPoints[ WindsClockwise ? LeftPointIndex : RightPointIndex ] ), 0.0f );
 
 							const int32 BottomLeftVertexIndex = 3;
-							TempPoints[ BottomLeftVertexIndex ] = FVector3f( FVector2f(Building.BuildingPoints[ WindsClockwise ? RightPointIndex : LeftPointIndex ]), 0.0f );
+							TempPoints[ BottomLeftVertexIndex ] = FVector3f( ToMeshLocation( Building.BuildingPoints[ WindsClockwise ? RightPointIndex : LeftPointIndex ] ), 0.0f );
 
 
 							TempIndices.SetNum( 6, false );
@@ -394,7 +663,7 @@ void UStreetMapComponent::GenerateMesh()
 							const FVector2D Point = Building.BuildingPoints[ PointIndex ];
 
 							FStreetMapVertex& NewVertex = *new( this->Vertices )FStreetMapVertex();
-							NewVertex.Position = FVector3f( FVector2f(Point), 0.0f );
+							NewVertex.Position = FVector3f( ToMeshLocation( Point ), 0.0f );
 							NewVertex.TextureCoordinate = FVector2f( 0.0f, 0.0f );	// NOTE: We're not using texture coordinates for anything yet
 							NewVertex.TangentX = FVector3f::ForwardVector;	 // NOTE: Tangents aren't important for these unlit buildings
 							NewVertex.TangentZ = FVector3f::UpVector;
@@ -436,8 +705,8 @@ void UStreetMapComponent::GenerateMesh()
 				for( int32 PointIndex = 0; PointIndex < Building.BuildingPoints.Num(); ++PointIndex )
 				{
 					AddThick2DLine(
-						FVector2f(Building.BuildingPoints[ PointIndex ]),
-						FVector2f(Building.BuildingPoints[ ( PointIndex + 1 ) % Building.BuildingPoints.Num() ]),
+						ToMeshLocation( Building.BuildingPoints[ PointIndex ] ),
+						ToMeshLocation( Building.BuildingPoints[ ( PointIndex + 1 ) % Building.BuildingPoints.Num() ] ),
 						BuildingBorderZ,
 						BuildingBorderThickness,		// Thickness
 						BuildingBorderColor,
@@ -448,7 +717,19 @@ void UStreetMapComponent::GenerateMesh()
 		}
 
 		CachedLocalBounds = FBox(MeshBoundingBox);
+		bMeshGenerated = true;
+
+		// The mesh has one origin, so a map this large loses precision at its edges however it is placed.  Only its
+		// tiles can fix that.
+		const double MeshExtent = FMath::Max( CachedLocalBounds.Min.GetAbsMax(), CachedLocalBounds.Max.GetAbsMax() );
+		if( MeshExtent > StreetMapMeshPrecisionWarningDistance )
+		{
+			UE_LOG( LogStreetMapComponent, Warning, TEXT( "Street map %s reaches %.0f km from its mesh origin, so its mesh is only accurate to about %.1f cm at the edges.  Split it into tiles for a precise mesh." ),
+				*StreetMap->GetName(), MeshExtent / 100000.0, FMath::Pow( 2.0, FMath::FloorLog2_64( (uint64)MeshExtent ) - 23.0 ) );
+		}
 	}
+
+	UpdateMeshMemoryStat();
 }
 
 
@@ -496,7 +777,7 @@ void UStreetMapComponent::BuildMesh()
 	// Wipes out our cached mesh data. Maybe unnecessary in case GenerateMesh is clearing cached mesh data and creating a new SceneProxy  !
 	InvalidateMesh();
 
-	GenerateMesh();
+	LoadOrGenerateMesh();
 
 	if (HasValidMesh())
 	{
@@ -541,9 +822,12 @@ void UStreetMapComponent::UpdateNavigationIfNeeded()
 
 void UStreetMapComponent::InvalidateMesh()
 {
+	bMeshGenerated = false;
 	Vertices.Reset();
 	Indices.Reset();
+	MeshOrigin = FVector::ZeroVector;
 	CachedLocalBounds = FBoxSphereBounds(FBox(ForceInit));
+	UpdateMeshMemoryStat();
 	ClearCollision();
 	// Mark our render state dirty so that CreateSceneProxy can refresh it on demand
 	MarkRenderStateDirty();
@@ -554,7 +838,7 @@ FBoxSphereBounds UStreetMapComponent::CalcBounds( const FTransform& LocalToWorld
 {
 	if( HasValidMesh() )
 	{
-		FBoxSphereBounds WorldSpaceBounds = CachedLocalBounds.TransformBy( LocalToWorld );
+		FBoxSphereBounds WorldSpaceBounds = CachedLocalBounds.TransformBy( FTransform( MeshOrigin ) * LocalToWorld );
 		WorldSpaceBounds.BoxExtent *= BoundsScale;
 		WorldSpaceBounds.SphereRadius *= BoundsScale;
 		return WorldSpaceBounds;
@@ -566,6 +850,13 @@ FBoxSphereBounds UStreetMapComponent::CalcBounds( const FTransform& LocalToWorld
 }
 
 
+FMatrix UStreetMapComponent::GetRenderMatrix() const
+{
+	// Our vertices are relative to the mesh origin, so offset them back into component space in double precision
+	return FTranslationMatrix( MeshOrigin ) * Super::GetRenderMatrix();
+}
+
+
 void UStreetMapComponent::AddThick2DLine( const FVector2f Start, const FVector2f End, const float Z, const float Thickness, const FColor& StartColor, const FColor& EndColor, FBox3f& MeshBoundingBox )
 {
 	const float HalfThickness = Thickness * 0.5f;
@@ -619,7 +910,7 @@ void UStreetMapComponent::AddThick2DLine( const FVector2f Start, const FVector2f
 };
 
 
-void UStreetMapComponent::AddTriangles( const TArray<FVector3f>& Points, const TArray<int32>& PointIndices, const FVector3f& ForwardVector, const FVector3f& UpVector, const FColor& Color, FBox3f& MeshBoundingBox )
+void UStreetMapComponent::AddTriangles( const TArray<FVector3f>& Points, TArrayView<const int32> PointIndices, const FVector3f& ForwardVector, const FVector3f& UpVector, const FColor& Color, FBox3f& MeshBoundingBox )
 {
 	const int32 FirstVertexIndex = Vertices.Num();
 
@@ -0,0 +1,9 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapCustomVersion.h"
+#include "Serialization/CustomVersion.h"
+
+const FGuid FStreetMapCustomVersion::GUID(0xCAF72E06, 0xE9CB4A79, 0x94B27AB0, 0x8AEC1ED3);
+
+// Register the custom version with core
+FCustomVersionRegistration GRegisterStreetMapCustomVersion(FStreetMapCustomVersion::GUID, FStreetMapCustomVersion::LatestVersion, TEXT("StreetMapVer"));
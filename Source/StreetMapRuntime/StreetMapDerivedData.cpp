@@ -0,0 +1,123 @@
+#include "StreetMapDerivedData.h"
+#include "StreetMapSnapshot.h"
+#include "PolygonTools.h"
+
+
+void FStreetMapDerivedData::Build( const FStreetMapSnapshot& Snapshot )
+{
+	// Building roofs
+	{
+		const TArray<FStreetMapBuilding>& Buildings = Snapshot.GetBuildings();
+
+		BuildingTriangleOffsets.Reset( Buildings.Num() + 1 );
+		BuildingTriangleIndices.Reset();
+		BuildingTriangleFlags.Reset( Buildings.Num() );
+
+		TArray<int32> TempIndices;
+		TArray<int32> TriangulatedIndices;
+		for( const FStreetMapBuilding& Building : Buildings )
+		{
+			BuildingTriangleOffsets.Add( BuildingTriangleIndices.Num() );
+
+			uint8 Flags = 0;
+			bool bWindsClockwise = false;
+			if( FPolygonTools::TriangulatePolygon( Building.BuildingPoints, TempIndices, /* Out */ TriangulatedIndices, /* Out */ bWindsClockwise ) )
+			{
+				Flags |= EBuildingTriangleFlags::Triangulated;
+				Flags |= bWindsClockwise ? EBuildingTriangleFlags::WindsClockwise : 0;
+				BuildingTriangleIndices.Append( TriangulatedIndices );
+			}
+			BuildingTriangleFlags.Add( Flags );
+		}
+		BuildingTriangleOffsets.Add( BuildingTriangleIndices.Num() );
+	}
+
+	// Road graph.  Each node gets an edge to the nearest node up and down every road it's on, in every direction that
+	// can be traveled, which is the same set of connections FStreetMapNode::GetConnection() finds when traveling forward.
+	{
+		const TArray<FStreetMapNode>& Nodes = Snapshot.GetNodes();
+		const TArray<FStreetMapRoad>& Roads = Snapshot.GetRoads();
+
+		GraphEdgeOffsets.Reset( Nodes.Num() + 1 );
+		GraphEdges.Reset();
+
+		for( const FStreetMapNode& Node : Nodes )
+		{
+			GraphEdgeOffsets.Add( GraphEdges.Num() );
+
+			for( const FStreetMapRoadRef& RoadRef : Snapshot.GetRoadRefs( Node ) )
+			{
+				const FStreetMapRoad& Road = Roads[ RoadRef.RoadIndex ];
+
+				auto AddEdge = [&]( const int32 ToRoadPointIndex )
+				{
+					FStreetMapGraphEdge& Edge = GraphEdges.AddDefaulted_GetRef();
+					Edge.ToNodeIndex = Road.NodeIndices[ ToRoadPointIndex ];
+					Edge.RoadIndex = RoadRef.RoadIndex;
+					Edge.FromRoadPointIndex = RoadRef.RoadPointIndex;
+					Edge.ToRoadPointIndex = ToRoadPointIndex;
+					Edge.Length = Road.ComputeDistanceBetweenPointsOnRoad( RoadRef.RoadPointIndex, ToRoadPointIndex );
+				};
+
+				if( RoadRef.RoadPointIndex > 0 && !Road.IsOneWay() )
+				{
+					int32 EarlierNodeRoadPointIndex = RoadRef.RoadPointIndex - 1;
+					while( EarlierNodeRoadPointIndex > 0 && Road.NodeIndices[ EarlierNodeRoadPointIndex ] == INDEX_NONE )
+					{
+						--EarlierNodeRoadPointIndex;
+					}
+					if( Road.NodeIndices[ EarlierNodeRoadPointIndex ] != INDEX_NONE )
+					{
+						AddEdge( EarlierNodeRoadPointIndex );
+					}
+				}
+
+				if( RoadRef.RoadPointIndex < Road.NodeIndices.Num() - 1 )
+				{
+					int32 LaterNodeRoadPointIndex = RoadRef.RoadPointIndex + 1;
+					while( LaterNodeRoadPointIndex < Road.NodeIndices.Num() - 1 && Road.NodeIndices[ LaterNodeRoadPointIndex ] == INDEX_NONE )
+					{
+						++LaterNodeRoadPointIndex;
+					}
+					if( Road.NodeIndices[ LaterNodeRoadPointIndex ] != INDEX_NONE )
+					{
+						AddEdge( LaterNodeRoadPointIndex );
+					}
+				}
+			}
+		}
+		GraphEdgeOffsets.Add( GraphEdges.Num() );
+	}
+
+	// Spatial queries
+	RoadSegmentIndex.Build( Snapshot.GetRoads() );
+	NodeIndex.Build( Snapshot.GetNodes() );
+	BuildingIndex.Build( Snapshot.GetBuildings() );
+}
+
+
+SIZE_T FStreetMapDerivedData::GetAllocatedSize() const
+{
+	return BuildingTriangleOffsets.GetAllocatedSize() +
+		BuildingTriangleIndices.GetAllocatedSize() +
+		BuildingTriangleFlags.GetAllocatedSize() +
+		GraphEdgeOffsets.GetAllocatedSize() +
+		GraphEdges.GetAllocatedSize() +
+		RoadSegmentIndex.GetAllocatedSize() +
+		NodeIndex.GetAllocatedSize() +
+		BuildingIndex.GetAllocatedSize();
+}
+
+
+FArchive& operator<<( FArchive& Ar, FStreetMapDerivedData& DerivedData )
+{
+	DerivedData.BuildingTriangleOffsets.BulkSerialize( Ar );
+	DerivedData.BuildingTriangleIndices.BulkSerialize( Ar );
+	DerivedData.BuildingTriangleFlags.BulkSerialize( Ar );
+	DerivedData.GraphEdgeOffsets.BulkSerialize( Ar );
+	Ar << DerivedData.GraphEdges;
+	Ar << DerivedData.RoadSegmentIndex;
+	Ar << DerivedData.NodeIndex;
+	Ar << DerivedData.BuildingIndex;
+	return Ar;
+}
@@ -0,0 +1,109 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapGeoReference.h"
+#include "Async/ParallelFor.h"
+
+// Length of the equator, see https://en.wikipedia.org/wiki/Equator#Exact_length
+const double FStreetMapGeoReference::DefaultMetersPerDegree = 40075036.0 / 360.0;
+
+namespace StreetMapGeoReference
+{
+	/** Batches are converted in chunks of this many points, one chunk per worker task */
+	static const int32 BatchChunkSize = 16 * 1024;
+
+	/** Terms of the projection that only depend on the geo reference, computed once per conversion */
+	struct FProjection
+	{
+		double MetersPerDegree;
+		double UnitsPerMeter;
+		double OriginLongitudeMeters;
+		double NegatedOriginLatitudeMeters;
+
+		explicit FProjection(const FStreetMapGeoReference& GeoReference)
+			: MetersPerDegree(GeoReference.MetersPerDegree),
+			  UnitsPerMeter(GeoReference.UnitsPerMeter),
+			  OriginLongitudeMeters(GeoReference.OriginLongitude * GeoReference.MetersPerDegree),
+			  NegatedOriginLatitudeMeters(-GeoReference.OriginLatitude * GeoReference.MetersPerDegree)
+		{
+		}
+
+		/**
+		 * Projects a single point.  Both single and batched conversions go through here.  Don't change the order of
+		 * operations: maps imported so far were projected with exactly this arithmetic.
+		 */
+		FORCEINLINE FVector2D Project(const double Latitude, const double Longitude) const
+		{
+			const double CosLatitude = FMath::Cos(FMath::DegreesToRadians(Latitude));
+			return FVector2D(
+				Longitude * MetersPerDegree * CosLatitude - OriginLongitudeMeters * CosLatitude,
+				-Latitude * MetersPerDegree - NegatedOriginLatitudeMeters) * UnitsPerMeter;
+		}
+	};
+
+	/** Runs Function over [0, Num) in chunks, in parallel when there are enough points to be worth it */
+	template<typename FunctionType>
+	static void ForEachChunk(const int32 Num, FunctionType&& Function)
+	{
+		const int32 NumChunks = FMath::DivideAndRoundUp(Num, BatchChunkSize);
+		ParallelFor(NumChunks, [Num, &Function](const int32 ChunkIndex)
+		{
+			const int32 Begin = ChunkIndex * BatchChunkSize;
+			Function(Begin, FMath::Min(Begin + BatchChunkSize, Num));
+		}, NumChunks <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+	}
+}
+
+
+FVector2D FStreetMapGeoReference::GeoToMap(const double Latitude, const double Longitude) const
+{
+	return StreetMapGeoReference::FProjection(*this).Project(Latitude, Longitude);
+}
+
+
+void FStreetMapGeoReference::MapToGeo(const FVector2D& MapLocation, double& OutLatitude, double& OutLongitude) const
+{
+	const FVector2D Meters = MapLocation / UnitsPerMeter;
+	OutLatitude = OriginLatitude - Meters.Y / MetersPerDegree;
+
+	// Longitude is undefined at the poles
+	const double CosLatitude = FMath::Cos(FMath::DegreesToRadians(OutLatitude));
+	OutLongitude = OriginLongitude + (FMath::Abs(CosLatitude) > UE_DOUBLE_SMALL_NUMBER ? Meters.X / (MetersPerDegree * CosLatitude) : 0.0);
+}
+
+
+void FStreetMapGeoReference::GeoToMap(TArrayView<const double> Latitudes, TArrayView<const double> Longitudes, TArrayView<FVector2D> OutMapLocations) const
+{
+	check(Latitudes.Num() == Longitudes.Num() && Latitudes.Num() == OutMapLocations.Num());
+
+	const StreetMapGeoReference::FProjection Projection(*this);
+	const double* RESTRICT LatitudeData = Latitudes.GetData();
+	const double* RESTRICT LongitudeData = Longitudes.GetData();
+	FVector2D* RESTRICT MapLocationData = OutMapLocations.GetData();
+
+	StreetMapGeoReference::ForEachChunk(Latitudes.Num(), [&Projection, LatitudeData, LongitudeData, MapLocationData](const int32 Begin, const int32 End)
+	{
+		// Branch free loop over plain arrays, so the compiler can vectorize it
+		for (int32 Index = Begin; Index < End; ++Index)
+		{
+			MapLocationData[Index] = Projection.Project(LatitudeData[Index], LongitudeData[Index]);
+		}
+	});
+}
+
+
+void FStreetMapGeoReference::MapToGeo(TArrayView<const FVector2D> MapLocations, TArrayView<double> OutLatitudes, TArrayView<double> OutLongitudes) const
+{
+	check(MapLocations.Num() == OutLatitudes.Num() && MapLocations.Num() == OutLongitudes.Num());
+
+	const FVector2D* RESTRICT MapLocationData = MapLocations.GetData();
+	double* RESTRICT LatitudeData = OutLatitudes.GetData();
+	double* RESTRICT LongitudeData = OutLongitudes.GetData();
+
+	StreetMapGeoReference::ForEachChunk(MapLocations.Num(), [this, MapLocationData, LatitudeData, LongitudeData](const int32 Begin, const int32 End)
+	{
+		for (int32 Index = Begin; Index < End; ++Index)
+		{
+			MapToGeo(MapLocationData[Index], LatitudeData[Index], LongitudeData[Index]);
+		}
+	});
+}
@@ -0,0 +1,320 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapMapMatcher.h"
+#include "StreetMap.h"
+#include "StreetMapDerivedData.h"
+#include "StreetMapSnapshot.h"
+
+namespace StreetMapMapMatcher
+{
+	/**
+	 * Finds the nearest graph node on a road before (Direction -1) or after (Direction 1) a location on that road, and how
+	 * far along the road the node is from the location.  Only intersections are graph nodes, so this may find nothing.
+	 */
+	static bool FindNodeAlongRoad(const FStreetMapRoad& Road, const FStreetMapRoadLocation& RoadLocation, const int32 Direction, int32& OutNodeIndex, double& OutDistance)
+	{
+		const int32 NumPoints = FMath::Min(Road.RoadPoints.Num(), Road.NodeIndices.Num());
+		int32 PointIndex = Direction < 0 ? RoadLocation.SegmentIndex : RoadLocation.SegmentIndex + 1;
+		if (PointIndex < 0 || PointIndex >= NumPoints)
+		{
+			return false;
+		}
+
+		double Distance = FVector2D::Distance(RoadLocation.Location, Road.RoadPoints[PointIndex]);
+		while (Road.NodeIndices[PointIndex] == INDEX_NONE)
+		{
+			const int32 NextPointIndex = PointIndex + Direction;
+			if (NextPointIndex < 0 || NextPointIndex >= NumPoints)
+			{
+				return false;
+			}
+			Distance += FVector2D::Distance(Road.RoadPoints[PointIndex], Road.RoadPoints[NextPointIndex]);
+			PointIndex = NextPointIndex;
+		}
+
+		OutNodeIndex = Road.NodeIndices[PointIndex];
+		OutDistance = Distance;
+		return true;
+	}
+
+	/** Log probability that a sample was recorded on a candidate, less a constant */
+	static double EmissionScore(const FStreetMapRoadLocation& Candidate, const double GpsNoise)
+	{
+		const double NormalizedDistance = Candidate.Distance / GpsNoise;
+		return -0.5 * NormalizedDistance * NormalizedDistance;
+	}
+}
+
+
+FStreetMapMapMatcher::FStreetMapMapMatcher(const TSharedRef<const FStreetMapSnapshot, ESPMode::ThreadSafe>& InSnapshot, const FStreetMapMapMatchSettings& Settings, const double WorldToMapScale)
+	: Snapshot(InSnapshot),
+	  DerivedDataRef(InSnapshot->GetDerivedData().ToSharedRef()),
+	  Roads(InSnapshot->GetRoads()),
+	  DerivedData(*DerivedDataRef),
+	  SearchRadius(FMath::Max(Settings.SearchRadius, 0.0f) * WorldToMapScale),
+	  MaxCandidates(FMath::Max(Settings.MaxCandidates, 1)),
+	  GpsNoise(FMath::Max(Settings.GpsNoise, 1.0f) * WorldToMapScale),
+	  RouteDeviation(FMath::Max(Settings.RouteDeviation, 1.0f) * WorldToMapScale),
+	  MaxDetour(FMath::Max(Settings.MaxDetour, 0.0f) * WorldToMapScale),
+	  Filter(Settings.Filter)
+{
+}
+
+
+void FStreetMapMapMatcher::MatchTrace(TArrayView<const FVector2D> Samples, TArrayView<FStreetMapRoadLocation> OutRoadLocations, FScratch& Scratch) const
+{
+	using namespace StreetMapMapMatcher;
+
+	check(Samples.Num() == OutRoadLocations.Num());
+
+	// Every sample's candidates are the nearest location on each of the nearest roads
+	const FStreetMapRoadSegmentIndex& RoadSegmentIndex = DerivedData.GetRoadSegmentIndex();
+	Scratch.Candidates.Reset();
+	Scratch.CandidateOffsets.Reset(Samples.Num() + 1);
+	for (const FVector2D& Sample : Samples)
+	{
+		Scratch.CandidateOffsets.Add(Scratch.Candidates.Num());
+		RoadSegmentIndex.FindNearestRoads(Roads, Sample, MaxCandidates, SearchRadius, [this](const int32 RoadIndex)
+		{
+			return Filter.AllowsRoadType(Roads[RoadIndex].RoadType);
+		}, Scratch.SampleCandidates);
+		Scratch.Candidates.Append(Scratch.SampleCandidates);
+	}
+	Scratch.CandidateOffsets.Add(Scratch.Candidates.Num());
+
+	const TArray<FStreetMapRoadLocation>& Candidates = Scratch.Candidates;
+	const TArray<int32>& Offsets = Scratch.CandidateOffsets;
+	Scratch.Scores.SetNumUninitialized(Candidates.Num(), EAllowShrinking::No);
+	Scratch.Previous.SetNumUninitialized(Candidates.Num(), EAllowShrinking::No);
+
+	// Viterbi over runs of samples that can be connected.  A sample without candidates, or one none of whose candidates
+	// can be reached from the sample before it, ends the run so far, which is then matched on its own.
+	int32 RunStart = INDEX_NONE;
+	for (int32 SampleIndex = 0; SampleIndex < Samples.Num(); ++SampleIndex)
+	{
+		const int32 FirstCandidate = Offsets[SampleIndex];
+		const int32 EndCandidate = Offsets[SampleIndex + 1];
+		if (FirstCandidate == EndCandidate)
+		{
+			if (RunStart != INDEX_NONE)
+			{
+				Backtrack(RunStart, SampleIndex, OutRoadLocations, Scratch);
+				RunStart = INDEX_NONE;
+			}
+			OutRoadLocations[SampleIndex] = FStreetMapRoadLocation();
+			continue;
+		}
+
+		bool bConnected = false;
+		if (RunStart != INDEX_NONE)
+		{
+			for (int32 CandidateIndex = FirstCandidate; CandidateIndex < EndCandidate; ++CandidateIndex)
+			{
+				Scratch.Scores[CandidateIndex] = -MAX_dbl;
+				Scratch.Previous[CandidateIndex] = INDEX_NONE;
+			}
+
+			// One bounded shortest path search per candidate of the previous sample reaches all of this sample's candidates
+			const double StraightDistance = FVector2D::Distance(Samples[SampleIndex - 1], Samples[SampleIndex]);
+			const TArrayView<const FStreetMapRoadLocation> ToCandidates(Candidates.GetData() + FirstCandidate, EndCandidate - FirstCandidate);
+			Scratch.RouteDistances.SetNumUninitialized(ToCandidates.Num(), EAllowShrinking::No);
+			for (int32 FromIndex = Offsets[SampleIndex - 1]; FromIndex < FirstCandidate; ++FromIndex)
+			{
+				if (Scratch.Scores[FromIndex] == -MAX_dbl)
+				{
+					continue;
+				}
+
+				FindRouteDistances(Candidates[FromIndex], ToCandidates, StraightDistance + MaxDetour, Scratch.RouteDistances, Scratch);
+				for (int32 ToIndex = 0; ToIndex < ToCandidates.Num(); ++ToIndex)
+				{
+					const double RouteDistance = Scratch.RouteDistances[ToIndex];
+					if (RouteDistance == MAX_dbl)
+					{
+						continue;
+					}
+
+					const double Score = Scratch.Scores[FromIndex] - FMath::Abs(RouteDistance - StraightDistance) / RouteDeviation;
+					if (Score > Scratch.Scores[FirstCandidate + ToIndex])
+					{
+						Scratch.Scores[FirstCandidate + ToIndex] = Score;
+						Scratch.Previous[FirstCandidate + ToIndex] = FromIndex;
+					}
+				}
+			}
+
+			for (int32 CandidateIndex = FirstCandidate; CandidateIndex < EndCandidate; ++CandidateIndex)
+			{
+				if (Scratch.Previous[CandidateIndex] != INDEX_NONE)
+				{
+					Scratch.Scores[CandidateIndex] += EmissionScore(Candidates[CandidateIndex], GpsNoise);
+					bConnected = true;
+				}
+			}
+
+			if (!bConnected)
+			{
+				Backtrack(RunStart, SampleIndex, OutRoadLocations, Scratch);
+			}
+		}
+
+		if (!bConnected)
+		{
+			RunStart = SampleIndex;
+			for (int32 CandidateIndex = FirstCandidate; CandidateIndex < EndCandidate; ++CandidateIndex)
+			{
+				Scratch.Scores[CandidateIndex] = EmissionScore(Candidates[CandidateIndex], GpsNoise);
+				Scratch.Previous[CandidateIndex] = INDEX_NONE;
+			}
+		}
+	}
+
+	if (RunStart != INDEX_NONE)
+	{
+		Backtrack(RunStart, Samples.Num(), OutRoadLocations, Scratch);
+	}
+}
+
+
+void FStreetMapMapMatcher::FindRouteDistances(const FStreetMapRoadLocation& From, TArrayView<const FStreetMapRoadLocation> To, const double MaxDistance, TArrayView<double> OutDistances, FScratch& Scratch) const
+{
+	using namespace StreetMapMapMatcher;
+
+	const FStreetMapRoad& FromRoad = Roads[From.RoadIndex];
+
+	// Candidates further along the same road can be driven to directly, unless that means going the wrong way down a one
+	// way road.  Every candidate can also be reached from the graph nodes either side of it on its road.
+	Scratch.RouteEnds.Reset();
+	for (int32 ToIndex = 0; ToIndex < To.Num(); ++ToIndex)
+	{
+		const FStreetMapRoadLocation& ToLocation = To[ToIndex];
+		const FStreetMapRoad& ToRoad = Roads[ToLocation.RoadIndex];
+
+		OutDistances[ToIndex] = MAX_dbl;
+		if (ToLocation.RoadIndex == From.RoadIndex && (ToLocation.PositionAlongRoad >= From.PositionAlongRoad || !FromRoad.IsOneWay()))
+		{
+			const double Distance = FMath::Abs(ToLocation.PositionAlongRoad - From.PositionAlongRoad);
+			if (Distance <= MaxDistance)
+			{
+				OutDistances[ToIndex] = Distance;
+			}
+		}
+
+		int32 NodeIndex;
+		double NodeDistance;
+		if (FindNodeAlongRoad(ToRoad, ToLocation, -1, NodeIndex, NodeDistance))
+		{
+			Scratch.RouteEnds.Add({ NodeIndex, NodeDistance, ToIndex });
+		}
+		if (!ToRoad.IsOneWay() && FindNodeAlongRoad(ToRoad, ToLocation, 1, NodeIndex, NodeDistance))
+		{
+			Scratch.RouteEnds.Add({ NodeIndex, NodeDistance, ToIndex });
+		}
+	}
+
+	if (Scratch.RouteEnds.Num() == 0)
+	{
+		return;
+	}
+
+	// Dijkstra's algorithm from the graph nodes either side of From, until every route end's node has been reached or the
+	// remaining routes are too long
+	const int32 NodeCount = DerivedData.GetNodeCount();
+	TArray<double>& NodeDistances = Scratch.NodeDistances;
+	TArray<uint32>& NodeSearchIds = Scratch.NodeSearchIds;
+	TArray<TPair<double, int32>>& Queue = Scratch.Queue;
+	if (NodeSearchIds.Num() < NodeCount)
+	{
+		// New nodes were never reached by any search.  Scratch can move between matchers, so it only ever grows.
+		NodeSearchIds.SetNumZeroed(NodeCount);
+		NodeDistances.SetNumUninitialized(NodeCount);
+	}
+	if (++Scratch.SearchId == 0)
+	{
+		// Wrapped around, so nodes reached long ago could look reached by this search
+		FMemory::Memzero(NodeSearchIds.GetData(), NodeSearchIds.Num() * sizeof(uint32));
+		Scratch.SearchId = 1;
+	}
+	const uint32 SearchId = Scratch.SearchId;
+	Queue.Reset();
+
+	const auto QueuePredicate = [](const TPair<double, int32>& A, const TPair<double, int32>& B)
+	{
+		return A.Key < B.Key;
+	};
+	const auto Reach = [&](const int32 NodeIndex, const double Distance)
+	{
+		if (NodeIndex < 0 || NodeIndex >= NodeCount || Distance > MaxDistance)
+		{
+			return;
+		}
+		if (NodeSearchIds[NodeIndex] != SearchId || Distance < NodeDistances[NodeIndex])
+		{
+			NodeSearchIds[NodeIndex] = SearchId;
+			NodeDistances[NodeIndex] = Distance;
+			Queue.HeapPush(TPair<double, int32>(Distance, NodeIndex), QueuePredicate);
+		}
+	};
+
+	int32 NodeIndex;
+	double NodeDistance;
+	if (FindNodeAlongRoad(FromRoad, From, 1, NodeIndex, NodeDistance))
+	{
+		Reach(NodeIndex, NodeDistance);
+	}
+	if (!FromRoad.IsOneWay() && FindNodeAlongRoad(FromRoad, From, -1, NodeIndex, NodeDistance))
+	{
+		Reach(NodeIndex, NodeDistance);
+	}
+
+	int32 RouteEndsLeft = Scratch.RouteEnds.Num();
+	while (Queue.Num() > 0 && RouteEndsLeft > 0)
+	{
+		TPair<double, int32> Entry;
+		Queue.HeapPop(Entry, QueuePredicate, EAllowShrinking::No);
+		const double Distance = Entry.Key;
+		const int32 VisitedNodeIndex = Entry.Value;
+		if (Distance > NodeDistances[VisitedNodeIndex])
+		{
+			// Stale entry, the node was reached by a shorter route since this was queued
+			continue;
+		}
+
+		for (FScratch::FRouteEnd& RouteEnd : Scratch.RouteEnds)
+		{
+			if (RouteEnd.NodeIndex == VisitedNodeIndex)
+			{
+				OutDistances[RouteEnd.CandidateIndex] = FMath::Min(OutDistances[RouteEnd.CandidateIndex], Distance + RouteEnd.Distance);
+				RouteEnd.NodeIndex = INDEX_NONE;
+				--RouteEndsLeft;
+			}
+		}
+
+		for (const FStreetMapGraphEdge& Edge : DerivedData.GetNodeEdges(VisitedNodeIndex))
+		{
+			Reach(Edge.ToNodeIndex, Distance + Edge.Length);
+		}
+	}
+}
+
+
+void FStreetMapMapMatcher::Backtrack(const int32 FirstSample, const int32 EndSample, TArrayView<FStreetMapRoadLocation> OutRoadLocations, const FScratch& Scratch) const
+{
+	int32 BestCandidate = INDEX_NONE;
+	double BestScore = -MAX_dbl;
+	for (int32 CandidateIndex = Scratch.CandidateOffsets[EndSample - 1]; CandidateIndex < Scratch.CandidateOffsets[EndSample]; ++CandidateIndex)
+	{
+		if (BestCandidate == INDEX_NONE || Scratch.Scores[CandidateIndex] > BestScore)
+		{
+			BestCandidate = CandidateIndex;
+			BestScore = Scratch.Scores[CandidateIndex];
+		}
+	}
+
+	for (int32 SampleIndex = EndSample - 1; SampleIndex >= FirstSample; --SampleIndex)
+	{
+		check(BestCandidate != INDEX_NONE);
+		OutRoadLocations[SampleIndex] = Scratch.Candidates[BestCandidate];
+		BestCandidate = Scratch.Previous[BestCandidate];
+	}
+}
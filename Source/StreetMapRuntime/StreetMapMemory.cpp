@@ -0,0 +1,145 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapMemory.h"
+#include "StreetMap.h"
+#include "StreetMapComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+LLM_DEFINE_TAG(StreetMap);
+LLM_DEFINE_TAG(StreetMap_Payload);
+LLM_DEFINE_TAG(StreetMap_Lookup);
+LLM_DEFINE_TAG(StreetMap_DerivedData);
+LLM_DEFINE_TAG(StreetMap_Snapshot);
+LLM_DEFINE_TAG(StreetMap_Mesh);
+LLM_DEFINE_TAG(StreetMap_RenderBuffers);
+LLM_DEFINE_TAG(StreetMap_Collision);
+LLM_DEFINE_TAG(StreetMap_Loading);
+
+namespace StreetMapMemory
+{
+	static double ToKB(SIZE_T Bytes)
+	{
+		return (double)Bytes / 1024.0;
+	}
+}
+
+static FAutoConsoleCommandWithOutputDevice GStreetMapMemReportCommand(
+	TEXT("StreetMap.MemReport"),
+	TEXT("Prints how much memory each loaded street map asset and street map component uses"),
+	FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&FStreetMapMemoryReport::Print));
+
+
+FStreetMapMemoryUsage& FStreetMapMemoryUsage::operator+=(const FStreetMapMemoryUsage& Other)
+{
+	Payload += Other.Payload;
+	Lookup += Other.Lookup;
+	DerivedData += Other.DerivedData;
+	Snapshot += Other.Snapshot;
+	CPUMesh += Other.CPUMesh;
+	GPUBuffers += Other.GPUBuffers;
+	Collision += Other.Collision;
+	return *this;
+}
+
+
+void FStreetMapMemoryReport::Print(FOutputDevice& Ar)
+{
+	using namespace StreetMapMemory;
+
+	// Biggest first, since those are the ones worth looking at
+	TArray<TPair<const UStreetMap*, FStreetMapMemoryUsage>> StreetMaps;
+	for (TObjectIterator<UStreetMap> It; It; ++It)
+	{
+		if (!It->IsTemplate())
+		{
+			StreetMaps.Emplace(*It, It->GetMemoryUsage());
+		}
+	}
+	StreetMaps.Sort([](const TPair<const UStreetMap*, FStreetMapMemoryUsage>& A, const TPair<const UStreetMap*, FStreetMapMemoryUsage>& B)
+	{
+		return A.Value.GetTotal() > B.Value.GetTotal();
+	});
+
+	TArray<TPair<const UStreetMapComponent*, FStreetMapMemoryUsage>> Components;
+	for (TObjectIterator<UStreetMapComponent> It; It; ++It)
+	{
+		if (!It->IsTemplate())
+		{
+			Components.Emplace(*It, It->GetMemoryUsage());
+		}
+	}
+	Components.Sort([](const TPair<const UStreetMapComponent*, FStreetMapMemoryUsage>& A, const TPair<const UStreetMapComponent*, FStreetMapMemoryUsage>& B)
+	{
+		return A.Value.GetTotal() > B.Value.GetTotal();
+	});
+
+	FStreetMapMemoryUsage StreetMapTotal;
+	Ar.Logf(TEXT("%d street map assets:"), StreetMaps.Num());
+	PrintStreetMapHeader(Ar);
+	for (const TPair<const UStreetMap*, FStreetMapMemoryUsage>& StreetMap : StreetMaps)
+	{
+		PrintStreetMap(Ar, *StreetMap.Key, StreetMap.Value);
+		StreetMapTotal += StreetMap.Value;
+	}
+
+	FStreetMapMemoryUsage ComponentTotal;
+	Ar.Logf(TEXT(""));
+	Ar.Logf(TEXT("%d street map components:"), Components.Num());
+	PrintComponentHeader(Ar);
+	for (const TPair<const UStreetMapComponent*, FStreetMapMemoryUsage>& Component : Components)
+	{
+		PrintComponent(Ar, *Component.Key, Component.Value);
+		ComponentTotal += Component.Value;
+	}
+
+	FStreetMapMemoryUsage Total = StreetMapTotal;
+	Total += ComponentTotal;
+	Ar.Logf(TEXT(""));
+	Ar.Logf(TEXT("Street map totals:  assets %.1f KB, components %.1f KB (system %.1f KB, GPU %.1f KB), all %.1f KB"),
+		ToKB(StreetMapTotal.GetTotal()),
+		ToKB(ComponentTotal.GetTotal()),
+		ToKB(Total.GetSystemMemory()),
+		ToKB(Total.GPUBuffers),
+		ToKB(Total.GetTotal()));
+}
+
+
+void FStreetMapMemoryReport::PrintStreetMapHeader(FOutputDevice& Ar)
+{
+	Ar.Logf(TEXT("%12s %12s %12s %12s %12s  %s"), TEXT("Payload KB"), TEXT("Lookup KB"), TEXT("Derived KB"), TEXT("Snapshot KB"), TEXT("Total KB"), TEXT("Street map"));
+}
+
+
+void FStreetMapMemoryReport::PrintStreetMap(FOutputDevice& Ar, const UStreetMap& StreetMap, const FStreetMapMemoryUsage& Usage)
+{
+	using namespace StreetMapMemory;
+
+	Ar.Logf(TEXT("%12.1f %12.1f %12.1f %12.1f %12.1f  %s"),
+		ToKB(Usage.Payload),
+		ToKB(Usage.Lookup),
+		ToKB(Usage.DerivedData),
+		ToKB(Usage.Snapshot),
+		ToKB(Usage.GetTotal()),
+		*StreetMap.GetPathName());
+}
+
+
+void FStreetMapMemoryReport::PrintComponentHeader(FOutputDevice& Ar)
+{
+	Ar.Logf(TEXT("%12s %12s %12s %12s  %s"), TEXT("Mesh KB"), TEXT("GPU KB"), TEXT("Collision KB"), TEXT("Total KB"), TEXT("Component (street map)"));
+}
+
+
+void FStreetMapMemoryReport::PrintComponent(FOutputDevice& Ar, const UStreetMapComponent& Component, const FStreetMapMemoryUsage& Usage)
+{
+	using namespace StreetMapMemory;
+
+	Ar.Logf(TEXT("%12.1f %12.1f %12.1f %12.1f  %s (%s)"),
+		ToKB(Usage.CPUMesh),
+		ToKB(Usage.GPUBuffers),
+		ToKB(Usage.Collision),
+		ToKB(Usage.GetTotal()),
+		*Component.GetPathName(),
+		*Component.GetStreetMapAssetName());
+}
@@ -0,0 +1,424 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapNameIndex.h"
+#include "Algo/Sort.h"
+
+namespace StreetMapNameIndex
+{
+	/**
+	 * Base letters of U+00C0 to U+017F (Latin-1 Supplement letters and Latin Extended-A).  '*' marks letters that fold to
+	 * two letters, and '-' the two signs in that range that separate words instead.
+	 */
+	static const char LatinFolds[] =
+		"aaaaaa*ceeeeiiii" "dnooooo-ouuuuy**" "aaaaaa*ceeeeiiii" "dnooooo-ouuuuy*y"
+		"aaaaaaccccccccdd" "ddeeeeeeeeeegggg" "gggghhhhiiiiiiii" "ii**jjkkklllllll"
+		"lllnnnnnnnnnoooo" "oo**rrrrrrssssss" "ssttttttuuuuuuuu" "uuuuwwyyyzzzzzzs";
+	static_assert(sizeof(LatinFolds) == 0x180 - 0xC0 + 1, "LatinFolds must cover U+00C0 to U+017F");
+
+	/** Folds a letter to one or two lower case letters without accents.  Returns the number of letters written. */
+	static int32 FoldLetter(const TCHAR Char, TCHAR OutFolded[2])
+	{
+		const uint32 Code = (uint32)Char;
+		if (Code < 0x80)
+		{
+			OutFolded[0] = FChar::ToLower(Char);
+			return 1;
+		}
+		if (Code >= 0xC0 && Code < 0x180)
+		{
+			const char Folded = LatinFolds[Code - 0xC0];
+			if (Folded != '*')
+			{
+				OutFolded[0] = (TCHAR)Folded;
+				return 1;
+			}
+
+			const TCHAR* Pair = TEXT("ae");
+			switch (Code)
+			{
+				case 0xDE: case 0xFE: Pair = TEXT("th"); break;
+				case 0xDF: Pair = TEXT("ss"); break;
+				case 0x132: case 0x133: Pair = TEXT("ij"); break;
+				case 0x152: case 0x153: Pair = TEXT("oe"); break;
+			}
+			OutFolded[0] = Pair[0];
+			OutFolded[1] = Pair[1];
+			return 2;
+		}
+
+		// Greek: capitals, letters with tonos and final sigma
+		uint32 Folded = Code;
+		if (Code >= 0x391 && Code <= 0x3A9)
+		{
+			Folded = Code + 0x20;
+		}
+		else
+		{
+			switch (Code)
+			{
+				case 0x386: case 0x3AC: Folded = 0x3B1; break;
+				case 0x388: case 0x3AD: Folded = 0x3B5; break;
+				case 0x389: case 0x3AE: Folded = 0x3B7; break;
+				case 0x38A: case 0x3AF: Folded = 0x3B9; break;
+				case 0x38C: case 0x3CC: Folded = 0x3BF; break;
+				case 0x38E: case 0x3CD: Folded = 0x3C5; break;
+				case 0x38F: case 0x3CE: Folded = 0x3C9; break;
+				case 0x3C2: Folded = 0x3C3; break;
+			}
+		}
+
+		// Cyrillic capitals, and ё as е
+		if (Code >= 0x400 && Code <= 0x40F)
+		{
+			Folded = Code + 0x50;
+		}
+		else if (Code >= 0x410 && Code <= 0x42F)
+		{
+			Folded = Code + 0x20;
+		}
+		if (Folded == 0x451)
+		{
+			Folded = 0x435;
+		}
+
+		OutFolded[0] = (TCHAR)Folded;
+		return 1;
+	}
+
+	/** Whether a character separates words */
+	static bool IsSeparator(const TCHAR Char)
+	{
+		const uint32 Code = (uint32)Char;
+		if (Code < 0x80)
+		{
+			return !FChar::IsAlnum(Char);
+		}
+		return (Code >= 0xA0 && Code <= 0xBF) ||	// Latin-1 punctuation and signs
+			Code == 0xD7 || Code == 0xF7 ||			// Multiplication and division signs
+			(Code >= 0x2000 && Code <= 0x206F) ||	// General punctuation
+			(Code >= 0x3000 && Code <= 0x303F) ||	// CJK punctuation
+			(Code >= 0xFF01 && Code <= 0xFF0F);		// Full width punctuation
+	}
+
+	/** Whether a character is dropped without separating words */
+	static bool IsIgnored(const TCHAR Char)
+	{
+		const uint32 Code = (uint32)Char;
+		return Code == '\'' || Code == 0x2019 ||	// Apostrophes
+			(Code >= 0x300 && Code <= 0x36F);		// Combining accents
+	}
+}
+
+
+void FStreetMapNameIndex::Build(TArrayView<const FStreetMapRoad> Roads, TArrayView<const FStreetMapBuilding> Buildings, TArrayView<const FString> Names)
+{
+	NameIds.Reset();
+	NormalizedNames.Reset();
+	RoadOffsets.Reset();
+	RoadIndices.Reset();
+	BuildingOffsets.Reset();
+	BuildingIndices.Reset();
+	Words.Reset();
+
+	// Count the features with each name, so names nothing uses (and names stripped when cooking) get no entry
+	TArray<int32> RoadCounts;
+	TArray<int32> BuildingCounts;
+	RoadCounts.SetNumZeroed(Names.Num());
+	BuildingCounts.SetNumZeroed(Names.Num());
+	for (const FStreetMapRoad& Road : Roads)
+	{
+		if (Names.IsValidIndex(Road.NameId))
+		{
+			++RoadCounts[Road.NameId];
+		}
+	}
+	for (const FStreetMapBuilding& Building : Buildings)
+	{
+		if (Names.IsValidIndex(Building.NameId))
+		{
+			++BuildingCounts[Building.NameId];
+		}
+	}
+
+	TArray<int32> EntryByNameId;
+	EntryByNameId.Init(INDEX_NONE, Names.Num());
+	RoadOffsets.Add(0);
+	BuildingOffsets.Add(0);
+	for (int32 NameId = 0; NameId < Names.Num(); ++NameId)
+	{
+		if (RoadCounts[NameId] + BuildingCounts[NameId] == 0)
+		{
+			continue;
+		}
+
+		FString NormalizedName = Normalize(Names[NameId]);
+		if (NormalizedName.IsEmpty())
+		{
+			continue;
+		}
+
+		const int32 EntryIndex = NameIds.Add(NameId);
+		EntryByNameId[NameId] = EntryIndex;
+		NormalizedNames.Add(MoveTemp(NormalizedName));
+		RoadOffsets.Add(RoadOffsets.Last() + RoadCounts[NameId]);
+		BuildingOffsets.Add(BuildingOffsets.Last() + BuildingCounts[NameId]);
+	}
+
+	// Fill in each entry's features, in index order
+	RoadIndices.SetNumUninitialized(RoadOffsets.Last());
+	BuildingIndices.SetNumUninitialized(BuildingOffsets.Last());
+	TArray<int32> RoadCursors(RoadOffsets.GetData(), NameIds.Num());
+	TArray<int32> BuildingCursors(BuildingOffsets.GetData(), NameIds.Num());
+	for (int32 RoadIndex = 0; RoadIndex < Roads.Num(); ++RoadIndex)
+	{
+		const int32 EntryIndex = EntryByNameId.IsValidIndex(Roads[RoadIndex].NameId) ? EntryByNameId[Roads[RoadIndex].NameId] : INDEX_NONE;
+		if (EntryIndex != INDEX_NONE)
+		{
+			RoadIndices[RoadCursors[EntryIndex]++] = RoadIndex;
+		}
+	}
+	for (int32 BuildingIndex = 0; BuildingIndex < Buildings.Num(); ++BuildingIndex)
+	{
+		const int32 EntryIndex = EntryByNameId.IsValidIndex(Buildings[BuildingIndex].NameId) ? EntryByNameId[Buildings[BuildingIndex].NameId] : INDEX_NONE;
+		if (EntryIndex != INDEX_NONE)
+		{
+			BuildingIndices[BuildingCursors[EntryIndex]++] = BuildingIndex;
+		}
+	}
+
+	// Normalized names have single spaces between words and none at either end, so every word starts at the beginning
+	// or right after a space
+	for (int32 EntryIndex = 0; EntryIndex < NormalizedNames.Num(); ++EntryIndex)
+	{
+		const FString& NormalizedName = NormalizedNames[EntryIndex];
+		Words.Add({ EntryIndex, 0 });
+		for (int32 CharIndex = 0; CharIndex < NormalizedName.Len(); ++CharIndex)
+		{
+			if (NormalizedName[CharIndex] == TEXT(' '))
+			{
+				Words.Add({ EntryIndex, CharIndex + 1 });
+			}
+		}
+	}
+
+	Algo::Sort(Words, [this](const FWord& A, const FWord& B)
+	{
+		const int32 Order = FCString::Strcmp(GetWordText(A), GetWordText(B));
+		return Order != 0 ? Order < 0 : (A.EntryIndex != B.EntryIndex ? A.EntryIndex < B.EntryIndex : A.Offset < B.Offset);
+	});
+}
+
+
+FString FStreetMapNameIndex::Normalize(FStringView Text)
+{
+	using namespace StreetMapNameIndex;
+
+	FString Normalized;
+	Normalized.Reserve(Text.Len());
+
+	bool bSeparate = false;
+	for (const TCHAR Char : Text)
+	{
+		if (IsIgnored(Char))
+		{
+			continue;
+		}
+		if (IsSeparator(Char))
+		{
+			bSeparate = Normalized.Len() > 0;
+			continue;
+		}
+
+		if (bSeparate)
+		{
+			Normalized.AppendChar(TEXT(' '));
+			bSeparate = false;
+		}
+
+		TCHAR Folded[2];
+		const int32 FoldedCount = FoldLetter(Char, Folded);
+		for (int32 FoldedIndex = 0; FoldedIndex < FoldedCount; ++FoldedIndex)
+		{
+			Normalized.AppendChar(Folded[FoldedIndex]);
+		}
+	}
+	return Normalized;
+}
+
+
+void FStreetMapNameIndex::FindByPrefix(FStringView Prefix, const int32 MaxResults, TArray<FStreetMapNameIndexMatch>& OutMatches) const
+{
+	OutMatches.Reset();
+
+	const FString Query = Normalize(Prefix);
+	if (Query.IsEmpty() || MaxResults <= 0)
+	{
+		return;
+	}
+
+	// Binary search for the first word that doesn't sort before the prefix.  Every word starting with the prefix follows it.
+	const int32 QueryLength = Query.Len();
+	int32 Low = 0;
+	int32 High = Words.Num();
+	while (Low < High)
+	{
+		const int32 Middle = Low + (High - Low) / 2;
+		if (FCString::Strncmp(GetWordText(Words[Middle]), *Query, QueryLength) < 0)
+		{
+			Low = Middle + 1;
+		}
+		else
+		{
+			High = Middle;
+		}
+	}
+
+	// A name can start with the prefix at more than one word
+	TSet<int32, DefaultKeyFuncs<int32>, TInlineSetAllocator<32>> FoundEntries;
+	for (int32 WordIndex = Low; WordIndex < Words.Num() && OutMatches.Num() < MaxResults; ++WordIndex)
+	{
+		const FWord& Word = Words[WordIndex];
+		if (FCString::Strncmp(GetWordText(Word), *Query, QueryLength) != 0)
+		{
+			break;
+		}
+
+		bool bAlreadyFound;
+		FoundEntries.Add(Word.EntryIndex, &bAlreadyFound);
+		if (!bAlreadyFound)
+		{
+			OutMatches.Add({ Word.EntryIndex, 0, Word.Offset });
+		}
+	}
+}
+
+
+void FStreetMapNameIndex::FindByFuzzyPrefix(FStringView Prefix, const int32 MaxEdits, const int32 MaxResults, TArray<FStreetMapNameIndexMatch>& OutMatches) const
+{
+	OutMatches.Reset();
+
+	const FString Query = Normalize(Prefix);
+	if (Query.IsEmpty() || MaxResults <= 0 || Words.Num() == 0)
+	{
+		return;
+	}
+
+	// The first row of the edit distance table is for the empty string, which is as many edits away as the query is long
+	const int32 RowSize = Query.Len() + 1;
+	TArray<int32> Rows;
+	Rows.SetNumUninitialized(RowSize);
+	for (int32 QueryIndex = 0; QueryIndex < RowSize; ++QueryIndex)
+	{
+		Rows[QueryIndex] = QueryIndex;
+	}
+
+	TMap<int32, FStreetMapNameIndexMatch> EntryMatches;
+	FindFuzzy(Query, 0, Words.Num(), 0, MAX_int32, FMath::Clamp(MaxEdits, 0, Query.Len() - 1), Rows, EntryMatches);
+
+	OutMatches.Reserve(EntryMatches.Num());
+	for (const TPair<int32, FStreetMapNameIndexMatch>& EntryMatch : EntryMatches)
+	{
+		OutMatches.Add(EntryMatch.Value);
+	}
+	Algo::Sort(OutMatches, [this](const FStreetMapNameIndexMatch& A, const FStreetMapNameIndexMatch& B)
+	{
+		return A.EditDistance != B.EditDistance ? A.EditDistance < B.EditDistance : FCString::Strcmp(GetMatchText(A), GetMatchText(B)) < 0;
+	});
+	if (OutMatches.Num() > MaxResults)
+	{
+		OutMatches.SetNum(MaxResults, EAllowShrinking::No);
+	}
+}
+
+
+void FStreetMapNameIndex::FindFuzzy(const FString& Query, const int32 Begin, const int32 End, const int32 Depth, const int32 BestEdits, const int32 MaxEdits, TArray<int32>& Rows, TMap<int32, FStreetMapNameIndexMatch>& OutEntryMatches) const
+{
+	const int32 QueryLength = Query.Len();
+	const int32 RowSize = QueryLength + 1;
+
+	// Words are walked in alphabetical order, so an entry's first word with its fewest edits also sorts first
+	const auto AddEntries = [this, &OutEntryMatches](const int32 RangeBegin, const int32 RangeEnd, const int32 Edits)
+	{
+		for (int32 WordIndex = RangeBegin; WordIndex < RangeEnd; ++WordIndex)
+		{
+			const FWord& Word = Words[WordIndex];
+			FStreetMapNameIndexMatch& EntryMatch = OutEntryMatches.FindOrAdd(Word.EntryIndex, { Word.EntryIndex, MAX_int32, 0 });
+			if (Edits < EntryMatch.EditDistance)
+			{
+				EntryMatch.EditDistance = Edits;
+				EntryMatch.WordOffset = Word.Offset;
+			}
+		}
+	};
+
+	// Words that end here sort first, and match as well as the text leading here did
+	int32 ChildBegin = Begin;
+	while (ChildBegin < End && GetWordText(Words[ChildBegin])[Depth] == TEXT('\0'))
+	{
+		++ChildBegin;
+	}
+	if (BestEdits <= MaxEdits)
+	{
+		AddEntries(Begin, ChildBegin, BestEdits);
+	}
+
+	// The rest split into one child per next character, each a run of words found by binary search
+	while (ChildBegin < End)
+	{
+		const TCHAR Char = GetWordText(Words[ChildBegin])[Depth];
+		int32 Low = ChildBegin + 1;
+		int32 High = End;
+		while (Low < High)
+		{
+			const int32 Middle = Low + (High - Low) / 2;
+			if (GetWordText(Words[Middle])[Depth] == Char)
+			{
+				Low = Middle + 1;
+			}
+			else
+			{
+				High = Middle;
+			}
+		}
+		const int32 ChildEnd = Low;
+
+		// Next row of the edit distance table, for the text leading here plus Char
+		Rows.SetNumUninitialized((Depth + 2) * RowSize, EAllowShrinking::No);
+		const int32* PreviousRow = Rows.GetData() + Depth * RowSize;
+		int32* Row = Rows.GetData() + (Depth + 1) * RowSize;
+		Row[0] = Depth + 1;
+		int32 RowMin = Row[0];
+		for (int32 QueryIndex = 1; QueryIndex <= QueryLength; ++QueryIndex)
+		{
+			const int32 Substitution = PreviousRow[QueryIndex - 1] + (Query[QueryIndex - 1] == Char ? 0 : 1);
+			Row[QueryIndex] = FMath::Min3(PreviousRow[QueryIndex] + 1, Row[QueryIndex - 1] + 1, Substitution);
+			RowMin = FMath::Min(RowMin, Row[QueryIndex]);
+		}
+
+		// No cell in later rows can be smaller than the smallest in this one, so the search stops as soon as going
+		// deeper can't find a closer match
+		const int32 ChildBestEdits = FMath::Min(BestEdits, Row[QueryLength]);
+		if (ChildBestEdits <= MaxEdits && RowMin >= ChildBestEdits)
+		{
+			AddEntries(ChildBegin, ChildEnd, ChildBestEdits);
+		}
+		else if (RowMin <= MaxEdits)
+		{
+			FindFuzzy(Query, ChildBegin, ChildEnd, Depth + 1, ChildBestEdits, MaxEdits, Rows, OutEntryMatches);
+		}
+
+		ChildBegin = ChildEnd;
+	}
+}
+
+
+SIZE_T FStreetMapNameIndex::GetAllocatedSize() const
+{
+	SIZE_T Size = NameIds.GetAllocatedSize() + NormalizedNames.GetAllocatedSize() + RoadOffsets.GetAllocatedSize() + RoadIndices.GetAllocatedSize() +
+		BuildingOffsets.GetAllocatedSize() + BuildingIndices.GetAllocatedSize() + Words.GetAllocatedSize();
+	for (const FString& NormalizedName : NormalizedNames)
+	{
+		Size += NormalizedName.GetAllocatedSize();
+	}
+	return Size;
+}
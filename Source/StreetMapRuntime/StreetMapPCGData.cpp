@@ -1,6 +1,7 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "StreetMapPCGData.h"
+#include "StreetMapSnapshot.h"
 #include "Data/PCGPointData.h"
 #include "Metadata/PCGMetadata.h"
 #include "Metadata/PCGMetadataAttribute.h"
@@ -15,6 +16,9 @@ void UStreetMapRoadsPCGData::Initialize(const UStreetMap* InStreetMap)
 	
 	if (StreetMap)
 	{
+		// Points may be generated off the game thread, so make the snapshot they read from now
+		StreetMap->GetSnapshot();
+
 		// Calculate bounds from street map
 		const FVector2D& BoundsMin = StreetMap->GetBoundsMin();
 		const FVector2D& BoundsMax = StreetMap->GetBoundsMax();
@@ -67,12 +71,17 @@ UPCGPointData* UStreetMapRoadsPCGData::CreatePointDataFromRoads(FPCGContext* Con
 
 	// Create metadata attributes for road properties
 	FPCGMetadataAttribute<FString>* RoadNameAttr = Metadata->CreateAttribute<FString>(TEXT("RoadName"), FString(), true, false);
+	FPCGMetadataAttribute<int32>* RoadNameIdAttr = Metadata->CreateAttribute<int32>(TEXT("RoadNameId"), INDEX_NONE, false, false);
 	FPCGMetadataAttribute<int32>* RoadTypeAttr = Metadata->CreateAttribute<int32>(TEXT("RoadType"), 0, true, false);
 	FPCGMetadataAttribute<int32>* RoadIndexAttr = Metadata->CreateAttribute<int32>(TEXT("RoadIndex"), 0, true, false);
 	FPCGMetadataAttribute<int32>* PointIndexAttr = Metadata->CreateAttribute<int32>(TEXT("PointIndex"), 0, true, false);
 	FPCGMetadataAttribute<bool>* IsOneWayAttr = Metadata->CreateAttribute<bool>(TEXT("IsOneWay"), false, true, false);
 
-	const TArray<FStreetMapRoad>& Roads = StreetMap->GetRoads();
+	// Each distinct name is added to the attribute once, and points share its value key
+	TMap<int32, PCGMetadataValueKey> NameValueKeys;
+
+	const FStreetMapSnapshotPtr Snapshot = StreetMap->GetSnapshot();
+	const TArray<FStreetMapRoad>& Roads = Snapshot->GetRoads();
 	
 	for (int32 RoadIndex = 0; RoadIndex < Roads.Num(); ++RoadIndex)
 	{
@@ -100,9 +109,18 @@ UPCGPointData* UStreetMapRoadsPCGData::CreatePointDataFromRoads(FPCGContext* Con
 			PCGMetadataEntryKey MetadataKey = Metadata->AddEntry();
 			NewPoint.MetadataEntry = MetadataKey;
 
-			if (RoadNameAttr)
+			if (RoadNameAttr && Road.NameId != INDEX_NONE)
 			{
-				RoadNameAttr->SetValue(MetadataKey, Road.RoadName);
+				PCGMetadataValueKey* NameValueKey = NameValueKeys.Find(Road.NameId);
+				if (!NameValueKey)
+				{
+					NameValueKey = &NameValueKeys.Add(Road.NameId, RoadNameAttr->AddValue(Snapshot->GetNameById(Road.NameId)));
+				}
+				RoadNameAttr->SetValueFromValueKey(MetadataKey, *NameValueKey);
+			}
+			if (RoadNameIdAttr)
+			{
+				RoadNameIdAttr->SetValue(MetadataKey, Road.NameId);
 			}
 			if (RoadTypeAttr)
 			{
@@ -135,6 +153,9 @@ void UStreetMapBuildingsPCGData::Initialize(const UStreetMap* InStreetMap)
 	
 	if (StreetMap)
 	{
+		// Points may be generated off the game thread, so make the snapshot they read from now
+		StreetMap->GetSnapshot();
+
 		// Calculate bounds from street map
 		const FVector2D& BoundsMin = StreetMap->GetBoundsMin();
 		const FVector2D& BoundsMax = StreetMap->GetBoundsMax();
@@ -187,12 +208,17 @@ UPCGPointData* UStreetMapBuildingsPCGData::CreatePointDataFromBuildings(FPCGCont
 
 	// Create metadata attributes for building properties
 	FPCGMetadataAttribute<FString>* BuildingNameAttr = Metadata->CreateAttribute<FString>(TEXT("BuildingName"), FString(), true, false);
+	FPCGMetadataAttribute<int32>* BuildingNameIdAttr = Metadata->CreateAttribute<int32>(TEXT("BuildingNameId"), INDEX_NONE, false, false);
 	FPCGMetadataAttribute<double>* HeightAttr = Metadata->CreateAttribute<double>(TEXT("Height"), 0.0, true, false);
 	FPCGMetadataAttribute<int32>* LevelsAttr = Metadata->CreateAttribute<int32>(TEXT("BuildingLevels"), 0, true, false);
 	FPCGMetadataAttribute<int32>* BuildingIndexAttr = Metadata->CreateAttribute<int32>(TEXT("BuildingIndex"), 0, true, false);
 	FPCGMetadataAttribute<int32>* VertexCountAttr = Metadata->CreateAttribute<int32>(TEXT("VertexCount"), 0, true, false);
 
-	const TArray<FStreetMapBuilding>& Buildings = StreetMap->GetBuildings();
+	// Each distinct name is added to the attribute once, and points share its value key
+	TMap<int32, PCGMetadataValueKey> NameValueKeys;
+
+	const FStreetMapSnapshotPtr Snapshot = StreetMap->GetSnapshot();
+	const TArray<FStreetMapBuilding>& Buildings = Snapshot->GetBuildings();
 	
 	for (int32 BuildingIndex = 0; BuildingIndex < Buildings.Num(); ++BuildingIndex)
 	{
@@ -232,9 +258,18 @@ UPCGPointData* UStreetMapBuildingsPCGData::CreatePointDataFromBuildings(FPCGCont
 		PCGMetadataEntryKey MetadataKey = Metadata->AddEntry();
 		NewPoint.MetadataEntry = MetadataKey;
 
-		if (BuildingNameAttr)
+		if (BuildingNameAttr && Building.NameId != INDEX_NONE)
+		{
+			PCGMetadataValueKey* NameValueKey = NameValueKeys.Find(Building.NameId);
+			if (!NameValueKey)
+			{
+				NameValueKey = &NameValueKeys.Add(Building.NameId, BuildingNameAttr->AddValue(Snapshot->GetNameById(Building.NameId)));
+			}
+			BuildingNameAttr->SetValueFromValueKey(MetadataKey, *NameValueKey);
+		}
+		if (BuildingNameIdAttr)
 		{
-			BuildingNameAttr->SetValue(MetadataKey, Building.BuildingName);
+			BuildingNameIdAttr->SetValue(MetadataKey, Building.NameId);
 		}
 		if (HeightAttr)
 		{
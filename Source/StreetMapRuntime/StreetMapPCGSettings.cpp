@@ -2,7 +2,9 @@
 
 #include "StreetMapPCGSettings.h"
 #include "StreetMap.h"
+#include "StreetMapSnapshot.h"
 #include "StreetMapPCGData.h"
+#include "StreetMapStats.h"
 #include "PCGContext.h"
 #include "Data/PCGPointData.h"
 #include "Metadata/PCGMetadata.h"
@@ -31,7 +33,7 @@ TArray<FPCGPinProperties> UPCGStreetMapSettings::OutputPinProperties() const
 	{
 		FPCGPinProperties& RoadsPin = PinProperties.Emplace_GetRef(TEXT("Roads"), EPCGDataType::Point);
 #if WITH_EDITOR
-		RoadsPin.Tooltip = NSLOCTEXT("PCGStreetMapSettings", "RoadsPin", "Road points with metadata (RoadName, RoadType, RoadIndex, PointIndex, IsOneWay)");
+		RoadsPin.Tooltip = NSLOCTEXT("PCGStreetMapSettings", "RoadsPin", "Road points with metadata (RoadName, RoadNameId, RoadType, RoadIndex, PointIndex, IsOneWay)");
 #endif
 	}
 
@@ -39,7 +41,7 @@ TArray<FPCGPinProperties> UPCGStreetMapSettings::OutputPinProperties() const
 	{
 		FPCGPinProperties& BuildingsPin = PinProperties.Emplace_GetRef(TEXT("Buildings"), EPCGDataType::Point);
 #if WITH_EDITOR
-		BuildingsPin.Tooltip = NSLOCTEXT("PCGStreetMapSettings", "BuildingsPin", "Building centroids with metadata (BuildingName, Height, BuildingLevels, BuildingIndex, VertexCount)");
+		BuildingsPin.Tooltip = NSLOCTEXT("PCGStreetMapSettings", "BuildingsPin", "Building centroids with metadata (BuildingName, BuildingNameId, Height, BuildingLevels, BuildingIndex, VertexCount)");
 #endif
 	}
 
@@ -53,7 +55,7 @@ FPCGElementPtr UPCGStreetMapSettings::CreateElement() const
 
 bool FPCGStreetMapElement::ExecuteInternal(FPCGContext* Context) const
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(FPCGStreetMapElement::Execute);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FPCGStreetMapElement::Execute, StreetMapChannel);
 
 	const UPCGStreetMapSettings* Settings = Context->GetInputSettings<UPCGStreetMapSettings>();
 	check(Settings);
@@ -69,6 +71,9 @@ bool FPCGStreetMapElement::ExecuteInternal(FPCGContext* Context) const
 		return true;
 	}
 
+	// Read through a snapshot, so the map can't change under us while points are generated
+	const FStreetMapSnapshotPtr Snapshot = LoadedStreetMap->GetSnapshot();
+
 	TArray<FPCGTaggedData>& Outputs = Context->OutputData.TaggedData;
 
 	// Output roads
@@ -80,12 +85,16 @@ bool FPCGStreetMapElement::ExecuteInternal(FPCGContext* Context) const
 
 		// Create metadata attributes
 		FPCGMetadataAttribute<FString>* RoadNameAttr = Metadata->CreateAttribute<FString>(TEXT("RoadName"), FString(), true, false);
+		FPCGMetadataAttribute<int32>* RoadNameIdAttr = Metadata->CreateAttribute<int32>(TEXT("RoadNameId"), INDEX_NONE, false, false);
 		FPCGMetadataAttribute<int32>* RoadTypeAttr = Metadata->CreateAttribute<int32>(TEXT("RoadType"), 0, true, false);
 		FPCGMetadataAttribute<int32>* RoadIndexAttr = Metadata->CreateAttribute<int32>(TEXT("RoadIndex"), 0, true, false);
 		FPCGMetadataAttribute<int32>* PointIndexAttr = Metadata->CreateAttribute<int32>(TEXT("PointIndex"), 0, true, false);
 		FPCGMetadataAttribute<bool>* IsOneWayAttr = Metadata->CreateAttribute<bool>(TEXT("IsOneWay"), false, true, false);
 
-		const TArray<FStreetMapRoad>& Roads = LoadedStreetMap->GetRoads();
+		// Each distinct name is added to the attribute once, and points share its value key
+		TMap<int32, PCGMetadataValueKey> NameValueKeys;
+
+		const TArray<FStreetMapRoad>& Roads = Snapshot->GetRoads();
 
 		for (int32 RoadIndex = 0; RoadIndex < Roads.Num(); ++RoadIndex)
 		{
@@ -112,9 +121,18 @@ bool FPCGStreetMapElement::ExecuteInternal(FPCGContext* Context) const
 				PCGMetadataEntryKey MetadataKey = Metadata->AddEntry();
 				NewPoint.MetadataEntry = MetadataKey;
 
-				if (RoadNameAttr)
+				if (RoadNameAttr && Road.NameId != INDEX_NONE)
 				{
-					RoadNameAttr->SetValue(MetadataKey, Road.RoadName);
+					PCGMetadataValueKey* NameValueKey = NameValueKeys.Find(Road.NameId);
+					if (!NameValueKey)
+					{
+						NameValueKey = &NameValueKeys.Add(Road.NameId, RoadNameAttr->AddValue(Snapshot->GetNameById(Road.NameId)));
+					}
+					RoadNameAttr->SetValueFromValueKey(MetadataKey, *NameValueKey);
+				}
+				if (RoadNameIdAttr)
+				{
+					RoadNameIdAttr->SetValue(MetadataKey, Road.NameId);
 				}
 				if (RoadTypeAttr)
 				{
@@ -149,12 +167,16 @@ bool FPCGStreetMapElement::ExecuteInternal(FPCGContext* Context) const
 
 		// Create metadata attributes
 		FPCGMetadataAttribute<FString>* BuildingNameAttr = Metadata->CreateAttribute<FString>(TEXT("BuildingName"), FString(), true, false);
+		FPCGMetadataAttribute<int32>* BuildingNameIdAttr = Metadata->CreateAttribute<int32>(TEXT("BuildingNameId"), INDEX_NONE, false, false);
 		FPCGMetadataAttribute<double>* HeightAttr = Metadata->CreateAttribute<double>(TEXT("Height"), 0.0, true, false);
 		FPCGMetadataAttribute<int32>* LevelsAttr = Metadata->CreateAttribute<int32>(TEXT("BuildingLevels"), 0, true, false);
 		FPCGMetadataAttribute<int32>* BuildingIndexAttr = Metadata->CreateAttribute<int32>(TEXT("BuildingIndex"), 0, true, false);
 		FPCGMetadataAttribute<int32>* VertexCountAttr = Metadata->CreateAttribute<int32>(TEXT("VertexCount"), 0, true, false);
 
-		const TArray<FStreetMapBuilding>& Buildings = LoadedStreetMap->GetBuildings();
+		// Each distinct name is added to the attribute once, and points share its value key
+		TMap<int32, PCGMetadataValueKey> NameValueKeys;
+
+		const TArray<FStreetMapBuilding>& Buildings = Snapshot->GetBuildings();
 
 		for (int32 BuildingIndex = 0; BuildingIndex < Buildings.Num(); ++BuildingIndex)
 		{
@@ -192,9 +214,18 @@ bool FPCGStreetMapElement::ExecuteInternal(FPCGContext* Context) const
 			PCGMetadataEntryKey MetadataKey = Metadata->AddEntry();
 			NewPoint.MetadataEntry = MetadataKey;
 
-			if (BuildingNameAttr)
+			if (BuildingNameAttr && Building.NameId != INDEX_NONE)
+			{
+				PCGMetadataValueKey* NameValueKey = NameValueKeys.Find(Building.NameId);
+				if (!NameValueKey)
+				{
+					NameValueKey = &NameValueKeys.Add(Building.NameId, BuildingNameAttr->AddValue(Snapshot->GetNameById(Building.NameId)));
+				}
+				BuildingNameAttr->SetValueFromValueKey(MetadataKey, *NameValueKey);
+			}
+			if (BuildingNameIdAttr)
 			{
-				BuildingNameAttr->SetValue(MetadataKey, Building.BuildingName);
+				BuildingNameIdAttr->SetValue(MetadataKey, Building.NameId);
 			}
 			if (HeightAttr)
 			{
@@ -0,0 +1,72 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Engine/LatentActionManager.h"
+#include "Engine/World.h"
+#include "LatentActions.h"
+
+/**
+ * Latent Blueprint action that waits for an asynchronous street map query.  The query's future is fulfilled on a worker
+ * thread, and the action polls it on every latent update, so the result is handed to the Blueprint on the game thread on
+ * the first update after the query finishes.
+ */
+template<typename ResultType>
+class FStreetMapQueryLatentAction : public FPendingLatentAction
+{
+public:
+
+	/** Called with the query result when it is ready, to copy it into the Blueprint's output pins */
+	using FOnResult = TUniqueFunction<void(ResultType&&)>;
+
+	FStreetMapQueryLatentAction(TFuture<ResultType>&& InFuture, FOnResult&& InOnResult, const FLatentActionInfo& LatentInfo)
+		: Future(MoveTemp(InFuture)),
+		  OnResult(MoveTemp(InOnResult)),
+		  ExecutionFunction(LatentInfo.ExecutionFunction),
+		  OutputLink(LatentInfo.Linkage),
+		  CallbackTarget(LatentInfo.CallbackTarget)
+	{
+	}
+
+	virtual void UpdateOperation(FLatentResponse& Response) override
+	{
+		if (Future.IsReady())
+		{
+			OnResult(Future.Consume());
+			Response.FinishAndTriggerIf(true, ExecutionFunction, OutputLink, CallbackTarget);
+		}
+	}
+
+#if WITH_EDITOR
+	virtual FString GetDescription() const override
+	{
+		return TEXT("Waiting for street map query");
+	}
+#endif
+
+	/** Starts a latent action for the specified query, unless the node already has one running */
+	static void Start(UWorld* World, const FLatentActionInfo& LatentInfo, TFunctionRef<TFuture<ResultType>()> StartQuery, FOnResult&& InOnResult)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		FLatentActionManager& LatentActionManager = World->GetLatentActionManager();
+		if (LatentActionManager.FindExistingAction<FStreetMapQueryLatentAction>(LatentInfo.CallbackTarget, LatentInfo.UUID) == nullptr)
+		{
+			LatentActionManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID, new FStreetMapQueryLatentAction(StartQuery(), MoveTemp(InOnResult), LatentInfo));
+		}
+	}
+
+private:
+
+	TFuture<ResultType> Future;
+	FOnResult OnResult;
+
+	FName ExecutionFunction;
+	int32 OutputLink;
+	FWeakObjectPtr CallbackTarget;
+};
@@ -24,5 +24,11 @@ public class StreetMapRuntime : ModuleRules
 				"NavigationSystem"
 			}
 		);
+
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("DerivedDataCache");
+			PrivateDependencyModuleNames.Add("TargetPlatform");
+		}
 	}
 }
\ No newline at end of file
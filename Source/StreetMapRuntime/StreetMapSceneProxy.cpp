@@ -2,9 +2,13 @@
 #include "StreetMapComponent.h"
 #include "Materials/MaterialRenderProxy.h"
 #include "SceneManagement.h"
+#include "StreetMapMemory.h"
+#include "StreetMapStats.h"
 
 FStreetMapSceneProxy::FStreetMapSceneProxy(const UStreetMapComponent* InComponent)
 	: FPrimitiveSceneProxy(InComponent),
+	  NumIndices(0),
+	  RenderBufferSize(0),
 	  VertexFactory(GetScene().GetFeatureLevel(), "FStreetMapSceneProxy"),
 	  MaterialInterface(nullptr),
 	  StreetMapComp(InComponent),
@@ -14,33 +18,45 @@ FStreetMapSceneProxy::FStreetMapSceneProxy(const UStreetMapComponent* InComponen
 
 void FStreetMapSceneProxy::Init(const UStreetMapComponent* InComponent, const TArray< FStreetMapVertex >& Vertices, const TArray< uint32 >& Indices)
 {
+	// The component keeps its own copy of the mesh, so outside of the editor the render buffers don't need to keep theirs
+	// once they are on the GPU.  The editor keeps them so resources can be recreated, e.g. when previewing another feature level.
+	const bool bNeedsCPUAccess = GIsEditor;
+
 	// Copy index buffer
 	IndexBuffer32.Indices = Indices;
+	NumIndices = Indices.Num();
 
 	MaterialInterface = nullptr;
 	this->MaterialRelevance = InComponent->GetMaterialRelevance(GetScene().GetFeatureLevel());
 
 
-	// Copy vertex data
+	// Copy vertex data straight into the vertex buffers
 	const int32 NumVerts = Vertices.Num();
-	TArray<FDynamicMeshVertex> DynamicVertices;
-	DynamicVertices.SetNumUninitialized(NumVerts);
+	VertexBuffer.PositionVertexBuffer.Init(NumVerts, bNeedsCPUAccess);
+	VertexBuffer.StaticMeshVertexBuffer.Init(NumVerts, 1, bNeedsCPUAccess);
+	VertexBuffer.ColorVertexBuffer.Init(NumVerts, bNeedsCPUAccess);
 
 	for (int VertIdx = 0; VertIdx < NumVerts; VertIdx++)
 	{
 		const FStreetMapVertex& StreetMapVert = Vertices[VertIdx];
-		FDynamicMeshVertex& Vert = DynamicVertices[VertIdx];
-		Vert.Position = StreetMapVert.Position;
-		Vert.Color = StreetMapVert.Color;
-		Vert.TextureCoordinate[0] = StreetMapVert.TextureCoordinate;
-		Vert.TangentX = StreetMapVert.TangentX;
-		Vert.TangentZ = StreetMapVert.TangentZ;
+		VertexBuffer.PositionVertexBuffer.VertexPosition(VertIdx) = StreetMapVert.Position;
+		VertexBuffer.StaticMeshVertexBuffer.SetVertexTangents(VertIdx, StreetMapVert.TangentX, FVector3f::CrossProduct(StreetMapVert.TangentZ, StreetMapVert.TangentX), StreetMapVert.TangentZ);
+		VertexBuffer.StaticMeshVertexBuffer.SetVertexUV(VertIdx, 0, StreetMapVert.TextureCoordinate);
+		VertexBuffer.ColorVertexBuffer.VertexColor(VertIdx) = StreetMapVert.Color;
 	}
 
-	VertexBuffer.InitFromDynamicVertex(&VertexFactory, DynamicVertices);
+	RenderBufferSize =
+		(SIZE_T)VertexBuffer.PositionVertexBuffer.GetNumVertices() * VertexBuffer.PositionVertexBuffer.GetStride() +
+		VertexBuffer.StaticMeshVertexBuffer.GetResourceSize() +
+		(SIZE_T)VertexBuffer.ColorVertexBuffer.GetNumVertices() * VertexBuffer.ColorVertexBuffer.GetStride() +
+		(SIZE_T)NumIndices * sizeof(uint32);
+
+	INC_MEMORY_STAT_BY(STAT_StreetMap_RenderBufferMemory, RenderBufferSize);
+	INC_DWORD_STAT_BY(STAT_StreetMap_ProxyVertices, NumVerts);
+	INC_DWORD_STAT_BY(STAT_StreetMap_ProxyTriangles, NumIndices / 3);
 
 	// Enqueue initialization of render resource
-	InitResources();
+	InitResources(bNeedsCPUAccess);
 
 	// Set a material
 	{
@@ -59,6 +75,10 @@ void FStreetMapSceneProxy::Init(const UStreetMapComponent* InComponent, const TA
 
 FStreetMapSceneProxy::~FStreetMapSceneProxy()
 {
+	DEC_MEMORY_STAT_BY(STAT_StreetMap_RenderBufferMemory, RenderBufferSize);
+	DEC_DWORD_STAT_BY(STAT_StreetMap_ProxyVertices, VertexBuffer.PositionVertexBuffer.GetNumVertices());
+	DEC_DWORD_STAT_BY(STAT_StreetMap_ProxyTriangles, NumIndices / 3);
+
 	VertexBuffer.PositionVertexBuffer.ReleaseResource();
 	VertexBuffer.StaticMeshVertexBuffer.ReleaseResource();
 	VertexBuffer.ColorVertexBuffer.ReleaseResource();
@@ -73,14 +93,47 @@ SIZE_T FStreetMapSceneProxy::GetTypeHash() const
 	return reinterpret_cast<size_t>(&UniquePointer);
 }
 
-void FStreetMapSceneProxy::InitResources()
+void FStreetMapSceneProxy::InitResources(bool bNeedsCPUAccess)
 {
 	// Start initializing our vertex buffer, index buffer, and vertex factory.  This will be kicked off on the render thread.
-	BeginInitResource(&VertexBuffer.PositionVertexBuffer);
-	BeginInitResource(&VertexBuffer.StaticMeshVertexBuffer);
-	BeginInitResource(&VertexBuffer.ColorVertexBuffer);
-	BeginInitResource(&IndexBuffer32);
-	BeginInitResource(&VertexFactory);
+	FStaticMeshVertexBuffers* VertexBuffers = &VertexBuffer;
+	FLocalVertexFactory* LocalVertexFactory = &VertexFactory;
+	ENQUEUE_RENDER_COMMAND(StreetMapInitVertexFactory)(
+		[VertexBuffers, LocalVertexFactory](FRHICommandListImmediate& RHICmdList)
+		{
+			LLM_SCOPE_BYTAG(StreetMap_RenderBuffers);
+			VertexBuffers->PositionVertexBuffer.InitResource(RHICmdList);
+			VertexBuffers->StaticMeshVertexBuffer.InitResource(RHICmdList);
+			VertexBuffers->ColorVertexBuffer.InitResource(RHICmdList);
+
+			FLocalVertexFactory::FDataType Data;
+			VertexBuffers->PositionVertexBuffer.BindPositionVertexBuffer(LocalVertexFactory, Data);
+			VertexBuffers->StaticMeshVertexBuffer.BindTangentVertexBuffer(LocalVertexFactory, Data);
+			VertexBuffers->StaticMeshVertexBuffer.BindPackedTexCoordVertexBuffer(LocalVertexFactory, Data);
+			VertexBuffers->StaticMeshVertexBuffer.BindLightMapVertexBuffer(LocalVertexFactory, Data, 0);
+			VertexBuffers->ColorVertexBuffer.BindColorVertexBuffer(LocalVertexFactory, Data);
+			LocalVertexFactory->SetData(RHICmdList, Data);
+			LocalVertexFactory->InitResource(RHICmdList);
+		});
+
+	FDynamicMeshIndexBuffer32* IndexBufferToInit = &IndexBuffer32;
+	ENQUEUE_RENDER_COMMAND(StreetMapInitIndexBuffer)(
+		[IndexBufferToInit](FRHICommandListImmediate& RHICmdList)
+		{
+			LLM_SCOPE_BYTAG(StreetMap_RenderBuffers);
+			IndexBufferToInit->InitResource(RHICmdList);
+		});
+
+	// Vertex buffers without CPU access drop their data on upload, but the index buffer has to be emptied by hand
+	if (!bNeedsCPUAccess)
+	{
+		FDynamicMeshIndexBuffer32* IndexBuffer = &IndexBuffer32;
+		ENQUEUE_RENDER_COMMAND(StreetMapReleaseIndexData)(
+			[IndexBuffer](FRHICommandListImmediate& RHICmdList)
+			{
+				IndexBuffer->Indices.Empty();
+			});
+	}
 }
 
 
@@ -142,8 +195,7 @@ void FStreetMapSceneProxy::MakeMeshBatch( FMeshBatch& Mesh, FMaterialRenderProxy
 	Mesh.MaterialRenderProxy = MaterialProxy;
 	Mesh.CastShadow = true;
 	BatchElement.FirstIndex = 0;
-	const int IndexCount = IndexBuffer32.Indices.Num();
-	BatchElement.NumPrimitives = IndexCount / 3;
+	BatchElement.NumPrimitives = NumIndices / 3;
 	BatchElement.MinVertexIndex = 0;
 	BatchElement.MaxVertexIndex = VertexBuffer.PositionVertexBuffer.GetNumVertices() - 1;
 	Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
@@ -155,8 +207,7 @@ void FStreetMapSceneProxy::MakeMeshBatch( FMeshBatch& Mesh, FMaterialRenderProxy
 
 void FStreetMapSceneProxy::DrawStaticElements( FStaticPrimitiveDrawInterface* PDI )
 {
-	const int IndexCount = IndexBuffer32.Indices.Num();
-	if( VertexBuffer.PositionVertexBuffer.GetNumVertices() > 0 && IndexCount > 0 )
+	if( VertexBuffer.PositionVertexBuffer.GetNumVertices() > 0 && NumIndices > 0 )
 	{
 		const float ScreenSize = 1.0f;
 
@@ -169,8 +220,7 @@ void FStreetMapSceneProxy::DrawStaticElements( FStaticPrimitiveDrawInterface* PD
 
 void FStreetMapSceneProxy::GetDynamicMeshElements(const TArray<const FSceneView*>& Views, const FSceneViewFamily& ViewFamily, uint32 VisibilityMap, class FMeshElementCollector& Collector) const
 {
-	const int IndexCount = IndexBuffer32.Indices.Num();
-	if (VertexBuffer.PositionVertexBuffer.GetNumVertices() > 0 && IndexCount > 0)
+	if (VertexBuffer.PositionVertexBuffer.GetNumVertices() > 0 && NumIndices > 0)
 	{
 		for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ++ViewIndex)
 		{
@@ -53,8 +53,17 @@ struct FStreetMapVertex
 		  Color(InitColor)
 	{
 	}
+
+	/** Serializes a vertex.  Every member is written in order and without padding, so vertex arrays can be bulk serialized. */
+	friend FArchive& operator<<( FArchive& Ar, FStreetMapVertex& Vertex )
+	{
+		Ar << Vertex.Position << Vertex.TextureCoordinate << Vertex.TangentX << Vertex.TangentZ << Vertex.Color;
+		return Ar;
+	}
 };
 
+static_assert( sizeof( FStreetMapVertex ) == sizeof( FVector3f ) * 3 + sizeof( FVector2f ) + sizeof( FColor ), "FStreetMapVertex must stay tightly packed to be bulk serialized" );
+
 
 /** Scene proxy for rendering a section of a street map mesh on the rendering thread */
 class FStreetMapSceneProxy : public FPrimitiveSceneProxy
@@ -81,10 +90,20 @@ public:
 	/** Return a type (or subtype) specific hash for sorting purposes */
 	SIZE_T GetTypeHash() const override;
 
+	/** Returns the size of the vertex and index buffers, as uploaded to the GPU */
+	SIZE_T GetRenderBufferSize() const
+	{
+		return RenderBufferSize;
+	}
+
 protected:
 
-	/** Initializes this scene proxy's vertex buffer, index buffer and vertex factory (on the render thread.) */
-	void InitResources();
+	/**
+	 * Initializes this scene proxy's vertex buffer, index buffer and vertex factory (on the render thread.)
+	 *
+	 * @param	bNeedsCPUAccess		False to drop the CPU copies of the vertex and index data once they have been uploaded
+	 */
+	void InitResources(bool bNeedsCPUAccess);
 
 	/** Makes a MeshBatch for rendering.  Called every time the mesh is drawn */
 	void MakeMeshBatch(struct FMeshBatch& Mesh, class FMaterialRenderProxy* WireframeMaterialRenderProxyOrNull, bool bDrawCollision = false) const;
@@ -111,6 +130,12 @@ protected:
 	/** All of the vertex indices32 in our street map mesh */
 	FDynamicMeshIndexBuffer32 IndexBuffer32;
 
+	/** Number of indices in IndexBuffer32.  Its CPU copy of the indices may have been dropped after upload. */
+	int32 NumIndices;
+
+	/** Size of the vertex and index buffers.  Worked out in Init(), before the CPU copies may be dropped. */
+	SIZE_T RenderBufferSize;
+
 	/** Our vertex factory specific to street map meshes */
 	FLocalVertexFactory VertexFactory;
 
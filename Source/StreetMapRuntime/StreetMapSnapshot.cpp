@@ -0,0 +1,264 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapSnapshot.h"
+#include "StreetMapNameIndex.h"
+#include "StreetMapDerivedData.h"
+#include "StreetMapMemory.h"
+#include "StreetMapStats.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/ScopeRWLock.h"
+
+#if WITH_EDITOR
+#include "DerivedDataCacheInterface.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#endif
+
+// Change this GUID whenever FStreetMapDerivedData::Build() or its serialization changes, so that cached data is rebuilt
+#define STREETMAP_DERIVEDDATA_VER TEXT("5B0D3E9A6C2F4A71B8E4D19F07C3A2E6")
+
+DEFINE_LOG_CATEGORY_STATIC(LogStreetMapSnapshot, Log, All);
+
+/** Maps OpenStreetMap IDs back to indices in a snapshot's feature lists */
+struct FStreetMapOsmIdIndex
+{
+	TMap<int64, int32> RoadIndices;
+	TMap<int64, int32> NodeIndices;
+	TMap<int64, int32> BuildingIndices;
+
+	/** Adds every feature's ID.  When features share an ID, lookups find the first one. */
+	static void Build(const TArray<int64>& OsmIds, TMap<int64, int32>& OutIndices, const TCHAR* FeatureType, const FName StreetMapName)
+	{
+		OutIndices.Reserve(OsmIds.Num());
+
+		int32 DuplicateCount = 0;
+		for (int32 FeatureIndex = 0; FeatureIndex < OsmIds.Num(); ++FeatureIndex)
+		{
+			const int32 IndexCount = OutIndices.Num();
+			OutIndices.FindOrAdd(OsmIds[FeatureIndex], FeatureIndex);
+			DuplicateCount += OutIndices.Num() == IndexCount ? 1 : 0;
+		}
+
+		if (DuplicateCount > 0)
+		{
+			UE_LOG(LogStreetMapSnapshot, Warning, TEXT("%s: %d %s have an OpenStreetMap ID that an earlier one already has.  Looking up those IDs finds the earlier one."),
+				*StreetMapName.ToString(), DuplicateCount, FeatureType);
+		}
+	}
+
+	static int32 Find(const TMap<int64, int32>& Indices, const int64 OsmId)
+	{
+		const int32* FoundIndexPtr = Indices.Find(OsmId);
+		return FoundIndexPtr != nullptr ? *FoundIndexPtr : INDEX_NONE;
+	}
+};
+
+
+FStreetMapSnapshot::FStreetMapSnapshot(FName InStreetMapName, uint32 InVersion)
+	: Version(InVersion)
+	, StreetMapName(InStreetMapName)
+	, BoundsMin(FVector2D::ZeroVector)
+	, BoundsMax(FVector2D::ZeroVector)
+	, CellSize(UStreetMap::DefaultCellSize)
+{
+}
+
+FStreetMapSnapshot::~FStreetMapSnapshot()
+{
+	delete OsmIdIndex.exchange(nullptr);
+	delete NameIndex.exchange(nullptr);
+}
+
+const FStreetMapOsmIdIndex& FStreetMapSnapshot::GetOsmIdIndex() const
+{
+	FStreetMapOsmIdIndex* Index = OsmIdIndex.load(std::memory_order_acquire);
+	if (Index == nullptr)
+	{
+		FScopeLock Lock(&OsmIdIndexCriticalSection);
+
+		// Someone else may have built the index while we were waiting for the lock
+		Index = OsmIdIndex.load(std::memory_order_acquire);
+		if (Index == nullptr)
+		{
+			LLM_SCOPE_BYTAG(StreetMap_Lookup);
+			Index = new FStreetMapOsmIdIndex();
+			FStreetMapOsmIdIndex::Build(RoadOsmIds, Index->RoadIndices, TEXT("roads"), StreetMapName);
+			FStreetMapOsmIdIndex::Build(NodeOsmIds, Index->NodeIndices, TEXT("nodes"), StreetMapName);
+			FStreetMapOsmIdIndex::Build(BuildingOsmIds, Index->BuildingIndices, TEXT("buildings"), StreetMapName);
+			OsmIdIndex.store(Index, std::memory_order_release);
+		}
+	}
+
+	return *Index;
+}
+
+int32 FStreetMapSnapshot::FindRoadIndexByOsmId(const int64 OsmWayId) const
+{
+	return FStreetMapOsmIdIndex::Find(GetOsmIdIndex().RoadIndices, OsmWayId);
+}
+
+int32 FStreetMapSnapshot::FindNodeIndexByOsmId(const int64 OsmNodeId) const
+{
+	return FStreetMapOsmIdIndex::Find(GetOsmIdIndex().NodeIndices, OsmNodeId);
+}
+
+int32 FStreetMapSnapshot::FindBuildingIndexByOsmId(const int64 OsmWayId) const
+{
+	return FStreetMapOsmIdIndex::Find(GetOsmIdIndex().BuildingIndices, OsmWayId);
+}
+
+const FStreetMapNameIndex& FStreetMapSnapshot::GetNameIndex() const
+{
+	FStreetMapNameIndex* Index = NameIndex.load(std::memory_order_acquire);
+	if (Index == nullptr)
+	{
+		FScopeLock Lock(&NameIndexCriticalSection);
+
+		// Someone else may have built the index while we were waiting for the lock
+		Index = NameIndex.load(std::memory_order_acquire);
+		if (Index == nullptr)
+		{
+			LLM_SCOPE_BYTAG(StreetMap_Lookup);
+			Index = new FStreetMapNameIndex();
+			Index->Build(Roads, Buildings, Names);
+			NameIndex.store(Index, std::memory_order_release);
+		}
+	}
+
+	return *Index;
+}
+
+TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> FStreetMapSnapshot::GetDerivedData() const
+{
+	{
+		FReadScopeLock ReadLock(DerivedDataLock);
+		if (DerivedData.IsValid())
+		{
+			return DerivedData;
+		}
+	}
+
+	// Fetching or building can take a while, so it's done without holding the lock, or every reader of this snapshot
+	// would wait on it.  Threads that race to build it each build their own, and the first one to finish is kept.
+	const TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> NewDerivedData = BuildDerivedData();
+
+	FWriteScopeLock WriteLock(DerivedDataLock);
+	if (!DerivedData.IsValid())
+	{
+		DerivedData = NewDerivedData;
+	}
+	return DerivedData;
+}
+
+TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> FStreetMapSnapshot::FindDerivedData() const
+{
+	FReadScopeLock ReadLock(DerivedDataLock);
+	return DerivedData;
+}
+
+TSharedPtr<const FStreetMapDerivedData, ESPMode::ThreadSafe> FStreetMapSnapshot::BuildDerivedData() const
+{
+	LLM_SCOPE_BYTAG(StreetMap_DerivedData);
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_BuildDerivedData);
+
+	TSharedRef<FStreetMapDerivedData, ESPMode::ThreadSafe> NewDerivedData = MakeShared<FStreetMapDerivedData, ESPMode::ThreadSafe>();
+
+#if WITH_EDITOR
+	const FString DerivedDataKey = GetDerivedDataKey();
+	const FString DebugContext = StreetMapName.ToString();
+
+	TArray<uint8> DerivedDataBytes;
+	if (GetDerivedDataCacheRef().GetSynchronous(*DerivedDataKey, DerivedDataBytes, DebugContext))
+	{
+		FMemoryReader Reader(DerivedDataBytes, /* bIsPersistent */ true);
+		Reader << *NewDerivedData;
+		if (!Reader.IsError())
+		{
+			return NewDerivedData;
+		}
+	}
+
+	NewDerivedData->Build(*this);
+
+	DerivedDataBytes.Reset();
+	FMemoryWriter Writer(DerivedDataBytes, /* bIsPersistent */ true);
+	Writer << *NewDerivedData;
+	GetDerivedDataCacheRef().Put(*DerivedDataKey, DerivedDataBytes, DebugContext);
+#else
+	NewDerivedData->Build(*this);
+#endif
+
+	return NewDerivedData;
+}
+
+#if WITH_EDITOR
+FString FStreetMapSnapshot::GetDerivedDataKey() const
+{
+	// Hash everything the derived data is built from
+	FSHA1 Hash;
+	for (const FStreetMapRoad& Road : Roads)
+	{
+		const uint8 RoadFlags = (uint8)Road.RoadType | (Road.bIsOneWay ? 0x80 : 0);
+		Hash.Update(&RoadFlags, sizeof(RoadFlags));
+		Hash.Update((const uint8*)Road.RoadPoints.GetData(), Road.RoadPoints.Num() * Road.RoadPoints.GetTypeSize());
+		Hash.Update((const uint8*)Road.NodeIndices.GetData(), Road.NodeIndices.Num() * Road.NodeIndices.GetTypeSize());
+	}
+	for (const FStreetMapNode& Node : Nodes)
+	{
+		Hash.Update((const uint8*)&Node.Location, sizeof(Node.Location));
+		Hash.Update((const uint8*)&Node.FirstRoadRef, sizeof(Node.FirstRoadRef));
+		Hash.Update((const uint8*)&Node.NumRoadRefs, sizeof(Node.NumRoadRefs));
+	}
+	Hash.Update((const uint8*)NodeRoadRefs.GetData(), NodeRoadRefs.Num() * NodeRoadRefs.GetTypeSize());
+	for (const FStreetMapBuilding& Building : Buildings)
+	{
+		const int32 PointCount = Building.BuildingPoints.Num();
+		Hash.Update((const uint8*)&PointCount, sizeof(PointCount));
+		Hash.Update((const uint8*)Building.BuildingPoints.GetData(), Building.BuildingPoints.Num() * Building.BuildingPoints.GetTypeSize());
+	}
+	Hash.Final();
+
+	FSHAHash DataHash;
+	Hash.GetHash(DataHash.Hash);
+
+	return FDerivedDataCacheInterface::BuildCacheKey(TEXT("STREETMAP"), STREETMAP_DERIVEDDATA_VER, *DataHash.ToString());
+}
+#endif	// WITH_EDITOR
+
+SIZE_T FStreetMapSnapshot::GetAllocatedSize() const
+{
+	SIZE_T Size = sizeof(*this);
+
+	Size += Roads.GetAllocatedSize();
+	for (const FStreetMapRoad& Road : Roads)
+	{
+		Size += Road.RoadPoints.GetAllocatedSize() + Road.NodeIndices.GetAllocatedSize();
+	}
+
+	Size += Nodes.GetAllocatedSize() + NodeRoadRefs.GetAllocatedSize();
+
+	Size += Buildings.GetAllocatedSize();
+	for (const FStreetMapBuilding& Building : Buildings)
+	{
+		Size += Building.BuildingPoints.GetAllocatedSize();
+	}
+
+	Size += Names.GetAllocatedSize();
+	for (const FString& Name : Names)
+	{
+		Size += Name.GetAllocatedSize();
+	}
+
+	Size += RoadOsmIds.GetAllocatedSize() + NodeOsmIds.GetAllocatedSize() + BuildingOsmIds.GetAllocatedSize();
+
+	if (const FStreetMapOsmIdIndex* Index = OsmIdIndex.load(std::memory_order_acquire))
+	{
+		Size += sizeof(*Index) + Index->RoadIndices.GetAllocatedSize() + Index->NodeIndices.GetAllocatedSize() + Index->BuildingIndices.GetAllocatedSize();
+	}
+	if (const FStreetMapNameIndex* Index = NameIndex.load(std::memory_order_acquire))
+	{
+		Size += sizeof(*Index) + Index->GetAllocatedSize();
+	}
+	return Size;
+}
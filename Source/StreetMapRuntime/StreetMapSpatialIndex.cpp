@@ -0,0 +1,1088 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapSpatialIndex.h"
+#include "StreetMap.h"
+#include "PolygonTools.h"
+#include "Algo/Sort.h"
+#include <cmath>
+
+namespace StreetMapSpatialIndex
+{
+	/** Converts to float, rounding down, so that bounds never shrink */
+	static float RoundDown(const double Value)
+	{
+		const float Result = (float)Value;
+		return (double)Result > Value ? std::nextafter(Result, -MAX_flt) : Result;
+	}
+
+	/** Converts to float, rounding up, so that bounds never shrink */
+	static float RoundUp(const double Value)
+	{
+		const float Result = (float)Value;
+		return (double)Result < Value ? std::nextafter(Result, MAX_flt) : Result;
+	}
+
+	/** Squared distance from Location to the closest point of segment Start-End, and how far along the segment that point is */
+	static FORCEINLINE double SegmentDistanceSquared(const FVector2D& Location, const FVector2D& Start, const FVector2D& End, double& OutAlpha)
+	{
+		const FVector2D SegmentVector = End - Start;
+		const double LengthSquared = SegmentVector.SizeSquared();
+		OutAlpha = LengthSquared > 0.0 ? FMath::Clamp(((Location - Start) | SegmentVector) / LengthSquared, 0.0, 1.0) : 0.0;
+		return FVector2D::DistSquared(Location, Start + SegmentVector * OutAlpha);
+	}
+
+	/**
+	 * Intersects the segment Start + Time * Delta with a polygon extruded from Z zero up to Height.  Only hits before
+	 * InOutTime are found, and InOutTime is updated to the hit.
+	 */
+	static bool IntersectExtrudedPolygon(const TArray<FVector2D>& Polygon, const double Height, const FVector& Start, const FVector& Delta, double& InOutTime, FStreetMapBuildingHit& OutHit)
+	{
+		if (Height <= 0.0 || Polygon.Num() < 3)
+		{
+			return false;
+		}
+
+		const FVector2D Start2D(Start);
+		const FVector2D Delta2D(Delta);
+		if (Start.Z >= 0.0 && Start.Z <= Height && FPolygonTools::IsPointInsidePolygon(Polygon, Start2D))
+		{
+			InOutTime = 0.0;
+			OutHit.Face = EStreetMapBuildingFace::Inside;
+			OutHit.WallIndex = INDEX_NONE;
+			OutHit.Normal = FVector::ZeroVector;
+			return true;
+		}
+
+		bool bHit = false;
+
+		// Walls: where the segment's shadow on the ground crosses an edge, at a height within the building
+		const int32 NumCorners = Polygon.Num();
+		for (int32 CornerIndex = 0, PreviousCornerIndex = NumCorners - 1; CornerIndex < NumCorners; PreviousCornerIndex = CornerIndex++)
+		{
+			const FVector2D EdgeStart = Polygon[PreviousCornerIndex];
+			const FVector2D Edge = Polygon[CornerIndex] - EdgeStart;
+			const double Denominator = Delta2D ^ Edge;
+			if (FMath::IsNearlyZero(Denominator))
+			{
+				continue;
+			}
+
+			const FVector2D ToEdgeStart = EdgeStart - Start2D;
+			const double Time = (ToEdgeStart ^ Edge) / Denominator;
+			const double EdgeAlpha = (ToEdgeStart ^ Delta2D) / Denominator;
+			if (Time < 0.0 || Time >= InOutTime || EdgeAlpha < 0.0 || EdgeAlpha > 1.0)
+			{
+				continue;
+			}
+
+			const double Z = Start.Z + Time * Delta.Z;
+			if (Z < 0.0 || Z > Height)
+			{
+				continue;
+			}
+
+			FVector2D Normal = FVector2D(Edge.Y, -Edge.X).GetSafeNormal();
+			if ((Normal | Delta2D) > 0.0)
+			{
+				Normal = -Normal;
+			}
+
+			InOutTime = Time;
+			OutHit.Face = EStreetMapBuildingFace::Wall;
+			OutHit.WallIndex = PreviousCornerIndex;
+			OutHit.Normal = FVector(Normal, 0.0);
+			bHit = true;
+		}
+
+		// Roof from above, or floor from below
+		if (Delta.Z != 0.0)
+		{
+			const bool bFromAbove = Delta.Z < 0.0;
+			const double PlaneZ = bFromAbove ? Height : 0.0;
+			const double Time = (PlaneZ - Start.Z) / Delta.Z;
+			if ((bFromAbove ? Start.Z >= Height : Start.Z <= 0.0) && Time >= 0.0 && Time < InOutTime &&
+				FPolygonTools::IsPointInsidePolygon(Polygon, Start2D + Delta2D * Time))
+			{
+				InOutTime = Time;
+				OutHit.Face = bFromAbove ? EStreetMapBuildingFace::Roof : EStreetMapBuildingFace::Floor;
+				OutHit.WallIndex = INDEX_NONE;
+				OutHit.Normal = bFromAbove ? FVector::UpVector : FVector::DownVector;
+				bHit = true;
+			}
+		}
+
+		return bHit;
+	}
+
+	/**
+	 * Remembers which items a query has already visited, such as buildings listed in several cells.  Items are stamped with
+	 * the query's number rather than cleared after each query, and the stamps only ever grow, so queries don't allocate
+	 * once a thread has run one over the largest list of items.
+	 */
+	struct FVisitStamps
+	{
+		TArray<uint32> Stamps;
+		uint32 Stamp = 0;
+
+		/** Starts a new query over up to ItemCount items */
+		void Begin(const int32 ItemCount)
+		{
+			if (Stamps.Num() < ItemCount)
+			{
+				Stamps.SetNumZeroed(ItemCount);
+			}
+			if (++Stamp == 0)
+			{
+				// Wrapped around, so items visited long ago could look visited by this query
+				FMemory::Memzero(Stamps.GetData(), Stamps.Num() * sizeof(uint32));
+				Stamp = 1;
+			}
+		}
+
+		/** @return True the first time the item is visited during this query */
+		bool Visit(const int32 Index)
+		{
+			if (Stamps[Index] == Stamp)
+			{
+				return false;
+			}
+			Stamps[Index] = Stamp;
+			return true;
+		}
+	};
+
+	/**
+	 * Each thread has its own stamps for roads and for buildings, so queries run on any number of workers at once.  A
+	 * query's filter must not run another query of the same kind on the same thread, since that would restart the stamps
+	 * the first query is still using.
+	 */
+	static thread_local FVisitStamps VisitedRoads;
+	static thread_local FVisitStamps VisitedBuildings;
+}
+
+
+FStreetMapQueryVolume::FStreetMapQueryVolume(TArrayView<const FPlane> InPlanes, const FBox& ClipBox)
+	: Bounds(ForceInit)
+{
+	if (!ClipBox.IsValid)
+	{
+		return;
+	}
+
+	for (const FPlane& Plane : InPlanes)
+	{
+		// Skip degenerate planes, like the far plane of an infinite projection
+		const double NormalSize = Plane.GetNormal().Size();
+		if (NormalSize > UE_DOUBLE_SMALL_NUMBER)
+		{
+			Planes.Add(FPlane(Plane.X / NormalSize, Plane.Y / NormalSize, Plane.Z / NormalSize, Plane.W / NormalSize));
+		}
+	}
+	Planes.Add(FPlane(FVector(1.0, 0.0, 0.0), ClipBox.Max.X));
+	Planes.Add(FPlane(FVector(-1.0, 0.0, 0.0), -ClipBox.Min.X));
+	Planes.Add(FPlane(FVector(0.0, 1.0, 0.0), ClipBox.Max.Y));
+	Planes.Add(FPlane(FVector(0.0, -1.0, 0.0), -ClipBox.Min.Y));
+	Planes.Add(FPlane(FVector(0.0, 0.0, 1.0), ClipBox.Max.Z));
+	Planes.Add(FPlane(FVector(0.0, 0.0, -1.0), -ClipBox.Min.Z));
+
+	// The corners of the volume are where three of its planes meet without being outside any of the others.  There are at
+	// most a dozen planes, so trying every triple is quick.
+	const double Tolerance = FMath::Max(ClipBox.GetExtent().GetMax() * 1e-9, 1e-3);
+	for (int32 PlaneA = 0; PlaneA < Planes.Num(); ++PlaneA)
+	{
+		for (int32 PlaneB = PlaneA + 1; PlaneB < Planes.Num(); ++PlaneB)
+		{
+			for (int32 PlaneC = PlaneB + 1; PlaneC < Planes.Num(); ++PlaneC)
+			{
+				FVector Corner;
+				if (!FMath::IntersectPlanes3(Corner, Planes[PlaneA], Planes[PlaneB], Planes[PlaneC]))
+				{
+					continue;
+				}
+
+				bool bInside = true;
+				for (int32 PlaneIndex = 0; PlaneIndex < Planes.Num() && bInside; ++PlaneIndex)
+				{
+					bInside = Planes[PlaneIndex].PlaneDot(Corner) <= Tolerance;
+				}
+				if (bInside)
+				{
+					Bounds += Corner;
+				}
+			}
+		}
+	}
+}
+
+
+bool FStreetMapQueryVolume::IntersectsBox(const FBox& Box) const
+{
+	if (!Bounds.Intersect(Box))
+	{
+		return false;
+	}
+
+	// The box is outside if it is entirely in front of any plane
+	const FVector Center = Box.GetCenter();
+	const FVector Extent = Box.GetExtent();
+	for (const FPlane& Plane : Planes)
+	{
+		const double PushOut = FMath::Abs(Plane.X * Extent.X) + FMath::Abs(Plane.Y * Extent.Y) + FMath::Abs(Plane.Z * Extent.Z);
+		if (Plane.PlaneDot(Center) > PushOut)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+bool FStreetMapQueryVolume::IntersectsSegment(const FVector& Start, const FVector& End) const
+{
+	// Clip the segment against each plane in turn
+	double EnterAlpha = 0.0;
+	double ExitAlpha = 1.0;
+	for (const FPlane& Plane : Planes)
+	{
+		const double StartDistance = Plane.PlaneDot(Start);
+		const double EndDistance = Plane.PlaneDot(End);
+		if (StartDistance > 0.0 && EndDistance > 0.0)
+		{
+			return false;
+		}
+		if (StartDistance > 0.0)
+		{
+			EnterAlpha = FMath::Max(EnterAlpha, StartDistance / (StartDistance - EndDistance));
+		}
+		else if (EndDistance > 0.0)
+		{
+			ExitAlpha = FMath::Min(ExitAlpha, StartDistance / (StartDistance - EndDistance));
+		}
+		if (EnterAlpha > ExitAlpha)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+void FStreetMapBoundsTree::Build(TArrayView<const FBox2D> ItemBounds, TArray<int32>& OutItemOrder)
+{
+	Nodes.Reset();
+	OutItemOrder.Reset(ItemBounds.Num());
+	Origin = FVector2D::ZeroVector;
+	if (ItemBounds.Num() == 0)
+	{
+		return;
+	}
+
+	FBox2D AllBounds(ForceInit);
+	TArray<FVector2D> ItemCenters;
+	ItemCenters.Reserve(ItemBounds.Num());
+	for (int32 ItemIndex = 0; ItemIndex < ItemBounds.Num(); ++ItemIndex)
+	{
+		AllBounds += ItemBounds[ItemIndex];
+		ItemCenters.Add(ItemBounds[ItemIndex].GetCenter());
+		OutItemOrder.Add(ItemIndex);
+	}
+
+	// Keep coordinates small, where floats are most precise
+	Origin = AllBounds.GetCenter();
+
+	// A binary tree with full leaves has just under twice as many nodes as leaves
+	Nodes.Reserve(2 * FMath::DivideAndRoundUp(ItemBounds.Num(), MaxLeafSize));
+	Nodes.AddUninitialized();
+	BuildNode(0, 0, ItemBounds.Num(), ItemBounds, ItemCenters, OutItemOrder);
+	Nodes.Shrink();
+}
+
+
+void FStreetMapBoundsTree::BuildNode(const int32 NodeIndex, const int32 Begin, const int32 End, TArrayView<const FBox2D> ItemBounds, const TArray<FVector2D>& ItemCenters, TArray<int32>& ItemOrder)
+{
+	using namespace StreetMapSpatialIndex;
+
+	FBox2D Bounds(ForceInit);
+	FBox2D CenterBounds(ForceInit);
+	for (int32 OrderIndex = Begin; OrderIndex < End; ++OrderIndex)
+	{
+		Bounds += ItemBounds[ItemOrder[OrderIndex]];
+		CenterBounds += ItemCenters[ItemOrder[OrderIndex]];
+	}
+
+	{
+		FNode& Node = Nodes[NodeIndex];
+		Node.Min = FVector2f(RoundDown(Bounds.Min.X - Origin.X), RoundDown(Bounds.Min.Y - Origin.Y));
+		Node.Max = FVector2f(RoundUp(Bounds.Max.X - Origin.X), RoundUp(Bounds.Max.Y - Origin.Y));
+	}
+
+	if (End - Begin <= MaxLeafSize)
+	{
+		Nodes[NodeIndex].First = Begin;
+		Nodes[NodeIndex].Count = End - Begin;
+		return;
+	}
+
+	// Split at the median along the axis the item centers are most spread out on
+	const FVector2D CenterExtent = CenterBounds.GetSize();
+	const int32 Axis = CenterExtent.X >= CenterExtent.Y ? 0 : 1;
+	Algo::Sort(MakeArrayView(ItemOrder.GetData() + Begin, End - Begin), [&ItemCenters, Axis](const int32 A, const int32 B)
+	{
+		return ItemCenters[A][Axis] < ItemCenters[B][Axis];
+	});
+	const int32 Middle = Begin + (End - Begin) / 2;
+
+	// Adding the children may move the nodes, so don't hold on to a reference across it
+	const int32 FirstChild = Nodes.Num();
+	Nodes.AddUninitialized(2);
+	Nodes[NodeIndex].First = FirstChild;
+	Nodes[NodeIndex].Count = 0;
+
+	BuildNode(FirstChild, Begin, Middle, ItemBounds, ItemCenters, ItemOrder);
+	BuildNode(FirstChild + 1, Middle, End, ItemBounds, ItemCenters, ItemOrder);
+}
+
+
+FArchive& operator<<(FArchive& Ar, FStreetMapBoundsTree& Tree)
+{
+	Ar << Tree.Origin;
+	Tree.Nodes.BulkSerialize(Ar);
+	return Ar;
+}
+
+
+FORCEINLINE bool FStreetMapRoadSegmentIndex::GetSegmentPoints(TArrayView<const FStreetMapRoad> Roads, const FSegment& Segment, const FVector2D*& OutStart, const FVector2D*& OutEnd)
+{
+	if (!Roads.IsValidIndex(Segment.RoadIndex))
+	{
+		return false;
+	}
+
+	const TArray<FVector2D>& RoadPoints = Roads[Segment.RoadIndex].RoadPoints;
+	if (!RoadPoints.IsValidIndex(Segment.PointIndex))
+	{
+		return false;
+	}
+
+	OutStart = &RoadPoints[Segment.PointIndex];
+	OutEnd = &RoadPoints[FMath::Min(Segment.PointIndex + 1, RoadPoints.Num() - 1)];
+	return true;
+}
+
+
+void FStreetMapRoadSegmentIndex::Build(TArrayView<const FStreetMapRoad> Roads)
+{
+	TArray<FSegment> UnorderedSegments;
+	TArray<FBox2D> SegmentBounds;
+	for (int32 RoadIndex = 0; RoadIndex < Roads.Num(); ++RoadIndex)
+	{
+		const TArray<FVector2D>& RoadPoints = Roads[RoadIndex].RoadPoints;
+		const int32 SegmentCount = FMath::Max(RoadPoints.Num() - 1, FMath::Min(RoadPoints.Num(), 1));
+
+		float PositionAlongRoad = 0.0f;
+		for (int32 PointIndex = 0; PointIndex < SegmentCount; ++PointIndex)
+		{
+			const FVector2D& Start = RoadPoints[PointIndex];
+			const FVector2D& End = RoadPoints[FMath::Min(PointIndex + 1, RoadPoints.Num() - 1)];
+
+			UnorderedSegments.Add({ RoadIndex, PointIndex, PositionAlongRoad });
+			SegmentBounds.Add(FBox2D(FVector2D::Min(Start, End), FVector2D::Max(Start, End)));
+
+			// Same sum FStreetMapRoad::ComputeDistanceBetweenNodesOnRoad() makes, so positions agree with it
+			PositionAlongRoad += (End - Start).Size();
+		}
+	}
+
+	TArray<int32> SegmentOrder;
+	Tree.Build(SegmentBounds, SegmentOrder);
+
+	Segments.Reset(SegmentOrder.Num());
+	for (const int32 SegmentIndex : SegmentOrder)
+	{
+		Segments.Add(UnorderedSegments[SegmentIndex]);
+	}
+}
+
+
+bool FStreetMapRoadSegmentIndex::FindNearestLocation(TArrayView<const FStreetMapRoad> Roads, const FVector2D& Location, const double MaxDistance, FStreetMapRoadLocation& OutRoadLocation) const
+{
+	using namespace StreetMapSpatialIndex;
+
+	OutRoadLocation = FStreetMapRoadLocation();
+
+	double BestDistanceSquared = MaxDistance * MaxDistance;
+	const int32 BestSegmentIndex = Tree.FindNearest(Location, BestDistanceSquared, [this, Roads, &Location](const int32 SegmentIndex)
+	{
+		const FVector2D* Start;
+		const FVector2D* End;
+		if (!GetSegmentPoints(Roads, Segments[SegmentIndex], Start, End))
+		{
+			return MAX_dbl;
+		}
+		double Alpha;
+		return SegmentDistanceSquared(Location, *Start, *End, Alpha);
+	});
+	if (BestSegmentIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	MakeRoadLocation(Roads, BestSegmentIndex, Location, BestDistanceSquared, OutRoadLocation);
+	return true;
+}
+
+
+void FStreetMapRoadSegmentIndex::MakeRoadLocation(TArrayView<const FStreetMapRoad> Roads, const int32 SegmentIndex, const FVector2D& Location, const double DistanceSquared, FStreetMapRoadLocation& OutRoadLocation) const
+{
+	using namespace StreetMapSpatialIndex;
+
+	const FSegment& Segment = Segments[SegmentIndex];
+	const FVector2D* Start;
+	const FVector2D* End;
+	GetSegmentPoints(Roads, Segment, Start, End);
+
+	double Alpha;
+	SegmentDistanceSquared(Location, *Start, *End, Alpha);
+
+	OutRoadLocation.RoadIndex = Segment.RoadIndex;
+	OutRoadLocation.SegmentIndex = Segment.PointIndex;
+	OutRoadLocation.SegmentAlpha = (float)Alpha;
+	OutRoadLocation.PositionAlongRoad = Segment.PositionAlongRoad + (float)(Alpha * FVector2D::Distance(*Start, *End));
+	OutRoadLocation.Location = FMath::Lerp(*Start, *End, Alpha);
+	OutRoadLocation.Distance = (float)FMath::Sqrt(DistanceSquared);
+}
+
+
+bool FStreetMapRoadSegmentIndex::FindNearestPoint(TArrayView<const FStreetMapRoad> Roads, const FVector2D& Location, const double MaxDistance, int32& OutRoadIndex, int32& OutPointIndex) const
+{
+	OutRoadIndex = INDEX_NONE;
+	OutPointIndex = INDEX_NONE;
+
+	// Every road point is an end of some segment, so the nearest segment end is the nearest road point
+	double BestDistanceSquared = MaxDistance * MaxDistance;
+	const int32 BestSegmentIndex = Tree.FindNearest(Location, BestDistanceSquared, [this, Roads, &Location](const int32 SegmentIndex)
+	{
+		const FVector2D* Start;
+		const FVector2D* End;
+		if (!GetSegmentPoints(Roads, Segments[SegmentIndex], Start, End))
+		{
+			return MAX_dbl;
+		}
+		return FMath::Min(FVector2D::DistSquared(Location, *Start), FVector2D::DistSquared(Location, *End));
+	});
+	if (BestSegmentIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FSegment& Segment = Segments[BestSegmentIndex];
+	const FVector2D* Start;
+	const FVector2D* End;
+	GetSegmentPoints(Roads, Segment, Start, End);
+
+	OutRoadIndex = Segment.RoadIndex;
+	OutPointIndex = FVector2D::DistSquared(Location, *Start) <= FVector2D::DistSquared(Location, *End) ? Segment.PointIndex : Segment.PointIndex + 1;
+	return true;
+}
+
+
+void FStreetMapRoadSegmentIndex::FindNearestRoads(TArrayView<const FStreetMapRoad> Roads, const FVector2D& Location, const int32 MaxCount, const double MaxDistance, TFunctionRef<bool(int32 RoadIndex)> RoadFilter, TArray<FStreetMapRoadLocation>& OutRoadLocations) const
+{
+	using namespace StreetMapSpatialIndex;
+
+	OutRoadLocations.Reset();
+	if (MaxCount <= 0)
+	{
+		return;
+	}
+
+	// Segments come out nearest first, so the first segment of a road is its nearest one, and later ones are skipped
+	FVisitStamps& FoundRoads = VisitedRoads;
+	FoundRoads.Begin(Roads.Num());
+	Tree.ForEachNearest(Location, MaxDistance * MaxDistance, [this, Roads, &Location, &RoadFilter](const int32 SegmentIndex)
+	{
+		const FVector2D* Start;
+		const FVector2D* End;
+		if (!GetSegmentPoints(Roads, Segments[SegmentIndex], Start, End) || !RoadFilter(Segments[SegmentIndex].RoadIndex))
+		{
+			return MAX_dbl;
+		}
+		double Alpha;
+		return SegmentDistanceSquared(Location, *Start, *End, Alpha);
+	},
+	[&](const int32 SegmentIndex, const double DistanceSquared)
+	{
+		const int32 RoadIndex = Segments[SegmentIndex].RoadIndex;
+		if (Roads.IsValidIndex(RoadIndex) && FoundRoads.Visit(RoadIndex))
+		{
+			MakeRoadLocation(Roads, SegmentIndex, Location, DistanceSquared, OutRoadLocations.AddDefaulted_GetRef());
+		}
+		return OutRoadLocations.Num() < MaxCount;
+	});
+}
+
+
+void FStreetMapRoadSegmentIndex::FindRoadsInVolume(TArrayView<const FStreetMapRoad> Roads, const FStreetMapQueryVolume& Volume, TArray<FStreetMapRoadRange>& OutRoadRanges) const
+{
+	if (Volume.IsEmpty())
+	{
+		return;
+	}
+
+	// Add a one segment range for every segment inside, then sort them and merge neighbors.  That way the only memory
+	// used is the output's.
+	const int32 FirstNewRange = OutRoadRanges.Num();
+	Tree.ForEachOverlapping([&Volume](const FBox2D& NodeBounds)
+	{
+		return Volume.IntersectsBox(FBox(FVector(NodeBounds.Min, 0.0), FVector(NodeBounds.Max, 0.0)));
+	},
+	[this, Roads, &Volume, &OutRoadRanges](const int32 SegmentIndex)
+	{
+		const FSegment& Segment = Segments[SegmentIndex];
+		const FVector2D* Start;
+		const FVector2D* End;
+		if (GetSegmentPoints(Roads, Segment, Start, End) && Volume.IntersectsSegment(FVector(*Start, 0.0), FVector(*End, 0.0)))
+		{
+			FStreetMapRoadRange& Range = OutRoadRanges.AddDefaulted_GetRef();
+			Range.RoadIndex = Segment.RoadIndex;
+			Range.FirstPointIndex = Segment.PointIndex;
+			Range.LastPointIndex = FMath::Min(Segment.PointIndex + 1, Roads[Segment.RoadIndex].RoadPoints.Num() - 1);
+		}
+	});
+
+	TArrayView<FStreetMapRoadRange> NewRanges(OutRoadRanges.GetData() + FirstNewRange, OutRoadRanges.Num() - FirstNewRange);
+	Algo::Sort(NewRanges, [](const FStreetMapRoadRange& A, const FStreetMapRoadRange& B)
+	{
+		return A.RoadIndex != B.RoadIndex ? A.RoadIndex < B.RoadIndex : A.FirstPointIndex < B.FirstPointIndex;
+	});
+
+	int32 MergedCount = 0;
+	for (const FStreetMapRoadRange& Range : NewRanges)
+	{
+		if (MergedCount > 0 && NewRanges[MergedCount - 1].RoadIndex == Range.RoadIndex && NewRanges[MergedCount - 1].LastPointIndex >= Range.FirstPointIndex)
+		{
+			NewRanges[MergedCount - 1].LastPointIndex = FMath::Max(NewRanges[MergedCount - 1].LastPointIndex, Range.LastPointIndex);
+		}
+		else
+		{
+			NewRanges[MergedCount++] = Range;
+		}
+	}
+	OutRoadRanges.SetNum(FirstNewRange + MergedCount, EAllowShrinking::No);
+}
+
+
+FArchive& operator<<(FArchive& Ar, FStreetMapRoadSegmentIndex& Index)
+{
+	Ar << Index.Tree;
+	Index.Segments.BulkSerialize(Ar);
+	return Ar;
+}
+
+
+void FStreetMapNodeIndex::Build(TArrayView<const FStreetMapNode> Nodes)
+{
+	TArray<FBox2D> NodeBounds;
+	NodeBounds.Reserve(Nodes.Num());
+	for (const FStreetMapNode& Node : Nodes)
+	{
+		NodeBounds.Add(FBox2D(Node.Location, Node.Location));
+	}
+
+	Tree.Build(NodeBounds, NodeIndices);
+
+	NodeLocations.Reset(NodeIndices.Num());
+	for (const int32 NodeIndex : NodeIndices)
+	{
+		NodeLocations.Add(Nodes[NodeIndex].Location);
+	}
+}
+
+
+void FStreetMapNodeIndex::FindNearestNodes(const FVector2D& Location, const int32 MaxCount, const double MaxDistance, TFunctionRef<bool(int32 NodeIndex)> NodeFilter, TArray<FStreetMapNearestItem>& OutNodes) const
+{
+	OutNodes.Reset();
+	if (MaxCount <= 0)
+	{
+		return;
+	}
+
+	Tree.ForEachNearest(Location, MaxDistance * MaxDistance, [this, &Location, &NodeFilter](const int32 ItemIndex)
+	{
+		return NodeFilter(NodeIndices[ItemIndex]) ? FVector2D::DistSquared(Location, NodeLocations[ItemIndex]) : MAX_dbl;
+	},
+	[this, MaxCount, &OutNodes](const int32 ItemIndex, const double DistanceSquared)
+	{
+		OutNodes.Add({ NodeIndices[ItemIndex], FMath::Sqrt(DistanceSquared) });
+		return OutNodes.Num() < MaxCount;
+	});
+}
+
+
+FArchive& operator<<(FArchive& Ar, FStreetMapNodeIndex& Index)
+{
+	Ar << Index.Tree;
+	Index.NodeIndices.BulkSerialize(Ar);
+	Index.NodeLocations.BulkSerialize(Ar);
+	return Ar;
+}
+
+
+void FStreetMapBuildingIndex::Build(TArrayView<const FStreetMapBuilding> Buildings)
+{
+	CellOffsets.Reset();
+	CellBuildings.Reset();
+	Origin = FVector2D::ZeroVector;
+	CellSize = 1.0;
+	CellCount = FIntPoint::ZeroValue;
+	if (Buildings.Num() == 0)
+	{
+		return;
+	}
+
+	FBox2D AllBounds(ForceInit);
+	double TotalBuildingSize = 0.0;
+	for (const FStreetMapBuilding& Building : Buildings)
+	{
+		AllBounds += FBox2D(Building.BoundsMin, Building.BoundsMax);
+		TotalBuildingSize += (Building.BoundsMax - Building.BoundsMin).GetMax();
+	}
+
+	// Cells about as big as a few buildings spread evenly over the map, but never smaller than a typical building, so
+	// that most buildings are only listed in one or two cells
+	const FVector2D Size = AllBounds.GetSize();
+	CellSize = FMath::Sqrt(Size.X * Size.Y * TargetBuildingsPerCell / Buildings.Num());
+	CellSize = FMath::Max3(CellSize, TotalBuildingSize / Buildings.Num(), 1.0);
+
+	// Long thin maps can still ask for far more cells than buildings.  Keep the grid proportional to the building count.
+	const double MaxCellCount = FMath::Max(Buildings.Num() / TargetBuildingsPerCell, 1.0) * 4.0;
+	while ((FMath::FloorToDouble(Size.X / CellSize) + 1.0) * (FMath::FloorToDouble(Size.Y / CellSize) + 1.0) > MaxCellCount)
+	{
+		CellSize *= 2.0;
+	}
+
+	Origin = AllBounds.Min;
+	CellCount.X = (int32)FMath::FloorToDouble(Size.X / CellSize) + 1;
+	CellCount.Y = (int32)FMath::FloorToDouble(Size.Y / CellSize) + 1;
+
+	// Count the buildings in each cell, then turn the counts into offsets and fill the cells in a second pass
+	CellOffsets.SetNumZeroed(CellCount.X * CellCount.Y + 1);
+	for (const FStreetMapBuilding& Building : Buildings)
+	{
+		FIntPoint MinCell, MaxCell;
+		GetCellRange(FBox2D(Building.BoundsMin, Building.BoundsMax), MinCell, MaxCell);
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+			{
+				++CellOffsets[CellY * CellCount.X + CellX + 1];
+			}
+		}
+	}
+	for (int32 CellIndex = 1; CellIndex < CellOffsets.Num(); ++CellIndex)
+	{
+		CellOffsets[CellIndex] += CellOffsets[CellIndex - 1];
+	}
+
+	TArray<int32> CellFill(CellOffsets.GetData(), CellOffsets.Num() - 1);
+	CellBuildings.SetNumUninitialized(CellOffsets.Last());
+	for (int32 BuildingIndex = 0; BuildingIndex < Buildings.Num(); ++BuildingIndex)
+	{
+		FIntPoint MinCell, MaxCell;
+		GetCellRange(FBox2D(Buildings[BuildingIndex].BoundsMin, Buildings[BuildingIndex].BoundsMax), MinCell, MaxCell);
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+			{
+				CellBuildings[CellFill[CellY * CellCount.X + CellX]++] = BuildingIndex;
+			}
+		}
+	}
+}
+
+
+bool FStreetMapBuildingIndex::GetCellRange(const FBox2D& Box, FIntPoint& OutMinCell, FIntPoint& OutMaxCell) const
+{
+	const FVector2D LocalMin = (Box.Min - Origin) / CellSize;
+	const FVector2D LocalMax = (Box.Max - Origin) / CellSize;
+	if (LocalMax.X < 0.0 || LocalMax.Y < 0.0 || LocalMin.X >= CellCount.X || LocalMin.Y >= CellCount.Y)
+	{
+		return false;
+	}
+
+	OutMinCell.X = FMath::Clamp((int32)FMath::FloorToDouble(LocalMin.X), 0, CellCount.X - 1);
+	OutMinCell.Y = FMath::Clamp((int32)FMath::FloorToDouble(LocalMin.Y), 0, CellCount.Y - 1);
+	OutMaxCell.X = FMath::Clamp((int32)FMath::FloorToDouble(LocalMax.X), 0, CellCount.X - 1);
+	OutMaxCell.Y = FMath::Clamp((int32)FMath::FloorToDouble(LocalMax.Y), 0, CellCount.Y - 1);
+	return true;
+}
+
+
+template<typename VisitorType>
+void FStreetMapBuildingIndex::ForEachBuildingOverlapping(TArrayView<const FStreetMapBuilding> Buildings, const FBox2D& Box, VisitorType&& Visitor) const
+{
+	FIntPoint MinCell, MaxCell;
+	if (!GetCellRange(Box, MinCell, MaxCell))
+	{
+		return;
+	}
+
+	for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+	{
+		for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+		{
+			const int32 CellIndex = CellY * CellCount.X + CellX;
+			for (int32 EntryIndex = CellOffsets[CellIndex]; EntryIndex < CellOffsets[CellIndex + 1]; ++EntryIndex)
+			{
+				const int32 BuildingIndex = CellBuildings[EntryIndex];
+				if (!Buildings.IsValidIndex(BuildingIndex))
+				{
+					continue;
+				}
+
+				const FStreetMapBuilding& Building = Buildings[BuildingIndex];
+				const FBox2D BuildingBounds(Building.BoundsMin, Building.BoundsMax);
+				if (!BuildingBounds.Intersect(Box))
+				{
+					continue;
+				}
+
+				// A building listed in several of the cells being searched is only visited from the first of them: the
+				// cell where its own cell range and the searched range start to overlap
+				FIntPoint BuildingMinCell, BuildingMaxCell;
+				GetCellRange(BuildingBounds, BuildingMinCell, BuildingMaxCell);
+				if (CellX != FMath::Max(BuildingMinCell.X, MinCell.X) || CellY != FMath::Max(BuildingMinCell.Y, MinCell.Y))
+				{
+					continue;
+				}
+
+				Visitor(BuildingIndex, Building);
+			}
+		}
+	}
+}
+
+
+int32 FStreetMapBuildingIndex::FindBuildingAt(TArrayView<const FStreetMapBuilding> Buildings, const FVector2D& Location) const
+{
+	int32 FoundBuildingIndex = INDEX_NONE;
+	ForEachBuildingOverlapping(Buildings, FBox2D(Location, Location), [&FoundBuildingIndex, &Location](const int32 BuildingIndex, const FStreetMapBuilding& Building)
+	{
+		if (FoundBuildingIndex == INDEX_NONE && FPolygonTools::IsPointInsidePolygon(Building.BuildingPoints, Location))
+		{
+			FoundBuildingIndex = BuildingIndex;
+		}
+	});
+	return FoundBuildingIndex;
+}
+
+
+void FStreetMapBuildingIndex::FindBuildingsInCircle(TArrayView<const FStreetMapBuilding> Buildings, const FVector2D& Center, const double Radius, TArray<int32>& OutBuildingIndices) const
+{
+	const double RadiusSquared = Radius * Radius;
+	const FBox2D CircleBounds(Center - FVector2D(Radius), Center + FVector2D(Radius));
+	ForEachBuildingOverlapping(Buildings, CircleBounds, [&](const int32 BuildingIndex, const FStreetMapBuilding& Building)
+	{
+		// The bounds are cheap to reject against before looking at the footprint
+		const FBox2D BuildingBounds(Building.BoundsMin, Building.BoundsMax);
+		if (BuildingBounds.ComputeSquaredDistanceToPoint(Center) <= RadiusSquared &&
+			FPolygonTools::DoesPolygonIntersectCircle(Building.BuildingPoints, Center, Radius))
+		{
+			OutBuildingIndices.Add(BuildingIndex);
+		}
+	});
+}
+
+
+void FStreetMapBuildingIndex::FindBuildingsInBox(TArrayView<const FStreetMapBuilding> Buildings, const FBox2D& Box, TArray<int32>& OutBuildingIndices) const
+{
+	ForEachBuildingOverlapping(Buildings, Box, [&](const int32 BuildingIndex, const FStreetMapBuilding& Building)
+	{
+		if (FPolygonTools::DoesPolygonIntersectBox(Building.BuildingPoints, Box))
+		{
+			OutBuildingIndices.Add(BuildingIndex);
+		}
+	});
+}
+
+
+void FStreetMapBuildingIndex::FindNearestBuildings(TArrayView<const FStreetMapBuilding> Buildings, const FVector2D& Location, const int32 MaxCount, const double MaxDistance, TFunctionRef<bool(int32 BuildingIndex)> BuildingFilter, TArray<FStreetMapNearestItem>& OutBuildings) const
+{
+	OutBuildings.Reset();
+	if (MaxCount <= 0 || CellCount.X == 0 || CellCount.Y == 0)
+	{
+		return;
+	}
+
+	// The best buildings so far, as a heap with the farthest on top, so it can be replaced when a nearer one turns up.
+	// Distances are squared until the end.
+	const auto IsFarther = [](const FStreetMapNearestItem& A, const FStreetMapNearestItem& B)
+	{
+		return A.Distance > B.Distance;
+	};
+	const double MaxDistanceSquared = MaxDistance * MaxDistance;
+	const auto GetSearchDistanceSquared = [&]()
+	{
+		return OutBuildings.Num() < MaxCount ? MaxDistanceSquared : OutBuildings.HeapTop().Distance;
+	};
+
+	// Buildings are listed in every cell their bounds touch, so remember which ones were already looked at
+	VisitedBuildings.Begin(Buildings.Num());
+	const auto VisitCell = [&](const int32 CellX, const int32 CellY)
+	{
+		const int32 CellIndex = CellY * CellCount.X + CellX;
+		for (int32 EntryIndex = CellOffsets[CellIndex]; EntryIndex < CellOffsets[CellIndex + 1]; ++EntryIndex)
+		{
+			const int32 BuildingIndex = CellBuildings[EntryIndex];
+			if (!Buildings.IsValidIndex(BuildingIndex) || !VisitedBuildings.Visit(BuildingIndex) || !BuildingFilter(BuildingIndex))
+			{
+				continue;
+			}
+
+			// The bounds are cheap to reject against before looking at the footprint
+			const FStreetMapBuilding& Building = Buildings[BuildingIndex];
+			const double SearchDistanceSquared = GetSearchDistanceSquared();
+			if (FBox2D(Building.BoundsMin, Building.BoundsMax).ComputeSquaredDistanceToPoint(Location) >= SearchDistanceSquared)
+			{
+				continue;
+			}
+			const double DistanceSquared = FPolygonTools::DistanceSquaredToPolygon(Building.BuildingPoints, Location);
+			if (DistanceSquared >= SearchDistanceSquared)
+			{
+				continue;
+			}
+
+			if (OutBuildings.Num() == MaxCount)
+			{
+				FStreetMapNearestItem Farthest;
+				OutBuildings.HeapPop(Farthest, IsFarther, EAllowShrinking::No);
+			}
+			OutBuildings.HeapPush({ BuildingIndex, DistanceSquared }, IsFarther);
+		}
+	};
+
+	// Rings of cells around the cell nearest to the location, one cell wider each time
+	const FVector2D LocalLocation = (Location - Origin) / CellSize;
+	const FIntPoint CenterCell(
+		FMath::Clamp((int32)FMath::FloorToDouble(LocalLocation.X), 0, CellCount.X - 1),
+		FMath::Clamp((int32)FMath::FloorToDouble(LocalLocation.Y), 0, CellCount.Y - 1));
+	for (int32 Ring = 0; ; ++Ring)
+	{
+		// Everything not searched yet lies outside the block of cells searched so far.  Sides of the block that reached the
+		// edge of the grid have nothing beyond them.
+		double RingDistance = 0.0;
+		if (Ring > 0)
+		{
+			const int32 Searched = Ring - 1;
+			RingDistance = MAX_dbl;
+			if (CenterCell.X - Searched > 0)
+			{
+				RingDistance = FMath::Min(RingDistance, Location.X - (Origin.X + (CenterCell.X - Searched) * CellSize));
+			}
+			if (CenterCell.X + Searched < CellCount.X - 1)
+			{
+				RingDistance = FMath::Min(RingDistance, Origin.X + (CenterCell.X + Searched + 1) * CellSize - Location.X);
+			}
+			if (CenterCell.Y - Searched > 0)
+			{
+				RingDistance = FMath::Min(RingDistance, Location.Y - (Origin.Y + (CenterCell.Y - Searched) * CellSize));
+			}
+			if (CenterCell.Y + Searched < CellCount.Y - 1)
+			{
+				RingDistance = FMath::Min(RingDistance, Origin.Y + (CenterCell.Y + Searched + 1) * CellSize - Location.Y);
+			}
+			if (RingDistance == MAX_dbl)
+			{
+				// The whole grid has been searched
+				break;
+			}
+			RingDistance = FMath::Max(RingDistance, 0.0);
+		}
+		if (RingDistance * RingDistance >= GetSearchDistanceSquared())
+		{
+			break;
+		}
+
+		const int32 MinX = CenterCell.X - Ring;
+		const int32 MaxX = CenterCell.X + Ring;
+		const int32 MinY = CenterCell.Y - Ring;
+		const int32 MaxY = CenterCell.Y + Ring;
+		const int32 ClampedMinX = FMath::Max(MinX, 0);
+		const int32 ClampedMaxX = FMath::Min(MaxX, CellCount.X - 1);
+		for (int32 CellY = FMath::Max(MinY, 0); CellY <= FMath::Min(MaxY, CellCount.Y - 1); ++CellY)
+		{
+			if (CellY == MinY || CellY == MaxY)
+			{
+				// Top and bottom rows of the ring
+				for (int32 CellX = ClampedMinX; CellX <= ClampedMaxX; ++CellX)
+				{
+					VisitCell(CellX, CellY);
+				}
+			}
+			else
+			{
+				// Left and right columns of the ring
+				if (MinX >= 0)
+				{
+					VisitCell(MinX, CellY);
+				}
+				if (MaxX < CellCount.X && MaxX != MinX)
+				{
+					VisitCell(MaxX, CellY);
+				}
+			}
+		}
+	}
+
+	OutBuildings.Sort([](const FStreetMapNearestItem& A, const FStreetMapNearestItem& B)
+	{
+		return A.Distance < B.Distance;
+	});
+	for (FStreetMapNearestItem& Building : OutBuildings)
+	{
+		Building.Distance = FMath::Sqrt(Building.Distance);
+	}
+}
+
+
+void FStreetMapBuildingIndex::FindBuildingsInVolume(TArrayView<const FStreetMapBuilding> Buildings, const FStreetMapQueryVolume& Volume, const double LevelHeight, TArray<int32>& OutBuildingIndices) const
+{
+	if (Volume.IsEmpty())
+	{
+		return;
+	}
+
+	const FBox& VolumeBounds = Volume.GetBounds();
+	const FBox2D VolumeBounds2D(FVector2D(VolumeBounds.Min), FVector2D(VolumeBounds.Max));
+	ForEachBuildingOverlapping(Buildings, VolumeBounds2D, [&](const int32 BuildingIndex, const FStreetMapBuilding& Building)
+	{
+		const FBox BuildingBounds(FVector(Building.BoundsMin, 0.0), FVector(Building.BoundsMax, FMath::Max(GetBuildingHeight(Building, LevelHeight), 0.0)));
+		if (Volume.IntersectsBox(BuildingBounds))
+		{
+			OutBuildingIndices.Add(BuildingIndex);
+		}
+	});
+}
+
+
+bool FStreetMapBuildingIndex::LineTrace(TArrayView<const FStreetMapBuilding> Buildings, const FVector& Start, const FVector& End, const double LevelHeight, const double MaxTime, FStreetMapBuildingHit& OutHit) const
+{
+	using namespace StreetMapSpatialIndex;
+
+	OutHit = FStreetMapBuildingHit();
+	if (CellCount.X == 0 || CellCount.Y == 0)
+	{
+		return false;
+	}
+
+	// Clip the segment's shadow on the ground to the grid
+	const FVector Delta = End - Start;
+	const FVector2D Start2D(Start);
+	const FVector2D Delta2D(Delta);
+	const FVector2D GridMax = Origin + FVector2D(CellCount) * CellSize;
+	double EnterTime = 0.0;
+	double ExitTime = FMath::Min(MaxTime, 1.0);
+	for (int32 Axis = 0; Axis < 2 && EnterTime <= ExitTime; ++Axis)
+	{
+		if (Delta2D[Axis] == 0.0)
+		{
+			if (Start2D[Axis] < Origin[Axis] || Start2D[Axis] > GridMax[Axis])
+			{
+				return false;
+			}
+		}
+		else
+		{
+			const double TimeA = (Origin[Axis] - Start2D[Axis]) / Delta2D[Axis];
+			const double TimeB = (GridMax[Axis] - Start2D[Axis]) / Delta2D[Axis];
+			EnterTime = FMath::Max(EnterTime, FMath::Min(TimeA, TimeB));
+			ExitTime = FMath::Min(ExitTime, FMath::Max(TimeA, TimeB));
+		}
+	}
+	if (EnterTime > ExitTime)
+	{
+		return false;
+	}
+
+	// Walk the cells under the segment in order (Amanatides and Woo), stopping once the next cell starts beyond the best hit
+	const FVector2D EnterLocation = (Start2D + Delta2D * EnterTime - Origin) / CellSize;
+	const int32 CellCounts[2] = { CellCount.X, CellCount.Y };
+	int32 Cell[2] = {
+		FMath::Clamp((int32)FMath::FloorToDouble(EnterLocation.X), 0, CellCount.X - 1),
+		FMath::Clamp((int32)FMath::FloorToDouble(EnterLocation.Y), 0, CellCount.Y - 1) };
+
+	int32 Step[2];
+	FVector2D NextCrossingTime;
+	FVector2D CellCrossingTime;
+	for (int32 Axis = 0; Axis < 2; ++Axis)
+	{
+		if (Delta2D[Axis] == 0.0)
+		{
+			Step[Axis] = 0;
+			NextCrossingTime[Axis] = MAX_dbl;
+			CellCrossingTime[Axis] = MAX_dbl;
+		}
+		else
+		{
+			Step[Axis] = Delta2D[Axis] > 0.0 ? 1 : -1;
+			const double Boundary = Origin[Axis] + (Cell[Axis] + (Step[Axis] > 0 ? 1 : 0)) * CellSize;
+			NextCrossingTime[Axis] = (Boundary - Start2D[Axis]) / Delta2D[Axis];
+			CellCrossingTime[Axis] = CellSize / FMath::Abs(Delta2D[Axis]);
+		}
+	}
+
+	// Buildings are listed in every cell their bounds touch, so remember which ones were already traced
+	FVisitStamps& TracedBuildings = VisitedBuildings;
+	TracedBuildings.Begin(Buildings.Num());
+	double BestTime = ExitTime;
+	double CellEnterTime = EnterTime;
+	while (CellEnterTime <= BestTime)
+	{
+		const int32 CellIndex = Cell[1] * CellCount.X + Cell[0];
+		for (int32 EntryIndex = CellOffsets[CellIndex]; EntryIndex < CellOffsets[CellIndex + 1]; ++EntryIndex)
+		{
+			const int32 BuildingIndex = CellBuildings[EntryIndex];
+			if (!Buildings.IsValidIndex(BuildingIndex) || !TracedBuildings.Visit(BuildingIndex))
+			{
+				continue;
+			}
+
+			const FStreetMapBuilding& Building = Buildings[BuildingIndex];
+			double Time = BestTime;
+			if (IntersectExtrudedPolygon(Building.BuildingPoints, GetBuildingHeight(Building, LevelHeight), Start, Delta, Time, OutHit))
+			{
+				BestTime = Time;
+				OutHit.BuildingIndex = BuildingIndex;
+			}
+		}
+
+		// On to the neighboring cell the segment crosses into first
+		const int32 Axis = NextCrossingTime.X < NextCrossingTime.Y ? 0 : 1;
+		CellEnterTime = NextCrossingTime[Axis];
+		Cell[Axis] += Step[Axis];
+		NextCrossingTime[Axis] += CellCrossingTime[Axis];
+		if (Step[Axis] == 0 || Cell[Axis] < 0 || Cell[Axis] >= CellCounts[Axis])
+		{
+			break;
+		}
+	}
+
+	if (!OutHit.IsValid())
+	{
+		return false;
+	}
+
+	OutHit.Time = (float)BestTime;
+	OutHit.Location = Start + Delta * BestTime;
+	OutHit.Distance = (float)(Delta.Size() * BestTime);
+	return true;
+}
+
+
+FArchive& operator<<(FArchive& Ar, FStreetMapBuildingIndex& Index)
+{
+	Ar << Index.Origin << Index.CellSize << Index.CellCount;
+	Index.CellOffsets.BulkSerialize(Ar);
+	Index.CellBuildings.BulkSerialize(Ar);
+	return Ar;
+}
@@ -0,0 +1,37 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetMapStats.h"
+
+DEFINE_STAT(STAT_StreetMap_LoadOSMFile);
+DEFINE_STAT(STAT_StreetMap_ConvertOSMFile);
+DEFINE_STAT(STAT_StreetMap_BuildDerivedData);
+DEFINE_STAT(STAT_StreetMap_PublishSnapshot);
+DEFINE_STAT(STAT_StreetMap_LoadOrGenerateMesh);
+DEFINE_STAT(STAT_StreetMap_GenerateMesh);
+DEFINE_STAT(STAT_StreetMap_GenerateCollision);
+DEFINE_STAT(STAT_StreetMap_GetPhysicsTriMeshData);
+DEFINE_STAT(STAT_StreetMap_CreateSceneProxy);
+DEFINE_STAT(STAT_StreetMap_FindNearestRoadPoint);
+DEFINE_STAT(STAT_StreetMap_FindNearestRoadLocation);
+DEFINE_STAT(STAT_StreetMap_FindBuildingsInRadius);
+DEFINE_STAT(STAT_StreetMap_FindBuildingAtLocation);
+DEFINE_STAT(STAT_StreetMap_FindBuildingsInBox);
+DEFINE_STAT(STAT_StreetMap_FindNearestRoads);
+DEFINE_STAT(STAT_StreetMap_FindNearestNodes);
+DEFINE_STAT(STAT_StreetMap_FindNearestBuildings);
+DEFINE_STAT(STAT_StreetMap_FindFeaturesInVolume);
+DEFINE_STAT(STAT_StreetMap_LineTraceBuildings);
+DEFINE_STAT(STAT_StreetMap_FindFeaturesByName);
+DEFINE_STAT(STAT_StreetMap_FindNearestRoadPoints);
+DEFINE_STAT(STAT_StreetMap_FindNearestRoadLocations);
+DEFINE_STAT(STAT_StreetMap_FindBuildingsAtLocations);
+DEFINE_STAT(STAT_StreetMap_FindBuildingsInRadiusBatch);
+DEFINE_STAT(STAT_StreetMap_LineTraceBuildingsBatch);
+DEFINE_STAT(STAT_StreetMap_MatchTraces);
+
+DEFINE_STAT(STAT_StreetMap_MeshMemory);
+DEFINE_STAT(STAT_StreetMap_RenderBufferMemory);
+DEFINE_STAT(STAT_StreetMap_ProxyVertices);
+DEFINE_STAT(STAT_StreetMap_ProxyTriangles);
+
+UE_TRACE_CHANNEL_DEFINE(StreetMapChannel);
@@ -3,8 +3,530 @@
 #include "StreetMapSubsystem.h"
 #include "StreetMap.h"
 #include "StreetMapComponent.h"
+#include "StreetMapSnapshot.h"
+#include "StreetMapDerivedData.h"
+#include "StreetMapStats.h"
+#include "StreetMapQueryLatentAction.h"
 #include "Engine/World.h"
 #include "Engine/Engine.h"
+#include "ConvexVolume.h"
+#include "SceneManagement.h"
+#include "Kismet/GameplayStatics.h"
+#include "Algo/StableSort.h"
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeLock.h"
+#include "Tasks/Task.h"
+#include "UObject/GarbageCollection.h"
+
+namespace StreetMapSubsystem
+{
+	/** Nearest road queries without a maximum distance only look this far, in map units (1km) */
+	static constexpr double DefaultMaxSearchDistance = 100000.0;
+
+	/** Volume queries look this far above a street map for buildings, in map units (10km) */
+	static constexpr double MaxVolumeQueryHeight = 1000000.0;
+
+	/** Batched queries are run in chunks of this many queries, one chunk per worker task */
+	static constexpr int32 BatchChunkSize = 256;
+
+	static double GetMaxSearchDistance(const float MaxSearchDistance)
+	{
+		return MaxSearchDistance > 0.0f ? (double)MaxSearchDistance : DefaultMaxSearchDistance;
+	}
+
+	/** Runs Function over [0, Num) in chunks, in parallel when there are enough queries to be worth it */
+	template<typename FunctionType>
+	static void ForEachChunk(const int32 Num, FunctionType&& Function)
+	{
+		const int32 NumChunks = FMath::DivideAndRoundUp(Num, BatchChunkSize);
+		ParallelFor(NumChunks, [Num, &Function](const int32 ChunkIndex)
+		{
+			const int32 Begin = ChunkIndex * BatchChunkSize;
+			Function(Begin, FMath::Min(Begin + BatchChunkSize, Num));
+		}, NumChunks <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+	}
+
+	/** Scratch space for one worker running batched building queries */
+	struct FBuildingQueryScratch
+	{
+		/** Buildings found by this worker, one chunk after another */
+		TArray<FStreetMapBuildingRef> Buildings;
+
+		/** Building indices found in one street map, before they are turned into references */
+		TArray<int32> BuildingIndices;
+
+		/** First query of each chunk this worker ran, and where that chunk's buildings start in Buildings */
+		TArray<TPair<int32, int32>> Chunks;
+
+		void Reset()
+		{
+			Buildings.Reset();
+			Chunks.Reset();
+		}
+	};
+
+	template<typename TargetType>
+	static FStreetMapBuildingRef MakeBuildingRef(const TargetType& Target, const int32 BuildingIndex)
+	{
+		FStreetMapBuildingRef Building;
+		Building.BuildingIndex = BuildingIndex;
+		Building.StreetMap = Target.StreetMap;
+		Building.Component = Target.Component;
+		return Building;
+	}
+
+	/**
+	 * Finds the nearest road location on any of the targets.  Each street map is searched only as far as the best
+	 * location found so far, and street maps whose bounds are farther than that are skipped.
+	 */
+	template<typename TargetType>
+	static bool FindNearestRoadLocation(TArrayView<const TargetType> Targets, const FVector& WorldLocation, const double MaxDistance, FStreetMapRoadLocation& OutRoadLocation)
+	{
+		OutRoadLocation = FStreetMapRoadLocation();
+
+		double BestDistance = MaxDistance;
+		for (const TargetType& Target : Targets)
+		{
+			const FVector2D MapLocation = Target.WorldToMap(WorldLocation);
+			if (Target.GetWorldDistanceToBounds(MapLocation) >= BestDistance)
+			{
+				continue;
+			}
+
+			FStreetMapRoadLocation RoadLocation;
+			if (Target.DerivedData->GetRoadSegmentIndex().FindNearestLocation(Target.Snapshot->GetRoads(), MapLocation, BestDistance * Target.WorldToMapScale, RoadLocation))
+			{
+				BestDistance = FVector2D::Distance(MapLocation, RoadLocation.Location) / Target.WorldToMapScale;
+				OutRoadLocation = RoadLocation;
+				OutRoadLocation.Distance = (float)BestDistance;
+				OutRoadLocation.WorldLocation = Target.MapToWorldLocation(RoadLocation.Location);
+				OutRoadLocation.StreetMap = Target.StreetMap;
+				OutRoadLocation.Component = Target.Component;
+			}
+		}
+		return OutRoadLocation.IsValid();
+	}
+
+	/** Finds the nearest road point on any of the targets, skipping street maps the same way FindNearestRoadLocation() does */
+	template<typename TargetType>
+	static bool FindNearestRoadPoint(TArrayView<const TargetType> Targets, const FVector& WorldLocation, const double MaxDistance, FStreetMapRoadPointRef& OutRoadPoint)
+	{
+		OutRoadPoint = FStreetMapRoadPointRef();
+
+		double BestDistance = MaxDistance;
+		for (const TargetType& Target : Targets)
+		{
+			const FVector2D MapLocation = Target.WorldToMap(WorldLocation);
+			if (Target.GetWorldDistanceToBounds(MapLocation) >= BestDistance)
+			{
+				continue;
+			}
+
+			const TArray<FStreetMapRoad>& Roads = Target.Snapshot->GetRoads();
+			int32 RoadIndex, PointIndex;
+			if (Target.DerivedData->GetRoadSegmentIndex().FindNearestPoint(Roads, MapLocation, BestDistance * Target.WorldToMapScale, RoadIndex, PointIndex))
+			{
+				const FVector2D& RoadPoint = Roads[RoadIndex].RoadPoints[PointIndex];
+				BestDistance = FVector2D::Distance(MapLocation, RoadPoint) / Target.WorldToMapScale;
+				OutRoadPoint.RoadIndex = RoadIndex;
+				OutRoadPoint.PointIndex = PointIndex;
+				OutRoadPoint.StreetMap = Target.StreetMap;
+				OutRoadPoint.Component = Target.Component;
+				OutRoadPoint.WorldLocation = Target.MapToWorldLocation(RoadPoint);
+				OutRoadPoint.Distance = BestDistance;
+			}
+		}
+		return OutRoadPoint.IsValid();
+	}
+
+	/** Finds the building containing a location on any of the targets */
+	template<typename TargetType>
+	static FStreetMapBuildingRef FindBuildingAtLocation(TArrayView<const TargetType> Targets, const FVector& WorldLocation)
+	{
+		for (const TargetType& Target : Targets)
+		{
+			const FVector2D MapLocation = Target.WorldToMap(WorldLocation);
+			if (Target.MapBounds.IsInsideOrOn(MapLocation))
+			{
+				const int32 BuildingIndex = Target.DerivedData->GetBuildingIndex().FindBuildingAt(Target.Snapshot->GetBuildings(), MapLocation);
+				if (BuildingIndex != INDEX_NONE)
+				{
+					return MakeBuildingRef(Target, BuildingIndex);
+				}
+			}
+		}
+		return FStreetMapBuildingRef();
+	}
+
+	/** Adds the buildings within a radius on all of the targets to OutBuildings.  ScratchIndices is working space. */
+	template<typename TargetType, typename AllocatorType>
+	static void FindBuildingsInRadius(TArrayView<const TargetType> Targets, const FVector& WorldLocation, const double Radius, TArray<int32>& ScratchIndices, TArray<FStreetMapBuildingRef, AllocatorType>& OutBuildings)
+	{
+		for (const TargetType& Target : Targets)
+		{
+			const FVector2D MapLocation = Target.WorldToMap(WorldLocation);
+			if (Target.GetWorldDistanceToBounds(MapLocation) > Radius)
+			{
+				continue;
+			}
+
+			ScratchIndices.Reset();
+			Target.DerivedData->GetBuildingIndex().FindBuildingsInCircle(Target.Snapshot->GetBuildings(), MapLocation, Radius * Target.WorldToMapScale, ScratchIndices);
+			for (const int32 BuildingIndex : ScratchIndices)
+			{
+				OutBuildings.Add(MakeBuildingRef(Target, BuildingIndex));
+			}
+		}
+	}
+
+	/**
+	 * Adds the buildings overlapping a box on all of the targets to OutBuildings.  The box is tested in each map's space as
+	 * the bounds of its corners.  ScratchIndices is working space.
+	 */
+	template<typename TargetType>
+	static void FindBuildingsInBox(TArrayView<const TargetType> Targets, const FBox& WorldBox, TArray<int32>& ScratchIndices, TArray<FStreetMapBuildingRef>& OutBuildings)
+	{
+		const double CenterZ = WorldBox.GetCenter().Z;
+		for (const TargetType& Target : Targets)
+		{
+			FBox2D MapBox(ForceInit);
+			MapBox += Target.WorldToMap(FVector(WorldBox.Min.X, WorldBox.Min.Y, CenterZ));
+			MapBox += Target.WorldToMap(FVector(WorldBox.Max.X, WorldBox.Min.Y, CenterZ));
+			MapBox += Target.WorldToMap(FVector(WorldBox.Min.X, WorldBox.Max.Y, CenterZ));
+			MapBox += Target.WorldToMap(FVector(WorldBox.Max.X, WorldBox.Max.Y, CenterZ));
+			if (!MapBox.Intersect(Target.MapBounds))
+			{
+				continue;
+			}
+
+			ScratchIndices.Reset();
+			Target.DerivedData->GetBuildingIndex().FindBuildingsInBox(Target.Snapshot->GetBuildings(), MapBox, ScratchIndices);
+			for (const int32 BuildingIndex : ScratchIndices)
+			{
+				OutBuildings.Add(MakeBuildingRef(Target, BuildingIndex));
+			}
+		}
+	}
+
+	/** Finds the first building hit by a segment on any of the targets.  Each street map only searches up to the best hit so far. */
+	template<typename TargetType>
+	static bool LineTraceBuildings(TArrayView<const TargetType> Targets, const FVector& WorldStart, const FVector& WorldEnd, FStreetMapBuildingHit& OutHit)
+	{
+		OutHit = FStreetMapBuildingHit();
+
+		// Times along the segment are the same in every street map's space, so hits on different maps compare directly
+		double BestTime = 1.0;
+		for (const TargetType& Target : Targets)
+		{
+			const FVector MapStart = Target.MapToWorld.InverseTransformPosition(WorldStart);
+			const FVector MapEnd = Target.MapToWorld.InverseTransformPosition(WorldEnd);
+			FBox2D SegmentBounds(ForceInit);
+			SegmentBounds += FVector2D(MapStart);
+			SegmentBounds += FVector2D(MapEnd);
+			if (!SegmentBounds.Intersect(Target.MapBounds))
+			{
+				continue;
+			}
+
+			FStreetMapBuildingHit Hit;
+			if (Target.DerivedData->GetBuildingIndex().LineTrace(Target.Snapshot->GetBuildings(), MapStart, MapEnd, Target.BuildingLevelHeight, BestTime, Hit))
+			{
+				BestTime = Hit.Time;
+				OutHit = Hit;
+				OutHit.Location = Target.MapToWorld.TransformPosition(Hit.Location);
+				// Normals transform by the inverse transpose, which for a transform is its rotation with the scale inverted
+				const FVector InverseScale = FTransform::GetSafeScaleReciprocal(Target.MapToWorld.GetScale3D());
+				OutHit.Normal = Target.MapToWorld.TransformVectorNoScale(Hit.Normal * InverseScale).GetSafeNormal();
+				OutHit.StreetMap = Target.StreetMap;
+				OutHit.Component = Target.Component;
+			}
+		}
+
+		if (!OutHit.IsValid())
+		{
+			return false;
+		}
+		OutHit.Distance = (float)(FVector::Distance(WorldStart, WorldEnd) * BestTime);
+		return true;
+	}
+
+	/** Scratch space for one worker matching traces */
+	struct FMapMatchScratch
+	{
+		FStreetMapMapMatcher::FScratch Matcher;
+
+		/** The samples of the trace being matched, in map space */
+		TArray<FVector2D> MapSamples;
+
+		/** Nothing carries over from one trace to the next, so there is nothing to reset between calls */
+		void Reset()
+		{
+		}
+	};
+
+	/**
+	 * Sets of per worker scratch space kept between batched queries.  A call takes a set for as long as it runs, so
+	 * concurrent calls never share one, and gives it back so the next call reuses what it allocated.
+	 */
+	template<typename ScratchType>
+	class TScratchPool
+	{
+	public:
+		/** A set taken from a pool, with reset scratch space for NumContexts workers.  Goes back to the pool when it goes out of scope. */
+		class FScopedSet
+		{
+		public:
+			FScopedSet(TScratchPool& InPool, const int32 NumContexts)
+				: Pool(InPool)
+				, Set(InPool.Take())
+			{
+				if (Set->Num() < NumContexts)
+				{
+					Set->SetNum(NumContexts);
+				}
+				Contexts = MakeArrayView(Set->GetData(), NumContexts);
+				for (ScratchType& Scratch : Contexts)
+				{
+					Scratch.Reset();
+				}
+			}
+
+			~FScopedSet()
+			{
+				Pool.Give(MoveTemp(Set));
+			}
+
+			TArrayView<ScratchType> GetContexts() const
+			{
+				return Contexts;
+			}
+
+		private:
+			TScratchPool& Pool;
+			TUniquePtr<TArray<ScratchType>> Set;
+			TArrayView<ScratchType> Contexts;
+		};
+
+	private:
+		TUniquePtr<TArray<ScratchType>> Take()
+		{
+			FScopeLock Lock(&CriticalSection);
+			return Sets.Num() > 0 ? Sets.Pop(EAllowShrinking::No) : MakeUnique<TArray<ScratchType>>();
+		}
+
+		void Give(TUniquePtr<TArray<ScratchType>>&& Set)
+		{
+			FScopeLock Lock(&CriticalSection);
+			Sets.Add(MoveTemp(Set));
+		}
+
+		FCriticalSection CriticalSection;
+
+		/** Sets no call is using.  There are as many as there have ever been calls running at once. */
+		TArray<TUniquePtr<TArray<ScratchType>>> Sets;
+	};
+
+	/**
+	 * Matches a trace onto the target whose bounds hold most of its samples, with that target's matcher.  Matches get
+	 * world space locations, and their distances are converted to world units.
+	 */
+	template<typename TargetType>
+	static void MatchTrace(TArrayView<const TargetType> Targets, TArrayView<const FStreetMapMapMatcher> Matchers, TArrayView<const FVector> WorldLocations, TArrayView<FStreetMapRoadLocation> OutRoadLocations, FMapMatchScratch& Scratch)
+	{
+		int32 BestTargetIndex = INDEX_NONE;
+		int32 BestSampleCount = 0;
+		for (int32 TargetIndex = 0; TargetIndex < Targets.Num(); ++TargetIndex)
+		{
+			int32 SampleCount = 0;
+			for (const FVector& WorldLocation : WorldLocations)
+			{
+				SampleCount += Targets[TargetIndex].MapBounds.IsInsideOrOn(Targets[TargetIndex].WorldToMap(WorldLocation)) ? 1 : 0;
+			}
+			if (SampleCount > BestSampleCount)
+			{
+				BestTargetIndex = TargetIndex;
+				BestSampleCount = SampleCount;
+			}
+		}
+
+		if (BestTargetIndex == INDEX_NONE)
+		{
+			for (FStreetMapRoadLocation& RoadLocation : OutRoadLocations)
+			{
+				RoadLocation = FStreetMapRoadLocation();
+			}
+			return;
+		}
+
+		const TargetType& Target = Targets[BestTargetIndex];
+		Scratch.MapSamples.Reset(WorldLocations.Num());
+		for (const FVector& WorldLocation : WorldLocations)
+		{
+			Scratch.MapSamples.Add(Target.WorldToMap(WorldLocation));
+		}
+
+		Matchers[BestTargetIndex].MatchTrace(Scratch.MapSamples, OutRoadLocations, Scratch.Matcher);
+		for (FStreetMapRoadLocation& RoadLocation : OutRoadLocations)
+		{
+			if (RoadLocation.IsValid())
+			{
+				RoadLocation.Distance = (float)(RoadLocation.Distance / Target.WorldToMapScale);
+				RoadLocation.WorldLocation = Target.MapToWorldLocation(RoadLocation.Location);
+				RoadLocation.StreetMap = Target.StreetMap;
+				RoadLocation.Component = Target.Component;
+			}
+		}
+	}
+
+	/**
+	 * Sorts results gathered from several street maps nearest first, and keeps the nearest Count of them.  Once there are
+	 * that many, InOutMaxDistance shrinks to the farthest one, so the remaining street maps aren't searched as far.
+	 */
+	template<typename ResultType>
+	static void KeepNearest(TArray<ResultType>& Results, const int32 Count, double& InOutMaxDistance)
+	{
+		Results.StableSort([](const ResultType& A, const ResultType& B)
+		{
+			return A.Distance < B.Distance;
+		});
+		if (Results.Num() >= Count)
+		{
+			Results.SetNum(Count, EAllowShrinking::No);
+			InOutMaxDistance = Results.Last().Distance;
+		}
+	}
+
+	/** A street map or component a query read, and a weak pointer to find out later whether it still exists */
+	using FQueriedObject = TPair<const UObject*, FWeakObjectPtr>;
+
+	/**
+	 * Gets the snapshot and derived data of every street map in Sources that still exists.  Safe to call on any thread.
+	 * Derived data that isn't there yet is built, which can take a while for large maps.
+	 */
+	template<typename SourceType, typename TargetsType>
+	static void ResolveQueryTargets(TArrayView<const SourceType> Sources, TargetsType& OutTargets, TArray<FQueriedObject>* OutQueriedObjects = nullptr)
+	{
+		{
+			// Other threads can only look at street maps while garbage collection is held off
+			TOptional<FGCScopeGuard> GCGuard;
+			if (!IsInGameThread())
+			{
+				GCGuard.Emplace();
+			}
+
+			OutTargets.Reset(Sources.Num());
+			for (const SourceType& Source : Sources)
+			{
+				UStreetMap* StreetMap = Source.StreetMap.Get();
+				UStreetMapComponent* Component = Source.Component.Get();
+				if (StreetMap == nullptr || (Component == nullptr && !Source.Component.IsExplicitlyNull()))
+				{
+					continue;
+				}
+
+				if (OutQueriedObjects != nullptr)
+				{
+					OutQueriedObjects->Emplace(StreetMap, Source.StreetMap);
+					if (Component != nullptr)
+					{
+						OutQueriedObjects->Emplace(Component, Source.Component);
+					}
+				}
+
+				auto& Target = OutTargets.AddDefaulted_GetRef();
+				Target.StreetMap = StreetMap;
+				Target.Component = Component;
+				Target.Snapshot = StreetMap->GetSnapshot();
+				Target.MapToWorld = Source.MapToWorld;
+				Target.WorldToMapScale = 1.0 / FMath::Max(Source.MapToWorld.GetMaximumAxisScale(), UE_DOUBLE_SMALL_NUMBER);
+				Target.MapBounds = FBox2D(Target.Snapshot->GetBoundsMin(), Target.Snapshot->GetBoundsMax());
+				Target.BuildingLevelHeight = Source.BuildingLevelHeight;
+			}
+		}
+
+		// Derived data comes from the same snapshot as the roads, nodes and buildings its indices refer to.  Snapshots
+		// don't need the street map, so this doesn't hold off garbage collection while it builds.
+		for (auto& Target : OutTargets)
+		{
+			Target.DerivedData = Target.Snapshot->GetDerivedData();
+		}
+	}
+
+	/** Whether a result refers to a street map or component that was destroyed while an asynchronous query ran */
+	static bool IsUnloaded(const UStreetMap* StreetMap, const UStreetMapComponent* Component, TArrayView<const UObject* const> UnloadedObjects)
+	{
+		return UnloadedObjects.Contains(StreetMap) || (Component != nullptr && UnloadedObjects.Contains(Component));
+	}
+
+	static void ForgetUnloaded(FStreetMapRoadLocation& Result, TArrayView<const UObject* const> UnloadedObjects)
+	{
+		if (IsUnloaded(Result.StreetMap.Get(), Result.Component.Get(), UnloadedObjects))
+		{
+			Result = FStreetMapRoadLocation();
+		}
+	}
+
+	static void ForgetUnloaded(FStreetMapBuildingRef& Result, TArrayView<const UObject* const> UnloadedObjects)
+	{
+		if (IsUnloaded(Result.StreetMap.Get(), Result.Component.Get(), UnloadedObjects))
+		{
+			Result = FStreetMapBuildingRef();
+		}
+	}
+
+	static void ForgetUnloaded(TArray<FStreetMapBuildingRef>& Result, TArrayView<const UObject* const> UnloadedObjects)
+	{
+		Result.RemoveAll([UnloadedObjects](const FStreetMapBuildingRef& Building)
+		{
+			return IsUnloaded(Building.StreetMap.Get(), Building.Component.Get(), UnloadedObjects);
+		});
+	}
+
+	/**
+	 * Runs Query(Targets) on a worker thread, and fulfills the returned future with its result there too.  The calling
+	 * thread only hands over which street maps to search and where they are.  The task gets their snapshots and derived
+	 * data itself, so the query reads the street maps as they are when it starts, and the calling thread never waits for
+	 * derived data to be built.
+	 */
+	template<typename ResultType, typename TargetsType, typename SourcesType, typename QueryType>
+	static TFuture<ResultType> RunQueryAsync(SourcesType&& Sources, QueryType&& Query)
+	{
+		TSharedRef<TPromise<ResultType>, ESPMode::ThreadSafe> Promise = MakeShared<TPromise<ResultType>, ESPMode::ThreadSafe>();
+		TFuture<ResultType> Future = Promise->GetFuture();
+		UE::Tasks::Launch(UE_SOURCE_LOCATION, [Promise, Sources = MoveTemp(Sources), Query = MoveTemp(Query)]() mutable
+		{
+			TargetsType Targets;
+			TArray<FQueriedObject> QueriedObjects;
+			ResolveQueryTargets(MakeConstArrayView(Sources), Targets, &QueriedObjects);
+
+			ResultType Result = Query(MakeConstArrayView(Targets));
+
+			// Results can't be handed out for street maps or components that were destroyed before the query finished
+			{
+				FGCScopeGuard GCGuard;
+
+				TArray<const UObject*, TInlineAllocator<8>> UnloadedObjects;
+				for (const FQueriedObject& QueriedObject : QueriedObjects)
+				{
+					if (!QueriedObject.Value.IsValid())
+					{
+						UnloadedObjects.Add(QueriedObject.Key);
+					}
+				}
+				if (UnloadedObjects.Num() > 0)
+				{
+					ForgetUnloaded(Result, UnloadedObjects);
+				}
+			}
+
+			// Let go of the snapshots here rather than on whichever thread consumes the result
+			Targets.Empty();
+
+			Promise->SetValue(MoveTemp(Result));
+		});
+		return Future;
+	}
+}
 
 UStreetMapSubsystem* UStreetMapSubsystem::Get(const UObject* WorldContextObject)
 {
@@ -18,6 +540,12 @@ UStreetMapSubsystem* UStreetMapSubsystem::Get(const UObject* WorldContextObject)
 	return nullptr;
 }
 
+struct UStreetMapSubsystem::FBatchScratchPool
+{
+	StreetMapSubsystem::TScratchPool<StreetMapSubsystem::FBuildingQueryScratch> BuildingQueries;
+	StreetMapSubsystem::TScratchPool<StreetMapSubsystem::FMapMatchScratch> MapMatches;
+};
+
 void UStreetMapSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
@@ -25,6 +553,7 @@ void UStreetMapSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 	// Initialize any required state
 	RegisteredStreetMaps.Empty();
 	RegisteredComponents.Empty();
+	BatchScratchPool = MakePimpl<FBatchScratchPool>();
 }
 
 void UStreetMapSubsystem::Deinitialize()
@@ -59,6 +588,11 @@ bool UStreetMapSubsystem::RegisterStreetMap(UStreetMap* InStreetMap)
 	}
 
 	RegisteredStreetMaps.Add(InStreetMap);
+
+	// Make the snapshot and derived data now, on the game thread, so queries from other threads only ever have to acquire them
+	InStreetMap->GetSnapshot();
+	InStreetMap->GetDerivedData();
+
 	OnStreetMapRegistered.Broadcast(InStreetMap);
 	
 	return true;
@@ -153,68 +687,689 @@ TArray<UStreetMapComponent*> UStreetMapSubsystem::GetRegisteredComponents() cons
 	return Result;
 }
 
-bool UStreetMapSubsystem::FindNearestRoadPoint(const FVector& WorldLocation, int32& OutRoadIndex, int32& OutPointIndex, float MaxSearchDistance) const
+void UStreetMapSubsystem::GetQueryTargets(FQueryTargets& OutTargets) const
 {
-	OutRoadIndex = INDEX_NONE;
-	OutPointIndex = INDEX_NONE;
+	FQueryTargetSources Sources;
+	GetQueryTargetSources(Sources);
+	StreetMapSubsystem::ResolveQueryTargets(MakeConstArrayView(Sources), OutTargets);
+}
 
-	UStreetMap* StreetMap = GetPrimaryStreetMap();
-	if (!StreetMap)
+void UStreetMapSubsystem::GetQueryTargetSources(FQueryTargetSources& OutSources) const
+{
+	auto AddSource = [&OutSources](UStreetMap* StreetMap, UStreetMapComponent* Component, const FTransform& MapToWorld)
 	{
-		return false;
+		FQueryTargetSource& Source = OutSources.AddDefaulted_GetRef();
+		Source.StreetMap = StreetMap;
+		Source.Component = Component;
+		Source.MapToWorld = MapToWorld;
+		Source.BuildingLevelHeight = Component ? Component->GetMeshBuildSettings().BuildingLevelFloorFactor : FStreetMapMeshBuildSettings().BuildingLevelFloorFactor;
+	};
+
+	for (const TWeakObjectPtr<UStreetMapComponent>& WeakComp : RegisteredComponents)
+	{
+		UStreetMapComponent* Comp = WeakComp.Get();
+		if (UStreetMap* StreetMap = Comp ? Comp->GetStreetMap() : nullptr)
+		{
+			AddSource(StreetMap, Comp, Comp->GetComponentTransform());
+		}
 	}
 
-	const TArray<FStreetMapRoad>& Roads = StreetMap->GetRoads();
-	// Use a reasonable maximum search distance (1km squared) if none specified to avoid performance issues
-	constexpr float DefaultMaxSearchDistanceSquared = 100000.0f * 100000.0f;  // 1km in cm squared
-	float BestDistanceSquared = MaxSearchDistance > 0.0f ? MaxSearchDistance * MaxSearchDistance : DefaultMaxSearchDistanceSquared;
-	FVector2D Location2D(WorldLocation.X, WorldLocation.Y);
+	// Street maps registered on their own sit at the world origin
+	for (const TObjectPtr<UStreetMap>& Map : RegisteredStreetMaps)
+	{
+		if (Map && !OutSources.ContainsByPredicate([&Map](const FQueryTargetSource& Source) { return Source.StreetMap == Map; }))
+		{
+			AddSource(Map, nullptr, FTransform::Identity);
+		}
+	}
+}
 
-	for (int32 RoadIndex = 0; RoadIndex < Roads.Num(); ++RoadIndex)
+bool UStreetMapSubsystem::FindNearestRoadPoint(const FVector& WorldLocation, FStreetMapRoadPointRef& OutRoadPoint, float MaxSearchDistance) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindNearestRoadPoint);
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+	return StreetMapSubsystem::FindNearestRoadPoint(MakeConstArrayView(Targets), WorldLocation, StreetMapSubsystem::GetMaxSearchDistance(MaxSearchDistance), OutRoadPoint);
+}
+
+bool UStreetMapSubsystem::FindNearestRoadLocation(const FVector& WorldLocation, FStreetMapRoadLocation& OutRoadLocation, float MaxSearchDistance) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindNearestRoadLocation);
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+	return StreetMapSubsystem::FindNearestRoadLocation(MakeConstArrayView(Targets), WorldLocation, StreetMapSubsystem::GetMaxSearchDistance(MaxSearchDistance), OutRoadLocation);
+}
+
+TArray<FStreetMapBuildingRef> UStreetMapSubsystem::FindBuildingsInRadius(const FVector& WorldLocation, float Radius) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindBuildingsInRadius);
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+
+	TArray<FStreetMapBuildingRef> Result;
+	TArray<int32> ScratchIndices;
+	StreetMapSubsystem::FindBuildingsInRadius(MakeConstArrayView(Targets), WorldLocation, Radius, ScratchIndices, Result);
+	return Result;
+}
+
+FStreetMapBuildingRef UStreetMapSubsystem::FindBuildingAtLocation(const FVector& WorldLocation) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindBuildingAtLocation);
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+	return StreetMapSubsystem::FindBuildingAtLocation(MakeConstArrayView(Targets), WorldLocation);
+}
+
+TArray<FStreetMapBuildingRef> UStreetMapSubsystem::FindBuildingsInBox(const FBox& WorldBox) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindBuildingsInBox);
+
+	TArray<FStreetMapBuildingRef> Result;
+	if (!WorldBox.IsValid)
 	{
-		const FStreetMapRoad& Road = Roads[RoadIndex];
-		
-		for (int32 PointIndex = 0; PointIndex < Road.RoadPoints.Num(); ++PointIndex)
+		return Result;
+	}
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+
+	TArray<int32> ScratchIndices;
+	StreetMapSubsystem::FindBuildingsInBox(MakeConstArrayView(Targets), WorldBox, ScratchIndices, Result);
+	return Result;
+}
+
+TArray<FStreetMapRoadLocation> UStreetMapSubsystem::FindNearestRoads(const FVector& WorldLocation, int32 Count, const FStreetMapQueryFilter& Filter, float MaxSearchDistance) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindNearestRoads);
+
+	TArray<FStreetMapRoadLocation> Result;
+	if (Count <= 0)
+	{
+		return Result;
+	}
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+
+	double MaxDistance = StreetMapSubsystem::GetMaxSearchDistance(MaxSearchDistance);
+	TArray<FStreetMapRoadLocation> MapRoadLocations;
+	for (const FQueryTarget& Target : Targets)
+	{
+		const FVector2D MapLocation = Target.WorldToMap(WorldLocation);
+		if (Target.GetWorldDistanceToBounds(MapLocation) >= MaxDistance)
+		{
+			continue;
+		}
+
+		const TArray<FStreetMapRoad>& Roads = Target.Snapshot->GetRoads();
+		Target.DerivedData->GetRoadSegmentIndex().FindNearestRoads(Roads, MapLocation, Count, MaxDistance * Target.WorldToMapScale, [&Roads, &Filter](const int32 RoadIndex)
+		{
+			return Filter.AllowsRoadType(Roads[RoadIndex].RoadType);
+		}, MapRoadLocations);
+
+		for (FStreetMapRoadLocation& RoadLocation : MapRoadLocations)
+		{
+			RoadLocation.Distance = (float)(FVector2D::Distance(MapLocation, RoadLocation.Location) / Target.WorldToMapScale);
+			RoadLocation.WorldLocation = Target.MapToWorldLocation(RoadLocation.Location);
+			RoadLocation.StreetMap = Target.StreetMap;
+			RoadLocation.Component = Target.Component;
+			Result.Add(RoadLocation);
+		}
+		StreetMapSubsystem::KeepNearest(Result, Count, MaxDistance);
+	}
+	return Result;
+}
+
+TArray<FStreetMapNodeRef> UStreetMapSubsystem::FindNearestNodes(const FVector& WorldLocation, int32 Count, const FStreetMapQueryFilter& Filter, float MaxSearchDistance) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindNearestNodes);
+
+	TArray<FStreetMapNodeRef> Result;
+	if (Count <= 0)
+	{
+		return Result;
+	}
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+
+	double MaxDistance = StreetMapSubsystem::GetMaxSearchDistance(MaxSearchDistance);
+	TArray<FStreetMapNearestItem> MapNodes;
+	for (const FQueryTarget& Target : Targets)
+	{
+		const FVector2D MapLocation = Target.WorldToMap(WorldLocation);
+		if (Target.GetWorldDistanceToBounds(MapLocation) >= MaxDistance)
+		{
+			continue;
+		}
+
+		const FStreetMapSnapshot& Snapshot = *Target.Snapshot;
+		const TArray<FStreetMapNode>& Nodes = Snapshot.GetNodes();
+		const TArray<FStreetMapRoad>& Roads = Snapshot.GetRoads();
+		Target.DerivedData->GetNodeIndex().FindNearestNodes(MapLocation, Count, MaxDistance * Target.WorldToMapScale, [&](const int32 NodeIndex)
 		{
-			const float DistSquared = FVector2D::DistSquared(Location2D, Road.RoadPoints[PointIndex]);
-			if (DistSquared < BestDistanceSquared)
+			if (!Nodes.IsValidIndex(NodeIndex) || Nodes[NodeIndex].NumRoadRefs < Filter.MinNodeRoadCount)
 			{
-				BestDistanceSquared = DistSquared;
-				OutRoadIndex = RoadIndex;
-				OutPointIndex = PointIndex;
+				return false;
 			}
+			if (Filter.AllowedRoadTypes.Num() == 0)
+			{
+				return true;
+			}
+			for (const FStreetMapRoadRef& RoadRef : Snapshot.GetRoadRefs(Nodes[NodeIndex]))
+			{
+				if (Roads.IsValidIndex(RoadRef.RoadIndex) && Filter.AllowsRoadType(Roads[RoadRef.RoadIndex].RoadType))
+				{
+					return true;
+				}
+			}
+			return false;
+		}, MapNodes);
+
+		for (const FStreetMapNearestItem& MapNode : MapNodes)
+		{
+			FStreetMapNodeRef& Node = Result.AddDefaulted_GetRef();
+			Node.NodeIndex = MapNode.Index;
+			Node.StreetMap = Target.StreetMap;
+			Node.Component = Target.Component;
+			Node.WorldLocation = Target.MapToWorldLocation(Nodes[MapNode.Index].Location);
+			Node.Distance = (float)(MapNode.Distance / Target.WorldToMapScale);
 		}
+		StreetMapSubsystem::KeepNearest(Result, Count, MaxDistance);
 	}
+	return Result;
+}
+
+TArray<FStreetMapBuildingRef> UStreetMapSubsystem::FindNearestBuildings(const FVector& WorldLocation, int32 Count, const FStreetMapQueryFilter& Filter, float MaxSearchDistance) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindNearestBuildings);
+
+	TArray<FStreetMapBuildingRef> Result;
+	if (Count <= 0)
+	{
+		return Result;
+	}
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
 
-	return OutRoadIndex != INDEX_NONE;
+	double MaxDistance = StreetMapSubsystem::GetMaxSearchDistance(MaxSearchDistance);
+	TArray<FStreetMapNearestItem> MapBuildings;
+	for (const FQueryTarget& Target : Targets)
+	{
+		const FVector2D MapLocation = Target.WorldToMap(WorldLocation);
+		if (Target.GetWorldDistanceToBounds(MapLocation) >= MaxDistance)
+		{
+			continue;
+		}
+
+		const TArray<FStreetMapBuilding>& Buildings = Target.Snapshot->GetBuildings();
+		Target.DerivedData->GetBuildingIndex().FindNearestBuildings(Buildings, MapLocation, Count, MaxDistance * Target.WorldToMapScale, [&Buildings, &Filter](const int32 BuildingIndex)
+		{
+			return Filter.AllowsBuilding(Buildings[BuildingIndex]);
+		}, MapBuildings);
+
+		for (const FStreetMapNearestItem& MapBuilding : MapBuildings)
+		{
+			FStreetMapBuildingRef& Building = Result.Add_GetRef(StreetMapSubsystem::MakeBuildingRef(Target, MapBuilding.Index));
+			Building.Distance = (float)(MapBuilding.Distance / Target.WorldToMapScale);
+		}
+		StreetMapSubsystem::KeepNearest(Result, Count, MaxDistance);
+	}
+	return Result;
 }
 
-TArray<int32> UStreetMapSubsystem::FindBuildingsInRadius(const FVector& WorldLocation, float Radius) const
+void UStreetMapSubsystem::FindFeaturesInBox(const FBox& WorldBox, FStreetMapVolumeQueryResult& OutResult) const
 {
-	TArray<int32> Result;
+	OutResult.Reset();
+	if (!WorldBox.IsValid)
+	{
+		return;
+	}
 
-	UStreetMap* StreetMap = GetPrimaryStreetMap();
-	if (!StreetMap)
+	const FPlane BoxPlanes[] =
+	{
+		FPlane(FVector(1.0, 0.0, 0.0), WorldBox.Max.X),
+		FPlane(FVector(-1.0, 0.0, 0.0), -WorldBox.Min.X),
+		FPlane(FVector(0.0, 1.0, 0.0), WorldBox.Max.Y),
+		FPlane(FVector(0.0, -1.0, 0.0), -WorldBox.Min.Y),
+		FPlane(FVector(0.0, 0.0, 1.0), WorldBox.Max.Z),
+		FPlane(FVector(0.0, 0.0, -1.0), -WorldBox.Min.Z),
+	};
+	FindFeaturesInPlanes(BoxPlanes, OutResult);
+}
+
+void UStreetMapSubsystem::FindFeaturesInView(const FMinimalViewInfo& View, FStreetMapVolumeQueryResult& OutResult) const
+{
+	FMatrix ViewMatrix, ProjectionMatrix, ViewProjectionMatrix;
+	UGameplayStatics::GetViewProjectionMatrix(View, ViewMatrix, ProjectionMatrix, ViewProjectionMatrix);
+
+	FConvexVolume Frustum;
+	GetViewFrustumBounds(Frustum, ViewProjectionMatrix, /* UseNearPlane */ true);
+	FindFeaturesInVolume(Frustum, OutResult);
+}
+
+void UStreetMapSubsystem::FindFeaturesInVolume(const FConvexVolume& WorldVolume, FStreetMapVolumeQueryResult& OutResult) const
+{
+	OutResult.Reset();
+	FindFeaturesInPlanes(WorldVolume.Planes, OutResult);
+}
+
+void UStreetMapSubsystem::FindFeaturesInPlanes(TArrayView<const FPlane> WorldPlanes, FStreetMapVolumeQueryResult& OutResult) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindFeaturesInVolume);
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+
+	TArray<FPlane, TInlineAllocator<12>> MapPlanes;
+	for (const FQueryTarget& Target : Targets)
+	{
+		// Planes carried into map space, and the volume cut down to the space above the street map
+		const FMatrix WorldToMap = Target.MapToWorld.ToInverseMatrixWithScale();
+		MapPlanes.Reset();
+		for (const FPlane& Plane : WorldPlanes)
+		{
+			MapPlanes.Add(Plane.TransformBy(WorldToMap));
+		}
+		const FBox ClipBox(FVector(Target.MapBounds.Min, 0.0), FVector(Target.MapBounds.Max, StreetMapSubsystem::MaxVolumeQueryHeight));
+		const FStreetMapQueryVolume Volume(MapPlanes, ClipBox);
+		if (Volume.IsEmpty())
+		{
+			continue;
+		}
+
+		const int32 FirstRoadRange = OutResult.RoadRanges.Num();
+		Target.DerivedData->GetRoadSegmentIndex().FindRoadsInVolume(Target.Snapshot->GetRoads(), Volume, OutResult.RoadRanges);
+		for (int32 RangeIndex = FirstRoadRange; RangeIndex < OutResult.RoadRanges.Num(); ++RangeIndex)
+		{
+			OutResult.RoadRanges[RangeIndex].StreetMap = Target.StreetMap;
+			OutResult.RoadRanges[RangeIndex].Component = Target.Component;
+		}
+
+		OutResult.ScratchBuildingIndices.Reset();
+		Target.DerivedData->GetBuildingIndex().FindBuildingsInVolume(Target.Snapshot->GetBuildings(), Volume, Target.BuildingLevelHeight, OutResult.ScratchBuildingIndices);
+		for (const int32 BuildingIndex : OutResult.ScratchBuildingIndices)
+		{
+			OutResult.Buildings.Add(StreetMapSubsystem::MakeBuildingRef(Target, BuildingIndex));
+		}
+	}
+}
+
+bool UStreetMapSubsystem::LineTraceBuildings(const FVector& Start, const FVector& End, FStreetMapBuildingHit& OutHit) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_LineTraceBuildings);
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+	return StreetMapSubsystem::LineTraceBuildings(MakeConstArrayView(Targets), Start, End, OutHit);
+}
+
+bool UStreetMapSubsystem::HasLineOfSight(const FVector& From, const FVector& To) const
+{
+	FStreetMapBuildingHit Hit;
+	return !LineTraceBuildings(From, To, Hit);
+}
+
+TArray<FStreetMapNamedFeatures> UStreetMapSubsystem::FindFeaturesByName(const FString& Text, int32 MaxResults, int32 MaxEdits) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindFeaturesByName);
+
+	TArray<FStreetMapNamedFeatures> Result;
+	if (MaxResults <= 0)
 	{
 		return Result;
 	}
 
-	const TArray<FStreetMapBuilding>& Buildings = StreetMap->GetBuildings();
-	const float RadiusSquared = Radius * Radius;
-	const FVector2D Location2D(WorldLocation.X, WorldLocation.Y);
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+
+	// Names don't depend on where a street map is, so a street map shown by several components is only searched once
+	TArray<const UStreetMap*, TInlineAllocator<8>> SearchedStreetMaps;
+	TArray<FStreetMapNameIndexMatch> Matches;
+
+	// Each street map's matches come sorted by edits, then by the name from the matching word on.  Results from every
+	// street map are merged in that same order, whether there is one street map or several.
+	TArray<FString> MatchTexts;
+	for (const FQueryTarget& Target : Targets)
+	{
+		if (SearchedStreetMaps.Contains(Target.StreetMap))
+		{
+			continue;
+		}
+		SearchedStreetMaps.Add(Target.StreetMap);
+
+		const FStreetMapNameIndex& NameIndex = Target.Snapshot->GetNameIndex();
+		if (MaxEdits > 0)
+		{
+			NameIndex.FindByFuzzyPrefix(Text, MaxEdits, MaxResults, Matches);
+		}
+		else
+		{
+			NameIndex.FindByPrefix(Text, MaxResults, Matches);
+		}
+
+		for (const FStreetMapNameIndexMatch& Match : Matches)
+		{
+			FStreetMapNamedFeatures& NamedFeatures = Result.AddDefaulted_GetRef();
+			NamedFeatures.Name = Target.Snapshot->GetNameById(NameIndex.GetEntryNameId(Match.EntryIndex));
+			const TArrayView<const int32> RoadIndices = NameIndex.GetEntryRoads(Match.EntryIndex);
+			const TArrayView<const int32> BuildingIndices = NameIndex.GetEntryBuildings(Match.EntryIndex);
+			NamedFeatures.RoadIndices.Append(RoadIndices.GetData(), RoadIndices.Num());
+			NamedFeatures.BuildingIndices.Append(BuildingIndices.GetData(), BuildingIndices.Num());
+			NamedFeatures.EditDistance = Match.EditDistance;
+			NamedFeatures.StreetMap = Target.StreetMap;
+			NamedFeatures.Component = Target.Component;
+			MatchTexts.Add(NameIndex.GetMatchText(Match));
+		}
+	}
 
-	for (int32 BuildingIndex = 0; BuildingIndex < Buildings.Num(); ++BuildingIndex)
+	if (SearchedStreetMaps.Num() > 1)
 	{
-		const FStreetMapBuilding& Building = Buildings[BuildingIndex];
-		
-		// Use building center for distance check
-		const FVector2D BuildingCenter = (Building.BoundsMin + Building.BoundsMax) * 0.5f;
-		
-		if (FVector2D::DistSquared(Location2D, BuildingCenter) <= RadiusSquared)
+		TArray<int32> Order;
+		Order.Reserve(Result.Num());
+		for (int32 ResultIndex = 0; ResultIndex < Result.Num(); ++ResultIndex)
+		{
+			Order.Add(ResultIndex);
+		}
+		Algo::StableSort(Order, [&Result, &MatchTexts](const int32 A, const int32 B)
+		{
+			return Result[A].EditDistance != Result[B].EditDistance ? Result[A].EditDistance < Result[B].EditDistance : MatchTexts[A].Compare(MatchTexts[B], ESearchCase::CaseSensitive) < 0;
+		});
+
+		TArray<FStreetMapNamedFeatures> SortedResult;
+		SortedResult.Reserve(FMath::Min(Result.Num(), MaxResults));
+		for (int32 OrderIndex = 0; OrderIndex < Order.Num() && OrderIndex < MaxResults; ++OrderIndex)
 		{
-			Result.Add(BuildingIndex);
+			SortedResult.Add(MoveTemp(Result[Order[OrderIndex]]));
 		}
+		Result = MoveTemp(SortedResult);
 	}
+	return Result;
+}
 
+TArray<FStreetMapRoadLocation> UStreetMapSubsystem::MatchTrace(const TArray<FVector>& WorldLocations, const FStreetMapMapMatchSettings& Settings) const
+{
+	TArray<FStreetMapRoadLocation> Result;
+	Result.SetNum(WorldLocations.Num());
+	const int32 TraceOffsets[] = { 0, WorldLocations.Num() };
+	MatchTraces(WorldLocations, TraceOffsets, Settings, Result);
 	return Result;
 }
+
+void UStreetMapSubsystem::FindNearestRoadPoints(TArrayView<const FVector> WorldLocations, TArrayView<FStreetMapRoadPointRef> OutRoadPoints, float MaxSearchDistance) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindNearestRoadPoints);
+
+	check(WorldLocations.Num() == OutRoadPoints.Num());
+
+	// Every worker reads the same snapshots, so all results come from one consistent version of each map
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+	const TArrayView<const FQueryTarget> TargetView = Targets;
+	const double MaxDistance = StreetMapSubsystem::GetMaxSearchDistance(MaxSearchDistance);
+	StreetMapSubsystem::ForEachChunk(WorldLocations.Num(), [&](const int32 Begin, const int32 End)
+	{
+		for (int32 QueryIndex = Begin; QueryIndex < End; ++QueryIndex)
+		{
+			StreetMapSubsystem::FindNearestRoadPoint(TargetView, WorldLocations[QueryIndex], MaxDistance, OutRoadPoints[QueryIndex]);
+		}
+	});
+}
+
+void UStreetMapSubsystem::FindNearestRoadLocations(TArrayView<const FVector> WorldLocations, TArrayView<FStreetMapRoadLocation> OutRoadLocations, float MaxSearchDistance) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindNearestRoadLocations);
+
+	check(WorldLocations.Num() == OutRoadLocations.Num());
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+	const TArrayView<const FQueryTarget> TargetView = Targets;
+	const double MaxDistance = StreetMapSubsystem::GetMaxSearchDistance(MaxSearchDistance);
+	StreetMapSubsystem::ForEachChunk(WorldLocations.Num(), [&](const int32 Begin, const int32 End)
+	{
+		for (int32 QueryIndex = Begin; QueryIndex < End; ++QueryIndex)
+		{
+			StreetMapSubsystem::FindNearestRoadLocation(TargetView, WorldLocations[QueryIndex], MaxDistance, OutRoadLocations[QueryIndex]);
+		}
+	});
+}
+
+void UStreetMapSubsystem::FindBuildingsAtLocations(TArrayView<const FVector> WorldLocations, TArrayView<FStreetMapBuildingRef> OutBuildings) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindBuildingsAtLocations);
+
+	check(WorldLocations.Num() == OutBuildings.Num());
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+	const TArrayView<const FQueryTarget> TargetView = Targets;
+	StreetMapSubsystem::ForEachChunk(WorldLocations.Num(), [&](const int32 Begin, const int32 End)
+	{
+		for (int32 QueryIndex = Begin; QueryIndex < End; ++QueryIndex)
+		{
+			OutBuildings[QueryIndex] = StreetMapSubsystem::FindBuildingAtLocation(TargetView, WorldLocations[QueryIndex]);
+		}
+	});
+}
+
+void UStreetMapSubsystem::FindBuildingsInRadiusBatch(TArrayView<const FVector> WorldLocations, float Radius, TArray<FStreetMapBuildingRef>& OutBuildings, TArray<int32>& OutResultOffsets) const
+{
+	using namespace StreetMapSubsystem;
+
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindBuildingsInRadiusBatch);
+
+	const int32 QueryCount = WorldLocations.Num();
+	OutBuildings.Reset();
+	OutResultOffsets.Reset(QueryCount + 1);
+	OutResultOffsets.AddZeroed(QueryCount + 1);
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+	if (Targets.Num() == 0)
+	{
+		return;
+	}
+
+	// Each worker appends the buildings of the chunks it runs to its own scratch space, and counts them per query.
+	// The counts become offsets, and then each chunk's buildings are copied to where they belong.
+	const TArrayView<const FQueryTarget> TargetView = Targets;
+	check(BatchScratchPool);
+	const int32 NumChunks = FMath::DivideAndRoundUp(QueryCount, BatchChunkSize);
+	const EParallelForFlags Flags = NumChunks <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None;
+	const TScratchPool<FBuildingQueryScratch>::FScopedSet WorkerScratch(BatchScratchPool->BuildingQueries, ParallelForImpl::GetNumberOfThreadTasks(NumChunks, 1, Flags));
+	ParallelForWithExistingTaskContext(WorkerScratch.GetContexts(), NumChunks, 1, [&](FBuildingQueryScratch& Scratch, const int32 ChunkIndex)
+	{
+		const int32 Begin = ChunkIndex * BatchChunkSize;
+		const int32 End = FMath::Min(Begin + BatchChunkSize, QueryCount);
+		Scratch.Chunks.Emplace(Begin, Scratch.Buildings.Num());
+		for (int32 QueryIndex = Begin; QueryIndex < End; ++QueryIndex)
+		{
+			const int32 FirstBuilding = Scratch.Buildings.Num();
+			StreetMapSubsystem::FindBuildingsInRadius(TargetView, WorldLocations[QueryIndex], Radius, Scratch.BuildingIndices, Scratch.Buildings);
+			OutResultOffsets[QueryIndex + 1] = Scratch.Buildings.Num() - FirstBuilding;
+		}
+	}, Flags);
+
+	for (int32 QueryIndex = 0; QueryIndex < QueryCount; ++QueryIndex)
+	{
+		OutResultOffsets[QueryIndex + 1] += OutResultOffsets[QueryIndex];
+	}
+
+	OutBuildings.SetNum(OutResultOffsets.Last());
+	for (const FBuildingQueryScratch& Scratch : WorkerScratch.GetContexts())
+	{
+		for (const TPair<int32, int32>& Chunk : Scratch.Chunks)
+		{
+			const int32 FirstQuery = Chunk.Key;
+			const int32 EndQuery = FMath::Min(FirstQuery + BatchChunkSize, QueryCount);
+			const int32 Count = OutResultOffsets[EndQuery] - OutResultOffsets[FirstQuery];
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				OutBuildings[OutResultOffsets[FirstQuery] + Index] = Scratch.Buildings[Chunk.Value + Index];
+			}
+		}
+	}
+}
+
+void UStreetMapSubsystem::LineTraceBuildingsBatch(TArrayView<const FVector> Starts, TArrayView<const FVector> Ends, TArrayView<FStreetMapBuildingHit> OutHits) const
+{
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_LineTraceBuildingsBatch);
+
+	check(Starts.Num() == Ends.Num() && Starts.Num() == OutHits.Num());
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+	const TArrayView<const FQueryTarget> TargetView = Targets;
+	StreetMapSubsystem::ForEachChunk(Starts.Num(), [&](const int32 Begin, const int32 End)
+	{
+		for (int32 QueryIndex = Begin; QueryIndex < End; ++QueryIndex)
+		{
+			StreetMapSubsystem::LineTraceBuildings(TargetView, Starts[QueryIndex], Ends[QueryIndex], OutHits[QueryIndex]);
+		}
+	});
+}
+
+void UStreetMapSubsystem::MatchTraces(TArrayView<const FVector> WorldLocations, TArrayView<const int32> TraceOffsets, const FStreetMapMapMatchSettings& Settings, TArrayView<FStreetMapRoadLocation> OutRoadLocations) const
+{
+	using namespace StreetMapSubsystem;
+
+	STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_MatchTraces);
+
+	check(WorldLocations.Num() == OutRoadLocations.Num());
+	check(TraceOffsets.Num() == 0 || (TraceOffsets[0] == 0 && TraceOffsets.Last() == WorldLocations.Num()));
+
+	FQueryTargets Targets;
+	GetQueryTargets(Targets);
+	TArray<FStreetMapMapMatcher, TInlineAllocator<8>> Matchers;
+	for (const FQueryTarget& Target : Targets)
+	{
+		Matchers.Emplace(Target.Snapshot.ToSharedRef(), Settings, Target.WorldToMapScale);
+	}
+
+	// Traces are matched one per task, since one trace's samples depend on each other
+	const TArrayView<const FQueryTarget> TargetView = Targets;
+	const TArrayView<const FStreetMapMapMatcher> MatcherView = Matchers;
+	check(BatchScratchPool);
+	const int32 TraceCount = FMath::Max(TraceOffsets.Num() - 1, 0);
+	const EParallelForFlags Flags = TraceCount <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None;
+	const TScratchPool<FMapMatchScratch>::FScopedSet WorkerScratch(BatchScratchPool->MapMatches, ParallelForImpl::GetNumberOfThreadTasks(TraceCount, 1, Flags));
+	ParallelForWithExistingTaskContext(WorkerScratch.GetContexts(), TraceCount, 1, [&](FMapMatchScratch& Scratch, const int32 TraceIndex)
+	{
+		const int32 FirstSample = TraceOffsets[TraceIndex];
+		const int32 SampleCount = TraceOffsets[TraceIndex + 1] - FirstSample;
+		StreetMapSubsystem::MatchTrace(TargetView, MatcherView, WorldLocations.Slice(FirstSample, SampleCount), OutRoadLocations.Slice(FirstSample, SampleCount), Scratch);
+	}, Flags);
+}
+
+TFuture<FStreetMapRoadLocation> UStreetMapSubsystem::FindNearestRoadLocationAsync(const FVector& WorldLocation, float MaxSearchDistance) const
+{
+	FQueryTargetSources Sources;
+	GetQueryTargetSources(Sources);
+
+	const double MaxDistance = StreetMapSubsystem::GetMaxSearchDistance(MaxSearchDistance);
+	return StreetMapSubsystem::RunQueryAsync<FStreetMapRoadLocation, FQueryTargets>(MoveTemp(Sources), [WorldLocation, MaxDistance](TArrayView<const FQueryTarget> QueryTargets)
+	{
+		STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindNearestRoadLocation);
+
+		FStreetMapRoadLocation RoadLocation;
+		StreetMapSubsystem::FindNearestRoadLocation(QueryTargets, WorldLocation, MaxDistance, RoadLocation);
+		return RoadLocation;
+	});
+}
+
+TFuture<FStreetMapBuildingRef> UStreetMapSubsystem::FindBuildingAtLocationAsync(const FVector& WorldLocation) const
+{
+	FQueryTargetSources Sources;
+	GetQueryTargetSources(Sources);
+
+	return StreetMapSubsystem::RunQueryAsync<FStreetMapBuildingRef, FQueryTargets>(MoveTemp(Sources), [WorldLocation](TArrayView<const FQueryTarget> QueryTargets)
+	{
+		STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindBuildingAtLocation);
+
+		return StreetMapSubsystem::FindBuildingAtLocation(QueryTargets, WorldLocation);
+	});
+}
+
+TFuture<TArray<FStreetMapBuildingRef>> UStreetMapSubsystem::FindBuildingsInRadiusAsync(const FVector& WorldLocation, float Radius) const
+{
+	FQueryTargetSources Sources;
+	GetQueryTargetSources(Sources);
+
+	return StreetMapSubsystem::RunQueryAsync<TArray<FStreetMapBuildingRef>, FQueryTargets>(MoveTemp(Sources), [WorldLocation, Radius](TArrayView<const FQueryTarget> QueryTargets)
+	{
+		STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindBuildingsInRadius);
+
+		TArray<FStreetMapBuildingRef> Buildings;
+		TArray<int32> ScratchIndices;
+		StreetMapSubsystem::FindBuildingsInRadius(QueryTargets, WorldLocation, Radius, ScratchIndices, Buildings);
+		return Buildings;
+	});
+}
+
+TFuture<TArray<FStreetMapBuildingRef>> UStreetMapSubsystem::FindBuildingsInBoxAsync(const FBox& WorldBox) const
+{
+	FQueryTargetSources Sources;
+	if (WorldBox.IsValid)
+	{
+		GetQueryTargetSources(Sources);
+	}
+
+	return StreetMapSubsystem::RunQueryAsync<TArray<FStreetMapBuildingRef>, FQueryTargets>(MoveTemp(Sources), [WorldBox](TArrayView<const FQueryTarget> QueryTargets)
+	{
+		STREETMAP_SCOPE_CYCLE_COUNTER(STAT_StreetMap_FindBuildingsInBox);
+
+		TArray<FStreetMapBuildingRef> Buildings;
+		TArray<int32> ScratchIndices;
+		StreetMapSubsystem::FindBuildingsInBox(QueryTargets, WorldBox, ScratchIndices, Buildings);
+		return Buildings;
+	});
+}
+
+void UStreetMapSubsystem::FindNearestRoadLocationLatent(const FVector& WorldLocation, float MaxSearchDistance, bool& bOutFound, FStreetMapRoadLocation& OutRoadLocation, FLatentActionInfo LatentInfo)
+{
+	// Output pins live in the Blueprint's frame, which outlives the latent action
+	FStreetMapQueryLatentAction<FStreetMapRoadLocation>::Start(GetWorld(), LatentInfo,
+		[&]() { return FindNearestRoadLocationAsync(WorldLocation, MaxSearchDistance); },
+		[&bOutFound, &OutRoadLocation](FStreetMapRoadLocation&& RoadLocation)
+		{
+			bOutFound = RoadLocation.IsValid();
+			OutRoadLocation = MoveTemp(RoadLocation);
+		});
+}
+
+void UStreetMapSubsystem::FindBuildingAtLocationLatent(const FVector& WorldLocation, bool& bOutFound, FStreetMapBuildingRef& OutBuilding, FLatentActionInfo LatentInfo)
+{
+	FStreetMapQueryLatentAction<FStreetMapBuildingRef>::Start(GetWorld(), LatentInfo,
+		[&]() { return FindBuildingAtLocationAsync(WorldLocation); },
+		[&bOutFound, &OutBuilding](FStreetMapBuildingRef&& Building)
+		{
+			bOutFound = Building.IsValid();
+			OutBuilding = MoveTemp(Building);
+		});
+}
+
+void UStreetMapSubsystem::FindBuildingsInRadiusLatent(const FVector& WorldLocation, float Radius, TArray<FStreetMapBuildingRef>& OutBuildings, FLatentActionInfo LatentInfo)
+{
+	FStreetMapQueryLatentAction<TArray<FStreetMapBuildingRef>>::Start(GetWorld(), LatentInfo,
+		[&]() { return FindBuildingsInRadiusAsync(WorldLocation, Radius); },
+		[&OutBuildings](TArray<FStreetMapBuildingRef>&& Buildings)
+		{
+			OutBuildings = MoveTemp(Buildings);
+		});
+}
+
+void UStreetMapSubsystem::FindBuildingsInBoxLatent(const FBox& WorldBox, TArray<FStreetMapBuildingRef>& OutBuildings, FLatentActionInfo LatentInfo)
+{
+	FStreetMapQueryLatentAction<TArray<FStreetMapBuildingRef>>::Start(GetWorld(), LatentInfo,
+		[&]() { return FindBuildingsInBoxAsync(WorldBox); },
+		[&OutBuildings](TArray<FStreetMapBuildingRef>&& Buildings)
+		{
+			OutBuildings = MoveTemp(Buildings);
+		});
+}
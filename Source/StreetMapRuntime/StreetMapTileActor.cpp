@@ -0,0 +1,22 @@
+#include "StreetMapTileActor.h"
+#include "StreetMapComponent.h"
+#include "StreetMap.h"
+
+AStreetMapTileActor::AStreetMapTileActor(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+	, TileCoordinate(FIntPoint::ZeroValue)
+{
+	// Tiles never move, and each one should only be loaded when the player is near it
+	StreetMapComponent->SetMobility(EComponentMobility::Static);
+#if WITH_EDITORONLY_DATA
+	bIsSpatiallyLoaded = true;
+#endif
+}
+
+void AStreetMapTileActor::SetStreetMapTile(UStreetMap* StreetMapTile)
+{
+	check(StreetMapTile != nullptr && StreetMapTile->IsTile());
+
+	TileCoordinate = StreetMapTile->GetTileCoordinate();
+	StreetMapComponent->SetStreetMap(StreetMapTile, true, true);
+}